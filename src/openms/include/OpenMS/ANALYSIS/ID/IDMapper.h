@@ -295,6 +295,9 @@ protected:
     /// increase a bounding box by the given RT and m/z tolerances
     void increaseBoundingBox_(DBoundingBox<2>& box);
 
+    /// increase a bounding box of observed positions, so that it contains all peptide positions that can match them according to isMatch_()
+    void increaseMatchingBox_(DBoundingBox<2>& box) const;
+
     /// try to determine the type of m/z value reported for features, return
     /// whether average peptide masses should be used for matching
     bool checkMassType_(const std::vector<DataProcessing>& processing) const;
@@ -119,6 +119,18 @@ public:
     std::pair<bool, double> operator()(const BaseFeature & left,
                                            const BaseFeature & right);
 
+    /**
+       @brief Computes a lower bound for the distance between two features with at least the given RT and m/z differences
+
+       Intensities, charge states and constraints are not taken into account, so the result never exceeds the distance computed by operator() for such a pair of features.
+       This can be used to exclude features from neighbor searches without computing their distances.
+
+       @param rt_diff Minimum absolute RT difference
+       @param mz_diff Minimum absolute m/z difference
+       @param left_mz Largest m/z of the left feature (only relevant if the m/z tolerance is given in ppm)
+    */
+    double lowerBound(double rt_diff, double mz_diff, double left_mz) const;
+
 protected:
 
     /// Structure for storing distance parameters
@@ -55,6 +55,17 @@ namespace OpenMS
       The second way is more memory efficient because at all times, only the
       reference map and the current map need to be in memory
 
+      With "group", the maps can also be combined hierarchically (parameter
+      @p merge_strategy set to "tree"): pairs of maps are merged in parallel,
+      then pairs of the resulting consensus maps, and so on, which replaces the
+      N-1 sequential merges by about log2(N) levels of parallel merges. This
+      needs more memory than the sequential way: all input maps are passed in
+      memory and the results of a level are kept until the next level is
+      done. Parameter @p max_parallel_merges limits the number of concurrent
+      merges, i.e. only the working memory of the pair finders (the input
+      maps are converted to consensus maps just before they are merged). The
+      time taken by each level is reported to the info log.
+
       @htmlinclude OpenMS_FeatureGroupingAlgorithmUnlabeled.parameters
 
       @ingroup FeatureGrouping
@@ -123,6 +134,15 @@ public:
 
 private:
 
+    /// Returns the parameters for the pair finder (i.e. without the ones of this class)
+    Param pairFinderParameters_() const;
+
+    /// Adds the maps one by one to the consensus of the largest map and the ones added before
+    void mergeSequential_(const std::vector<FeatureMap>& maps, ConsensusMap& out) const;
+
+    /// Merges pairs of maps (in parallel), then pairs of the results, and so on
+    void mergeTree_(const std::vector<FeatureMap>& maps, ConsensusMap& out) const;
+
     // This vector should always have 2 elements
     // - the first element is the currently computed consensus map.
     //   After initialization of the algorithm, it will consist of the reference
@@ -45,6 +45,7 @@
 #include <boost/unordered_map.hpp>
 
 #include <list>
+#include <queue>
 #include <vector>
 #include <set>
 #include <utility> // for pair<>
@@ -92,7 +93,11 @@ namespace OpenMS
    This algorithm includes a number of optimizations to reduce run-time:
    @li two-dimensional hashing of features,
    @li a look-up table for feature distances,
-   @li a variant of QT clustering that requires only one round of clustering.
+   @li a variant of QT clustering that requires only one round of clustering,
+   @li parallel computation of the initial clusters (if OpenMP is enabled),
+   @li a priority queue of clusters ordered by quality, from which outdated
+       entries are discarded lazily, so that finding the next best cluster
+       does not require a scan over all clusters.
 
    @see FeatureGroupingAlgorithmQT
 
@@ -117,6 +122,36 @@ private:
 
     typedef HashGrid<OpenMS::GridFeature*> Grid;
 
+    /**
+       @brief Entry of the queue of clusters ordered by quality
+
+       An entry is outdated if the quality of its cluster changed after the
+       entry was added (a new entry is added for every change), or if the
+       cluster became invalid. Among clusters of equal quality, the one that
+       comes first in the clustering is preferred.
+    */
+    struct QueueEntry_
+    {
+      /// Quality of the cluster when the entry was added
+      double quality;
+      /// Index of the cluster in the clustering
+      Size index;
+
+      QueueEntry_(double quality_, Size index_) :
+        quality(quality_), index(index_)
+      {
+      }
+
+      bool operator<(const QueueEntry_& rhs) const
+      {
+        if (quality != rhs.quality) return quality < rhs.quality;
+        return index > rhs.index;
+      }
+    };
+
+    /// Queue of clusters, the best cluster is on top
+    typedef std::priority_queue<QueueEntry_> ClusterQueue;
+
     /// Number of input maps
     Size num_maps_;
 
@@ -138,22 +173,33 @@ private:
     /// Set of features already used
     std::set<OpenMS::GridFeature*> already_used_;
 
-    /**
-       @brief Calculates the distance between two grid features.
-    */
-    double getDistance_(const OpenMS::GridFeature* left, const
-        OpenMS::GridFeature* right);
-
     /// Sets algorithm parameters
     void setParameters_(double max_intensity, double max_mz);
 
-    /// Generates a consensus feature from the best cluster and updates the clustering
-    void makeConsensusFeature_(std::list<QTCluster>& clustering,
+    /**
+       @brief Generates a consensus feature from the best cluster and updates the clustering
+
+       @return False if no valid cluster was left (@p feature is not set in this case)
+    */
+    bool makeConsensusFeature_(std::vector<QTCluster>& clustering,
+                               ClusterQueue& queue,
                                ConsensusFeature& feature,
-                               ElementMapping& element_mapping, Grid&);
+                               ElementMapping& element_mapping, const Grid& grid);
+
+    /**
+       @brief Sorts grid entries into the iteration order of the former HashGrid
+
+       QT clustering breaks ties between equidistant neighbors (and between
+       clusters of equal quality) by the order in which it visits the grid.
+       That order came from the nested hash maps in which HashGrid used to
+       store its cells. Inserting the entries in this order into the grid
+       restores it (for iteration over the grid as well as within each cell),
+       so the linking results do not change.
+    */
+    static void sortInFormerGridOrder_(const Grid& grid, std::vector<Grid::value_type>& entries);
 
     /// Computes an initial QT clustering of the points in the hash grid
-    void computeClustering_(Grid& grid, std::list<QTCluster>& clustering);
+    void computeClustering_(const Grid& grid, std::vector<QTCluster>& clustering);
 
     /// Runs the algorithm on feature maps or consensus maps
     template <typename MapType>
@@ -164,9 +210,14 @@ private:
     void run_internal_(const std::vector<MapType>& input_maps,
                        ConsensusMap& result_map, bool do_progress);
 
-    /// Adds elements to the cluster based on the elements hashed in the grid
+    /**
+       @brief Adds elements to the cluster based on the elements hashed in the grid
+
+       @p feature_distance is passed explicitly, as computing distances may
+       change its internal state (threads need to use their own copy).
+    */
     void addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-      const OpenMS::GridFeature* center_feature);
+      const OpenMS::GridFeature* center_feature, FeatureDistance& feature_distance);
 
 protected:
 
@@ -37,6 +37,8 @@
 
 #include <OpenMS/ANALYSIS/MAPMATCHING/BaseGroupFinder.h>
 
+#include <set>
+
 namespace OpenMS
 {
   class AASequence;
@@ -168,6 +170,10 @@ protected:
     bool compatibleIDs_(const ConsensusFeature& feat1,
                         const ConsensusFeature& feat2) const;
 
+    /// Inserts the sequences of the best hits of all peptide identifications of @p feature into @p sequences
+    void collectBestHitSequences_(const ConsensusFeature& feature,
+                                  std::set<String>& sequences) const;
+
     /// The distance to the second nearest neighbors must be by this factor larger than the distance to the matched element itself.
     double second_nearest_gap_;
 
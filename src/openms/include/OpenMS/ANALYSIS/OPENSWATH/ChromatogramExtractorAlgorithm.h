@@ -55,6 +55,18 @@ namespace OpenMS
    * In the case of MS2 extraction, the map is assumed to originate from a SWATH
    * (data-independent acquisition or DIA) experiment.
    *
+   * The extraction is done as a sweep: the extraction windows of all
+   * coordinates are computed once and, since coordinates and peaks are both
+   * sorted by m/z, each spectrum is traversed in a single merge pass which
+   * keeps track of the first and last peak inside the current window.
+   *
+   * If OpenMP is available and the function is not called from within a
+   * parallel region, the spectra are split into contiguous RT blocks which
+   * are extracted in parallel (each thread using a light clone of the input).
+   * Each block writes its points directly into slots reserved for it in the
+   * output chromatograms, so the output is identical to the serial
+   * extraction without buffering the extracted points.
+   *
   */
   class OPENMS_DLLAPI ChromatogramExtractorAlgorithm :
     public ProgressLogger
@@ -97,6 +109,9 @@ public:
      * @param ppm Whether mz_extraction_window is in ppm or in Th
      * @param filter Which function to apply in m/z space (currently "tophat" only)
      *
+     * @note If reading a spectrum fails, the exception is passed on and the
+     * output chromatograms are left as they were before the call.
+     *
     */
     void extractChromatograms(const OpenSwath::SpectrumAccessPtr input, 
         std::vector< OpenSwath::ChromatogramPtr >& output, 
@@ -127,6 +142,9 @@ private:
 
     int getFilterNr_(String filter);
 
+    /// Computes the (open) extraction window (left, right) around @p mz
+    static void getExtractionWindow_(double mz, double mz_extraction_window, bool ppm, double& left, double& right);
+
   };
 
 }
@@ -41,6 +41,7 @@
 
 #include <OpenMS/KERNEL/MSSpectrum.h>
 #include <OpenMS/KERNEL/MSChromatogram.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <OpenMS/ANALYSIS/TARGETED/TargetedExperiment.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
@@ -60,6 +61,21 @@ public:
     /// Convert an OpenMS Spectrum to an SpectrumPtr
     static OpenSwath::SpectrumPtr convertToSpectrumPtr(const OpenMS::MSSpectrum<> & spectrum);
 
+    /**
+      @brief Moves the data arrays of a SpectrumPtr into a ColumnarSpectrum
+
+      The arrays are swapped, not copied: afterwards @p sptr holds the
+      previous peaks of @p spectrum (usually none).
+    */
+    static void swapToColumnarSpectrum(OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<> & spectrum);
+
+    /**
+      @brief Moves the columns of a ColumnarSpectrum into a new SpectrumPtr
+
+      The columns are swapped, not copied: afterwards @p spectrum is empty.
+    */
+    static OpenSwath::SpectrumPtr swapToSpectrumPtr(ColumnarSpectrum<> & spectrum);
+
     /// Convert a ChromatogramPtr to an OpenMS Chromatogram
     static void convertToOpenMSChromatogram(OpenMS::MSChromatogram<> & chromatogram, const OpenSwath::ChromatogramPtr cptr);
 
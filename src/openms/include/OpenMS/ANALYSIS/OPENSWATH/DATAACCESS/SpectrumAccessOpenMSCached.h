@@ -41,7 +41,15 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/ISpectrumAccess.h>
 
-#include <fstream>
+#include <boost/shared_ptr.hpp>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class mapped_region;
+  }
+}
 
 namespace OpenMS
 {
@@ -53,10 +61,18 @@ namespace OpenMS
     (ISpectrumAccess) using the CachedmzML class which is able to read and
     write a cached mzML file.
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    The cached file is memory-mapped (read-only) and spectra and
+    chromatograms are copied directly from the mapped pages into the
+    returned data arrays, no file stream or system call is involved on
+    access. The mapping, the binary index and the meta data are shared
+    between all light clones of an object, so that lightClone() does not
+    copy any data. Retention time lookups (getSpectraByRT) use a binary
+    search on the index stored at the end of the cached file.
+
+    @note Since no internal file pointer is kept, concurrent calls to
+    getSpectrumById and getChromatogramById are safe, even on the same
+    object. Note however that the OpenSwath::ISpectrumAccess interface in
+    general does not guarantee this.
 
   */
   class OPENMS_DLLAPI SpectrumAccessOpenMSCached :
@@ -68,7 +84,7 @@ public:
     typedef OpenMS::MSSpectrum<Peak1D> MSSpectrumType;
 
     /**
-      @brief Constructor, opens the file stream
+      @brief Constructor, maps the cached file into memory
 
       @param filename The filename of the .mzML file (it is assumed a second
       file .mzML.cached exists).
@@ -83,7 +99,7 @@ public:
     */
     ~SpectrumAccessOpenMSCached();
 
-    /// Copy constructor
+    /// Copy constructor (shares the memory mapping with @p rhs)
     SpectrumAccessOpenMSCached(const SpectrumAccessOpenMSCached & rhs);
 
     /// Light clone operator (actual data will not get copied)
@@ -109,11 +125,17 @@ public:
 
 private:
 
-    /// Meta data
-    MSExperimentType meta_ms_experiment_;
+    /// Meta data (shared between light clones)
+    boost::shared_ptr<MSExperimentType> meta_ms_experiment_;
 
-    /// Internal filestream 
-    std::ifstream ifs_;
+    /// Read-only memory mapping of the cached file (shared between light clones)
+    boost::shared_ptr<boost::interprocess::mapped_region> mapped_region_;
+
+    /// Start of the mapped memory
+    const char* mapped_data_;
+
+    /// Size of the mapped memory (in bytes)
+    Size mapped_size_;
 
     /// Name of the mzML file
     String filename_;
@@ -121,9 +143,13 @@ private:
     /// Name of the cached mzML file
     String filename_cached_;
 
-    /// Indices
-    std::vector<std::streampos> spectra_index_;
-    std::vector<std::streampos> chrom_index_;
+    /// Indices (shared between light clones)
+    boost::shared_ptr<std::vector<std::streampos> > spectra_index_;
+    boost::shared_ptr<std::vector<std::streampos> > chrom_index_;
+
+    /// Retention times and MS levels from the index of the cached file (shared between light clones)
+    boost::shared_ptr<std::vector<double> > spectra_rt_;
+    boost::shared_ptr<std::vector<int> > spectra_ms_level_;
   };
 
 } //end namespace
@@ -40,6 +40,8 @@
 
 namespace OpenMS
 {
+  class IsotopeDistributionCache;
+
   namespace DIAHelpers
   {
     /**
@@ -60,6 +62,14 @@ namespace OpenMS
                                          int nr_isotopes = 4,
                                          double mannmass = 1.00048);
 
+    /// get averagine distribution given mass, looked up in @p cache (no locking, see IsotopeDistributionCache::getAveragineCache)
+    OPENMS_DLLAPI void getAveragineIsotopeDistribution(double product_mz,
+                                         std::vector<std::pair<double, double> >& isotopesSpec, 
+                                         const IsotopeDistributionCache& cache,
+                                         double charge = 1.,
+                                         int nr_isotopes = 4,
+                                         double mannmass = 1.00048);
+
     /// simulate spectrum from AASequence
     OPENMS_DLLAPI void simulateSpectrumFromAASequence(AASequence& aa,
                                         std::vector<double>& firstIsotopeMasses, //[out]
@@ -84,6 +94,12 @@ namespace OpenMS
                           std::vector<std::pair<double, double> >& isotopeMasses, //[out]
                           double charge = 1.);
 
+    /// given an experimental spectrum add isotope pattern (looked up in @p cache).
+    OPENMS_DLLAPI void addIsotopes2Spec(const std::vector<std::pair<double, double> >& spec,
+                          std::vector<std::pair<double, double> >& isotopeMasses, //[out]
+                          const IsotopeDistributionCache& cache,
+                          double charge = 1.);
+
     /// sorts vector of pairs by first
     OPENMS_DLLAPI void sortByFirst(std::vector<std::pair<double, double> >& tmp);
     /// extract first from vector of pairs
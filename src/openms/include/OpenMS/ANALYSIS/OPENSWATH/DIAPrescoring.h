@@ -48,6 +48,8 @@
 
 namespace OpenMS
 {
+  class IsotopeDistributionCache;
+
   /**
     @brief Scoring of an spectrum given library intensities of a transition group.
 
@@ -68,11 +70,20 @@ namespace OpenMS
     double dia_extract_window_; //done
     int nr_isotopes_;
     int nr_charges_;
+    const IsotopeDistributionCache* isotope_cache_;
 public:
 
     DiaPrescore();
 
-    DiaPrescore(double dia_extract_window, int nr_isotopes = 4, int nr_charges = 4);
+    /**
+      @brief Constructor
+
+      The theoretical isotope patterns are looked up in @p isotope_cache. If
+      it is 0, the process-wide averagine cache is used (see
+      IsotopeDistributionCache::getAveragineCache, which locks; pass the
+      cache when constructing many objects inside a parallel region).
+    */
+    DiaPrescore(double dia_extract_window, int nr_isotopes = 4, int nr_charges = 4, const IsotopeDistributionCache* isotope_cache = 0);
 
     void defineDefaults();
 
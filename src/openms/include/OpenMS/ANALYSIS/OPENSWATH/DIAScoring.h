@@ -46,6 +46,8 @@
 
 namespace OpenMS
 {
+  class IsotopeDistributionCache;
+
   /**
     @brief Scoring of an spectrum at the peak apex of an chromatographic elution peak.
 
@@ -210,6 +212,9 @@ private:
     double dia_nr_isotopes_;
     double dia_nr_charges_;
     double peak_before_mono_max_ppm_diff_;
+
+    /// Averagine isotope distributions (obtained once on construction, lookups need no locking)
+    const IsotopeDistributionCache* isotope_cache_;
   };
 }
 
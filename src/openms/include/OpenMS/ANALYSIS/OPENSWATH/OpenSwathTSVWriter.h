@@ -0,0 +1,141 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_ANALYSIS_OPENSWATH_OPENSWATHTSVWRITER_H
+#define OPENMS_ANALYSIS_OPENSWATH_OPENSWATHTSVWRITER_H
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+
+#include <fstream>
+#include <vector>
+
+namespace OpenMS
+{
+  class ColumnarTableFile;
+  class OpenSwathAsyncWriter;
+
+  /**
+    @brief Class to write out an OpenSwath TSV output (mProphet input)
+
+    Optionally (or instead), the same table is written as binary columnar
+    table (see ColumnarTableFile): the lines are split into their fields by
+    the writer thread, so the scoring threads do the same work for both
+    outputs.
+
+    The lines are written by a separate writer thread, thus writeLine() and
+    writeLines() can be called from several threads concurrently and return
+    as soon as the data is queued. Lines are written in the order in which
+    they are handed over. At most @p max_queued_bytes of output are
+    buffered: if the queue is full, writeLine() blocks until the writer
+    thread has caught up, so memory use stays bounded even if scoring is
+    faster than the disk.
+
+    close() (or the destructor) writes all pending lines and stops the
+    writer thread.
+  */
+  class OPENMS_DLLAPI OpenSwathTSVWriter
+  {
+
+public:
+
+    /**
+      @brief Constructor
+
+      @param output_filename The TSV file to write (empty: no TSV output)
+      @param input_filename The name of the input file (written into the "filename" column)
+      @param ms1_scores Whether to write the MS1 scores
+      @param uis_scores Whether to write the UIS (identification) scores
+      @param max_queued_bytes Maximal size of the output that is queued for writing
+      @param columnar_filename The binary columnar table to write (empty: no columnar output)
+
+      @throws Exception::UnableToCreateFile is thrown if an output file cannot be created
+    */
+    OpenSwathTSVWriter(const String& output_filename, const String& input_filename = "inputfile",
+                       bool ms1_scores = false, bool uis_scores = false, Size max_queued_bytes = 16 * 1024 * 1024,
+                       const String& columnar_filename = "");
+
+    /// Destructor (writes all pending lines)
+    ~OpenSwathTSVWriter();
+
+    /// Whether output (TSV or columnar) is written
+    bool isActive() const;
+
+    /**
+      @brief Writes all pending lines to disk (no further lines can be written afterwards)
+
+      @throws Exception::IllegalArgument is thrown if a line could not be written to the columnar table (more fields than columns)
+    */
+    void close();
+
+    /// Returns the names of the columns (the fields of the header line)
+    std::vector<String> getColumnNames() const;
+
+    /// Writes the header line
+    void writeHeader();
+
+    /// Returns the lines (one per feature) for the features of a transition group
+    String prepareLine(const OpenSwath::LightPeptide& pep, const OpenSwath::LightTransition* transition,
+                       FeatureMap& output, String id) const;
+
+    /// Queues @p line for writing (blocks while the queue is full)
+    void writeLine(const String& line);
+
+    /// Queues @p to_output for writing, see writeLine()
+    void writeLines(const std::vector<String>& to_output);
+
+private:
+
+    /// Not implemented (owns the writer thread)
+    OpenSwathTSVWriter(const OpenSwathTSVWriter& rhs);
+
+    /// Not implemented (owns the writer thread)
+    OpenSwathTSVWriter& operator=(const OpenSwathTSVWriter& rhs);
+
+    /// stops the writer thread and closes the files, returns the error of the writer thread (if any)
+    String finish_();
+
+    std::ofstream ofs_;
+    String input_filename_;
+    bool doWrite_;
+    bool use_ms1_traces_;
+    bool enable_uis_scoring_;
+    ColumnarTableFile* table_;
+    OpenSwathAsyncWriter* writer_;
+
+  };
+}
+
+#endif // OPENMS_ANALYSIS_OPENSWATH_OPENSWATHTSVWRITER_H
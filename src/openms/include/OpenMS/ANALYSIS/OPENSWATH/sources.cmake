@@ -17,6 +17,7 @@ set(sources_list_h
   MRMTransitionGroupPicker.h
   OpenSwathHelper.h
   OpenSwathScoring.h
+  OpenSwathTSVWriter.h
   SpectrumAddition.h
   TransitionTSVReader.h
   SwathMapMassCorrection.h
@@ -72,6 +72,15 @@ public:
     typedef ContainerType::const_iterator ConstIterator;
     //@}
 
+    /// Averagine models which can be used to estimate a distribution from a weight
+    enum Averagine
+    {
+      PEPTIDE, ///< see estimateFromPeptideWeight()
+      RNA,     ///< see estimateFromRNAWeight()
+      DNA,     ///< see estimateFromDNAWeight()
+      SIZE_OF_AVERAGINE
+    };
+
     /// @name Constructors and Destructors
     //@{
     /** Default constructor, note max_isotope must be set later
@@ -150,6 +159,18 @@ public:
     */
     void estimateFromWeightAndComp(double average_weight, double C, double H, double N, double O, double S, double P);
 
+    /// Estimate Isotopedistribution from weight using the averagine model @p averagine
+    void estimateFromAveragineWeight(double average_weight, Averagine averagine);
+
+    /**
+        @brief Returns the number of atoms per unit weight of the averagine model @p averagine
+
+        The factors are given in the order C, H, N, O, S (and P for nucleotides). The estimateFrom...Weight()
+        methods use Math::round(average_weight * factor) atoms of each element, so the estimated composition
+        (and the distribution) only changes at the weights where one of these products crosses .5.
+    */
+    static void getAveragineFactors(Averagine averagine, std::vector<double> & factors);
+
     /** @brief re-normalizes the sum of the probabilities of the isotopes to 1
 
             The re-normalisation is needed as in distributions with a lot of isotopes (and with high max isotope)
@@ -224,6 +245,12 @@ protected:
     /// convolves the distribution @p input with itself and stores the result in @p result
     void convolveSquare_(ContainerType & result, const ContainerType & input) const;
 
+    /// estimates the distribution from @p average_weight with @p factors atoms per unit weight (C, H, N, O, S, P)
+    void estimateFromFactors_(double average_weight, const std::vector<double> & factors);
+
+    /// stores the number of atoms per unit weight of the average composition @p C, @p H, @p N, @p O, @p S, @p P in @p factors
+    static void getCompositionFactors_(double C, double H, double N, double O, double S, double P, std::vector<double> & factors);
+
     /// fill a gapped isotope pattern (i.e. certain masses are missing), with zero probability masses
     ContainerType fillGaps_(const ContainerType& id) const;
 
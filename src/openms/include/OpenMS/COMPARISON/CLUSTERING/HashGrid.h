@@ -32,14 +32,17 @@
 // $Authors: Bastian Blank $
 // --------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
-#include <boost/array.hpp>
 #include <boost/functional/hash.hpp>
-#include <boost/unordered/unordered_map.hpp>
 
+#include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/CONCEPT/Types.h>
 #include <OpenMS/DATASTRUCTURES/DPosition.h>
 
@@ -56,6 +59,28 @@ namespace OpenMS
    *
    * This container implements most parts of the C++ standard map interface.
    *
+   * The cells are stored contiguously (in the order in which they were
+   * created) and are found through an open-addressing hash table with linear
+   * probing. The elements of a cell are stored contiguously as well, so
+   * neighbourhood queries only touch a few consecutive memory blocks. Use the
+   * range version of insert() to fill a grid with many elements at once: it
+   * buckets the elements by cell and allocates every cell only once. For
+   * neighbourhood queries, grid_find() avoids the exception thrown by
+   * grid_at() for missing cells.
+   *
+   * Iteration visits the cells in the order in which they were created and
+   * the elements of a cell in the order in which they were inserted (erasing
+   * an element moves the last element of its cell into its place). This
+   * order does not depend on the coordinates; clients that break ties between
+   * elements by iteration order have to insert the elements in the order
+   * they need.
+   *
+   * @note Inserting an element into a cell that does not exist yet may
+   * reallocate the cell storage and then invalidates all iterators and
+   * references into the grid. Inserting into or erasing from an existing cell
+   * invalidates iterators and references to the elements of that cell (like
+   * for a std::vector).
+   *
    * @tparam Cluster Type to be stored in the hash grid. (e.g. HierarchicalClustering::Cluster)
    */
   template <typename Cluster>
@@ -73,19 +98,19 @@ public:
      */
     typedef DPosition<2, Int64> CellIndex;
 
+    typedef ClusterCenter key_type;
+    typedef Cluster mapped_type;
+    typedef std::pair<ClusterCenter, Cluster> value_type;
+
     /**
      * @brief Contents of a cell.
      */
-    typedef typename boost::unordered_multimap<ClusterCenter, Cluster> CellContent;
+    typedef std::vector<value_type> CellContent;
 
     /**
-     * @brief Map of (cell-index, cell-content).
+     * @brief List of (cell-index, cell-content).
      */
-    typedef boost::unordered_map<CellIndex, CellContent> Grid;
-
-    typedef typename CellContent::key_type key_type;
-    typedef typename CellContent::mapped_type mapped_type;
-    typedef typename CellContent::value_type value_type;
+    typedef std::vector<std::pair<CellIndex, CellContent> > Grid;
 
 private:
     /**
@@ -100,8 +125,8 @@ private:
       typedef typename Grid::iterator grid_iterator;
       typedef typename CellContent::iterator cell_iterator;
 
-      Grid & grid_;
       grid_iterator grid_it_;
+      grid_iterator grid_end_;
       cell_iterator cell_it_;
 
       // Search for next non-empty cell
@@ -109,10 +134,10 @@ private:
       {
         while (cell_it_ == grid_it_->second.end())
         {
-          grid_it_++;
+          ++grid_it_;
 
           // If we are at the last cell, set cell iterator to something well-known
-          if (grid_it_ == grid_.end())
+          if (grid_it_ == grid_end_)
           {
             cell_it_ = cell_iterator();
             return;
@@ -124,11 +149,11 @@ private:
 
 public:
       Iterator(Grid & grid) :
-        grid_(grid), grid_it_(grid.end())
+        grid_it_(grid.end()), grid_end_(grid.end()), cell_it_()
       {}
 
       Iterator(Grid & grid, grid_iterator grid_it, cell_iterator cell_it) :
-        grid_(grid), grid_it_(grid_it), cell_it_(cell_it)
+        grid_it_(grid_it), grid_end_(grid.end()), cell_it_(cell_it)
       {
         searchNextCell_();
       }
@@ -178,8 +203,8 @@ private:
       typedef typename Grid::const_iterator grid_iterator;
       typedef typename CellContent::const_iterator cell_iterator;
 
-      const Grid & grid_;
       grid_iterator grid_it_;
+      grid_iterator grid_end_;
       cell_iterator cell_it_;
 
       // Search for next non-empty cell
@@ -187,10 +212,10 @@ private:
       {
         while (cell_it_ == grid_it_->second.end())
         {
-          grid_it_++;
+          ++grid_it_;
 
           // If we are at the last cell, set cell iterator to something well-known
-          if (grid_it_ == grid_.end())
+          if (grid_it_ == grid_end_)
           {
             cell_it_ = cell_iterator();
             return;
@@ -202,17 +227,17 @@ private:
 
 public:
       ConstIterator(const Grid & grid) :
-        grid_(grid), grid_it_(grid.end())
+        grid_it_(grid.end()), grid_end_(grid.end()), cell_it_()
       {}
 
       ConstIterator(const Grid & grid, grid_iterator grid_it, cell_iterator cell_it) :
-        grid_(grid), grid_it_(grid_it), cell_it_(cell_it)
+        grid_it_(grid_it), grid_end_(grid.end()), cell_it_(cell_it)
       {
         searchNextCell_();
       }
 
       ConstIterator(const Iterator & it) :
-        grid_(it.grid_), grid_it_(it.grid_it_), cell_it_(it.cell_it_)
+        grid_it_(it.grid_it_), grid_end_(it.grid_end_), cell_it_(it.cell_it_)
       {}
 
       ConstIterator & operator++()
@@ -258,7 +283,13 @@ public:
     typedef typename CellContent::size_type size_type;
 
 private:
+    /// Marks an unused slot of the hash table
+    static const Size EMPTY_SLOT_ = static_cast<Size>(-1);
+
+    /// The cells (in order of creation)
     Grid cells_;
+    /// Open-addressing hash table: positions of the cells in cells_ (or EMPTY_SLOT_), size is a power of two
+    std::vector<Size> slots_;
     CellIndex grid_dimension_;
 
 public:
@@ -275,9 +306,18 @@ public:
 
 public:
     HashGrid(const ClusterCenter & c_dimension) :
-      cells_(), 
-      grid_dimension_(), 
-      cell_dimension(c_dimension), 
+      cells_(),
+      slots_(),
+      grid_dimension_(),
+      cell_dimension(c_dimension),
+      grid_dimension(grid_dimension_)
+    {}
+
+    HashGrid(const HashGrid & rhs) :
+      cells_(rhs.cells_),
+      slots_(rhs.slots_),
+      grid_dimension_(rhs.grid_dimension_),
+      cell_dimension(rhs.cell_dimension),
       grid_dimension(grid_dimension_)
     {}
 
@@ -289,9 +329,43 @@ public:
     cell_iterator insert(const value_type & v)
     {
       const CellIndex cellkey = cellindexAtClustercenter_(v.first);
-      CellContent & cell = cells_[cellkey];
+      CellContent & cell = cells_[findOrCreateCellPosition_(cellkey)].second;
       updateGridDimension_(cellkey);
-      return cell.insert(v);
+      cell.push_back(v);
+      return cell.end() - 1;
+    }
+
+    /**
+     * @brief Inserts a range of (2-dimensional coordinate, value) pairs.
+     *
+     * The pairs are bucketed by cell first (a counting sort), so every cell
+     * is allocated only once with its final size. Within a cell, the pairs
+     * keep their order.
+     */
+    template <typename RandomAccessIterator>
+    void insert(RandomAccessIterator first, RandomAccessIterator last)
+    {
+      // cell of every pair, and number of new pairs per cell
+      std::vector<Size> cell_of(last - first);
+      std::vector<Size> count;
+      for (RandomAccessIterator it = first; it != last; ++it)
+      {
+        const CellIndex cellkey = cellindexAtClustercenter_(it->first);
+        const Size pos = findOrCreateCellPosition_(cellkey);
+        updateGridDimension_(cellkey);
+        if (pos >= count.size()) count.resize(pos + 1, 0);
+        ++count[pos];
+        cell_of[it - first] = pos;
+      }
+
+      for (Size pos = 0; pos < count.size(); ++pos)
+      {
+        if (count[pos] > 0) cells_[pos].second.reserve(cells_[pos].second.size() + count[pos]);
+      }
+      for (RandomAccessIterator it = first; it != last; ++it)
+      {
+        cells_[cell_of[it - first]].second.push_back(*it);
+      }
     }
 
     /**
@@ -311,19 +385,23 @@ public:
     size_type erase(const key_type & key)
     {
       const CellIndex cellkey = cellindexAtClustercenter_(key);
-      try
-      {
-        CellContent & cell = cells_.at(cellkey);
-        return cell.erase(key);
-      }
-      catch (std::out_of_range &) {}
-      return 0;
+      Size pos = findCell_(cellkey);
+      if (pos == EMPTY_SLOT_) return 0;
+
+      CellContent & cell = cells_[pos].second;
+      size_type old_size = cell.size();
+      cell.erase(std::remove_if(cell.begin(), cell.end(), KeyEquals_(key)), cell.end());
+      return old_size - cell.size();
     }
 
     /**
      * @brief Clears the map.
      */
-    void clear() { cells_.clear(); }
+    void clear()
+    {
+      cells_.clear();
+      slots_.clear();
+    }
 
     /**
      * @brief Returns iterator to first element.
@@ -400,8 +478,34 @@ public:
 
     /**
      * @brief Returns the grid cell at given index.
+     * @exception std::out_of_range is thrown if the cell does not exist
+     */
+    const CellContent & grid_at(const CellIndex & x) const
+    {
+      Size pos = findCell_(x);
+      if (pos == EMPTY_SLOT_) throw std::out_of_range("HashGrid: no cell at the given index");
+      return cells_[pos].second;
+    }
+
+    /**
+     * @brief Returns the index of the cell that a 2-dimensional coordinate belongs to.
      */
-    const typename Grid::mapped_type & grid_at(const CellIndex & x) const { return cells_.at(x); }
+    CellIndex cell_index(const key_type & key) const
+    {
+      return cellindexAtClustercenter_(key);
+    }
+
+    /**
+     * @brief Returns the grid cell at given index, or NULL if the cell does not exist.
+     *
+     * Unlike grid_at(), this does not throw for missing cells, which makes it
+     * the better choice for neighbourhood queries in sparse grids.
+     */
+    const CellContent * grid_find(const CellIndex & x) const
+    {
+      Size pos = findCell_(x);
+      return pos == EMPTY_SLOT_ ? 0 : &cells_[pos].second;
+    }
 
     /**
      * @warning Currently needed non-const by HierarchicalClustering.
@@ -414,11 +518,89 @@ public:
     /**
      * @warning Currently needed non-const by HierarchicalClustering.
      */
-    typename Grid::mapped_type & grid_at(const CellIndex & x) { return cells_.at(x); }
+    CellContent & grid_at(const CellIndex & x)
+    {
+      Size pos = findCell_(x);
+      if (pos == EMPTY_SLOT_) throw std::out_of_range("HashGrid: no cell at the given index");
+      return cells_[pos].second;
+    }
 
 private:
+    /// Assignment is not supported (cell_dimension is constant)
+    HashGrid & operator=(const HashGrid &);
+
+    /// Tests elements for a given key
+    struct KeyEquals_
+    {
+      explicit KeyEquals_(const key_type & key) :
+        key_(key)
+      {}
+
+      bool operator()(const value_type & v) const
+      {
+        return v.first == key_;
+      }
+
+      key_type key_;
+    };
+
+    /// Hash table slot for a cell index (before probing)
+    Size hashCell_(const CellIndex & x) const
+    {
+      std::size_t seed = 0;
+      boost::hash_combine(seed, x[0]);
+      boost::hash_combine(seed, x[1]);
+      return seed & (slots_.size() - 1);
+    }
+
+    /// Returns the position of the cell in cells_ (or EMPTY_SLOT_ if it does not exist)
+    Size findCell_(const CellIndex & x) const
+    {
+      if (slots_.empty()) return EMPTY_SLOT_;
+
+      const Size mask = slots_.size() - 1;
+      for (Size slot = hashCell_(x); ; slot = (slot + 1) & mask)
+      {
+        const Size pos = slots_[slot];
+        if (pos == EMPTY_SLOT_ || cells_[pos].first == x) return pos;
+      }
+    }
+
+    /// Returns the position of the cell in cells_, creates an empty cell if it does not exist
+    Size findOrCreateCellPosition_(const CellIndex & x)
+    {
+      // keep the load factor of the hash table at or below 1/2
+      if (2 * (cells_.size() + 1) > slots_.size())
+      {
+        rehash_(std::max<Size>(16, 2 * slots_.size()));
+      }
+
+      const Size mask = slots_.size() - 1;
+      Size slot = hashCell_(x);
+      for (; slots_[slot] != EMPTY_SLOT_; slot = (slot + 1) & mask)
+      {
+        if (cells_[slots_[slot]].first == x) return slots_[slot];
+      }
+      slots_[slot] = cells_.size();
+      cells_.push_back(std::make_pair(x, CellContent()));
+      return slots_[slot];
+    }
+
+    /// Rebuilds the hash table with @p num_slots slots (must be a power of two)
+    void rehash_(Size num_slots)
+    {
+      slots_.assign(num_slots, EMPTY_SLOT_);
+      const Size mask = num_slots - 1;
+      for (Size pos = 0; pos < cells_.size(); ++pos)
+      {
+        Size slot = hashCell_(cells_[pos].first);
+        while (slots_[slot] != EMPTY_SLOT_) slot = (slot + 1) & mask;
+        slots_[slot] = pos;
+      }
+    }
+
     // XXX: Replace with proper operator
-    CellIndex cellindexAtClustercenter_(const ClusterCenter & key)
+    CellIndex cellindexAtClustercenter_(const ClusterCenter & key) const
     {
       CellIndex ret;
       typename CellIndex::iterator it = ret.begin();
@@ -445,6 +627,9 @@ private:
 
   };
 
+  template <typename Cluster>
+  const Size HashGrid<Cluster>::EMPTY_SLOT_;
+
   /** Hash value for OpenMS::DPosition. */
   template <UInt N, typename T>
   std::size_t hash_value(const DPosition<N, T> & b)
@@ -52,6 +52,11 @@ namespace OpenMS
     - Automatic conversion is supported and throws Exceptions in case of invalid conversions.
     - An empty object is created with the default constructor.
 
+    Short strings are stored directly inside the object. Longer strings, lists
+    and units are kept in immutable storage that is shared between copies
+    (with a thread-safe reference count), so copying a DataValue never
+    allocates memory.
+
     @ingroup Datastructures
   */
   class OPENMS_DLLAPI DataValue
@@ -356,6 +361,9 @@ public:
     /// assignment operator
     DataValue& operator=(const DataValue&);
 
+    /// swaps the contents (including the unit) with @p rhs without copying the data
+    void swap(DataValue& rhs);
+
     /// test if the value is empty
     inline bool isEmpty() const
     {
@@ -369,7 +377,7 @@ public:
     /// Check if the value has a unit
     inline bool hasUnit() const
     {
-      return unit_ != "";
+      return unit_ != 0;
     }
 
     /// Return the unit associated to this DataValue.
@@ -397,26 +405,55 @@ public:
 
 protected:
 
+    /// Reference counted, immutable storage for values that do not fit into the object
+    template <typename T>
+    struct Shared_;
+
+    /// Maximum length of strings which are stored inside the object
+    enum {SHORT_STRING_CAPACITY = 15};
+
     /// Type of the currently stored value
     DataType value_type_;
 
+    /// Whether a STRING_VALUE is stored in data_.chars_ (otherwise in data_.str_)
+    bool short_string_;
+
+    /// Length of a string stored in data_.chars_
+    unsigned char short_string_length_;
+
     /// Space to store the data
     union
     {
       SignedSize ssize_;
       double dou_;
-      String* str_;
-      StringList* str_list_;
-      IntList* int_list_;
-      DoubleList* dou_list_;
+      char chars_[SHORT_STRING_CAPACITY + 1];
+      Shared_<String>* str_;
+      Shared_<StringList>* str_list_;
+      Shared_<IntList>* int_list_;
+      Shared_<DoubleList>* dou_list_;
     } data_;
 
 private:
-    /// The unit of the data value (if it has one), otherwise empty string.
-    String unit_;
+    /// The unit of the data value (if it has one), otherwise NULL.
+    Shared_<String>* unit_;
 
     /// Clears the current state of the DataValue and release every used memory.
     void clear_();
+
+    /// Takes over the value and unit of @p rhs (sharing its storage). Expects a cleared object.
+    void copy_(const DataValue& rhs);
+
+    /// Stores a string value. Expects a cleared object.
+    void setString_(const char* str, Size length);
+
+    /// Returns the characters of a STRING_VALUE
+    const char* stringData_() const;
+
+    /// Returns the length of a STRING_VALUE
+    Size stringLength_() const;
+
+    /// Three-way comparison of two STRING_VALUEs
+    static int compareStrings_(const DataValue& a, const DataValue& b);
   };
 }
 
@@ -533,6 +533,12 @@ public:
       return size_;
     }   
 
+    /// pointer to the first character of the view (the data is not null-terminated)
+    inline const char* data() const
+    {
+      return begin_;
+    }
+
     /// create String object from view
     inline String getString() const
     {
@@ -36,28 +36,99 @@
 #define OPENMS_FILTERING_DATAREDUCTION_ISOTOPEDISTRIBUTIONCACHE_H
 
 #include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/CHEMISTRY/IsotopeDistribution.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 
 namespace OpenMS
 {
   /**
    * @brief Pre-calculate isotope distributions for interesting mass ranges
+   *
+   * The distributions are estimated with one of the averagine models of
+   * IsotopeDistribution. They are either calculated for mass windows of fixed
+   * width (as done by the feature finders), or, using the exact constructor,
+   * once for every mass range in which the averagine model yields the same
+   * elemental composition. Since the estimated composition is a step function
+   * of the mass, a lookup in an exact cache returns the same distribution
+   * IsotopeDistribution would calculate for that mass, without any binning or
+   * interpolation error. Distributions of an ion are looked up at m/z times
+   * charge.
+   *
+   * A cache is immutable once constructed and can be read by several threads
+   * concurrently. getAveragineCache() returns exact caches which are built
+   * only once per process and used e.g. by the OpenSWATH scoring.
    */
   class OPENMS_DLLAPI IsotopeDistributionCache
   {
 public:
     typedef FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
 
-    IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage = 0, double intensity_percentage_optional = 0);
+    /**
+     * @brief Calculates the distributions for mass windows of width @p mass_window_width up to @p max_mass
+     *
+     * Each distribution is estimated at the center of its window with at most @p max_isotopes isotopes,
+     * trimmed at @p intensity_percentage_optional and scaled to a maximum of 1. Isotopes below
+     * @p intensity_percentage at the beginning/end are marked as optional.
+     */
+    IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage = 0, double intensity_percentage_optional = 0,
+                             Size max_isotopes = 20, IsotopeDistribution::Averagine averagine = IsotopeDistribution::PEPTIDE);
 
-    /// Returns the isotope distribution for a certain mass window
+    /**
+     * @brief Calculates the exact distributions of all averagine compositions up to @p max_mass
+     *
+     * The distributions hold the first @p max_isotopes isotopes (untrimmed) and are scaled to a maximum of 1.
+     */
+    IsotopeDistributionCache(double max_mass, Size max_isotopes, IsotopeDistribution::Averagine averagine);
+
+    /**
+     * @brief Returns the isotope distribution for a certain mass window
+     *
+     * @exception Exception::InvalidValue is thrown if @p mass was not pre-calculated
+     */
     const TheoreticalIsotopePattern & getIsotopeDistribution(double mass) const;
 
+    /**
+     * @brief Returns the probabilities of the first @p nr_isotopes isotopes at @p mass
+     *
+     * For exact caches the values are the (not normalised) probabilities IsotopeDistribution::estimateFromAveragineWeight()
+     * reports with a maximum of @p nr_isotopes isotopes, for fixed-width windows they are the ones at the window center.
+     * If @p mass or @p nr_isotopes exceed the pre-calculated range, they are calculated on the fly.
+     */
+    void getIsotopeProbabilities(double mass, Size nr_isotopes, std::vector<double> & probabilities) const;
+
+    /**
+     * @brief Returns the process-wide exact cache for the averagine model @p averagine
+     *
+     * The cache covers masses up to 20000 Da and the first 10 isotopes. It is built on the first call (which
+     * may happen from several threads at once) and is never modified afterwards, i.e. later changes of the
+     * isotope abundances in ElementDB are not reflected.
+     *
+     * Every call enters a critical section. Hot code should therefore obtain the reference once, outside of
+     * the loop (e.g. on construction, as DIAScoring does), and use it for lookups, which need no locking.
+     */
+    static const IsotopeDistributionCache & getAveragineCache(IsotopeDistribution::Averagine averagine = IsotopeDistribution::PEPTIDE);
+
 private:
+    /// Returns the index of the distribution for @p mass (or the number of distributions if it was not pre-calculated)
+    Size getIndex_(double mass) const;
+
+    /// Estimates the distribution at @p mass and stores it in @p pattern (trimmed at @p intensity_percentage_optional)
+    void estimate_(double mass, double intensity_percentage, double intensity_percentage_optional, TheoreticalIsotopePattern & pattern) const;
+
     /// Vector of pre-calculated isotope distributions for several mass windows
     std::vector<TheoreticalIsotopePattern> isotope_distributions_;
 
+    /// Width of the mass windows (0 for exact caches)
     double mass_window_width_;
+
+    /// Exclusive upper mass of each distribution (exact caches only)
+    std::vector<double> window_ends_;
+
+    /// Maximal number of isotopes of the distributions
+    Size max_isotopes_;
+
+    /// Averagine model used for the estimation
+    IsotopeDistribution::Averagine averagine_;
   };
 }
 
@@ -37,6 +37,7 @@
 
 #include <OpenMS/INTERFACES/DataStructures.h>
 #include <OpenMS/INTERFACES/ISpectrumAccess.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <assert.h>
 #include <vector>
 
@@ -173,6 +174,15 @@ public:
       return estimateNoise(chrom->getTimeArray()->data, chrom->getIntensityArray()->data);
     }
 
+    /** @brief Compute noise estimator for a spectrum stored as m/z and intensity columns using windows
+     *
+     * Will return a noise estimator object.
+    */
+    inline NoiseEstimator estimateNoise(const ColumnarSpectrum<>& spectrum)
+    {
+      return estimateNoise(spectrum.getMZArray(), spectrum.getIntensityArray());
+    }
+
     /** @brief Compute noise estimator for an m/z and intensity array using windows
      *
      * Will return a noise estimator object.
@@ -39,6 +39,7 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
 #include <OpenMS/FILTERING/SMOOTHING/GaussFilterAlgorithm.h>
 
 #include <cmath>
@@ -135,6 +136,31 @@ public:
       }
     }
 
+    /**
+      @brief Smoothes a spectrum stored as m/z and intensity columns.
+
+      The filter works on the columns directly, only the intensities are
+      replaced.
+    */
+    void filter(ColumnarSpectrum<> & spectrum)
+    {
+      typedef std::vector<double> ContainerT;
+
+      ContainerT mz_out(spectrum.size()), int_out(spectrum.size());
+      bool found_signal = gauss_algo_.filter(spectrum.getMZArray().begin(), spectrum.getMZArray().end(),
+                                             spectrum.getIntensityArray().begin(), mz_out.begin(), int_out.begin());
+
+      // If all intensities are zero in the scan and the scan has a reasonable size, report it (see above).
+      if (!found_signal && spectrum.size() >= 3)
+      {
+        std::cerr << "Found no signal. The gaussian width is probably smaller than the spacing in your profile data. Try to use a bigger width." << std::endl;
+      }
+      else
+      {
+        spectrum.swapIntensityArray(int_out);
+      }
+    }
+
     template <typename PeakType>
     void filter(MSChromatogram<PeakType> & chromatogram)
     {
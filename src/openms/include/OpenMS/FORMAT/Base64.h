@@ -49,8 +49,11 @@
 #include <algorithm>
 #include <iterator>
 #include <cmath>
+#include <cstring>
 #include <vector>
 
+#include <boost/type_traits/is_same.hpp>
+
 #include <QByteArray>
 #include <zlib.h>
 
@@ -60,6 +63,13 @@ namespace OpenMS
     @brief Class to encode and decode Base64
 
     Base64 supports two precisions: 32 bit (float) and 64 bit (double).
+
+    Encoding and decoding of uncompressed data is done by SIMD kernels (SSSE3
+    or AVX2) if the CPU supports them; the kernel is chosen at runtime (see
+    getSupportedKernel()) and a scalar implementation is used otherwise.
+    Data is processed in blocks that fit into the L1 cache and the byte order
+    swap (and type conversion, see decodeAndConvert()) of each block is done
+    right after it was decoded.
   */
   class OPENMS_DLLAPI Base64
   {
@@ -79,6 +89,28 @@ public:
       BYTEORDER_LITTLEENDIAN            ///< Little endian type
     };
 
+    /// Implementation (instruction set) used for encoding and decoding
+    enum Kernel
+    {
+      KERNEL_SCALAR,                    ///< Portable scalar implementation
+      KERNEL_SSSE3,                     ///< x86 SSSE3 implementation (16 characters at a time)
+      KERNEL_AVX2                       ///< x86 AVX2 implementation (32 characters at a time)
+    };
+
+    /// Returns the fastest kernel supported by this CPU (and compiler)
+    static Kernel getSupportedKernel();
+
+    /**
+        @brief Sets the kernel used by this object
+
+        Mainly useful for testing and benchmarking. If the CPU does not
+        support @p kernel, the fastest supported kernel is used instead.
+    */
+    void setKernel(Kernel kernel);
+
+    /// Returns the kernel used by this object (by default the fastest supported one)
+    Kernel getKernel() const;
+
     /**
         @brief Encodes a vector of floating point numbers to a Base64 string
 
@@ -97,6 +129,18 @@ public:
     template <typename ToType>
     void decode(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression = false);
 
+    /**
+        @brief Decodes a Base64 string of @p FromType values to a vector of @p ToType
+
+        Use this to decode e.g. 32 bit float data directly into a vector of
+        doubles: the byte order swap and the conversion are done block-wise
+        together with the Base64 decoding, no intermediate vector is needed.
+
+        You have to specify the byte order of the input and if it is zlib-compressed.
+    */
+    template <typename FromType, typename ToType>
+    void decodeAndConvert(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression = false);
+
     /**
         @brief Encodes a vector of integer point numbers to a Base64 string
 
@@ -151,37 +195,72 @@ public:
 
 private:
 
-    ///Internal class needed for type-punning
-    union Reinterpreter64_
+    /// Integer type used to interpret integer data of a given size
+    template <Size element_size>
+    struct IntegerType_
     {
-      double f;
-      UInt64 i;
+      typedef Int64 Type;
     };
 
-    ///Internal class needed for type-punning
-    union Reinterpreter32_
+    static const char encoder_[];
+    static const Byte decoder_[256];
+
+    /// Kernel used for encoding and decoding
+    Kernel kernel_;
+
+    /// Whether data in @p byte_order needs to be swapped on this machine
+    static bool needsByteSwap_(ByteOrder byte_order)
     {
-      float f;
-      UInt32 i;
-    };
+      return (OPENMS_IS_BIG_ENDIAN && byte_order == Base64::BYTEORDER_LITTLEENDIAN) ||
+             (!OPENMS_IS_BIG_ENDIAN && byte_order == Base64::BYTEORDER_BIGENDIAN);
+    }
 
-    static const char encoder_[];
-    static const char decoder_[];
-    /// Decodes a Base64 string to a vector of floating point numbers
-    template <typename ToType>
+    /// Returns @p value with reversed byte order (for 4 and 8 byte types)
+    template <typename T>
+    static T byteSwapped_(T value);
+
+    /**
+        @brief Decodes @p in_size Base64 characters to bytes
+
+        Characters beyond @p in_size (within the last group of four) are
+        treated as zero. At most @p max_out bytes are written.
+
+        @return The number of bytes written
+    */
+    Size decodeBytes_(const char * in, Size in_size, Byte * out, Size max_out) const;
+
+    /**
+        @brief Encodes @p in_size bytes to Base64 (including padding)
+
+        @p out needs space for 4 * ceil(in_size / 3) characters.
+
+        @return The number of characters written
+    */
+    Size encodeBytes_(const Byte * in, Size in_size, char * out) const;
+
+    /// Reverses the byte order of @p count elements of size @p element_size (4 or 8) in place
+    void swapBytes_(Byte * data, Size count, Size element_size) const;
+
+    /**
+        @brief Encodes @p count elements of size @p element_size to Base64
+
+        The byte order of @p data is changed in place if necessary.
+    */
+    void encodeElements_(Byte * data, Size count, Size element_size, ByteOrder to_byte_order, String & out, bool zlib_compression) const;
+
+    /// Decodes an uncompressed Base64 string of FromType values to a vector of ToType
+    template <typename FromType, typename ToType>
     void decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
 
-    ///Decodes a compressed Base64 string to a vector of floating point numbers
-    template <typename ToType>
+    /// Decodes a compressed Base64 string of FromType values to a vector of ToType
+    template <typename FromType, typename ToType>
     void decodeCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
+  };
 
-    /// Decodes a Base64 string to a vector of integer numbers
-    template <typename ToType>
-    void decodeIntegersUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
-
-    ///Decodes a compressed Base64 string to a vector of integer numbers
-    template <typename ToType>
-    void decodeIntegersCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out);
+  template <>
+  struct Base64::IntegerType_<4>
+  {
+    typedef Int32 Type;
   };
 
   /// Endianizes a 32 bit type from big endian to little endian and vice versa
@@ -206,155 +285,62 @@ private:
            ((n << 56) & 0xFF00000000000000);
   }
 
-  template <typename FromType>
-  void Base64::encode(std::vector<FromType> & in, ByteOrder to_byte_order, String & out, bool zlib_compression)
+  template <typename T>
+  T Base64::byteSwapped_(T value)
   {
-    out.clear();
-    if (in.empty())
-      return;
-
-    //initialize
-    const Size element_size = sizeof(FromType);
-    const Size input_bytes = element_size * in.size();
-    String compressed;
-    Byte * it;
-    Byte * end;
-    //Change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
+    if (sizeof(T) == 4)
     {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter32_ tmp;
-          tmp.f = in[i];
-          tmp.i = endianize32(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
-      else
-      {
-        for (Size i = 0; i < in.size(); ++i)
-        {
-          Reinterpreter64_ tmp;
-          tmp.f = in[i];
-          tmp.i = endianize64(tmp.i);
-          in[i] = tmp.f;
-        }
-      }
+      UInt32 tmp;
+      std::memcpy(&tmp, &value, 4);
+      tmp = endianize32(tmp);
+      std::memcpy(&value, &tmp, 4);
     }
-
-    //encode with compression
-    if (zlib_compression)
-    {
-      unsigned long sourceLen =   (unsigned long)in.size();
-      unsigned long compressed_length =       //compressBound((unsigned long)in.size());
-                                        sourceLen + (sourceLen >> 12) + (sourceLen >> 14) + 11; // taken from zlib's compress.c, as we cannot use compressBound*
-      //
-      // (*) compressBound is not defined in the QtCore lib, which forces the linker under windows to link in our zlib.
-      //     This leads to multiply defined symbols as compress() is then defined twice.
-
-      int zlib_error;
-      do
-      {
-        compressed.resize(compressed_length);
-        zlib_error = compress(reinterpret_cast<Bytef *>(&compressed[0]), &compressed_length, reinterpret_cast<Bytef *>(&in[0]), (unsigned long)input_bytes);
-
-        switch (zlib_error)
-        {
-        case Z_MEM_ERROR:
-          throw Exception::OutOfMemory(__FILE__, __LINE__, __PRETTY_FUNCTION__, compressed_length);
-          break;
-
-        case Z_BUF_ERROR:
-          compressed_length *= 2;
-        }
-      }
-      while (zlib_error == Z_BUF_ERROR);
-
-      if (zlib_error != Z_OK)
-      {
-        throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Compression error?");
-      }
-
-      String(compressed).swap(compressed);
-      it = reinterpret_cast<Byte *>(&compressed[0]);
-      end = it + compressed_length;
-      out.resize((Size)ceil(compressed_length / 3.) * 4);     //resize output array in order to have enough space for all characters
-    }
-    //encode without compression
     else
     {
-      out.resize((Size)ceil(input_bytes / 3.) * 4);     //resize output array in order to have enough space for all characters
-      it = reinterpret_cast<Byte *>(&in[0]);
-      end = it + input_bytes;
+      UInt64 tmp;
+      std::memcpy(&tmp, &value, 8);
+      tmp = endianize64(tmp);
+      std::memcpy(&value, &tmp, 8);
     }
+    return value;
+  }
 
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
+  template <typename FromType>
+  void Base64::encode(std::vector<FromType> & in, ByteOrder to_byte_order, String & out, bool zlib_compression)
+  {
+    out.clear();
+    if (in.empty())
+      return;
 
-    out.resize(written);         //no more space is needed
+    encodeElements_(reinterpret_cast<Byte *>(&in[0]), in.size(), sizeof(FromType), to_byte_order, out, zlib_compression);
   }
 
   template <typename ToType>
   void Base64::decode(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression)
+  {
+    decodeAndConvert<ToType>(in, from_byte_order, out, zlib_compression);
+  }
+
+  template <typename FromType, typename ToType>
+  void Base64::decodeAndConvert(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression)
   {
     if (zlib_compression)
     {
-      decodeCompressed_(in, from_byte_order, out);
+      decodeCompressed_<FromType>(in, from_byte_order, out);
     }
     else
     {
-      decodeUncompressed_(in, from_byte_order, out);
+      decodeUncompressed_<FromType>(in, from_byte_order, out);
     }
   }
 
-  template <typename ToType>
+  template <typename FromType, typename ToType>
   void Base64::decodeCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
   {
     out.clear();
     if (in == "") return;
 
-    const Size element_size = sizeof(ToType);
-
-    String decompressed;
+    const Size element_size = sizeof(FromType);
 
     QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
     QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
@@ -371,41 +357,28 @@ private:
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decompression error?");
     }
-    decompressed.resize(base64_uncompressed.size());
-
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
-
-    void* byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
-    Size buffer_size = decompressed.size();
 
-    const ToType * float_buffer = reinterpret_cast<const ToType *>(byte_buffer);
+    const Size buffer_size = base64_uncompressed.size();
     if (buffer_size % element_size != 0)
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount?");
     }
-    
-    Size float_count = buffer_size / element_size;
-    
-    // change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
+
+    // convert values (and change endianness if necessary) directly from the uncompressed buffer
+    const Size value_count = buffer_size / element_size;
+    const char * buffer = base64_uncompressed.constData();
+    const bool swap = needsByteSwap_(from_byte_order);
+    out.resize(value_count);
+    for (Size i = 0; i < value_count; ++i)
     {
-      if (element_size == 4) // 32 bit
-      {
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-      }
-      else // 64 bit
-      {
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-      }
+      FromType value;
+      std::memcpy(&value, buffer + i * element_size, element_size);
+      // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
+      out[i] = (ToType) (swap ? byteSwapped_(value) : value);
     }
-
-    // copy values
-    out.assign(float_buffer, float_buffer + float_count);
   }
 
-  template <typename ToType>
+  template <typename FromType, typename ToType>
   void Base64::decodeUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
   {
     out.clear();
@@ -425,469 +398,74 @@ private:
 
     src_size -= padding;
 
-    register UInt a;
-    register UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
-    const Size element_size = sizeof(ToType);
-
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    // Parse little endian data in big endian OpenMS (or other way round)
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || 
-       (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
+    // every group of 4 characters yields 3 bytes, an incomplete value at the end is dropped
+    const Size element_size = sizeof(FromType);
+    const Size value_count = (3 * ((src_size + 3) / 4)) / element_size;
+    const Size total_bytes = value_count * element_size;
+    out.resize(value_count);
+    if (value_count == 0)
     {
-      offset = 0;
-      inc = 1;
+      return;
     }
 
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
+    const bool swap = needsByteSwap_(from_byte_order);
+    const bool same_type = boost::is_same<FromType, ToType>::value;
+
+    // decode blocks of 3 KB (a multiple of 3, 4 and 8 bytes) and swap /
+    // convert each block while it is still in the cache. If no conversion is
+    // needed, we decode directly into the output vector.
+    const Size block_bytes = 3072;
+    Byte block[block_bytes];
+    const char * src = in.c_str();
+    Byte * out_bytes = reinterpret_cast<Byte *>(&out[0]);
+    for (Size done = 0; done < total_bytes; done += block_bytes)
     {
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
+      const Size bytes = std::min(block_bytes, total_bytes - done);
+      const Size first_char = (done / 3) * 4;
+      const Size chars = std::min((bytes + 2) / 3 * 4, src_size - first_char);
 
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
+      if (same_type)
       {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType * to_type = reinterpret_cast<ToType *>(&element[0]);
-        out.push_back((*to_type));
-        strcpy(element, "");
-      }
-    }
-  }
-
-  template <typename FromType>
-  void Base64::encodeIntegers(std::vector<FromType> & in, ByteOrder to_byte_order, String & out, bool zlib_compression)
-  {
-    out.clear();
-    if (in.empty())
-      return;
-
-    //initialize
-    const Size element_size = sizeof(FromType);
-    const Size input_bytes = element_size * in.size();
-    String compressed;
-    Byte * it;
-    Byte * end;
-    //Change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && to_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      if (element_size == 4)
-      {
-        for (Size i = 0; i < in.size(); ++i)
+        decodeBytes_(src + first_char, chars, out_bytes + done, bytes);
+        if (swap)
         {
-          UInt32 tmp = in[i];
-          tmp = endianize32(tmp);
-          in[i] = tmp;
+          swapBytes_(out_bytes + done, bytes / element_size, element_size);
         }
       }
       else
       {
-        for (Size i = 0; i < in.size(); ++i)
+        decodeBytes_(src + first_char, chars, block, bytes);
+        if (swap)
         {
-          UInt64 tmp = in[i];
-          tmp = endianize64(tmp);
-          in[i] = tmp;
+          swapBytes_(block, bytes / element_size, element_size);
         }
-      }
-    }
-
-    //encode with compression (use Qt because of zlib support)
-    if (zlib_compression)
-    {
-      unsigned long sourceLen =   (unsigned long)input_bytes;
-      unsigned long compressed_length =       //compressBound((unsigned long)in.size());
-                                        sourceLen + (sourceLen >> 12) + (sourceLen >> 14) + 11; // taken from zlib's compress.c, as we cannot use compressBound*
-
-      compressed.resize(compressed_length);
-      while (compress(reinterpret_cast<Bytef *>(&compressed[0]), &compressed_length, reinterpret_cast<Bytef *>(&in[0]), (unsigned long)input_bytes) != Z_OK)
-      {
-        compressed_length *= 2;
-        compressed.reserve(compressed_length);
-      }
-
-
-      String(compressed).swap(compressed);
-      it = reinterpret_cast<Byte *>(&compressed[0]);
-      end = it + compressed_length;
-      out.resize((Size)ceil(compressed_length / 3.) * 4);     //resize output array in order to have enough space for all characters
-    }
-    //encode without compression
-    else
-    {
-      out.resize((Size)ceil(input_bytes / 3.) * 4);     //resize output array in order to have enough space for all characters
-      it = reinterpret_cast<Byte *>(&in[0]);
-      end = it + input_bytes;
-    }
-
-    Byte * to = reinterpret_cast<Byte *>(&out[0]);
-
-
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
+        ToType * target = &out[done / element_size];
+        for (Size i = 0; i < bytes / element_size; ++i)
         {
-          int_24bit |= *it++ << ((2 - i) * 8);
+          FromType value;
+          std::memcpy(&value, block + i * element_size, element_size);
+          target[i] = (ToType) value;
         }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
       }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
-
-    out.resize(written);         //no more space is needed
-  }
-
-  template <typename ToType>
-  void Base64::decodeIntegers(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression)
-  {
-    if (zlib_compression)
-    {
-      decodeIntegersCompressed_(in, from_byte_order, out);
-    }
-    else
-    {
-      decodeIntegersUncompressed_(in, from_byte_order, out);
     }
   }
 
-  template <typename ToType>
-  void Base64::decodeIntegersCompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  template <typename FromType>
+  void Base64::encodeIntegers(std::vector<FromType> & in, ByteOrder to_byte_order, String & out, bool zlib_compression)
   {
     out.clear();
-    if (in == "")
+    if (in.empty())
       return;
 
-    void * byte_buffer;
-    Size buffer_size;
-    const Size element_size = sizeof(ToType);
-
-    String decompressed;
-
-    QByteArray qt_byte_array = QByteArray::fromRawData(in.c_str(), (int) in.size());
-    QByteArray bazip = QByteArray::fromBase64(qt_byte_array);
-    QByteArray czip;
-    czip.resize(4);
-    czip[0] = (bazip.size() & 0xff000000) >> 24;
-    czip[1] = (bazip.size() & 0x00ff0000) >> 16;
-    czip[2] = (bazip.size() & 0x0000ff00) >> 8;
-    czip[3] = (bazip.size() & 0x000000ff);
-    czip += bazip;
-    QByteArray base64_uncompressed = qUncompress(czip);
-    if (base64_uncompressed.isEmpty())
-    {
-      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Decompression error?");
-    }
-    decompressed.resize(base64_uncompressed.size());
-
-    std::copy(base64_uncompressed.begin(), base64_uncompressed.end(), decompressed.begin());
-
-    byte_buffer = reinterpret_cast<void *>(&decompressed[0]);
-    buffer_size = decompressed.size();
-
-    //change endianness if necessary
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      if (element_size == 4)
-      {
-        const Int32 * float_buffer = reinterpret_cast<const Int32 *>(byte_buffer);
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount?");
-        Size float_count = buffer_size / element_size;
-        UInt32 * p = reinterpret_cast<UInt32 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize32);
-
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
-      else
-      {
-        const Int64 * float_buffer = reinterpret_cast<const Int64 *>(byte_buffer);
-
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount?");
-
-        Size float_count = buffer_size / element_size;
-
-        UInt64 * p = reinterpret_cast<UInt64 *>(byte_buffer);
-        std::transform(p, p + float_count, p, endianize64);
-
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
-    }
-    else
-    {
-      if (element_size == 4)
-      {
-        const Int * float_buffer = reinterpret_cast<const Int *>(byte_buffer);
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount while decoding?");
-
-        Size float_count = buffer_size / element_size;
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
-      else
-      {
-        const Int64 * float_buffer = reinterpret_cast<const Int64 *>(byte_buffer);
-
-        if (buffer_size % element_size != 0)
-          throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Bad BufferCount while decoding?");
-
-        Size float_count = buffer_size / element_size;
-        out.resize(float_count);
-        // do NOT use assign here, as it will give a lot of type conversion warnings on VS compiler
-        for (Size i = 0; i < float_count; ++i)
-        {
-          out[i] = (ToType) * float_buffer;
-          ++float_buffer;
-        }
-      }
-    }
-
+    encodeElements_(reinterpret_cast<Byte *>(&in[0]), in.size(), sizeof(FromType), to_byte_order, out, zlib_compression);
   }
 
   template <typename ToType>
-  void Base64::decodeIntegersUncompressed_(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out)
+  void Base64::decodeIntegers(const String & in, ByteOrder from_byte_order, std::vector<ToType> & out, bool zlib_compression)
   {
-    out.clear();
-
-    // The length of a base64 string is a always a multiple of 4 (always 3
-    // bytes are encoded as 4 characters)
-    if (in.size() < 4)
-    {
-      return;
-    }
-
-    Size src_size = in.size();
-    // last one or two '=' are skipped if contained
-    int padding = 0;
-    if (in[src_size - 1] == '=') padding++;
-    if (in[src_size - 2] == '=') padding++;
-
-    src_size -= padding;
-
-    register UInt a;
-    register UInt b;
-
-    UInt offset = 0;
-    int inc = 1;
-    UInt written = 0;
-
-    const Size element_size = sizeof(ToType);
-
-    // enough for either float or double
-    char element[8] = "\x00\x00\x00\x00\x00\x00\x00";
-
-    if ((OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_LITTLEENDIAN) || (!OPENMS_IS_BIG_ENDIAN && from_byte_order == Base64::BYTEORDER_BIGENDIAN))
-    {
-      offset = (element_size - 1);              // other endian
-      inc = -1;
-    }
-    else
-    {
-      offset = 0;
-      inc = 1;
-    }
-
-    //reserve enough space in the output vector
-    out.reserve((UInt)(std::ceil((4.0 * src_size) / 3.0) + 6.0));
-
-    // sort all read bytes correctly into a char[4] (double) or
-    // char[8] (float) and push_back when necessary.
-    for (Size i = 0; i < src_size; i += 4)
-    {
-
-      // decode 4 Base64-Chars to 3 Byte
-      // -------------------------------
-
-      // decode the first two chars
-      a = decoder_[(int)in[i] - 43] - 62;
-      b = decoder_[(int)in[i + 1] - 43] - 62;
-      if (i + 1 >= src_size)
-      {
-        b = 0;
-      }
-      // write first byte (6 bits from a and 2 highest bits from b)
-      element[offset] = (unsigned char) ((a << 2) | (b >> 4));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the third char
-      a = decoder_[(int)in[i + 2] - 43] - 62;
-      if (i + 2 >= src_size)
-      {
-        a = 0;
-      }
-      // write second byte (4 lowest bits from b and 4 highest bits from a)
-      element[offset] = (unsigned char) (((b & 15) << 4) | (a >> 2));
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-
-      // decode the fourth char
-      b = decoder_[(int)in[i + 3] - 43] - 62;
-      if (i + 3 >= src_size)
-      {
-        b = 0;
-      }
-      // write third byte (2 lowest bits from a and 6 bits from b)
-      element[offset] = (unsigned char) (((a & 3) << 6) | b);
-      written++;
-      offset = (offset + inc) % element_size;
-
-      if (written % element_size == 0)
-      {
-        ToType float_value;
-        if (element_size == 4)
-        {
-          Int32 * value = reinterpret_cast<Int32 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        else
-        {
-          Int64 * value = reinterpret_cast<Int64 *>(&element[0]);
-          float_value = (ToType) * value;
-        }
-        out.push_back(float_value);
-        strcpy(element, "");
-      }
-    }
+    // the data is interpreted as (signed) integers of the size of ToType
+    typedef typename IntegerType_<sizeof(ToType)>::Type FromType;
+    decodeAndConvert<FromType>(in, from_byte_order, out, zlib_compression);
   }
 
 } //namespace OpenMS
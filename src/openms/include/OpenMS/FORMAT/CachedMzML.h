@@ -42,10 +42,12 @@
 
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/MSNumpressCoder.h>
 
 #include <fstream>
 
 #define CACHED_MZML_FILE_IDENTIFIER 8093
+#define CACHED_MZML_FILE_VERSION 2
 
 namespace OpenMS
 {
@@ -58,12 +60,35 @@ namespace OpenMS
     be very fast and done in random order (once the in-memory index is built
     for the file).
 
+    The cached file (format version 2) has the following layout:
+
+    - header: file identifier (Int32), format version (Int32)
+    - one block per spectrum: number of peaks (UInt64), MS level (Int32),
+      RT (double), followed by the m/z and the intensity array
+    - one block per chromatogram: number of peaks (UInt64), followed by the
+      time and the intensity array
+    - index: for each spectrum its offset (Int64), RT (double), MS level
+      (Int32) and precursor isolation window (2x double); for each
+      chromatogram its offset (Int64)
+    - trailer: number of spectra (UInt64), number of chromatograms (UInt64),
+      offset of the index (Int64), file identifier (Int32)
+
+    Each binary array is stored as encoding (Int32, see BlockEncoding), number
+    of bytes (UInt64) and the raw bytes. By default, m/z, time and
+    chromatogram intensities are stored as 64 bit and spectrum intensities as
+    32 bit floating point numbers (matching the precision of Peak1D and
+    ChromatogramPeak, so no precision is lost). Optionally, each array can be
+    compressed using MSNumpress (see setNumpressConfigurationMassTime and
+    setNumpressConfigurationIntensity); arrays for which the numpress error
+    tolerance cannot be met are stored uncompressed.
+
+    Since the index is stored at the end of the file, creating the in-memory
+    index (createMemdumpIndex) does not require a pass through the file.
+
   */
   class OPENMS_DLLAPI CachedmzML :
     public ProgressLogger
   {
-    int int_field_;
-    double dbl_field_;
 
 public:
 
@@ -71,11 +96,38 @@ public:
     typedef MSSpectrum<Peak1D> SpectrumType;
     typedef MSChromatogram<ChromatogramPeak> ChromatogramType;
 
-    // using double precision to store all data (has to agree with type of BinaryDataArrayPtr)
+    // using double precision to return all data (has to agree with type of BinaryDataArrayPtr)
     typedef double DatumSingleton;
 
     typedef std::vector<DatumSingleton> Datavector;
 
+    /// Encoding of a single binary array in the cached file
+    enum BlockEncoding
+    {
+      ENCODING_FLOAT64 = 0,         ///< uncompressed 64 bit floating point numbers
+      ENCODING_FLOAT32 = 1,         ///< uncompressed 32 bit floating point numbers
+      ENCODING_NUMPRESS_LINEAR = 2, ///< MSNumpress linear prediction compression
+      ENCODING_NUMPRESS_PIC = 3,    ///< MSNumpress positive integer compression
+      ENCODING_NUMPRESS_SLOF = 4    ///< MSNumpress short logged float compression
+    };
+
+    /// Index entry of a single spectrum, stored in the index at the end of the file
+    struct OPENMS_DLLAPI SpectrumIndexEntry
+    {
+      double rt; ///< retention time
+      int ms_level; ///< MS level
+      double precursor_lower_mz; ///< lower bound of the precursor isolation window (0 if no precursor is present)
+      double precursor_upper_mz; ///< upper bound of the precursor isolation window (0 if no precursor is present)
+
+      SpectrumIndexEntry() :
+        rt(0.0),
+        ms_level(0),
+        precursor_lower_mz(0.0),
+        precursor_upper_mz(0.0)
+      {
+      }
+    };
+
     /** @name Constructors and Destructor
     */
     //@{
@@ -89,6 +141,22 @@ public:
     CachedmzML& operator=(const CachedmzML& rhs);
     //@}
 
+    /** @name Compression options
+    */
+    //@{
+    /// Numpress configuration used for m/z and time arrays (default: no compression)
+    void setNumpressConfigurationMassTime(MSNumpressCoder::NumpressConfig config);
+
+    /// Numpress configuration used for m/z and time arrays
+    MSNumpressCoder::NumpressConfig getNumpressConfigurationMassTime() const;
+
+    /// Numpress configuration used for intensity arrays (default: no compression, 32 bit storage)
+    void setNumpressConfigurationIntensity(MSNumpressCoder::NumpressConfig config);
+
+    /// Numpress configuration used for intensity arrays
+    MSNumpressCoder::NumpressConfig getNumpressConfigurationIntensity() const;
+    //@}
+
     /** @name Read / Write a complete mass spectrometric experiment (or its meta data)
     */
     //@{
@@ -99,14 +167,24 @@ public:
     /// Write only the meta data of an MSExperiment
     void writeMetadata(MapType exp, String out_meta, bool addCacheMetaValue=false);
 
-    /// Read all spectra from a dump from the disk
+    /**
+      @brief Read all spectra from a dump from the disk
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file is not a cached file of the current version
+    */
     void readMemdump(MapType& exp_reading, String filename) const;
     //@}
 
     /** @name Access and creation of the binary indices
     */
     //@{
-    /// Create an index on the location of all the spectra and chromatograms
+    /**
+      @brief Read the index on the location of all the spectra and chromatograms from the end of the file
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file is not a (complete) cached file of the current version
+    */
     void createMemdumpIndex(String filename);
 
     /// Access to a constant copy of the binary spectra index
@@ -114,6 +192,9 @@ public:
 
     /// Access to a constant copy of the binary chromatogram index
     const std::vector<std::streampos>& getChromatogramIndex() const;
+
+    /// Access to the RT, MS level and precursor window of all spectra (same order as getSpectraIndex())
+    const std::vector<SpectrumIndexEntry>& getSpectraIndexEntries() const;
     //@}
 
     /** @name Direct access to a single Spectrum or Chromatogram
@@ -125,53 +206,40 @@ public:
 
       @throws Exception::ParseError is thrown if the spectrum size cannot be read
     */
-    static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
-                                        OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level,
-                                        double& rt)
-    {
-      Size spec_size = -1;
-      ifs.read((char*) &spec_size, sizeof(spec_size));
-      ifs.read((char*) &ms_level, sizeof(ms_level));
-      ifs.read((char*) &rt, sizeof(rt));
-
-      if ( static_cast<int>(spec_size) < 0)
-      {
-        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
-          "Read an invalid spectrum length, something is wrong here. Aborting.", "filestream");
-      }
-
-      data1->data.resize(spec_size);
-      data2->data.resize(spec_size);
-
-      if (spec_size > 0)
-      {
-        ifs.read((char*) &(data1->data)[0], spec_size * sizeof(double));
-        ifs.read((char*) &(data2->data)[0], spec_size * sizeof(double));
-      }
-    }
+    static void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
+                                 OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level,
+                                 double& rt);
 
     /**
       @brief fast access to a chromatogram (a direct copy of the data into the provided arrays)
 
       @throws Exception::ParseError is thrown if the chromatogram size cannot be read
     */
-    static inline void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
-                                            OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs)
-    {
-      Size spec_size = -1;
-      ifs.read((char*) &spec_size, sizeof(spec_size));
+    static void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
+                                     OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs);
 
-      if ( static_cast<int>(spec_size) < 0)
-      {
-        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
-          "Read an invalid chromatogram length, something is wrong here. Aborting.", "filestream");
-      }
+    /**
+      @brief fast access to a spectrum stored in a memory buffer (e.g. a memory-mapped cached file)
+
+      Reads the spectrum starting at position @p pos of @p buffer (which has
+      a total length of @p buffer_size bytes) and decodes the data directly
+      into the provided arrays. No file stream is involved, thus concurrent
+      calls on the same (read-only) buffer are safe.
+
+      @throws Exception::ParseError is thrown if the spectrum size cannot be read or the spectrum exceeds the buffer
+    */
+    static void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
+                                 OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size,
+                                 Size pos, int& ms_level, double& rt);
 
-      data1->data.resize(spec_size);
-      data2->data.resize(spec_size);
-      ifs.read((char*) &(data1->data)[0], spec_size * sizeof(double));
-      ifs.read((char*) &(data2->data)[0], spec_size * sizeof(double));
-    }
+    /**
+      @brief fast access to a chromatogram stored in a memory buffer (e.g. a memory-mapped cached file)
+
+      @throws Exception::ParseError is thrown if the chromatogram size cannot be read or the chromatogram exceeds the buffer
+    */
+    static void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
+                                     OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size,
+                                     Size pos);
     //@}
 
 protected:
@@ -188,15 +256,43 @@ protected:
     /// read a single chromatogram directly into an OpenMS MSChromatograms (assuming file is already at the correct position)
     void readChromatogram_(ChromatogramType& chromatogram, std::ifstream& ifs) const;
 
-    /// write a single spectrum to filestream
+    /// write the file header (identifier and version) and reset the index
+    void writeHeader_(std::ofstream& ofs);
+
+    /// write a single spectrum to filestream and record it in the index
     void writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs);
 
-    /// write a single chromatogram to filestream
+    /// write a single chromatogram to filestream and record it in the index
     void writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs);
 
+    /// write the index and the trailer (has to be called after all spectra and chromatograms are written)
+    void writeFooter_(std::ofstream& ofs);
+
+    /// write a single binary array using the given numpress configuration (or 32/64 bit floats if numpress is not used or fails)
+    void writeBinaryArray_(const Datavector& data, const MSNumpressCoder::NumpressConfig& config,
+                           bool single_precision, std::ofstream& ofs);
+
+    /// decode a single binary array of @p byte_count bytes with @p expected_size values
+    static void decodeBinaryArray_(const char* data, UInt64 byte_count, Int32 encoding,
+                                   UInt64 expected_size, Datavector& result);
+
+    /// read a single binary array from the stream
+    static void readBinaryArray_(std::ifstream& ifs, UInt64 expected_size, Datavector& result);
+
+    /// read a single binary array from a memory buffer, advances @p pos
+    static void readBinaryArray_(const char* buffer, Size buffer_size, Size& pos,
+                                 UInt64 expected_size, Datavector& result);
+
+    /// check the header of the file and read the trailer, returns offset of the index
+    Int64 readHeaderAndTrailer_(std::ifstream& ifs, const String& filename, UInt64& exp_size, UInt64& chrom_size) const;
+
     /// Members
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
+    std::vector<SpectrumIndexEntry> spectra_index_entries_;
+
+    MSNumpressCoder::NumpressConfig np_config_mz_;
+    MSNumpressCoder::NumpressConfig np_config_int_;
 
   };
 }
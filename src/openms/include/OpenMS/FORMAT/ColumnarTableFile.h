@@ -0,0 +1,179 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_COLUMNARTABLEFILE_H
+#define OPENMS_FORMAT_COLUMNARTABLEFILE_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <fstream>
+#include <vector>
+
+#define COLUMNAR_TABLE_FILE_IDENTIFIER 8095
+#define COLUMNAR_TABLE_FILE_VERSION 1
+
+namespace OpenMS
+{
+
+  /**
+    @brief Reads and writes tables in a binary, column-oriented format
+
+    A table is written row by row (e.g. the lines of a TSV file split into
+    their fields), but stored column by column in blocks of rows. Numbers
+    are stored in binary, so a column can be read back without parsing
+    text, and the output is written while it is produced: only the current
+    block is kept in memory.
+
+    Within a block, a column is stored as numbers if all of its values in
+    that block are numbers or empty. Otherwise the text of all values is
+    stored. A column of the loaded table is numeric if all of its blocks
+    are numeric. Empty values of numeric columns are NaN. For columns that
+    also contain text, numbers are converted back to text (their original
+    formatting, e.g. trailing zeros, is not kept).
+
+    The file (format version 1) has the following layout:
+
+    - header: file identifier (Int32), format version (Int32), number of
+      columns (UInt64) and the name of every column (string)
+    - blocks: number of rows (UInt64, greater than zero), followed by the
+      values of every column: the column type (Byte, 0 = numbers, 1 = text)
+      and either the numbers (double array) or the lengths of the values
+      (UInt32 array) followed by their characters
+    - end of the blocks: number of rows zero (UInt64)
+    - trailer: file identifier (Int32)
+
+    Strings are stored as number of characters (UInt64) followed by the
+    characters. All numbers are stored in the native byte order, without
+    padding; the file is meant to be read sequentially.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI ColumnarTableFile
+  {
+
+public:
+
+    /// A column of a loaded table
+    struct OPENMS_DLLAPI Column
+    {
+      /// name of the column
+      String name;
+      /// whether all values are numbers (stored in @p numbers, otherwise the values are stored in @p strings)
+      bool numeric;
+      /// values of a numeric column (NaN for empty values)
+      std::vector<double> numbers;
+      /// values of a text column
+      std::vector<String> strings;
+
+      Column() :
+        numeric(true)
+      {
+      }
+    };
+
+    /** @name Constructors and Destructor
+    */
+    //@{
+    /// Default constructor
+    ColumnarTableFile();
+
+    /// Destructor (closes the file if a table is being written)
+    ~ColumnarTableFile();
+    //@}
+
+    /** @name Writing
+    */
+    //@{
+    /**
+      @brief Creates a file and writes the header of a table with the given columns
+
+      @param filename The file to create
+      @param column_names The names of the columns
+      @param rows_per_block Number of rows that are collected before a block is written
+
+      @throws Exception::UnableToCreateFile is thrown if the file cannot be created
+      @throws Exception::IllegalArgument is thrown if a table is already being written
+    */
+    void create(const String& filename, const std::vector<String>& column_names, Size rows_per_block = 4096);
+
+    /**
+      @brief Adds a row to the table
+
+      @p values contains the values in the order of the columns. Missing
+      values at the end of the row are empty.
+
+      @throws Exception::IllegalArgument is thrown if no table is being written or if there are more values than columns
+    */
+    void addRow(const std::vector<String>& values);
+
+    /// Writes all pending rows and closes the file (no-op if no table is being written)
+    void close();
+
+    /// Returns whether a table is being written
+    bool isOpen() const;
+    //@}
+
+    /**
+      @brief Loads a complete table
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file is not a (complete) columnar table of the current version
+    */
+    void load(const String& filename, std::vector<Column>& columns) const;
+
+protected:
+
+    /// writes the rows collected in block_ and clears it
+    void writeBlock_();
+
+    std::ofstream ofs_;
+    String filename_;
+    Size rows_per_block_;
+    /// number of rows in block_
+    Size block_rows_;
+    /// values of the current block, one vector per column
+    std::vector<std::vector<String> > block_;
+
+private:
+
+    /// Not implemented (owns the output stream)
+    ColumnarTableFile(const ColumnarTableFile& rhs);
+
+    /// Not implemented (owns the output stream)
+    ColumnarTableFile& operator=(const ColumnarTableFile& rhs);
+
+  };
+}
+#endif // OPENMS_FORMAT_COLUMNARTABLEFILE_H
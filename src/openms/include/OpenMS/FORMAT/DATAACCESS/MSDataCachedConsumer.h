@@ -69,20 +69,18 @@ namespace OpenMS
         spectra_written_(0),
         chromatograms_written_(0)
       {
-        int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-        ofs_.write((char*)&file_identifier, sizeof(file_identifier));
+        writeHeader_(ofs_);
       }
 
       /**
         @brief Destructor
   
-        Closes the output file and writes the footer.
+        Writes the footer (index of all spectra and chromatograms) and closes the output file.
       */
       ~MSDataCachedConsumer()
       {
-        // Write size of file (to the end of the file)
-        ofs_.write((char*)&spectra_written_, sizeof(spectra_written_));
-        ofs_.write((char*)&chromatograms_written_, sizeof(chromatograms_written_));
+        // Write the index and the size of the file (to the end of the file)
+        writeFooter_(ofs_);
 
         // Close file stream: close() _should_ call flush() but it might not in
         // all cases. To be sure call flush() first.
@@ -100,6 +100,7 @@ namespace OpenMS
       PSQ,                ///< NCBI binary blast db
       MRM,                ///< SpectraST MRM List
       PSMS,               ///< Percolator tab-delimited output (PSM level)
+      PEPIDX,             ///< %OpenMS peptide index of a digested protein database (.pepidx)
       SIZE_OF_TYPE        ///< No file type. Simply stores the number of types
     };
 
@@ -102,6 +102,13 @@ namespace OpenMS
         std::vector< std::pair<std::string, long> > & chromatograms_offsets
       );
 
+      /**
+        @brief Decodes the Base64 (and possibly numpress) encoded binary data arrays
+
+        32 bit float m/z and time arrays are stored as doubles anyway, so they
+        are decoded and converted in one pass into BinaryData::floats_64 (and
+        their precision is set to 64 bit).
+      */
       static void decodeBase64Arrays(std::vector<BinaryData> & data_, bool skipXMLCheck = false);
 
       static void computeDataProperties_(std::vector<BinaryData>& data_, bool& precision_64, SignedSize& index, String index_name);
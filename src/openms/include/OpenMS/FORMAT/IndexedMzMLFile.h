@@ -44,8 +44,18 @@
 #include <string>
 #include <fstream>
 
+#include <boost/shared_ptr.hpp>
+
 //#define DEBUG_READER
 
+namespace boost
+{
+  namespace interprocess
+  {
+    class mapped_region;
+  }
+}
+
 namespace OpenMS
 {
 
@@ -61,26 +71,33 @@ namespace OpenMS
     extracting all the offsets of the <chromatogram> and <spectrum> tags. These
     offsets are stored as members of this class as well as the offset to the <indexList> element
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    The file is memory-mapped (read-only) and no file position is kept, so
+    that all access functions can be called concurrently from multiple
+    threads. If the file cannot be mapped (e.g. it does not fit into the
+    address space), every access opens its own file stream instead. The
+    offsets and the mapping are shared between copies of an object.
+
+    Use getSpectraByIds to retrieve many spectra at once: adjacent spectra are
+    read in a single operation and decoded in parallel.
 
   */
   class OPENMS_DLLAPI IndexedMzMLFile
   {
+      /// Binary offsets of spectra or chromatograms (native id and file position)
+      typedef std::vector< std::pair<std::string, std::streampos> > OffsetVector;
+
       /// Name of the file
       String filename_;
-      /// Binary offsets to all spectra
-      std::vector< std::pair<std::string, std::streampos> > spectra_offsets_;
-      /// Binary offsets to all chromatograms
-      std::vector< std::pair<std::string, std::streampos> > chromatograms_offsets_;
+      /// Binary offsets to all spectra (shared between copies)
+      boost::shared_ptr<OffsetVector> spectra_offsets_;
+      /// Binary offsets to all chromatograms (shared between copies)
+      boost::shared_ptr<OffsetVector> chromatograms_offsets_;
       /// offset to the <indexList> element
       std::streampos index_offset_;
       /// Whether spectra are written before chromatograms in this file
       bool spectra_before_chroms_;
-      /// The current filestream (opened by openFile)
-      std::ifstream filestream_;
+      /// Read-only memory mapping of the file (empty if the file could not be mapped)
+      boost::shared_ptr<boost::interprocess::mapped_region> mapped_region_;
       /// Whether parsing the indexedmzML file was successful
       bool parsing_success_;
 
@@ -94,12 +111,34 @@ namespace OpenMS
     */
     void parseFooter_(String filename);
 
+    /**
+      @brief Computes the file region [start, end) of the spectrum at position @p id
+
+      @throw Exception if getParsingSuccess() returns false or if @p id is out of range
+    */
+    void getSpectrumRange_(int id, std::streampos& start, std::streampos& end) const;
+
+    /**
+      @brief Computes the file region [start, end) of the chromatogram at position @p id
+
+      @throw Exception if getParsingSuccess() returns false or if @p id is out of range
+    */
+    void getChromatogramRange_(int id, std::streampos& start, std::streampos& end) const;
+
+    /**
+      @brief Reads the file region [start, end) into @p text
+
+      Reads from the memory mapping if available, otherwise from a newly
+      opened file stream.
+    */
+    void readRange_(std::streampos start, std::streampos end, std::string& text) const;
+
     public:
 
     /**
       @brief Constructor
     */
-    IndexedMzMLFile() {}
+    IndexedMzMLFile();
 
     /**
       @brief Constructor
@@ -146,7 +185,20 @@ namespace OpenMS
 
       @return The spectrum at position id
     */
-    OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id);
+    OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id) const;
+
+    /**
+      @brief Retrieve the raw data for multiple spectra at once
+
+      Runs of consecutive ids (e.g. 5, 6, 7) are read from the file with a
+      single read operation and all spectra are decoded in parallel.
+
+      @throw Exception if getParsingSuccess() returns false
+      @throw Exception if any id is not within [0, getNrSpectra()-1]
+
+      @return The spectra in the order of @p ids
+    */
+    std::vector<OpenMS::Interfaces::SpectrumPtr> getSpectraByIds(const std::vector<int>& ids) const;
 
     /**
       @brief Retrieve the raw data for the chromatogram at position "id"
@@ -156,7 +208,7 @@ namespace OpenMS
 
       @return The chromatogram at position id
     */
-    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id);
+    OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id) const;
 
     ///sets whether to skip some XML checks and be fast instead
     void setSkipXMLChecks(bool skip)
@@ -174,17 +174,76 @@ public:
       QByteArray base64_uncompressed;
       base64coder_.decodeSingleString(in, base64_uncompressed, zlib_compression);
 
-      // Create a temporary string (*not* null-terminated) to hold the data
-      std::string tmpstring(base64_uncompressed.constData(), base64_uncompressed.size());
-      decodeNP_(tmpstring, out, config);
-
-      // NOTE: it is possible (and likely faster) to call directly the const
-      // unsigned char * function but this would make it necessary to deal with
-      // reinterpret_cast ugliness here ... 
-      //
-      // decodeNP_internal_(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
+      // decode directly from the buffer, no temporary copy is needed
+      decodeNPInternal_(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
     }
 
+    /**
+     * @brief Encodes a vector of floating point numbers into raw (not base64 encoded) numpress bytes
+     *
+     * @note In case of error (or if the error tolerance of @p config cannot
+     * be met), the result string is empty
+     *
+     * @param in The vector of floating point numbers to be encoded
+     * @param result The resulting raw bytes
+     * @param config The numpress configuration defining the compression strategy
+    */
+    void encodeNPRaw(const std::vector<double> & in, String & result, const NumpressConfig & config)
+    {
+      result.clear();
+      encodeNP_(in, result, config);
+    }
+
+    /**
+     * @brief Decodes raw (not base64 encoded) numpress bytes into the result vector out
+     *
+     * @param in The raw numpress bytes
+     * @param in_size The number of bytes in @p in
+     * @param out The resulting vector of floating point numbers
+     * @param config The numpress configuration defining the compression strategy
+     *
+     * @throws Exception::ConversionError if the data cannot be decoded
+    */
+    void decodeNPRaw(const unsigned char * in, size_t in_size, std::vector<double> & out, const NumpressConfig & config)
+    {
+      decodeNPInternal_(in, in_size, out, config);
+    }
+
+    /**
+     * @brief Returns the maximal number of values decoded from @p in_size raw numpress bytes
+     *
+     * Use this to size the buffer passed to the batch decoding functions.
+     *
+     * @param in_size The number of raw numpress bytes
+     * @param np_compression The numpress compression schema of the bytes
+    */
+    static size_t getDecodedSizeBound(size_t in_size, NumpressCompression np_compression);
+
+    /**
+     * @brief Decodes raw (not base64 encoded) numpress bytes directly into a caller supplied buffer
+     *
+     * No intermediate buffers are used, which makes this the fastest way to
+     * decode numpress data, e.g. into a buffer that is reused for many arrays.
+     *
+     * @param in The raw numpress bytes
+     * @param in_size The number of bytes in @p in
+     * @param out The buffer for the decoded values
+     * @param out_size The number of values that fit into @p out, needs to be at least getDecodedSizeBound(in_size, config.np_compression)
+     * @param config The numpress configuration defining the compression strategy
+     * @return The number of decoded values
+     *
+     * @throws Exception::ConversionError if the data cannot be decoded or @p out is too small
+    */
+    size_t decodeNPRaw(const unsigned char * in, size_t in_size, double * out, size_t out_size, const NumpressConfig & config);
+
+    /**
+     * @brief Decodes raw (not base64 encoded) numpress bytes directly into a caller supplied float buffer
+     *
+     * Values are decoded in double precision and converted to float. See
+     * decodeNPRaw(const unsigned char *, size_t, double *, size_t, const NumpressConfig &).
+    */
+    size_t decodeNPRaw(const unsigned char * in, size_t in_size, float * out, size_t out_size, const NumpressConfig & config);
+
 private:
 
     /**
@@ -0,0 +1,146 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_ONDISCSPECTRUMCACHE_H
+#define OPENMS_FORMAT_ONDISCSPECTRUMCACHE_H
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/INTERFACES/DataStructures.h>
+
+#include <QtCore/QMutex>
+
+#include <list>
+#include <map>
+
+namespace OpenMS
+{
+
+  /**
+    @brief A least-recently-used cache of decoded spectra with a memory budget
+
+    Spectra are identified by their index in the file. Once the (estimated)
+    memory used by the cached spectra exceeds the budget set by setMaxBytes,
+    the least recently used spectra are removed. A budget of zero disables
+    the cache.
+
+    All functions can be called concurrently from multiple threads. Cached
+    spectra are shared with the caller and must not be modified.
+
+  */
+  class OPENMS_DLLAPI OnDiscSpectrumCache
+  {
+
+public:
+
+    /// Constructor with the memory budget in bytes (zero disables the cache)
+    explicit OnDiscSpectrumCache(Size max_bytes = 0);
+
+    /// Destructor
+    ~OnDiscSpectrumCache();
+
+    /// Sets the memory budget in bytes (zero disables the cache), removes spectra if necessary
+    void setMaxBytes(Size max_bytes);
+
+    /// Returns the memory budget in bytes
+    Size getMaxBytes() const;
+
+    /**
+      @brief Looks up spectrum @p id
+
+      If the spectrum is cached, it is returned in @p sptr and marked as most
+      recently used. Hits and misses are counted if the cache is enabled.
+
+      @return Whether the spectrum was found
+    */
+    bool get(Size id, OpenMS::Interfaces::SpectrumPtr& sptr);
+
+    /// Adds spectrum @p id (spectra larger than the budget are not cached)
+    void insert(Size id, const OpenMS::Interfaces::SpectrumPtr& sptr);
+
+    /// Removes all spectra (the hit and miss counters are not reset)
+    void clear();
+
+    /// Returns the number of cached spectra
+    Size size() const;
+
+    /// Returns the estimated memory used by the cached spectra in bytes
+    Size getBytes() const;
+
+    /// Returns the number of successful lookups
+    Size getHits() const;
+
+    /// Returns the number of unsuccessful lookups
+    Size getMisses() const;
+
+    /// Resets the hit and miss counters
+    void resetStatistics();
+
+    /// Returns the estimated memory used by @p sptr in bytes
+    static Size estimateBytes(const OpenMS::Interfaces::SpectrumPtr& sptr);
+
+private:
+
+    /// Not implemented
+    OnDiscSpectrumCache(const OnDiscSpectrumCache&);
+
+    /// Not implemented
+    OnDiscSpectrumCache& operator=(const OnDiscSpectrumCache&);
+
+    /// Cached spectrum and its estimated memory usage
+    struct CacheEntry
+    {
+      Size id;
+      Size bytes;
+      OpenMS::Interfaces::SpectrumPtr spectrum;
+    };
+
+    /// Cached spectra, the most recently used spectrum is at the front
+    typedef std::list<CacheEntry> LRUList;
+
+    /// Removes least recently used spectra until the budget is met (mutex_ must be locked)
+    void evict_();
+
+    LRUList lru_list_;
+    std::map<Size, LRUList::iterator> lookup_;
+    Size max_bytes_;
+    Size bytes_;
+    Size hits_;
+    Size misses_;
+    mutable QMutex mutex_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_ONDISCSPECTRUMCACHE_H
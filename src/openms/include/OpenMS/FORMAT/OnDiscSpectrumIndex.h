@@ -0,0 +1,217 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_ONDISCSPECTRUMINDEX_H
+#define OPENMS_FORMAT_ONDISCSPECTRUMINDEX_H
+
+#include <OpenMS/config.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+
+#include <vector>
+
+#define ONDISC_SPECTRUM_INDEX_FILE_IDENTIFIER 8094
+#define ONDISC_SPECTRUM_INDEX_FILE_VERSION 2
+
+namespace OpenMS
+{
+
+  /**
+    @brief Index of retention time, MS level and precursor isolation window of all spectra in a file
+
+    The index allows to find spectra by retention time, MS level and
+    precursor isolation window (e.g. all MS2 spectra of a SWATH window in a
+    given RT range) without holding the spectra meta data in memory. It is
+    used by OnDiscMSExperiment.
+
+    The index can be built from the meta data of an experiment (build) and
+    be stored to / loaded from a small binary file (store, load) which is
+    usually placed next to the data file (see getIndexFilename). The binary
+    file has the following layout:
+
+    - header: file identifier (Int32), format version (Int32), stamp of the
+      data file (3x UInt64, see DataFileStamp), number of spectra (UInt64)
+    - for each spectrum: RT (double), MS level (Int32) and precursor
+      isolation window (2x double)
+
+    The stamp of the data file (size, modification time and a checksum of
+    its last bytes) is used to detect an outdated index file. For indexed
+    mzML the checksummed trailer contains the index offset and the SHA-1
+    checksum of the file, so a rewritten file is detected even if size and
+    modification time did not change.
+
+  */
+  class OPENMS_DLLAPI OnDiscSpectrumIndex
+  {
+
+public:
+
+    /// Index entry of a single spectrum
+    struct OPENMS_DLLAPI Entry
+    {
+      double rt; ///< retention time
+      int ms_level; ///< MS level
+      double precursor_lower_mz; ///< lower bound of the precursor isolation window (0 if no precursor is present)
+      double precursor_upper_mz; ///< upper bound of the precursor isolation window (0 if no precursor is present)
+
+      Entry() :
+        rt(0.0),
+        ms_level(0),
+        precursor_lower_mz(0.0),
+        precursor_upper_mz(0.0)
+      {
+      }
+    };
+
+    /// Identifies the state of a data file, used to detect an outdated index file
+    struct OPENMS_DLLAPI DataFileStamp
+    {
+      UInt64 file_size; ///< size of the data file in bytes
+      UInt64 modification_time; ///< last modification of the data file (seconds since the epoch)
+      UInt64 trailer_checksum; ///< checksum of the last (up to) TRAILER_SIZE bytes of the data file
+
+      /// Number of bytes at the end of the data file covered by the checksum
+      static const Size TRAILER_SIZE = 1024;
+
+      DataFileStamp() :
+        file_size(0),
+        modification_time(0),
+        trailer_checksum(0)
+      {
+      }
+
+      bool operator==(const DataFileStamp& rhs) const
+      {
+        return file_size == rhs.file_size &&
+               modification_time == rhs.modification_time &&
+               trailer_checksum == rhs.trailer_checksum;
+      }
+
+      bool operator!=(const DataFileStamp& rhs) const
+      {
+        return !(*this == rhs);
+      }
+    };
+
+    /// Default constructor (empty index)
+    OnDiscSpectrumIndex();
+
+    /// Destructor
+    ~OnDiscSpectrumIndex();
+
+    /// Builds the index from the spectra (meta data suffices) of @p exp
+    void build(const MSExperiment<>& exp);
+
+    /**
+      @brief Loads the index from @p filename
+
+      @param filename The index file
+      @param data_file_stamp The current stamp of the data file (see getDataFileStamp), the index is only loaded if it matches the stamp stored in the index file
+
+      @return Whether a valid, up-to-date index was loaded (if false, the index is left empty)
+    */
+    bool load(const String& filename, const DataFileStamp& data_file_stamp);
+
+    /**
+      @brief Stores the index to @p filename
+
+      @throw Exception::UnableToCreateFile if the file cannot be written
+    */
+    void store(const String& filename, const DataFileStamp& data_file_stamp) const;
+
+    /**
+      @brief Returns the stamp (size, modification time, trailer checksum) of the data file @p data_filename
+
+      @throw Exception::FileNotFound if the file cannot be read
+    */
+    static DataFileStamp getDataFileStamp(const String& data_filename);
+
+    /// Returns the default name of the index file for the data file @p data_filename
+    static String getIndexFilename(const String& data_filename);
+
+    /// Returns the number of spectra in the index
+    Size size() const;
+
+    /// Returns whether the index is empty
+    bool empty() const;
+
+    /// Removes all entries
+    void clear();
+
+    /// Returns the index entry of spectrum @p id (no bounds check)
+    const Entry& getEntry(Size id) const;
+
+    /**
+      @brief Returns the spectra with rt_min <= RT <= rt_max, sorted by RT
+
+      @param rt_min Lower RT bound
+      @param rt_max Upper RT bound
+      @param ms_level Only return spectra of this MS level (0 for all levels)
+    */
+    std::vector<Size> getSpectraByRT(double rt_min, double rt_max, int ms_level = 0) const;
+
+    /**
+      @brief Returns the MS2 spectra whose precursor isolation window contains @p precursor_mz and with rt_min <= RT <= rt_max, sorted by RT
+    */
+    std::vector<Size> getSpectraByPrecursor(double precursor_mz, double rt_min, double rt_max) const;
+
+    /**
+      @brief Returns the spectrum closest to @p rt
+
+      @param rt The retention time
+      @param ms_level Only consider spectra of this MS level (0 for all levels)
+
+      @return The id of the spectrum or size() if there is no such spectrum
+    */
+    Size findNearest(double rt, int ms_level = 0) const;
+
+protected:
+
+    /// Sorts the spectrum ids by RT (called after the entries were filled)
+    void sortByRT_();
+
+    /// Returns the position of the first spectrum with RT >= @p rt in rt_order_
+    Size lowerBound_(double rt) const;
+
+    /// Index entries (in the order of the spectra in the file)
+    std::vector<Entry> entries_;
+
+    /// Spectrum ids sorted by RT
+    std::vector<Size> rt_order_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_FORMAT_ONDISCSPECTRUMINDEX_H
@@ -0,0 +1,248 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_FORMAT_PEPTIDEINDEXFILE_H
+#define OPENMS_FORMAT_PEPTIDEINDEXFILE_H
+
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+
+#include <fstream>
+#include <vector>
+
+#define PEPTIDE_INDEX_FILE_IDENTIFIER 8094
+#define PEPTIDE_INDEX_FILE_VERSION 1
+
+namespace OpenMS
+{
+
+  /**
+    @brief Reads and writes a digested protein database (peptide index)
+
+    Search tools need the peptides of a protein database under a given
+    digestion. This class stores the result of the digestion, so that the
+    FASTA file has to be parsed and digested only once (see @ref
+    UTILS_PeptideIndexBuilder) and repeated searches can load the index
+    instead.
+
+    The index contains:
+    - the proteins (identifier, description and sequence)
+    - the digestion settings (enzyme, missed cleavages, minimum and maximum peptide length)
+    - all distinct peptides, sorted by their (unmodified) monoisotopic mass
+    - for each peptide, its occurrences (protein index and start position)
+    - optionally, a fragment ion index: for each m/z bin, the peptides with
+      a singly charged b- or y-ion in that bin
+
+    Peptide sequences are not stored separately, they are views on the
+    sequence of the first protein in which they occur. Peptides whose mass
+    cannot be computed (e.g. because they contain unknown amino acids) get a
+    mass of zero and are not part of the fragment ion index.
+
+    The file (format version 1) has the following layout:
+
+    - header: file identifier (Int32), format version (Int32)
+    - settings: enzyme name (string), missed cleavages, minimum and maximum
+      peptide length (UInt64 each), fragment bin size (double, 0 if there is
+      no fragment ion index)
+    - proteins: number of proteins (UInt64), followed by identifier,
+      description and sequence (string each) of every protein
+    - peptides: number of peptides (UInt64), the masses (double array), the
+      lengths (UInt32 array), the occurrence offsets (UInt64 array, one more
+      entry than peptides), number of occurrences (UInt64) and the
+      occurrences (UInt32 pairs of protein index and position)
+    - fragment ion index: number of bins (UInt64), the posting offsets
+      (UInt64 array, one more entry than bins), number of postings (UInt64)
+      and the postings (UInt32 peptide indices, ascending within each bin)
+    - trailer: file identifier (Int32)
+
+    Strings are stored as number of characters (UInt64) followed by the
+    characters. All numbers are stored in the native byte order, without
+    padding. load() reads the complete file into memory; the arrays are not
+    aligned in the file (they follow the variable-length protein block), so
+    the file is not meant to be accessed in place.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI PeptideIndexFile :
+    public ProgressLogger
+  {
+
+public:
+
+    /// Occurrence of a peptide in a protein
+    struct OPENMS_DLLAPI PeptideOccurrence
+    {
+      UInt32 protein_index; ///< index of the protein (see getProteins())
+      UInt32 position; ///< start position of the peptide in the protein sequence
+
+      PeptideOccurrence() :
+        protein_index(0),
+        position(0)
+      {
+      }
+
+      PeptideOccurrence(UInt32 protein, UInt32 pos) :
+        protein_index(protein),
+        position(pos)
+      {
+      }
+    };
+
+    /** @name Constructors and Destructor
+    */
+    //@{
+    /// Default constructor
+    PeptideIndexFile();
+
+    /// Default destructor
+    ~PeptideIndexFile();
+    //@}
+
+    /** @name Building, reading and writing
+    */
+    //@{
+    /**
+      @brief Digests the given proteins and builds the index
+
+      @param proteins The protein database
+      @param digestion Enzyme and missed cleavages used for the digestion
+      @param min_length Minimum length of peptides
+      @param max_length Maximum length of peptides (0 = no restriction)
+      @param fragment_bin_size Bin width (in Th) of the fragment ion index (0 = no fragment ion index)
+
+      @throws Exception::InvalidParameter is thrown if the database contains more proteins or longer proteins than the file format supports
+    */
+    void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length, Size max_length, double fragment_bin_size = 0.0);
+
+    /**
+      @brief Stores the index in a file
+
+      @throws Exception::UnableToCreateFile is thrown if the file cannot be created
+    */
+    void store(const String& filename) const;
+
+    /**
+      @brief Loads the index from a file
+
+      @throws Exception::FileNotFound is thrown if the file is not found
+      @throws Exception::ParseError is thrown if the file is not a (complete) peptide index of the current version
+    */
+    void load(const String& filename);
+    //@}
+
+    /** @name Digestion settings
+    */
+    //@{
+    /// Returns the name of the enzyme used for the digestion
+    const String& getEnzymeName() const;
+
+    /// Returns the number of missed cleavages used for the digestion
+    Size getMissedCleavages() const;
+
+    /// Returns the minimum peptide length
+    Size getMinLength() const;
+
+    /// Returns the maximum peptide length (0 = no restriction)
+    Size getMaxLength() const;
+    //@}
+
+    /** @name Access to proteins and peptides
+    */
+    //@{
+    /// Returns the proteins
+    const std::vector<FASTAFile::FASTAEntry>& getProteins() const;
+
+    /// Returns the number of (distinct) peptides
+    Size getPeptideCount() const;
+
+    /// Returns the monoisotopic mass of the unmodified peptide with index @p index (peptides are sorted by mass)
+    double getPeptideMass(Size index) const;
+
+    /// Returns the sequence of the peptide with index @p index (the view is valid as long as the proteins are not changed)
+    StringView getPeptideSequence(Size index) const;
+
+    /// Returns all occurrences of the peptide with index @p index in the proteins
+    void getPeptideOccurrences(Size index, std::vector<PeptideOccurrence>& occurrences) const;
+
+    /// Returns the index range [first, last) of peptides with a mass in [@p min_mass, @p max_mass]
+    std::pair<Size, Size> getPeptidesInMassRange(double min_mass, double max_mass) const;
+    //@}
+
+    /** @name Access to the fragment ion index
+    */
+    //@{
+    /// Returns whether the index contains a fragment ion index
+    bool hasFragmentIndex() const;
+
+    /// Returns the bin width (in Th) of the fragment ion index (0 if there is none)
+    double getFragmentBinSize() const;
+
+    /// Returns the (ascending) indices of all peptides with a fragment ion in the bin of @p mz (empty if there is no fragment ion index)
+    void getPeptidesWithFragment(double mz, std::vector<Size>& peptides) const;
+    //@}
+
+protected:
+
+    /// builds the fragment ion index (peptides and masses need to be set)
+    void buildFragmentIndex_(double fragment_bin_size);
+
+    /// clears all data
+    void clear_();
+
+    /// Members
+    String enzyme_name_;
+    Size missed_cleavages_;
+    Size min_length_;
+    Size max_length_;
+    std::vector<FASTAFile::FASTAEntry> proteins_;
+
+    /// monoisotopic masses of the peptides (ascending)
+    std::vector<double> peptide_masses_;
+    /// lengths of the peptides
+    std::vector<UInt32> peptide_lengths_;
+    /// occurrences of peptide i are stored at [occurrence_offsets_[i], occurrence_offsets_[i + 1])
+    std::vector<UInt64> occurrence_offsets_;
+    std::vector<PeptideOccurrence> occurrences_;
+
+    double fragment_bin_size_;
+    /// postings of bin b are stored at [fragment_offsets_[b], fragment_offsets_[b + 1])
+    std::vector<UInt64> fragment_offsets_;
+    std::vector<UInt32> fragment_postings_;
+
+  };
+}
+#endif // OPENMS_FORMAT_PEPTIDEINDEXFILE_H
@@ -26,6 +26,7 @@ Base64.h
 Bzip2Ifstream.h
 Bzip2InputStream.h
 CachedMzML.h
+ColumnarTableFile.h
 CompressedInputSource.h
 CVMappingFile.h
 ConsensusXMLFile.h
@@ -64,6 +65,8 @@ MzTabFile.h
 MzXMLFile.h
 OMSSACSVFile.h
 OMSSAXMLFile.h
+OnDiscSpectrumCache.h
+OnDiscSpectrumIndex.h
 ParamXMLFile.h
 PTMXMLFile.h
 PeakTypeEstimator.h
@@ -71,6 +74,7 @@ PepNovoInfile.h
 PepNovoOutfile.h
 PepXMLFile.h
 PepXMLFileMascot.h
+PeptideIndexFile.h
 PercolatorOutfile.h
 ProtXMLFile.h
 SequestInfile.h
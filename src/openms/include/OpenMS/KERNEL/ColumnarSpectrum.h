@@ -0,0 +1,377 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_KERNEL_COLUMNARSPECTRUM_H
+#define OPENMS_KERNEL_COLUMNARSPECTRUM_H
+
+#include <OpenMS/KERNEL/MSSpectrum.h>
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief The peak data of a 1D spectrum stored as separate columns.
+
+    In contrast to MSSpectrum, which stores peaks (m/z and intensity
+    interleaved), this class stores all m/z values and all intensities in two
+    separate contiguous arrays. Algorithms that go through one of the
+    dimensions only (e.g. binary search on m/z, or convolution of the
+    intensities) thus read contiguous memory and can be vectorized by the
+    compiler. It is the layout of the OpenSwath data access
+    (Interfaces::Spectrum / OpenSwath::Spectrum).
+
+    The intensities are stored as double by default. Using float halves the
+    memory of the intensity column if the precision is sufficient.
+
+    The class stores peak data only; meta data stays with the MSSpectrum the
+    peaks were taken from (see assignPeaks and copyPeaksTo).
+
+    The arrays are plain std::vector (whose memory is aligned for all
+    fundamental types), so they can be swapped with the data arrays of the
+    OpenSwath data structures without copying (see swapMZArray,
+    swapIntensityArray and OpenSwathDataAccessHelper).
+
+    @note Like MSSpectrum, most algorithms expect the peaks to be sorted by m/z
+    (see isSorted and sortByPosition).
+
+    @ingroup Kernel
+  */
+  template <typename IntensityT = double>
+  class ColumnarSpectrum
+  {
+public:
+    /// Intensity type
+    typedef IntensityT IntensityType;
+    /// Column of m/z values
+    typedef std::vector<double> MZArray;
+    /// Column of intensities
+    typedef std::vector<IntensityT> IntensityArray;
+
+    /// Default constructor
+    ColumnarSpectrum() :
+      mz_(),
+      intensity_()
+    {
+    }
+
+    /// Constructor from an MSSpectrum (copies the peaks)
+    template <typename PeakT>
+    explicit ColumnarSpectrum(const MSSpectrum<PeakT>& spectrum) :
+      mz_(),
+      intensity_()
+    {
+      assignPeaks(spectrum);
+    }
+
+    /// Equality operator
+    bool operator==(const ColumnarSpectrum& rhs) const
+    {
+      return mz_ == rhs.mz_ && intensity_ == rhs.intensity_;
+    }
+
+    /// Inequality operator
+    bool operator!=(const ColumnarSpectrum& rhs) const
+    {
+      return !(operator==(rhs));
+    }
+
+    /// Returns the number of peaks
+    Size size() const
+    {
+      return mz_.size();
+    }
+
+    /// Returns true if there are no peaks
+    bool empty() const
+    {
+      return mz_.empty();
+    }
+
+    /// Removes all peaks
+    void clear()
+    {
+      mz_.clear();
+      intensity_.clear();
+    }
+
+    /// Reserves memory for @p n peaks
+    void reserve(Size n)
+    {
+      mz_.reserve(n);
+      intensity_.reserve(n);
+    }
+
+    /// Resizes both columns to @p n peaks
+    void resize(Size n)
+    {
+      mz_.resize(n);
+      intensity_.resize(n);
+    }
+
+    /// Appends a peak
+    void push_back(double mz, IntensityT intensity)
+    {
+      mz_.push_back(mz);
+      intensity_.push_back(intensity);
+    }
+
+    /// Returns the m/z of peak @p i
+    double getMZ(Size i) const
+    {
+      return mz_[i];
+    }
+
+    /// Returns the intensity of peak @p i
+    IntensityT getIntensity(Size i) const
+    {
+      return intensity_[i];
+    }
+
+    /// Returns the m/z column
+    const MZArray& getMZArray() const
+    {
+      return mz_;
+    }
+
+    /// Returns the mutable m/z column (both columns must keep the same size)
+    MZArray& getMZArray()
+    {
+      return mz_;
+    }
+
+    /// Returns the intensity column
+    const IntensityArray& getIntensityArray() const
+    {
+      return intensity_;
+    }
+
+    /// Returns the mutable intensity column (both columns must keep the same size)
+    IntensityArray& getIntensityArray()
+    {
+      return intensity_;
+    }
+
+    /// Swaps the m/z column with @p mz (without copying)
+    void swapMZArray(MZArray& mz)
+    {
+      mz_.swap(mz);
+    }
+
+    /// Swaps the intensity column with @p intensity (without copying)
+    void swapIntensityArray(IntensityArray& intensity)
+    {
+      intensity_.swap(intensity);
+    }
+
+    /// Swaps the contents with another spectrum
+    void swap(ColumnarSpectrum& other)
+    {
+      mz_.swap(other.mz_);
+      intensity_.swap(other.intensity_);
+    }
+
+    /// Replaces the peaks with the peaks of @p spectrum
+    template <typename PeakT>
+    void assignPeaks(const MSSpectrum<PeakT>& spectrum)
+    {
+      const Size n = spectrum.size();
+      mz_.resize(n);
+      intensity_.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        mz_[i] = spectrum[i].getMZ();
+        intensity_[i] = spectrum[i].getIntensity();
+      }
+    }
+
+    /**
+      @brief Replaces the peaks of @p spectrum with the peaks of this spectrum
+
+      The meta data of @p spectrum is kept. Peaks of a type with more members
+      than m/z and intensity (e.g. RichPeak1D) are default constructed.
+    */
+    template <typename PeakT>
+    void copyPeaksTo(MSSpectrum<PeakT>& spectrum) const
+    {
+      const Size n = mz_.size();
+      spectrum.clear(false);
+      spectrum.resize(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        spectrum[i].setMZ(mz_[i]);
+        spectrum[i].setIntensity(intensity_[i]);
+      }
+    }
+
+    /// Checks if the peaks are sorted by ascending m/z
+    bool isSorted() const
+    {
+      for (Size i = 1; i < mz_.size(); ++i)
+      {
+        if (mz_[i - 1] > mz_[i]) return false;
+      }
+      return true;
+    }
+
+    /**
+      @brief Sorts the peaks by ascending m/z
+
+      Peaks with equal m/z keep their relative order. Nothing is done if the
+      peaks are sorted already.
+    */
+    void sortByPosition()
+    {
+      if (isSorted()) return;
+
+      std::vector<std::pair<double, Size> > order(mz_.size());
+      for (Size i = 0; i < mz_.size(); ++i)
+      {
+        order[i] = std::make_pair(mz_[i], i);
+      }
+      std::stable_sort(order.begin(), order.end(), PairFirstLess_());
+
+      MZArray mz(mz_.size());
+      IntensityArray intensity(intensity_.size());
+      for (Size i = 0; i < order.size(); ++i)
+      {
+        mz[i] = order[i].first;
+        intensity[i] = intensity_[order[i].second];
+      }
+      mz_.swap(mz);
+      intensity_.swap(intensity);
+    }
+
+    /**
+      @brief Returns the index of the first peak with m/z not smaller than @p mz (or size() if there is none)
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    Size MZBegin(double mz) const
+    {
+      return std::lower_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+
+    /**
+      @brief Returns the index of the first peak with m/z greater than @p mz (or size() if there is none)
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    Size MZEnd(double mz) const
+    {
+      return std::upper_bound(mz_.begin(), mz_.end(), mz) - mz_.begin();
+    }
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z
+
+      @param mz The searched for mass-to-charge ratio
+      @return Returns the index of the peak.
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+
+      @exception Exception::Precondition is thrown if the spectrum is empty (not only in debug mode)
+    */
+    Size findNearest(double mz) const
+    {
+      // no peak => no search
+      if (mz_.empty()) throw Exception::Precondition(__FILE__, __LINE__, __PRETTY_FUNCTION__, "There must be at least one peak to determine the nearest peak!");
+
+      const Size i = MZBegin(mz);
+      // border cases
+      if (i == 0) return 0;
+      if (i == mz_.size()) return mz_.size() - 1;
+
+      // the peak before or the current peak are closest
+      if (std::fabs(mz_[i] - mz) < std::fabs(mz_[i - 1] - mz))
+      {
+        return i;
+      }
+      return i - 1;
+    }
+
+    /**
+      @brief Binary search for the peak nearest to a specific m/z given a +/- tolerance window in Th
+
+      @return Returns the index of the peak or -1 if no peak present in tolerance window or if spectrum is empty
+    */
+    Int findNearest(double mz, double tolerance) const
+    {
+      if (mz_.empty()) return -1;
+      const Size i = findNearest(mz);
+      if (mz_[i] >= mz - tolerance && mz_[i] <= mz + tolerance)
+      {
+        return static_cast<Int>(i);
+      }
+      return -1;
+    }
+
+    /**
+      @brief Sums up the intensities of all peaks with m/z in the closed interval [@p mz_start, @p mz_end]
+
+      @note Make sure the spectrum is sorted with respect to m/z! Otherwise the result is undefined.
+    */
+    double sumIntensity(double mz_start, double mz_end) const
+    {
+      const Size end = MZEnd(mz_end);
+      double sum = 0.0;
+      for (Size i = MZBegin(mz_start); i < end; ++i)
+      {
+        sum += intensity_[i];
+      }
+      return sum;
+    }
+
+protected:
+    /// Compares pairs by their first member only (keeps std::stable_sort stable for equal m/z)
+    struct PairFirstLess_
+    {
+      bool operator()(const std::pair<double, Size>& a, const std::pair<double, Size>& b) const
+      {
+        return a.first < b.first;
+      }
+    };
+
+    /// m/z column
+    MZArray mz_;
+    /// intensity column
+    IntensityArray intensity_;
+  };
+
+} // namespace OpenMS
+
+#endif // OPENMS_KERNEL_COLUMNARSPECTRUM_H
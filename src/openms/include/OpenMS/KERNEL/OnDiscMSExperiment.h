@@ -43,6 +43,9 @@
 #include <OpenMS/METADATA/ExperimentalSettings.h>
 #include <OpenMS/FORMAT/IndexedMzMLFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/OnDiscSpectrumCache.h>
+#include <OpenMS/FORMAT/OnDiscSpectrumIndex.h>
+
 
 #include <vector>
 #include <algorithm>
@@ -57,10 +60,20 @@ namespace OpenMS
 
     @ingroup Kernel
 
-    @note This implementation is @a not thread-safe since it keeps internally a
-    single file access pointer which it moves when accessing a specific
-    data item. The caller is responsible to ensure that access is performed
-    atomically.
+    Spectra and chromatograms can be retrieved concurrently from multiple
+    threads (see IndexedMzMLFile).
+
+    When a file is opened, an index of the RT, MS level and precursor
+    isolation window of all spectra is created (see getSpectrumIndex), which
+    allows to find e.g. all spectra of a SWATH window in an RT range without
+    going through the meta data. The index is read from the file next to the
+    data file (see OnDiscSpectrumIndex::getIndexFilename) if it exists and is
+    up to date, otherwise it is built from the meta data and, if enabled with
+    setPersistSpectrumIndex, stored there for the next time.
+
+    Decoded spectra can be kept in a least-recently-used cache (see
+    setCacheSize and getCache) to avoid decoding them again when they are
+    accessed repeatedly. The cache is disabled by default.
 
   */
   template <typename PeakT = Peak1D, typename ChromatogramPeakT = ChromatogramPeak>
@@ -69,7 +82,12 @@ namespace OpenMS
 
 public:
 
-    OnDiscMSExperiment() {}
+    OnDiscMSExperiment() :
+      spectrum_index_(new OnDiscSpectrumIndex),
+      spectrum_cache_(new OnDiscSpectrumCache),
+      persist_spectrum_index_(false)
+    {
+    }
 
     /**
       @brief Constructor
@@ -77,7 +95,10 @@ public:
       This initializes the object and attempts to read the indexed mzML by
       parsing the index and then reading the meta information into memory.
     */
-    OnDiscMSExperiment(const String& filename)
+    OnDiscMSExperiment(const String& filename) :
+      spectrum_index_(new OnDiscSpectrumIndex),
+      spectrum_cache_(new OnDiscSpectrumCache),
+      persist_spectrum_index_(false)
     {
       openFile(filename);
     }
@@ -86,10 +107,15 @@ public:
     {
       filename_ = filename;
       indexed_mzml_file_.openFile(filename);
+      spectrum_cache_->clear();
       if (filename != "" && !skipMetaData)
       {
         loadMetaData_(filename);
       }
+      if (indexed_mzml_file_.getParsingSuccess())
+      {
+        loadSpectrumIndex_();
+      }
       return indexed_mzml_file_.getParsingSuccess();
     }
 
@@ -97,7 +123,10 @@ public:
     OnDiscMSExperiment(const OnDiscMSExperiment& source) :
       filename_(source.filename_),
       indexed_mzml_file_(source.indexed_mzml_file_),
-      meta_ms_experiment_(source.meta_ms_experiment_)
+      meta_ms_experiment_(source.meta_ms_experiment_),
+      spectrum_index_(source.spectrum_index_),
+      spectrum_cache_(new OnDiscSpectrumCache(source.spectrum_cache_->getMaxBytes())),
+      persist_spectrum_index_(source.persist_spectrum_index_)
     {
     }
 
@@ -105,8 +134,7 @@ public:
       @brief Equality operator
 
       This only checks whether the underlying file is the same and the parsed
-      meta-information is the same. Note that the file reader (e.g. the
-      std::ifstream of the file) might be in a different state.
+      meta-information is the same.
     */
     bool operator==(const OnDiscMSExperiment& rhs) const
     {
@@ -163,6 +191,47 @@ public:
       return boost::static_pointer_cast<const ExperimentalSettings>(meta_ms_experiment_);
     }
 
+    /**
+      @brief Returns the RT / MS level / precursor index of all spectra
+
+      The index is empty if the file was opened without meta data and no
+      index file was found.
+    */
+    const OnDiscSpectrumIndex& getSpectrumIndex() const
+    {
+      return *spectrum_index_;
+    }
+
+    /**
+      @brief Sets whether the spectrum index is stored next to the data file
+
+      If enabled, openFile stores the spectrum index it had to build (see
+      OnDiscSpectrumIndex::getIndexFilename), failures to write it are
+      ignored. Disabled by default.
+    */
+    void setPersistSpectrumIndex(bool persist)
+    {
+      persist_spectrum_index_ = persist;
+    }
+
+    /// Returns whether the spectrum index is stored next to the data file
+    bool getPersistSpectrumIndex() const
+    {
+      return persist_spectrum_index_;
+    }
+
+    /// Sets the memory budget of the spectrum cache in bytes (zero disables the cache, default)
+    void setCacheSize(Size max_bytes)
+    {
+      spectrum_cache_->setMaxBytes(max_bytes);
+    }
+
+    /// Returns the spectrum cache (e.g. for the hit and miss counters)
+    const OnDiscSpectrumCache& getCache() const
+    {
+      return *spectrum_cache_;
+    }
+
     /// alias for getSpectrum
     inline MSSpectrum<PeakT> operator[](Size n)
     {
@@ -176,7 +245,7 @@ public:
     */
     MSSpectrum<PeakT> getSpectrum(Size id)
     {
-      OpenMS::Interfaces::SpectrumPtr sptr = indexed_mzml_file_.getSpectrumById(static_cast<int>(id));
+      OpenMS::Interfaces::SpectrumPtr sptr = getSpectrumById(id);
       MSSpectrum<PeakT> spectrum(meta_ms_experiment_->operator[](id));
 
       // recreate a spectrum from the data arrays!
@@ -195,10 +264,23 @@ public:
 
     /**
       @brief returns a single spectrum
+
+      @note If the spectrum cache is enabled, the returned spectrum may be
+      shared with the cache and must not be modified.
     */
     OpenMS::Interfaces::SpectrumPtr getSpectrumById(Size id)
     {
-      return indexed_mzml_file_.getSpectrumById(id);
+      OpenMS::Interfaces::SpectrumPtr sptr;
+      if (spectrum_cache_->get(id, sptr))
+      {
+        return sptr;
+      }
+      sptr = indexed_mzml_file_.getSpectrumById(static_cast<int>(id));
+      if (spectrum_cache_->getMaxBytes() > 0)
+      {
+        spectrum_cache_->insert(id, sptr);
+      }
+      return sptr;
     }
 
     /**
@@ -255,6 +337,39 @@ private:
       f.load(filename, *meta_ms_experiment_.get());
     }
 
+    /// Loads the spectrum index from the index file or builds it from the meta data
+    void loadSpectrumIndex_()
+    {
+      spectrum_index_ = boost::shared_ptr<OnDiscSpectrumIndex>(new OnDiscSpectrumIndex);
+
+      const String index_file = OnDiscSpectrumIndex::getIndexFilename(filename_);
+      const OnDiscSpectrumIndex::DataFileStamp data_file_stamp = OnDiscSpectrumIndex::getDataFileStamp(filename_);
+      if (spectrum_index_->load(index_file, data_file_stamp) &&
+          spectrum_index_->size() == indexed_mzml_file_.getNrSpectra())
+      {
+        return;
+      }
+
+      spectrum_index_->clear();
+      if (!meta_ms_experiment_ || meta_ms_experiment_->size() != indexed_mzml_file_.getNrSpectra())
+      {
+        return; // no meta data available
+      }
+      spectrum_index_->build(*meta_ms_experiment_);
+
+      if (persist_spectrum_index_)
+      {
+        try
+        {
+          spectrum_index_->store(index_file, data_file_stamp);
+        }
+        catch (Exception::UnableToCreateFile& /* e */)
+        {
+          // e.g. a read-only directory, the index is rebuilt next time
+        }
+      }
+    }
+
 
 protected:
 
@@ -264,6 +379,12 @@ protected:
     IndexedMzMLFile indexed_mzml_file_;
     /// The meta-data
     boost::shared_ptr<MSExperiment<> > meta_ms_experiment_;
+    /// The RT / MS level / precursor index of the spectra (shared between copies)
+    boost::shared_ptr<OnDiscSpectrumIndex> spectrum_index_;
+    /// Cache of decoded spectra
+    boost::shared_ptr<OnDiscSpectrumCache> spectrum_cache_;
+    /// Whether the spectrum index is stored next to the data file
+    bool persist_spectrum_index_;
   };
 
 } // namespace OpenMS
@@ -127,6 +127,19 @@ namespace MSNumpress {
 		const unsigned char *data,
 		const size_t dataSize,
 		double *result);
+
+	/**
+	 * Same as above, but decodes into an array of floats. Each value is
+	 * computed in double precision and then converted to float.
+	 * @data		pointer to array of bytes to be decoded (need memorycont. repr.)
+	 * @dataSize	number of bytes from *data to decode
+	 * @result		pointer to were resulting floats should be stored
+	 * @return		the number of decoded floats
+	 */
+	size_t decodeLinear(
+		const unsigned char *data,
+		const size_t dataSize,
+		float *result);
 	
 	/**
 	 * Calls lower level decodeLinear while handling vector sizes appropriately
@@ -228,6 +241,18 @@ namespace MSNumpress {
 		const unsigned char *data,
 		const size_t dataSize,
 		double *result);
+
+	/**
+	 * Same as above, but decodes into an array of floats.
+	 * @data		pointer to array of bytes to be decoded (need memorycont. repr.)
+	 * @dataSize	number of bytes from *data to decode
+	 * @result		pointer to were resulting floats should be stored
+	 * @return		the number of decoded floats
+	 */
+	size_t decodePic(
+		const unsigned char *data,
+		const size_t dataSize,
+		float *result);
 	
 	/**
 	 * Calls lower level decodePic while handling vector sizes appropriately
@@ -296,6 +321,19 @@ namespace MSNumpress {
 		const unsigned char *data, 
 		const size_t dataSize, 
 		double *result);
+
+	/**
+	 * Same as above, but decodes into an array of floats. Each value is
+	 * computed in double precision and then converted to float.
+	 * @data		pointer to array of bytes to be decoded (need memorycont. repr.)
+	 * @dataSize	number of bytes from *data to decode
+	 * @result		pointer to were resulting floats should be stored
+	 * @return		the number of decoded floats
+	 */
+	size_t decodeSlof(
+		const unsigned char *data, 
+		const size_t dataSize, 
+		float *result);
 	
 	/**
 	 * Calls lower level decodeSlof while handling vector sizes appropriately
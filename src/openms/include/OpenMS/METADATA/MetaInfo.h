@@ -35,6 +35,7 @@
 #ifndef OPENMS_METADATA_METAINFO_H
 #define OPENMS_METADATA_METAINFO_H
 
+#include <utility>
 #include <vector>
 
 #include <OpenMS/CONCEPT/Types.h>
@@ -60,6 +61,10 @@ namespace OpenMS
       MetaInfoInterface, instead of simply adding MetaInfo as member. MetaInfoInterface implements
       a full interface to a MetaInfo member.
 
+      The values are kept in a vector of (index, value) pairs sorted by index. Objects like
+      peptide hits or features usually carry only a handful of meta values, for which a flat
+      vector needs far less memory than a node-based map and is faster to search and copy.
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfo
@@ -120,8 +125,16 @@ public:
 private:
     /// Static MetaInfoRegistry
     static MetaInfoRegistry registry_;
+    /// Storage type of the index to value mapping (sorted by index)
+    typedef std::vector<std::pair<UInt, DataValue> > ValueVector;
+
+    /// Returns the position of @p index in index_to_value_ (or the position where it would be inserted)
+    ValueVector::iterator lowerBound_(UInt index);
+    /// Returns the position of @p index in index_to_value_ (or the position where it would be inserted)
+    ValueVector::const_iterator lowerBound_(UInt index) const;
+
     /// The actual mapping of indexes to values
-    std::map<UInt, DataValue> index_to_value_;
+    ValueVector index_to_value_;
 
   };
 
@@ -47,6 +47,8 @@
 #pragma warning( disable : 4251 )     // disable MSVC dll-interface warning
 #endif
 
+class QReadWriteLock;
+
 namespace OpenMS
 {
 
@@ -69,6 +71,11 @@ namespace OpenMS
       12 - low_quality<BR>
       13 - charge<BR>
 
+      The registry is safe to use from several threads. Lookups only take a
+      shared (read) lock, so concurrent readers do not serialize each other
+      once all names are registered; only registering a new name or changing
+      a description or unit takes the exclusive lock.
+
       @ingroup Metadata
   */
   class OPENMS_DLLAPI MetaInfoRegistry
@@ -170,6 +177,8 @@ private:
     std::map<UInt, String> index_to_description_;
     /// map from index to unit
     std::map<UInt, String> index_to_unit_;
+    /// lock guarding the maps (shared for lookups, exclusive for modifications)
+    mutable QReadWriteLock* lock_;
 
   };
 
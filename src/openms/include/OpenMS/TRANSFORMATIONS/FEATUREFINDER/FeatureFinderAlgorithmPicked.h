@@ -38,6 +38,10 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/TraceFitter.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
+#include <OpenMS/DATASTRUCTURES/DBoundingBox.h>
+
+#include <boost/shared_ptr.hpp>
 
 #include <fstream>
 
@@ -139,8 +143,8 @@ protected:
     std::vector<std::vector<std::vector<double> > > intensity_thresholds_;
     //@}
 
-    ///Vector of precalculated isotope distributions for several mass windows
-    std::vector<TheoreticalIsotopePattern> isotope_distributions_;
+    ///Precalculated isotope distributions for several mass windows
+    boost::shared_ptr<IsotopeDistributionCache> isotope_distributions_;
 
     // Docu in base class
     virtual void updateMembers_();
@@ -154,6 +158,26 @@ protected:
      */
     double intersection_(const Feature& f1, const Feature& f2) const;
 
+    /**
+     * Finds all pairs of intersecting bounding boxes.
+     *
+     * The boxes are indexed in a grid over RT and m/z, so only boxes that
+     * share a grid cell are compared. For each box i, @p intersecting[i]
+     * contains the indices j > i of all boxes intersecting it, in ascending
+     * order.
+     */
+    static void findIntersectingBoundingBoxes_(const std::vector<DBoundingBox<2> >& bbs, std::vector<std::vector<Size> >& intersecting);
+
+    /**
+     * Finds all positions inside a bounding box.
+     *
+     * @p positions_by_mz contains the (m/z, index) pairs of all positions,
+     * sorted by m/z, and @p rts the RT of each position by index. @p result
+     * contains the indices j > @p min_index of all positions enclosed by
+     * @p bb, in ascending order.
+     */
+    static void findPositionsInBoundingBox_(const std::vector<std::pair<double, Size> >& positions_by_mz, const std::vector<double>& rts, const DBoundingBox<2>& bb, Size min_index, std::vector<Size>& result);
+
     /// Returns the isotope distribution for a certain mass window
     const TheoreticalIsotopePattern& getIsotopeDistribution_(double mass) const;
 
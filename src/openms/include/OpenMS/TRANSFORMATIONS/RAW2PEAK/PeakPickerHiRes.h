@@ -409,9 +409,10 @@ public:
     }
 
     /**
-     * @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-     * method picks peaks for each scan in the map consecutively. The resulting
-     * picked peaks are written to the output map.
+     * @brief Applies the peak-picking algorithm to a map (MSExperiment). The
+     * spectra and chromatograms of the map are picked in parallel (if OpenMP
+     * is enabled). The resulting picked peaks are written to the output map
+     * in the order of the input.
      *
      * @param input  input map in profile mode
      * @param output  output map with picked peaks
@@ -426,19 +427,33 @@ public:
     }
 
     /**
-     * @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-     * method picks peaks for each scan in the map consecutively. The resulting
-     * picked peaks are written to the output map.
+     * @brief Applies the peak-picking algorithm to a map (MSExperiment). The
+     * spectra and chromatograms of the map are picked in parallel (if OpenMP
+     * is enabled). The resulting picked peaks are written to the output map
+     * in the order of the input.
      *
      * @param input  input map in profile mode
      * @param output  output map with picked peaks
-     * @param boundaries_spec  boundaries of the picked peaks in spectra
+     * @param boundaries_spec  boundaries of the picked peaks in spectra (one entry per picked spectrum, in the order of the input)
      * @param boundaries_chrom  boundaries of the picked peaks in chromatograms
      * @param check_spectrum_type  if set, checks spectrum type and throws an exception if a centroided spectrum is passed 
      */
     template <typename PeakType, typename ChromatogramPeakT>
     void pickExperiment(const MSExperiment<PeakType, ChromatogramPeakT>& input, MSExperiment<PeakType, ChromatogramPeakT>& output, std::vector<std::vector<PeakBoundary> >& boundaries_spec, std::vector<std::vector<PeakBoundary> >& boundaries_chrom, const bool check_spectrum_type = true) const
     {
+      // check the spectrum types first, exceptions cannot leave the parallel loop below
+      if (check_spectrum_type)
+      {
+        for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+        {
+          if (ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()) &&
+              input[scan_idx].getType() == SpectrumSettings::PEAKS)
+          {
+            throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+          }
+        }
+      }
+
       // make sure that output is clear
       output.clear(true);
 
@@ -447,56 +462,70 @@ public:
 
       // resize output with respect to input
       output.resize(input.size());
+      output.getChromatograms().resize(input.getChromatograms().size());
 
       Size progress = 0;
       startProgress(0, input.size() + input.getChromatograms().size(), "picking peaks");
 
-      if (input.getNrSpectra() > 0)
+      // every spectrum is written to its own output slot, which keeps the
+      // output in input order independent of the thread scheduling
+      std::vector<std::vector<PeakBoundary> > boundaries_s(input.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.size(); ++scan_idx)
       {
-        for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+        if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
         {
-          if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
-          {
-            output[scan_idx] = input[scan_idx];
-          }
-          else
-          {
-            std::vector<PeakBoundary> boundaries_s; // peak boundaries of a single spectrum
-
-            // determine type of spectral data (profile or centroided)
-            SpectrumSettings::SpectrumType spectrum_type = input[scan_idx].getType();
-
-            if (spectrum_type == SpectrumSettings::PEAKS && check_spectrum_type)
-            {
-              throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-            }
-
-            pick(input[scan_idx], output[scan_idx], boundaries_s);
-            boundaries_spec.push_back(boundaries_s);
-          }
-          setProgress(++progress);
+          output[scan_idx] = input[scan_idx];
         }
+        else
+        {
+          pick(input[scan_idx], output[scan_idx], boundaries_s[scan_idx]);
+        }
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_progress)
+#endif
+        setProgress(++progress);
       }
 
-
-      for (Size i = 0; i < input.getChromatograms().size(); ++i)
+      std::vector<std::vector<PeakBoundary> > boundaries_c(input.getChromatograms().size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)input.getChromatograms().size(); ++i)
       {
-        MSChromatogram<ChromatogramPeakT> chromatogram;
-        std::vector<PeakBoundary> boundaries_c; // peak boundaries of a single chromatogram
-        pick(input.getChromatograms()[i], chromatogram, boundaries_c);
-        output.addChromatogram(chromatogram);
-        boundaries_chrom.push_back(boundaries_c);
+        pick(input.getChromatograms()[i], output.getChromatograms()[i], boundaries_c[i]);
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_progress)
+#endif
         setProgress(++progress);
       }
       endProgress();
 
+      for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+      {
+        if (ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
+        {
+          boundaries_spec.push_back(std::vector<PeakBoundary>());
+          boundaries_spec.back().swap(boundaries_s[scan_idx]);
+        }
+      }
+      for (Size i = 0; i < boundaries_c.size(); ++i)
+      {
+        boundaries_chrom.push_back(std::vector<PeakBoundary>());
+        boundaries_chrom.back().swap(boundaries_c[i]);
+      }
+
       return;
     }
 
     /**
-      @brief Applies the peak-picking algorithm to a map (MSExperiment). This
-      method picks peaks for each scan in the map consecutively. The resulting
-      picked peaks are written to the output map.
+      @brief Applies the peak-picking algorithm to a map (MSExperiment). The
+      spectra are read from disk, decoded and picked in parallel (if OpenMP
+      is enabled), see OnDiscMSExperiment for concurrent access. The
+      resulting picked peaks are written to the output map in the order of
+      the input.
 
       Currently we have to give up const-correctness but we know that everything on disc is constant
     */
@@ -512,42 +541,57 @@ public:
       Size progress = 0;
       startProgress(0, input.size() + input.getNrChromatograms(), "picking peaks");
 
-      if (input.getNrSpectra() > 0)
+      // resize output with respect to input
+      output.resize(input.getNrSpectra());
+      output.getChromatograms().resize(input.getNrChromatograms());
+
+      // the spectrum type is only known after the spectrum was read,
+      // exceptions are counted and re-thrown after the parallel loop
+      Size centroided_count = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize scan_idx = 0; scan_idx < (SignedSize)input.getNrSpectra(); ++scan_idx)
       {
+        if (centroided_count) continue; // no need to pick further if already an error was encountered
 
-        // resize output with respect to input
-        output.resize(input.size());
-
-        for (Size scan_idx = 0; scan_idx != input.size(); ++scan_idx)
+        MSSpectrum<PeakType> s = input.getSpectrum(scan_idx);
+        if (!ListUtils::contains(ms_levels_, s.getMSLevel()))
         {
-          if (!ListUtils::contains(ms_levels_, input[scan_idx].getMSLevel()))
-          {
-            output[scan_idx] = input[scan_idx];
-          }
-          else
-          {
-            MSSpectrum<PeakType> s = input[scan_idx];
-            s.sortByPosition();
-
-            // determine type of spectral data (profile or centroided)
-            SpectrumSettings::SpectrumType spectrum_type = s.getType();
-
-            if (spectrum_type == SpectrumSettings::PEAKS && check_spectrum_type)
-            {
-              throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
-            }
-
-            pick(s, output[scan_idx]);
-          }
-          setProgress(++progress);
+          output[scan_idx] = s;
+        }
+        else if (s.getType() == SpectrumSettings::PEAKS && check_spectrum_type)
+        {
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_error)
+#endif
+          ++centroided_count;
+        }
+        else
+        {
+          s.sortByPosition();
+          pick(s, output[scan_idx]);
         }
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_progress)
+#endif
+        setProgress(++progress);
+      }
+      if (centroided_count != 0)
+      {
+        endProgress();
+        throw OpenMS::Exception::IllegalArgument(__FILE__, __LINE__, __FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
       }
 
-      for (Size i = 0; i < input.getNrChromatograms(); ++i)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)input.getNrChromatograms(); ++i)
       {
-        MSChromatogram<ChromatogramPeakT> chromatogram;
-        pick(input.getChromatogram(i), chromatogram);
-        output.addChromatogram(chromatogram);
+        pick(input.getChromatogram(i), output.getChromatograms()[i]);
+#ifdef _OPENMP
+#pragma omp critical (PeakPickerHiRes_progress)
+#endif
         setProgress(++progress);
       }
       endProgress();
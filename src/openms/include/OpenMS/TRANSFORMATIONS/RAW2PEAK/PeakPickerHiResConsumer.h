@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Erhan Kenar $
+// --------------------------------------------------------------------------
+
+#ifndef OPENMS_TRANSFORMATIONS_RAW2PEAK_PEAKPICKERHIRESCONSUMER_H
+#define OPENMS_TRANSFORMATIONS_RAW2PEAK_PEAKPICKERHIRESCONSUMER_H
+
+#include <OpenMS/INTERFACES/IMSDataConsumer.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Consumer class that picks peaks in spectra and chromatograms on the fly
+
+    Each consumed spectrum (of an MS level selected by the "ms_levels"
+    parameter of the PeakPickerHiRes) and each consumed chromatogram is
+    replaced by its picked counterpart. Spectra of other MS levels are left
+    unchanged.
+
+    The consumer does not keep any data and can be chained with other
+    consumers using MSDataChainingConsumer, e.g. to pick peaks while a file is
+    read and write the picked data to disk without ever holding the full map
+    in memory:
+
+    @code
+    PeakPickerHiResConsumer picker(pp);
+    PlainMSDataWritingConsumer writer(out_file);
+
+    std::vector<Interfaces::IMSDataConsumer<> *> consumers;
+    consumers.push_back(&picker);
+    consumers.push_back(&writer);
+    MSDataChainingConsumer chain(consumers);
+
+    MzMLFile().transform(in_file, &chain);
+    @endcode
+
+  */
+  class OPENMS_DLLAPI PeakPickerHiResConsumer :
+    public Interfaces::IMSDataConsumer<>
+  {
+
+  public:
+    typedef MSExperiment<> MapType;
+    typedef MapType::SpectrumType SpectrumType;
+    typedef MapType::ChromatogramType ChromatogramType;
+
+    /**
+      @brief Constructor
+
+      @param pp The peak picker to use (a copy is stored)
+      @param check_spectrum_type If set, throws an exception if a centroided spectrum is consumed (see PeakPickerHiRes::pickExperiment)
+    */
+    explicit PeakPickerHiResConsumer(const PeakPickerHiRes& pp, bool check_spectrum_type = true);
+
+    /// Destructor
+    virtual ~PeakPickerHiResConsumer();
+
+    virtual void setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */);
+
+    virtual void setExperimentalSettings(const ExperimentalSettings& /* exp */);
+
+    /**
+      @brief Replaces the spectrum by its picked peaks
+
+      @exception Exception::IllegalArgument is thrown if a centroided spectrum is passed and the spectrum type is checked
+    */
+    virtual void consumeSpectrum(SpectrumType& s);
+
+    /// Replaces the chromatogram by its picked peaks
+    virtual void consumeChromatogram(ChromatogramType& c);
+
+  protected:
+    PeakPickerHiRes pp_;
+    std::vector<Int> ms_levels_;
+    bool check_spectrum_type_;
+  };
+
+} //end namespace OpenMS
+
+#endif // OPENMS_TRANSFORMATIONS_RAW2PEAK_PEAKPICKERHIRESCONSUMER_H
@@ -33,6 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/ANALYSIS/ID/IDMapper.h>
+#include <OpenMS/COMPARISON/CLUSTERING/HashGrid.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 
 using namespace std;
@@ -40,6 +41,95 @@ using namespace std;
 namespace OpenMS
 {
 
+  namespace
+  {
+    /**
+      @brief Index of bounding boxes (RT x m/z) for finding the boxes that contain a position
+
+      Every box is stored in all cells of a HashGrid that it overlaps. The cell
+      size is the average size of the boxes, so a box overlaps only a few cells
+      and a cell holds only a few boxes. Empty boxes are not stored.
+    */
+    class BoxIndex
+    {
+public:
+      explicit BoxIndex(const vector<DBoundingBox<2> >& boxes) :
+        boxes_(boxes), grid_(cellDimension_(boxes))
+      {
+        vector<HashGrid<Size>::value_type> entries;
+        for (Size index = 0; index < boxes.size(); ++index)
+        {
+          const DBoundingBox<2>& box = boxes[index];
+          if (box.isEmpty())
+          {
+            continue;
+          }
+          HashGrid<Size>::CellIndex first = cellIndex_(box.minPosition()),
+                                    last = cellIndex_(box.maxPosition());
+          for (Int64 x = first[0]; x <= last[0]; ++x)
+          {
+            for (Int64 y = first[1]; y <= last[1]; ++y)
+            {
+              // the center of a cell identifies it:
+              HashGrid<Size>::ClusterCenter center((x + 0.5) * grid_.cell_dimension[0],
+                                                   (y + 0.5) * grid_.cell_dimension[1]);
+              entries.push_back(make_pair(center, index));
+            }
+          }
+        }
+        grid_.insert(entries.begin(), entries.end());
+      }
+
+      /// Appends the indices of all boxes that contain @p position to @p result
+      void find(const DPosition<2>& position, vector<Size>& result) const
+      {
+        const HashGrid<Size>::CellContent* cell = grid_.grid_find(cellIndex_(position));
+        if (cell == 0)
+        {
+          return;
+        }
+        for (HashGrid<Size>::CellContent::const_iterator it = cell->begin();
+             it != cell->end(); ++it)
+        {
+          if (boxes_[it->second].encloses(position))
+          {
+            result.push_back(it->second);
+          }
+        }
+      }
+
+private:
+      static HashGrid<Size>::ClusterCenter cellDimension_(const vector<DBoundingBox<2> >& boxes)
+      {
+        double sum_rt = 0.0, sum_mz = 0.0;
+        Size count = 0;
+        for (vector<DBoundingBox<2> >::const_iterator it = boxes.begin(); it != boxes.end(); ++it)
+        {
+          if (!it->isEmpty())
+          {
+            sum_rt += it->width();
+            sum_mz += it->height();
+            ++count;
+          }
+        }
+        // fall back to 1 second / 1 Th for boxes without extent:
+        double rt = (sum_rt > 0.0) ? sum_rt / count : 1.0;
+        double mz = (sum_mz > 0.0) ? sum_mz / count : 1.0;
+        return HashGrid<Size>::ClusterCenter(rt, mz);
+      }
+
+      /// Same computation as in HashGrid
+      HashGrid<Size>::CellIndex cellIndex_(const DPosition<2>& position) const
+      {
+        return HashGrid<Size>::CellIndex(Int64(floor(position[0] / grid_.cell_dimension[0])),
+                                         Int64(floor(position[1] / grid_.cell_dimension[1])));
+      }
+
+      const vector<DBoundingBox<2> >& boxes_;
+      HashGrid<Size> grid_;
+    };
+  }
+
   IDMapper::IDMapper() :
     DefaultParamHandler("IDMapper"),
     rt_tolerance_(5.0),
@@ -103,30 +193,59 @@ namespace OpenMS
     //append protein identifications to Map
     map.getProteinIdentifications().insert(map.getProteinIdentifications().end(), protein_ids.begin(), protein_ids.end());
 
-    //keep track of assigned/unassigned peptide identifications
-    std::map<Size, Size> assigned;
-
-    // store which peptides fit which feature (and avoid double entries)
-    // consensusMap -> {peptide_index}
-    std::vector<std::set<size_t> > mapping(map.size());
+    // index the consensus features by the area in which peptides can match
+    // them (around the centroid or around all subelements):
+    std::vector<DBoundingBox<2> > boxes(map.size());
+    for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+    {
+      if (!measure_from_subelements)
+      {
+        boxes[cm_index].enlarge(map[cm_index].getPosition());
+      }
+      else
+      {
+        for (ConsensusFeature::HandleSetType::const_iterator it_handle = map[cm_index].getFeatures().begin();
+             it_handle != map[cm_index].getFeatures().end();
+             ++it_handle)
+        {
+          boxes[cm_index].enlarge(it_handle->getPosition());
+        }
+      }
+      increaseMatchingBox_(boxes[cm_index]);
+    }
+    BoxIndex index(boxes);
 
-    DoubleList mz_values;
-    double rt_pep;
-    IntList charges;
+    // matches of every peptide: (consensus feature index, matching subelement)
+    typedef std::vector<std::pair<Size, const FeatureHandle*> > Matches;
+    std::vector<Matches> matches(ids.size());
 
-    //iterate over the peptide IDs
-    for (Size i = 0; i < ids.size(); ++i)
+    //iterate over the peptide IDs - they are independent of each other
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)ids.size(); ++i)
     {
       if (ids[i].getHits().empty())
         continue;
 
+      DoubleList mz_values;
+      double rt_pep;
+      IntList charges;
       getIDDetails_(ids[i], rt_pep, mz_values, charges);
 
+      // candidate features (in map order):
+      std::vector<Size> candidates;
+      for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
+      {
+        index.find(DPosition<2>(rt_pep, mz_values[i_mz]), candidates);
+      }
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
       //iterate over the features
-      for (Size cm_index = 0; cm_index < map.size(); ++cm_index)
+      for (std::vector<Size>::const_iterator cand_it = candidates.begin(); cand_it != candidates.end(); ++cand_it)
       {
-        // if set to TRUE, we leave the i_mz-loop as we added the whole ID with all hits
-        bool was_added = false; // was current pep-m/z matched?!
+        Size cm_index = *cand_it;
 
         // iterate over m/z values of pepIds
         for (Size i_mz = 0; i_mz < mz_values.size(); ++i_mz)
@@ -151,14 +270,11 @@ namespace OpenMS
           }
 
           //check if we compare distance from centroid or subelements
+          const FeatureHandle* match = 0;
+          bool was_added = false; // was current pep-m/z matched?!
           if (!measure_from_subelements)
           {
-            if (isMatch_(rt_pep - map[cm_index].getRT(), mz_pep, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge())))
-            {
-              was_added = true;
-              map[cm_index].getPeptideIdentifications().push_back(ids[i]);
-              ++assigned[i];
-            }
+            was_added = isMatch_(rt_pep - map[cm_index].getRT(), mz_pep, map[cm_index].getMZ()) && (ignore_charge_ || ListUtils::contains(current_charges, map[cm_index].getCharge()));
           }
           else
           {
@@ -169,35 +285,38 @@ namespace OpenMS
               if (isMatch_(rt_pep - it_handle->getRT(), mz_pep, it_handle->getMZ())  && (ignore_charge_ || ListUtils::contains(current_charges, it_handle->getCharge())))
               {
                 was_added = true;
-                if (mapping[cm_index].count(i) == 0)
-                {
-                  // Store the map index of the peptide feature in the id the feature was mapped to.
-                  PeptideIdentification id_pep = ids[i];
-                  if (annotate_ids_with_subelements)
-                  {
-                    id_pep.setMetaValue("map index", it_handle->getMapIndex());
-                  }
-                  
-                  map[cm_index].getPeptideIdentifications().push_back(id_pep);
-                  ++assigned[i];
-                  mapping[cm_index].insert(i);
-                }
-                break; // we added this peptide already.. no need to check other handles
+                match = &(*it_handle);
+                break; // no need to check other handles
               }
             }
-            // continue to here
           }
 
+          // we add the whole ID with all hits only once
           if (was_added)
+          {
+            matches[i].push_back(std::make_pair(cm_index, match));
             break;
-
+          }
         } // m/z values to check
-
-        // break to here
-
       } // features
     } // Identifications
 
+    // annotate in the order of the peptide IDs:
+    std::vector<Size> assigned(ids.size(), 0);
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      for (Matches::const_iterator match_it = matches[i].begin(); match_it != matches[i].end(); ++match_it)
+      {
+        PeptideIdentification id_pep = ids[i];
+        if (annotate_ids_with_subelements && (match_it->second != 0))
+        {
+          // Store the map index of the peptide feature in the id the feature was mapped to.
+          id_pep.setMetaValue("map index", match_it->second->getMapIndex());
+        }
+        map[match_it->first].getPeptideIdentifications().push_back(id_pep);
+        ++assigned[i];
+      }
+    }
 
     Size matches_none(0);
     Size matches_single(0);
@@ -264,8 +383,6 @@ namespace OpenMS
     
     // calculate feature bounding boxes only once:
     std::vector<DBoundingBox<2> > boxes;
-    double min_rt = std::numeric_limits<double>::max();
-    double max_rt = -std::numeric_limits<double>::max();
     // std::cout << "Precomputing bounding boxes..." << std::endl;
     boxes.reserve(map.size());
     for (FeatureMap::Iterator f_it = map.begin();
@@ -288,73 +405,49 @@ namespace OpenMS
       }
       increaseBoundingBox_(box);
       boxes.push_back(box);
-      
-      min_rt = std::min(min_rt, box.minPosition().getX());
-      max_rt = std::max(max_rt, box.maxPosition().getX());
     }
-    
-    // hash bounding boxes of features by RT:
-    // RT range is partitioned into slices (bins) of 1 second; every feature
-    // that overlaps a certain slice is hashed into the corresponding bin
-    std::vector<std::vector<SignedSize> > hash_table;
-    // make sure the RT hash table has indices >= 0 and doesn't waste space
-    // in the beginning:
-    SignedSize offset(0);
-    
-    if (map.size() > 0)
-    {
-      // std::cout << "Setting up hash table..." << std::endl;
-      offset = SignedSize(floor(min_rt));
-      // this only works if features were found
-      hash_table.resize(SignedSize(floor(max_rt)) - offset + 1);
-      for (Size index = 0; index < boxes.size(); ++index)
-      {
-        const DBoundingBox<2> & box = boxes[index];
-        for (SignedSize i = SignedSize(floor(box.minPosition().getX()));
-             i <= SignedSize(floor(box.maxPosition().getX())); ++i)
-        {
-          hash_table[i - offset].push_back(index);
-        }
-      }
-    }
-    else
+
+    // index the bounding boxes by RT and m/z:
+    if (map.empty())
     {
       LOG_WARN << "IDMapper received an empty FeatureMap! All peptides are mapped as 'unassigned'!" << std::endl;
     }
-    
-    // for statistics:
-    Size matches_none = 0, matches_single = 0, matches_multi = 0;
-    
+    BoxIndex index(boxes);
+
+    // indices of the features matching each peptide ID:
+    std::vector<std::vector<Size> > matches(ids.size());
+
     // std::cout << "Finding matches..." << std::endl;
-    // iterate over peptide IDs:
-    for (std::vector<PeptideIdentification>::const_iterator id_it =
-         ids.begin(); id_it != ids.end(); ++id_it)
+    // iterate over peptide IDs - they are independent of each other:
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize id_index = 0; id_index < (SignedSize)ids.size(); ++id_index)
     {
-      // std::cout << "Peptide ID: " << id_it - ids.begin() << std::endl;
-      
-      if (id_it->getHits().empty()) continue;
-      
+      const PeptideIdentification& id = ids[id_index];
+      if (id.getHits().empty()) continue;
+
       DoubleList mz_values;
       double rt_value;
       IntList charges;
-      getIDDetails_(*id_it, rt_value, mz_values, charges, use_avg_mass);
-      
-      if ((rt_value < min_rt) || (rt_value > max_rt))             // RT out of bounds
+      getIDDetails_(id, rt_value, mz_values, charges, use_avg_mass);
+
+      // candidate features, i.e. those whose bounding box contains the ID:
+      std::vector<Size> candidates;
+      for (DoubleList::iterator mz_it = mz_values.begin();
+           mz_it != mz_values.end(); ++mz_it)
       {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
-        ++matches_none;
-        continue;
+        index.find(DPosition<2>(rt_value, *mz_it), candidates);
       }
-      
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
       // iterate over candidate features:
-      Size index = SignedSize(floor(rt_value)) - offset;
-      Size matching_features = 0;
-      for (std::vector<SignedSize>::iterator hash_it =
-           hash_table[index].begin(); hash_it != hash_table[index].end();
-           ++hash_it)
+      for (std::vector<Size>::iterator cand_it = candidates.begin();
+           cand_it != candidates.end(); ++cand_it)
       {
-        Feature & feat = map[*hash_it];
-        
+        const Feature & feat = map[*cand_it];
+
         // need to check the charge state?
         bool check_charge = !ignore_charge_;
         if (check_charge && (mz_values.size() == 1))               // check now
@@ -362,7 +455,7 @@ namespace OpenMS
           if (!ListUtils::contains(charges, feat.getCharge())) continue;
           check_charge = false;                 // don't need to check later
         }
-        
+
         // iterate over m/z values (only one if "mz_ref." is "precursor"):
         Size l_index = 0;
         for (DoubleList::iterator mz_it = mz_values.begin();
@@ -372,21 +465,20 @@ namespace OpenMS
           {
             continue;                   // charge states need to match
           }
-          
+
           DPosition<2> id_pos(rt_value, *mz_it);
-          if (boxes[*hash_it].encloses(id_pos))                 // potential match
+          if (boxes[*cand_it].encloses(id_pos))                 // potential match
           {
             if (use_centroid_mz)
             {
               // only one m/z value to check, which was already incorporated
               // into the overall bounding box -> success!
-              feat.getPeptideIdentifications().push_back(*id_it);
-              ++matching_features;
+              matches[id_index].push_back(*cand_it);
               break;                     // "mz_it" loop
             }
             // else: check all the mass traces
             bool found_match = false;
-            for (std::vector<ConvexHull2D>::iterator ch_it =
+            for (std::vector<ConvexHull2D>::const_iterator ch_it =
                  feat.getConvexHulls().begin(); ch_it !=
                  feat.getConvexHulls().end(); ++ch_it)
             {
@@ -399,8 +491,7 @@ namespace OpenMS
               increaseBoundingBox_(box);
               if (box.encloses(id_pos))                     // success!
               {
-                feat.getPeptideIdentifications().push_back(*id_it);
-                ++matching_features;
+                matches[id_index].push_back(*cand_it);
                 found_match = true;
                 break;                       // "ch_it" loop
               }
@@ -409,15 +500,31 @@ namespace OpenMS
           }
         }
       }
-      if (matching_features == 0)
+    }
+
+    // for statistics:
+    Size matches_none = 0, matches_single = 0, matches_multi = 0;
+
+    // annotate in the order of the peptide IDs:
+    for (Size id_index = 0; id_index < ids.size(); ++id_index)
+    {
+      if (ids[id_index].getHits().empty()) continue;
+
+      const std::vector<Size>& matching_features = matches[id_index];
+      for (std::vector<Size>::const_iterator match_it = matching_features.begin();
+           match_it != matching_features.end(); ++match_it)
+      {
+        map[*match_it].getPeptideIdentifications().push_back(ids[id_index]);
+      }
+      if (matching_features.empty())
       {
-        map.getUnassignedPeptideIdentifications().push_back(*id_it);
+        map.getUnassignedPeptideIdentifications().push_back(ids[id_index]);
         ++matches_none;
       }
-      else if (matching_features == 1) ++matches_single;
+      else if (matching_features.size() == 1) ++matches_single;
       else ++matches_multi;
     }
-    
+
     // some statistics output
     LOG_INFO << "Unassigned peptides: " << matches_none << "\n"
     << "Peptides assigned to exactly one feature: " << matches_single << "\n"
@@ -508,6 +615,27 @@ namespace OpenMS
     box.setMax(box.maxPosition() + add_max);
   }
 
+  void IDMapper::increaseMatchingBox_(DBoundingBox<2>& box) const
+  {
+    double mz_min = box.minPosition().getY(), mz_max = box.maxPosition().getY();
+    if (measure_ == MEASURE_PPM)
+    {
+      // tolerance is relative to the peptide m/z, see isMatch_()
+      double tolerance = mz_tolerance_ * 1e-6;
+      mz_min /= 1 + tolerance;
+      mz_max /= std::max(1 - tolerance, 1e-6);
+    }
+    else
+    {
+      mz_min -= mz_tolerance_;
+      mz_max += mz_tolerance_;
+    }
+    // allow for rounding differences to the exact check in isMatch_():
+    double margin = 1e-9 * (fabs(mz_max) + 1.0);
+    box.setMin(DPosition<2>(box.minPosition().getX() - rt_tolerance_ * (1 + 1e-9) - 1e-9, mz_min - margin));
+    box.setMax(DPosition<2>(box.maxPosition().getX() + rt_tolerance_ * (1 + 1e-9) + 1e-9, mz_max + margin));
+  }
+
   bool IDMapper::checkMassType_(const vector<DataProcessing>& processing) const
   {
     bool use_avg_mass = false;
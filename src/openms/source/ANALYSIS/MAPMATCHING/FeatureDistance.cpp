@@ -192,4 +192,18 @@ namespace OpenMS
     return make_pair(valid, dist);
   }
 
+  double FeatureDistance::lowerBound(double rt_diff, double mz_diff, double left_mz) const
+  {
+    DistanceParams_ params_mz(params_mz_);
+    if (params_mz.max_diff_ppm) // same computation as in operator()
+    {
+      double max_diff_mz = params_mz.max_difference;
+      max_diff_mz *= left_mz * 1e-6;
+      params_mz.norm_factor = 1 / max_diff_mz;
+    }
+
+    double dist = distance_(rt_diff, params_rt_) + distance_(mz_diff, params_mz);
+    return dist * total_weight_reciprocal_;
+  }
+
 }
@@ -36,6 +36,16 @@
 #include <OpenMS/ANALYSIS/MAPMATCHING/StablePairFinder.h>
 
 #include <OpenMS/KERNEL/ConversionHelper.h>
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <functional>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace OpenMS
 {
@@ -44,6 +54,10 @@ namespace OpenMS
     FeatureGroupingAlgorithm()
   {
     setName("FeatureGroupingAlgorithmUnlabeled");
+    defaults_.setValue("merge_strategy", "sequential", "How to combine the input maps in 'group': 'sequential' adds one map after the other to the consensus of all previous maps; 'tree' merges pairs of maps in parallel, then pairs of the results, and so on (faster for many maps, but the intermediate results of each level are kept in memory).");
+    defaults_.setValidStrings("merge_strategy", ListUtils::create<String>("sequential,tree"));
+    defaults_.setValue("max_parallel_merges", 0, "Strategy 'tree': maximum number of pairs of maps that are merged at the same time. This only limits the working memory of the concurrent merges (two consensus maps and the pair finder data each); all input maps and the intermediate results of a level are kept in memory regardless. '0' uses one merge per thread.", ListUtils::create<String>("advanced"));
+    defaults_.setMinInt("max_parallel_merges", 0);
     defaults_.insert("", StablePairFinder().getParameters());
     defaultsToParam_();
     // The input for the pairfinder is a vector of FeatureMaps of size 2
@@ -62,6 +76,55 @@ namespace OpenMS
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "At least two maps must be given!");
     }
 
+    if (param_.getValue("merge_strategy") == "tree")
+    {
+      mergeTree_(maps, out);
+    }
+    else
+    {
+      mergeSequential_(maps, out);
+    }
+
+    // add protein IDs and unassigned peptide IDs to the result map here,
+    // to keep the same order as the input maps (useful for output later)
+    for (std::vector<FeatureMap>::const_iterator map_it = maps.begin();
+         map_it != maps.end(); ++map_it)
+    {
+      // add protein identifications to result map
+      out.getProteinIdentifications().insert(
+        out.getProteinIdentifications().end(),
+        map_it->getProteinIdentifications().begin(),
+        map_it->getProteinIdentifications().end());
+
+      // add unassigned peptide identifications to result map
+      out.getUnassignedPeptideIdentifications().insert(
+        out.getUnassignedPeptideIdentifications().end(),
+        map_it->getUnassignedPeptideIdentifications().begin(),
+        map_it->getUnassignedPeptideIdentifications().end());
+    }
+
+    // canonical ordering for checking the results, and the ids have no real meaning anyway
+#if 1 // the way this was done in DelaunayPairFinder and StablePairFinder
+    out.sortByMZ();
+#else
+    out.sortByQuality();
+    out.sortByMaps();
+    out.sortBySize();
+#endif
+
+    return;
+  }
+
+  Param FeatureGroupingAlgorithmUnlabeled::pairFinderParameters_() const
+  {
+    Param param = param_.copy("", true);
+    param.remove("merge_strategy");
+    param.remove("max_parallel_merges");
+    return param;
+  }
+
+  void FeatureGroupingAlgorithmUnlabeled::mergeSequential_(const std::vector<FeatureMap>& maps, ConsensusMap& out) const
+  {
     // define reference map (the one with most peaks)
     Size reference_map_index = 0;
     Size max_count = 0;
@@ -82,7 +145,7 @@ namespace OpenMS
 
     // loop over all other maps, extend the groups
     StablePairFinder pair_finder;
-    pair_finder.setParameters(param_.copy("", true));
+    pair_finder.setParameters(pairFinderParameters_());
 
     for (Size i = 0; i < maps.size(); ++i)
     {
@@ -100,42 +163,130 @@ namespace OpenMS
     out.swap(input[0]);
     // copy back the input maps (they have been deleted while swapping)
     out.getFileDescriptions() = input[0].getFileDescriptions();
+  }
 
-    // add protein IDs and unassigned peptide IDs to the result map here,
-    // to keep the same order as the input maps (useful for output later)
-    for (std::vector<FeatureMap>::const_iterator map_it = maps.begin();
-         map_it != maps.end(); ++map_it)
+  void FeatureGroupingAlgorithmUnlabeled::mergeTree_(const std::vector<FeatureMap>& maps, ConsensusMap& out) const
+  {
+    // order the maps by size, so that maps of similar size are merged with
+    // each other and the larger map of each pair serves as the reference
+    // (maps of equal size stay in input order):
+    std::vector<std::pair<Size, Size> > order; // (size, index)
+    for (Size m = 0; m < maps.size(); ++m)
     {
-      // add protein identifications to result map
-      out.getProteinIdentifications().insert(
-        out.getProteinIdentifications().end(),
-        map_it->getProteinIdentifications().begin(),
-        map_it->getProteinIdentifications().end());
+      order.push_back(std::make_pair(maps[m].size(), maps.size() - m));
+    }
+    std::sort(order.begin(), order.end(), std::greater<std::pair<Size, Size> >());
 
-      // add unassigned peptide identifications to result map
-      out.getUnassignedPeptideIdentifications().insert(
-        out.getUnassignedPeptideIdentifications().end(),
-        map_it->getUnassignedPeptideIdentifications().begin(),
-        map_it->getUnassignedPeptideIdentifications().end());
+    Param pair_finder_param = pairFinderParameters_();
+#ifdef _OPENMP
+    Int max_parallel = param_.getValue("max_parallel_merges");
+    Int threads = omp_get_max_threads();
+    if ((max_parallel > 0) && (max_parallel < threads))
+    {
+      threads = max_parallel;
     }
+#endif
 
-    // canonical ordering for checking the results, and the ids have no real meaning anyway
-#if 1 // the way this was done in DelaunayPairFinder and StablePairFinder
-    out.sortByMZ();
-#else
-    out.sortByQuality();
-    out.sortByMaps();
-    out.sortBySize();
+    // the input maps are converted to consensus maps only when they are
+    // merged, so that at most two converted inputs per running merge exist
+    std::vector<ConsensusMap> current;
+    for (Size level = 1; (level == 1) || (current.size() > 1); ++level)
+    {
+      StopWatch stop_watch;
+      stop_watch.start();
+
+      // merge pairs of neighboring maps; an odd map out is passed on as it is
+      Size count = (level == 1) ? order.size() : current.size();
+      SignedSize merges = count / 2;
+      std::vector<ConsensusMap> next(merges + count % 2);
+      // exceptions must not leave the parallel loop, the first one is
+      // stored and re-thrown after the loop
+      bool failed = false;
+      Exception::BaseException error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threads)
 #endif
+      for (SignedSize m = 0; m < merges; ++m)
+      {
+        if (failed) continue; // no need to merge further if an error was encountered
 
-    return;
+        try
+        {
+          std::vector<ConsensusMap> input(2);
+          for (Size k = 0; k < 2; ++k)
+          {
+            if (level == 1)
+            {
+              Size index = maps.size() - order[2 * m + k].second;
+              MapConversion::convert(index, maps[index], input[k]);
+            }
+            else
+            {
+              input[k].swap(current[2 * m + k]);
+            }
+          }
+          StablePairFinder pair_finder;
+          pair_finder.setParameters(pair_finder_param);
+          pair_finder.run(input, next[m]);
+        }
+        catch (Exception::BaseException& e)
+        {
+#ifdef _OPENMP
+#pragma omp critical (FeatureGroupingAlgorithmUnlabeled_error)
+#endif
+          if (!failed)
+          {
+            failed = true;
+            error = e;
+          }
+        }
+        catch (std::exception& e)
+        {
+#ifdef _OPENMP
+#pragma omp critical (FeatureGroupingAlgorithmUnlabeled_error)
+#endif
+          if (!failed)
+          {
+            failed = true;
+            error = Exception::BaseException(__FILE__, __LINE__, __PRETTY_FUNCTION__, "std::exception", e.what());
+          }
+        }
+      }
+      if (failed)
+      {
+        throw error;
+      }
+      if (count % 2)
+      {
+        if (level == 1)
+        {
+          Size index = maps.size() - order.back().second;
+          MapConversion::convert(index, maps[index], next.back());
+        }
+        else
+        {
+          next.back().swap(current.back());
+        }
+      }
+      current.swap(next);
+
+      stop_watch.stop();
+      LOG_INFO << "Merge level " << level << ": " << merges << " pair(s) merged, "
+               << current.size() << " map(s) left (" << stop_watch.getClockTime()
+               << " s)" << std::endl;
+    }
+
+    // replace result with temporary map
+    out.swap(current[0]);
+    // copy back the file descriptions (they have been deleted while swapping)
+    out.getFileDescriptions() = current[0].getFileDescriptions();
   }
 
   void FeatureGroupingAlgorithmUnlabeled::addToGroup(int map_id, const FeatureMap& feature_map)
   {
     // create new PairFinder
     StablePairFinder pair_finder;
-    pair_finder.setParameters(param_.copy("", true));
+    pair_finder.setParameters(pairFinderParameters_());
 
     // Convert the input map to a consensus map (using the given map_id) and
     // replace the second element in the pairfinder_input_ vector.
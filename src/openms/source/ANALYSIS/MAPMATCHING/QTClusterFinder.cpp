@@ -212,7 +212,7 @@ namespace OpenMS
     // create the hash grid and fill it with features:
     // std::cout << "Hashing..." << std::endl;
     list<OpenMS::GridFeature> grid_features;
-    Grid grid(Grid::ClusterCenter(max_diff_rt_, max_diff_mz_));
+    vector<Grid::value_type> grid_entries;
     for (Size map_index = 0; map_index < num_maps_; ++map_index)
     {
       for (Size feature_index = 0; feature_index < input_maps[map_index].size();
@@ -230,14 +230,19 @@ namespace OpenMS
         {
           pep_it->sort();
         }
-        grid.insert(make_pair(Grid::ClusterCenter(gfeat.getRT(), gfeat.getMZ()),
-                              &gfeat));
+        grid_entries.push_back(make_pair(Grid::ClusterCenter(gfeat.getRT(), gfeat.getMZ()),
+                                         &gfeat));
       }
     }
+    Grid grid(Grid::ClusterCenter(max_diff_rt_, max_diff_mz_));
+    // the iteration order of the grid breaks ties between clusters of equal
+    // quality and between equidistant neighbors:
+    sortInFormerGridOrder_(grid, grid_entries);
+    grid.insert(grid_entries.begin(), grid_entries.end());
 
     // compute QT clustering:
     // std::cout << "Clustering..." << std::endl;
-    list<QTCluster> clustering;
+    vector<QTCluster> clustering;
     computeClustering_(grid, clustering);
     // number of clusters == number of data points:
     Size size = clustering.size();
@@ -245,7 +250,7 @@ namespace OpenMS
     // create a temp. map storing which grid features are next to which clusters
     typedef OpenMSBoost::unordered_map<Size, std::vector<GridFeature*> > NeighborList;
     ElementMapping element_mapping;
-    for (list<QTCluster>::iterator it = clustering.begin();
+    for (vector<QTCluster>::iterator it = clustering.begin();
          it != clustering.end(); ++it)
     {
       NeighborList neigh = it->getAllNeighbors();
@@ -262,13 +267,20 @@ namespace OpenMS
     }
 
     // ensure that all cluster centers are in the list
-    for (list<QTCluster>::iterator it = clustering.begin();
+    for (vector<QTCluster>::iterator it = clustering.begin();
          it != clustering.end(); ++it)
     {
       OpenMS::GridFeature* center_feature = it->getCenterPoint();
       element_mapping[center_feature].push_back(&(*it));
     }
 
+    // queue of all clusters, ordered by quality
+    ClusterQueue queue;
+    for (Size i = 0; i < clustering.size(); ++i)
+    {
+      queue.push(QueueEntry_(clustering[i].getQuality(), i));
+    }
+
     ProgressLogger logger;
     Size progress = 0;
     if (do_progress)
@@ -277,50 +289,48 @@ namespace OpenMS
       logger.startProgress(0, size, "linking features");
     }
 
-    while (!clustering.empty())
+    while (true)
     {
-      // std::cout << "Clusters: " << clustering.size() << std::endl;
       ConsensusFeature consensus_feature;
-      makeConsensusFeature_(clustering, consensus_feature, element_mapping, grid);
-      if (!clustering.empty())
+      if (!makeConsensusFeature_(clustering, queue, consensus_feature,
+                                 element_mapping, grid))
       {
-        result_map.push_back(consensus_feature);
+        break;
       }
+      result_map.push_back(consensus_feature);
       if (do_progress) logger.setProgress(progress++);
     }
 
     if (do_progress) logger.endProgress();
   }
 
-  void QTClusterFinder::makeConsensusFeature_(list<QTCluster>& clustering,
+  bool QTClusterFinder::makeConsensusFeature_(vector<QTCluster>& clustering,
+                                              ClusterQueue& queue,
                                               ConsensusFeature& feature,
                                               ElementMapping& element_mapping,
-                                              Grid& grid)
+                                              const Grid& grid)
   {
-    // find the best cluster (a valid cluster with the highest score)
-    // -> this is equivalent to std::max_element but we can skip invalid clusters
-    list<QTCluster>::iterator best = clustering.begin();
-    while (best != clustering.end() && best->isInvalid()) // find start element
+    // find the best cluster (a valid cluster with the highest score): take
+    // entries from the queue until one is up-to-date, i.e. its cluster is
+    // still valid and has not changed its quality since the entry was added
+    // (every change added a new entry, so no cluster is missed)
+    QTCluster* best = NULL;
+    while (!queue.empty())
     {
-      ++best;
-    }
-    for (list<QTCluster>::iterator it = best;
-         it != clustering.end(); ++it)
-    {
-      if (!it->isInvalid())
+      QueueEntry_ entry = queue.top();
+      queue.pop();
+      QTCluster& cluster = clustering[entry.index];
+      if (!cluster.isInvalid() && cluster.getQuality() == entry.quality)
       {
-        if (it->getQuality() > best->getQuality())
-        {
-          best = it;
-        }
+        best = &cluster;
+        break;
       }
     }
 
-    // no more clusters to process -> clear clustering and return
-    if (best == clustering.end())
+    // no more clusters to process
+    if (best == NULL)
     {
-      clustering.clear();
-      return;
+      return false;
     }
 
     OpenMSBoost::unordered_map<Size, OpenMS::GridFeature*> elements;
@@ -392,7 +402,8 @@ namespace OpenMS
             // add elements to the current cluster to replace the ones we just
             // removed
             const OpenMS::GridFeature* center_feature = (*cluster)->getCenterPoint();
-            addClusterElements_(x, y, grid, (**cluster), center_feature);
+            addClusterElements_(x, y, grid, (**cluster), center_feature, feature_distance_);
+            queue.push(QueueEntry_((*cluster)->getQuality(), *cluster - &clustering[0]));
 
             ////////////////////////////////////////
             // Step 2: update element_mapping as the best feature for each
@@ -424,10 +435,11 @@ namespace OpenMS
         }
       }
     }
+    return true;
   }
 
   void QTClusterFinder::addClusterElements_(int x, int y, const Grid& grid, QTCluster& cluster,
-    const OpenMS::GridFeature* center_feature)
+    const OpenMS::GridFeature* center_feature, FeatureDistance& feature_distance)
   {
     cluster.initializeCluster();
 
@@ -446,44 +458,39 @@ namespace OpenMS
       // iterate over neighboring grid cells (2nd dimension):
       for (int j = y - 1; j <= y + 1; ++j)
       {
-        try
-        {
-          const Grid::CellContent& act_pos = grid.grid_at(Grid::CellIndex(i, j));
+        const Grid::CellContent* act_pos = grid.grid_find(Grid::CellIndex(i, j));
+        if (act_pos == NULL) continue; // no features in this cell
 
-          for (Grid::const_cell_iterator it_cell = act_pos.begin();
-               it_cell != act_pos.end(); ++it_cell)
-          {
-            OpenMS::GridFeature* neighbor_feature = it_cell->second;
+        for (Grid::const_cell_iterator it_cell = act_pos->begin();
+             it_cell != act_pos->end(); ++it_cell)
+        {
+          OpenMS::GridFeature* neighbor_feature = it_cell->second;
 
 #ifdef DEBUG_QTCLUSTERFINDER
-            std::cout << " considering to add feature " << neighbor_feature->getFeature().getUniqueId() << " to cluster " <<  center_feature->getFeature().getUniqueId()<< std::endl;
+          std::cout << " considering to add feature " << neighbor_feature->getFeature().getUniqueId() << " to cluster " <<  center_feature->getFeature().getUniqueId()<< std::endl;
 #endif
 
-            // Skip features that we have already used -> we cannot add them to
-            // be neighbors any more
-            if (already_used_.find(neighbor_feature) != already_used_.end() )
-            {
-              continue;
-            }
+          // Skip features that we have already used -> we cannot add them to
+          // be neighbors any more
+          if (already_used_.find(neighbor_feature) != already_used_.end() )
+          {
+            continue;
+          }
 
-            // consider only "real" neighbors, not the element itself:
-            if (center_feature != neighbor_feature)
-            {
-              // NOTE: this actually caches the distance -> memory problem
-              double dist = getDistance_(center_feature, neighbor_feature);
+          // consider only "real" neighbors, not the element itself:
+          if (center_feature != neighbor_feature)
+          {
+            double dist = feature_distance(center_feature->getFeature(),
+                                           neighbor_feature->getFeature()).second;
 
-              if (dist == FeatureDistance::infinity)
-              {
-                continue; // conditions not satisfied
-              }
-              // if neighbor point is a possible cluster point, add it:
-              cluster.add(neighbor_feature, dist);
+            if (dist == FeatureDistance::infinity)
+            {
+              continue; // conditions not satisfied
             }
+            // if neighbor point is a possible cluster point, add it:
+            cluster.add(neighbor_feature, dist);
           }
         }
-        catch (std::out_of_range&)
-        {
-        }
       }
     }
 
@@ -522,8 +529,33 @@ namespace OpenMS
     run_(input_maps, result_map);
   }
 
-  void QTClusterFinder::computeClustering_(Grid& grid,
-                                           list<QTCluster>& clustering)
+  void QTClusterFinder::sortInFormerGridOrder_(const Grid& grid,
+                                               vector<Grid::value_type>& entries)
+  {
+    // same containers and insertion order as in the former HashGrid:
+    typedef OpenMSBoost::unordered_multimap<Grid::ClusterCenter, GridFeature*> FormerCell;
+    typedef OpenMSBoost::unordered_map<Grid::CellIndex, FormerCell> FormerGrid;
+    FormerGrid former_grid;
+    for (vector<Grid::value_type>::const_iterator it = entries.begin();
+         it != entries.end(); ++it)
+    {
+      former_grid[grid.cell_index(it->first)].insert(*it);
+    }
+
+    entries.clear();
+    for (FormerGrid::const_iterator cell_it = former_grid.begin();
+         cell_it != former_grid.end(); ++cell_it)
+    {
+      for (FormerCell::const_iterator it = cell_it->second.begin();
+           it != cell_it->second.end(); ++it)
+      {
+        entries.push_back(*it);
+      }
+    }
+  }
+
+  void QTClusterFinder::computeClustering_(const Grid& grid,
+                                           vector<QTCluster>& clustering)
   {
     clustering.clear();
     already_used_.clear();
@@ -531,27 +563,38 @@ namespace OpenMS
     // FeatureDistance produces normalized distances (between 0 and 1):
     const double max_distance = 1.0;
 
-    // iterate over all grid cells:
-    for (Grid::iterator it = grid.begin(); it != grid.end(); ++it)
+    // create one cluster per grid feature (the order defines which cluster
+    // is preferred among clusters of equal quality):
+    clustering.reserve(grid.size());
+    for (Grid::const_iterator it = grid.begin(); it != grid.end(); ++it)
     {
       const Grid::CellIndex& act_coords = it.index();
       const Int x = act_coords[0], y = act_coords[1];
 
       OpenMS::GridFeature* center_feature = it->second;
-      QTCluster cluster(center_feature, num_maps_, max_distance, use_IDs_, x, y);
-
-      addClusterElements_(x, y, grid, cluster, center_feature);
-
-      clustering.push_back(cluster);
+      clustering.push_back(QTCluster(center_feature, num_maps_, max_distance,
+                                     use_IDs_, x, y));
     }
-  }
 
-  double QTClusterFinder::getDistance_(const OpenMS::GridFeature* left,
-                                       const OpenMS::GridFeature* right)
-  {
-    return feature_distance_(left->getFeature(), right->getFeature()).second;
+    // collect the neighbors of every cluster center - the clusters are
+    // independent of each other, so this can be done in parallel
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // computing distances may modify the state of the functor
+      FeatureDistance feature_distance(feature_distance_);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)clustering.size(); ++i)
+      {
+        QTCluster& cluster = clustering[i];
+        addClusterElements_(cluster.getXCoord(), cluster.getYCoord(), grid,
+                            cluster, cluster.getCenterPoint(), feature_distance);
+      }
+    }
   }
-  
 
   QTClusterFinder::~QTClusterFinder()
   {
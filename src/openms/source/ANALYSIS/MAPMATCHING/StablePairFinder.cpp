@@ -41,6 +41,9 @@
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/METADATA/PeptideIdentification.h>
 
+#include <algorithm>
+#include <limits>
+
 #ifdef Debug_StablePairFinder
 #define V_(bla) std::cout << __FILE__ ":" << __LINE__ << ": " << bla << std::endl;
 #else
@@ -53,6 +56,332 @@ using namespace std;
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// Peptide annotations of the features of a map, prepared for fast comparison
+    struct PeptideAnnotations
+    {
+      /// Does the feature have peptide identifications?
+      std::vector<bool> annotated;
+
+      /// Sequences of the best hits of the feature's peptide identifications
+      std::vector<std::set<String> > best_hits;
+
+      /// Same criterion as StablePairFinder::compatibleIDs_()
+      bool compatible(Size index, const PeptideAnnotations& other, Size other_index) const
+      {
+        return !annotated[index] || !other.annotated[other_index] ||
+               (best_hits[index] == other.best_hits[other_index]);
+      }
+    };
+
+    /**
+      @brief k-d tree over the features of a consensus map
+
+      Features are split alternately by RT, m/z and index. Every node stores
+      the ranges of these three values for the features below it, so searches
+      can be restricted to positions and to ranges of indices at the same time.
+    */
+    class FeatureTree
+    {
+public:
+      struct Node
+      {
+        /// Range of the node's features in @p order
+        Size begin, end;
+        /// Position of the first child node (the second one follows), zero for leaves
+        Size child;
+        /// Ranges of the node's features
+        double rt_min, rt_max, mz_min, mz_max;
+        Size index_min, index_max;
+      };
+
+      explicit FeatureTree(const ConsensusMap& map) :
+        map_(map), order(map.size()), nodes()
+      {
+        for (Size i = 0; i < order.size(); ++i)
+        {
+          order[i] = i;
+        }
+        if (!order.empty())
+        {
+          nodes.push_back(Node());
+          build_(0, 0, order.size(), 0);
+        }
+      }
+
+      /// Feature indices, grouped by node
+      std::vector<Size> order;
+
+      /// Tree nodes, the root is the first element
+      std::vector<Node> nodes;
+
+private:
+      /// Maximum number of features in a leaf
+      static const Size leaf_size_ = 16;
+
+      /// Orders feature indices by RT, m/z or index
+      struct CoordinateLess
+      {
+        CoordinateLess(const ConsensusMap& map, Size dimension) :
+          map_(map), dimension_(dimension)
+        {
+        }
+
+        bool operator()(Size a, Size b) const
+        {
+          if (dimension_ == 0) return map_[a].getRT() < map_[b].getRT();
+          if (dimension_ == 1) return map_[a].getMZ() < map_[b].getMZ();
+          return a < b;
+        }
+
+        const ConsensusMap& map_;
+        Size dimension_;
+      };
+
+      void build_(Size node, Size begin, Size end, Size depth)
+      {
+        Node& current = nodes[node];
+        current.begin = begin;
+        current.end = end;
+        current.child = 0;
+        current.rt_min = current.mz_min = numeric_limits<double>::max();
+        current.rt_max = current.mz_max = -numeric_limits<double>::max();
+        current.index_min = numeric_limits<Size>::max();
+        current.index_max = 0;
+        for (Size i = begin; i < end; ++i)
+        {
+          const ConsensusFeature& feature = map_[order[i]];
+          current.rt_min = min(current.rt_min, feature.getRT());
+          current.rt_max = max(current.rt_max, feature.getRT());
+          current.mz_min = min(current.mz_min, feature.getMZ());
+          current.mz_max = max(current.mz_max, feature.getMZ());
+          current.index_min = min(current.index_min, order[i]);
+          current.index_max = max(current.index_max, order[i]);
+        }
+        if (end - begin <= leaf_size_)
+        {
+          return;
+        }
+
+        Size middle = begin + (end - begin) / 2;
+        nth_element(order.begin() + begin, order.begin() + middle,
+                    order.begin() + end, CoordinateLess(map_, depth % 3));
+        Size child = nodes.size();
+        current.child = child; // "current" is invalidated by the resize below
+        nodes.resize(child + 2);
+        build_(child, begin, middle, depth + 1);
+        build_(child + 1, middle, end, depth + 1);
+      }
+
+      const ConsensusMap& map_;
+    };
+
+    /**
+      @brief Finds the nearest and second-nearest neighbors of features among the features of another map
+
+      The result is the same as if all features of the other map were visited
+      in index order, updating the neighbors like this: a distance smaller
+      than the second-nearest one replaces the nearest distance (which becomes
+      the second-nearest one) if the pair is valid and closer than the nearest
+      neighbor; otherwise it replaces the second-nearest distance.
+
+      Only valid pairs can change the nearest neighbor, and they are all
+      within the maximum RT and m/z differences. In between two of them, the
+      second-nearest distance becomes the minimum of its value and the
+      distances of all (invalid) pairs in that range of indices. These minima
+      are computed by a branch-and-bound search, using
+      FeatureDistance::lowerBound() to skip parts of the map that cannot
+      contain a smaller distance. Only features compatible according to
+      @p annotations are considered.
+    */
+    class NeighborSearch
+    {
+public:
+      /**
+        @brief Constructor
+
+        @param map Map to search in
+        @param tree Tree of the features in @p map
+        @param annotations Peptide annotations of @p map (null if peptide IDs are not used)
+        @param map_is_left Are the features of @p map the left arguments of the distance functor?
+        @param max_diff_rt Maximum RT difference of valid pairs
+        @param max_diff_mz Maximum m/z difference of valid pairs
+        @param max_diff_ppm Is @p max_diff_mz given in ppm?
+      */
+      NeighborSearch(const ConsensusMap& map, const FeatureTree& tree,
+                     const PeptideAnnotations* annotations, bool map_is_left,
+                     double max_diff_rt, double max_diff_mz, bool max_diff_ppm) :
+        map_(map), tree_(tree), annotations_(annotations),
+        map_is_left_(map_is_left), max_diff_rt_(max_diff_rt),
+        max_diff_mz_(max_diff_mz), max_diff_ppm_(max_diff_ppm), query_(0),
+        query_index_(0), query_annotations_(0), distance_(0)
+      {
+      }
+
+      /// Updates @p nn_distance and @p nn_index with the neighbors of @p query (at @p query_index in its map)
+      void find(const ConsensusFeature& query, Size query_index,
+                const PeptideAnnotations* query_annotations,
+                FeatureDistance& distance, pair<double, double>& nn_distance,
+                UInt& nn_index)
+      {
+        if (tree_.nodes.empty())
+        {
+          return;
+        }
+        query_ = &query;
+        query_index_ = query_index;
+        query_annotations_ = query_annotations;
+        distance_ = &distance;
+
+        // candidates for valid pairs:
+        double window_mz = max_diff_mz_;
+        if (max_diff_ppm_) // same computation as in FeatureDistance
+        {
+          window_mz *= (map_is_left_ ? tree_.nodes[0].mz_max : query.getMZ()) * 1e-6;
+        }
+        vector<Size> window;
+        collectWindow_(0, window_mz, window);
+        sort(window.begin(), window.end());
+
+        Size next = 0; // first index not accounted for yet
+        for (vector<Size>::iterator it = window.begin(); it != window.end(); ++it)
+        {
+          if (!compatible_(*it))
+          {
+            continue;
+          }
+          pair<bool, double> result = distance_to_(*it);
+          if (!result.first)
+          {
+            continue; // covered by the minimum below
+          }
+          nn_distance.second = minimum_(0, next, *it, nn_distance.second);
+          if (result.second < nn_distance.second)
+          {
+            if (result.second < nn_distance.first)
+            {
+              nn_distance.second = nn_distance.first;
+              nn_distance.first = result.second;
+              nn_index = UInt(*it);
+            }
+            else
+            {
+              nn_distance.second = result.second;
+            }
+          }
+          next = *it + 1;
+        }
+        nn_distance.second = minimum_(0, next, map_.size(), nn_distance.second);
+      }
+
+private:
+      /// Distance between the query and the feature at @p index
+      pair<bool, double> distance_to_(Size index)
+      {
+        if (map_is_left_)
+        {
+          return (*distance_)(map_[index], *query_);
+        }
+        return (*distance_)(*query_, map_[index]);
+      }
+
+      bool compatible_(Size index) const
+      {
+        return !annotations_ ||
+               query_annotations_->compatible(query_index_, *annotations_, index);
+      }
+
+      /// Minimum differences in RT and m/z between the query and the features of @p node
+      void gaps_(const FeatureTree::Node& node, double& gap_rt, double& gap_mz) const
+      {
+        double rt = query_->getRT(), mz = query_->getMZ();
+        gap_rt = (rt < node.rt_min) ? node.rt_min - rt : ((rt > node.rt_max) ? rt - node.rt_max : 0.0);
+        gap_mz = (mz < node.mz_min) ? node.mz_min - mz : ((mz > node.mz_max) ? mz - node.mz_max : 0.0);
+      }
+
+      /// Collects the indices of all features within the RT and m/z window around the query
+      void collectWindow_(Size node, double window_mz, vector<Size>& indices) const
+      {
+        const FeatureTree::Node& current = tree_.nodes[node];
+        double gap_rt, gap_mz;
+        gaps_(current, gap_rt, gap_mz);
+        if ((gap_rt > max_diff_rt_) || (gap_mz > window_mz))
+        {
+          return;
+        }
+        if (current.child == 0)
+        {
+          for (Size i = current.begin; i < current.end; ++i)
+          {
+            Size index = tree_.order[i];
+            if ((fabs(map_[index].getRT() - query_->getRT()) <= max_diff_rt_) &&
+                (fabs(map_[index].getMZ() - query_->getMZ()) <= window_mz))
+            {
+              indices.push_back(index);
+            }
+          }
+          return;
+        }
+        collectWindow_(current.child, window_mz, indices);
+        collectWindow_(current.child + 1, window_mz, indices);
+      }
+
+      /// Lower bound for the distances between the query and the features of @p node
+      double lowerBound_(const FeatureTree::Node& node) const
+      {
+        double gap_rt, gap_mz;
+        gaps_(node, gap_rt, gap_mz);
+        // for ppm tolerances, the largest m/z of the left feature gives the smallest bound:
+        return distance_->lowerBound(gap_rt, gap_mz,
+                                     map_is_left_ ? node.mz_max : query_->getMZ());
+      }
+
+      /// Returns the minimum of @p bound and the distances to the features with indices in [@p first, @p last)
+      double minimum_(Size node, Size first, Size last, double bound)
+      {
+        const FeatureTree::Node& current = tree_.nodes[node];
+        if ((first >= last) || (current.index_max < first) ||
+            (current.index_min >= last) || (lowerBound_(current) >= bound))
+        {
+          return bound;
+        }
+        if (current.child == 0)
+        {
+          for (Size i = current.begin; i < current.end; ++i)
+          {
+            Size index = tree_.order[i];
+            if ((index >= first) && (index < last) && compatible_(index))
+            {
+              bound = min(bound, distance_to_(index).second);
+            }
+          }
+          return bound;
+        }
+        // search the more promising child first, to prune more of the other one:
+        Size child = current.child, other = current.child + 1;
+        if (lowerBound_(tree_.nodes[other]) < lowerBound_(tree_.nodes[child]))
+        {
+          swap(child, other);
+        }
+        bound = minimum_(child, first, last, bound);
+        return minimum_(other, first, last, bound);
+      }
+
+      const ConsensusMap& map_;
+      const FeatureTree& tree_;
+      const PeptideAnnotations* annotations_;
+      bool map_is_left_;
+      double max_diff_rt_, max_diff_mz_;
+      bool max_diff_ppm_;
+
+      const ConsensusFeature* query_;
+      Size query_index_;
+      const PeptideAnnotations* query_annotations_;
+      FeatureDistance* distance_;
+    };
+  }
+
   StablePairFinder::StablePairFinder() :
     Base()
   {
@@ -122,59 +451,61 @@ namespace OpenMS
     // - distances to nearest and second-nearest neighbors in map 0:
     vector<DoublePair> nn_distance_1(input_maps[1].size(), init);
 
-    // iterate over all feature pairs, find nearest neighbors:
-    // TODO: iterate over SENSIBLE RT (and m/z) window -- sort the maps beforehand
-    //       to save a lot of processing time...
-    //       Once done, remove the warning in the description of the 'use_identifications' parameter
-    for (UInt fi0 = 0; fi0 < input_maps[0].size(); ++fi0)
+    // find nearest and second-nearest neighbors; conceptually, all pairs of
+    // features are compared (see NeighborSearch for the details):
+    PeptideAnnotations annotations[2];
+    if (use_IDs_)
     {
-      const ConsensusFeature& feat0 = input_maps[0][fi0];
-
-      for (UInt fi1 = 0; fi1 < input_maps[1].size(); ++fi1)
+      for (UInt input = 0; input <= 1; ++input)
       {
-        const ConsensusFeature& feat1 = input_maps[1][fi1];
-
-        if (use_IDs_ && !compatibleIDs_(feat0, feat1)) // check peptide IDs
+        annotations[input].annotated.resize(input_maps[input].size());
+        annotations[input].best_hits.resize(input_maps[input].size());
+        for (Size index = 0; index < input_maps[input].size(); ++index)
         {
-          continue; // mismatch
+          const ConsensusFeature& feature = input_maps[input][index];
+          annotations[input].annotated[index] = !feature.getPeptideIdentifications().empty();
+          collectBestHitSequences_(feature, annotations[input].best_hits[index]);
         }
+      }
+    }
+    const PeptideAnnotations* annotations_0 = use_IDs_ ? &annotations[0] : 0;
+    const PeptideAnnotations* annotations_1 = use_IDs_ ? &annotations[1] : 0;
 
-        pair<bool, double> result = feature_distance(feat0, feat1);
-        double distance = result.second;
-        // we only care if distance constraints are satisfied for "best
-        // matches", not for second-best; this means that second-best distances
-        // can become smaller than best distances
-        // (e.g. the RT is larger than allowed (->invalid pair), but m/z is perfect and has the most weight --> better score!)
-        bool valid = result.first;
+    FeatureTree tree_0(input_maps[0]), tree_1(input_maps[1]);
+    double max_diff_rt = param_.getValue("distance_RT:max_difference");
+    double max_diff_mz = param_.getValue("distance_MZ:max_difference");
+    bool max_diff_ppm = (param_.getValue("distance_MZ:unit") == "ppm");
 
-        // update entries for map 0:
-        if (distance < nn_distance_0[fi0].second)
-        {
-          if (valid && (distance < nn_distance_0[fi0].first))
-          {
-            nn_distance_0[fi0].second = nn_distance_0[fi0].first;
-            nn_distance_0[fi0].first = distance;
-            nn_index_0[fi0] = fi1;
-          }
-          else
-          {
-            nn_distance_0[fi0].second = distance;
-          }
-        }
-        // update entries for map 1:
-        if (distance < nn_distance_1[fi1].second)
-        {
-          if (valid && (distance < nn_distance_1[fi1].first))
-          {
-            nn_distance_1[fi1].second = nn_distance_1[fi1].first;
-            nn_distance_1[fi1].first = distance;
-            nn_index_1[fi1] = fi0;
-          }
-          else
-          {
-            nn_distance_1[fi1].second = distance;
-          }
-        }
+    // the neighbors of different features are independent of each other:
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // computing distances may modify the state of the functor
+      FeatureDistance distance(feature_distance);
+
+      // neighbors in map 1 of the features in map 0:
+      NeighborSearch search_1(input_maps[1], tree_1, annotations_1, false,
+                              max_diff_rt, max_diff_mz, max_diff_ppm);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize fi0 = 0; fi0 < (SignedSize)input_maps[0].size(); ++fi0)
+      {
+        search_1.find(input_maps[0][fi0], fi0, annotations_0, distance,
+                      nn_distance_0[fi0], nn_index_0[fi0]);
+      }
+
+      // neighbors in map 0 of the features in map 1:
+      NeighborSearch search_0(input_maps[0], tree_0, annotations_0, true,
+                              max_diff_rt, max_diff_mz, max_diff_ppm);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 100)
+#endif
+      for (SignedSize fi1 = 0; fi1 < (SignedSize)input_maps[1].size(); ++fi1)
+      {
+        search_0.find(input_maps[1][fi1], fi1, annotations_1, distance,
+                      nn_distance_1[fi1], nn_index_1[fi1]);
       }
     }
 
@@ -264,25 +595,22 @@ namespace OpenMS
     if (feat1.getPeptideIdentifications().empty() || feat2.getPeptideIdentifications().empty())
       return true;
 
-    const vector<PeptideIdentification>& pep1 = feat1.getPeptideIdentifications();
-    const vector<PeptideIdentification>& pep2 = feat2.getPeptideIdentifications();
-
     set<String> best1, best2;
-    for (vector<PeptideIdentification>::const_iterator pep_it = pep1.begin(); pep_it != pep1.end(); ++pep_it)
-    {
-      if (pep_it->getHits().empty())
-        continue; // shouldn't be the case
+    collectBestHitSequences_(feat1, best1);
+    collectBestHitSequences_(feat2, best2);
+    return best1 == best2;
+  }
 
-      best1.insert(getBestHitSequence_(*pep_it).toString());
-    }
-    for (vector<PeptideIdentification>::const_iterator pep_it = pep2.begin(); pep_it != pep2.end(); ++pep_it)
+  void StablePairFinder::collectBestHitSequences_(const ConsensusFeature& feature, set<String>& sequences) const
+  {
+    const vector<PeptideIdentification>& peptides = feature.getPeptideIdentifications();
+    for (vector<PeptideIdentification>::const_iterator pep_it = peptides.begin(); pep_it != peptides.end(); ++pep_it)
     {
       if (pep_it->getHits().empty())
         continue; // shouldn't be the case
 
-      best2.insert(getBestHitSequence_(*pep_it).toString());
+      sequences.insert(getBestHitSequence_(*pep_it).toString());
     }
-    return best1 == best2;
   }
 
   const AASequence& StablePairFinder::getBestHitSequence_(const PeptideIdentification& peptideIdentification) const
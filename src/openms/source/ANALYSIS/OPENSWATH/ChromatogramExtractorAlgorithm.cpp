@@ -38,9 +38,193 @@
 
 #include <OpenMS/CONCEPT/Exception.h>
 
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /**
+      @brief Sums data[begin, end) using four independent scalar partial sums
+
+      This is not explicitly vectorized, it only breaks up the dependency
+      chain of a single accumulator so that consecutive additions can be
+      executed in parallel by the CPU. The result may differ from a strictly
+      sequential sum in the last bits.
+    */
+    inline double sumRange(const double* data, Size begin, Size end)
+    {
+      double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+      Size i = begin;
+      for (; i + 4 <= end; i += 4)
+      {
+        s0 += data[i];
+        s1 += data[i + 1];
+        s2 += data[i + 2];
+        s3 += data[i + 3];
+      }
+      for (; i < end; ++i)
+      {
+        s0 += data[i];
+      }
+      return (s0 + s1) + (s2 + s3);
+    }
+
+    /// Extraction windows and RT ranges of all coordinates (sorted by m/z)
+    struct ExtractionWindows
+    {
+      std::vector<double> mz;
+      std::vector<double> left;
+      std::vector<double> right;
+      std::vector<double> rt_start;
+      std::vector<double> rt_end;
+    };
+
+    /// Returns the number of values in the sorted range @p sorted with start <= value <= end
+    inline Size countInRange(const std::vector<double>& sorted, double start, double end)
+    {
+      return std::upper_bound(sorted.begin(), sorted.end(), end) -
+             std::lower_bound(sorted.begin(), sorted.end(), start);
+    }
+
+    /// Appends extracted points directly to the output chromatograms
+    struct OutputSink
+    {
+      std::vector<std::vector<double>*>& rt;
+      std::vector<std::vector<double>*>& intensity;
+
+      OutputSink(std::vector<std::vector<double>*>& rt_, std::vector<std::vector<double>*>& intensity_) :
+        rt(rt_),
+        intensity(intensity_)
+      {
+      }
+
+      void operator()(Size k, double current_rt, double integrated_intensity)
+      {
+        rt[k]->push_back(current_rt);
+        intensity[k]->push_back(integrated_intensity);
+      }
+    };
+
+    /// Writes extracted points of a block of spectra into its reserved slots of the (preallocated) output chromatograms
+    struct SlotSink
+    {
+      std::vector<std::vector<double>*>& rt;
+      std::vector<std::vector<double>*>& intensity;
+      std::vector<UInt>& next_slot;
+
+      SlotSink(std::vector<std::vector<double>*>& rt_, std::vector<std::vector<double>*>& intensity_, std::vector<UInt>& next_slot_) :
+        rt(rt_),
+        intensity(intensity_),
+        next_slot(next_slot_)
+      {
+      }
+
+      void operator()(Size k, double current_rt, double integrated_intensity)
+      {
+        const UInt idx = next_slot[k]++;
+        (*rt[k])[idx] = current_rt;
+        (*intensity[k])[idx] = integrated_intensity;
+      }
+    };
+
+    /// Discards extracted points
+    struct NullSink
+    {
+      void operator()(Size, double, double)
+      {
+      }
+    };
+
+    /**
+      @brief Extracts all coordinates from a single spectrum in one merge pass
+
+      Coordinates and peaks are both sorted by m/z. For the current window we
+      keep track of the first peak > left (lo), the first peak >= mz (pos)
+      and the first peak >= right (hi); all three only move forward (the
+      loops moving backwards only guard against rounding in the window
+      computation).
+    */
+    template <typename SinkT>
+    void extractSpectrum(const OpenSwath::SpectrumPtr& sptr, double current_rt,
+                         const ExtractionWindows& windows, SinkT& sink)
+    {
+      const std::vector<double>& mz_data = sptr->getMZArray()->data;
+      const std::vector<double>& int_data = sptr->getIntensityArray()->data;
+      const Size nr_peaks = mz_data.size();
+
+      if (nr_peaks == 0)
+        return;
+
+      const Size nr_coordinates = windows.mz.size();
+      Size lo = 0, pos = 0, hi = 0;
+      for (Size k = 0; k < nr_coordinates; ++k)
+      {
+        if (current_rt < windows.rt_start[k] || current_rt > windows.rt_end[k])
+        {
+          continue;
+        }
+
+        const double left = windows.left[k];
+        const double right = windows.right[k];
+        const double mz = windows.mz[k];
+        while (lo < nr_peaks && mz_data[lo] <= left) ++lo;
+        while (lo > 0 && mz_data[lo - 1] > left) --lo;
+        while (pos < nr_peaks && mz_data[pos] < mz) ++pos;
+        while (pos > 0 && mz_data[pos - 1] >= mz) --pos;
+        while (hi < nr_peaks && mz_data[hi] < right) ++hi;
+        while (hi > 0 && mz_data[hi - 1] >= right) --hi;
+
+        // sum up all peaks with left < m/z < right. To keep the results
+        // identical to extract_value_tophat, the first peak is only used if
+        // it is the first peak >= mz and the last peak is counted twice if
+        // all peaks are below mz.
+        double integrated_intensity = 0;
+        if (lo < hi)
+        {
+          const Size begin = (pos > 0 && lo == 0) ? 1 : lo;
+          integrated_intensity = sumRange(&int_data[0], begin, hi);
+          if (pos == nr_peaks && hi == nr_peaks)
+          {
+            integrated_intensity += int_data[nr_peaks - 1];
+          }
+        }
+        sink(k, current_rt, integrated_intensity);
+      }
+    }
+
+    /// Restores the output arrays to the sizes they had before the extraction (after an error)
+    void restoreOutput(const std::vector<std::vector<double>*>& out_rt, const std::vector<std::vector<double>*>& out_int,
+                       const std::vector<Size>& out_start)
+    {
+      for (Size k = 0; k < out_start.size(); ++k)
+      {
+        out_rt[k]->resize(out_start[k]);
+        out_int[k]->resize(out_start[k]);
+      }
+    }
+  }
+
+  void ChromatogramExtractorAlgorithm::getExtractionWindow_(double mz, double mz_extraction_window, bool ppm, double& left, double& right)
+  {
+    if (ppm)
+    {
+      left  = mz - mz * mz_extraction_window / 2.0 * 1.0e-6;
+      right = mz + mz * mz_extraction_window / 2.0 * 1.0e-6;
+    }
+    else
+    {
+      left  = mz - mz_extraction_window / 2.0;
+      right = mz + mz_extraction_window / 2.0;
+    }
+  }
+
   void ChromatogramExtractorAlgorithm::extract_value_tophat(
       const std::vector<double>::const_iterator& mz_start, 
             std::vector<double>::const_iterator& mz_it,
@@ -56,16 +240,7 @@ namespace OpenMS
 
     // calculate extraction window
     double left, right;
-    if (ppm)
-    {
-      left  = mz - mz * mz_extraction_window / 2.0 * 1.0e-6;
-      right = mz + mz * mz_extraction_window / 2.0 * 1.0e-6;
-    }
-    else
-    {
-      left  = mz - mz_extraction_window / 2.0;
-      right = mz + mz_extraction_window / 2.0;
-    }
+    getExtractionWindow_(mz, mz_extraction_window, ppm, left, right);
 
     std::vector<double>::const_iterator mz_walker;
     std::vector<double>::const_iterator int_walker;
@@ -149,55 +324,211 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
-    //go through all spectra
-    startProgress(0, input_size, "Extracting chromatograms");
+    if (used_filter == 2)
+    {
+      throw Exception::NotImplemented(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+    }
+
+    // the RT of all spectra (in spectrum order and sorted) to compute the size of each chromatogram
+    std::vector<double> scan_rt(input_size);
     for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
     {
-      setProgress(scan_idx);
+      scan_rt[scan_idx] = input->getSpectrumMetaById(scan_idx).RT;
+    }
+    std::vector<double> spectra_rt(scan_rt);
+    std::sort(spectra_rt.begin(), spectra_rt.end());
+
+    // compute the extraction windows and RT ranges once (the windows are
+    // sorted by m/z as well) and reserve space in the output
+    const Size nr_coordinates = extraction_coordinates.size();
+    ExtractionWindows windows;
+    windows.mz.resize(nr_coordinates);
+    windows.left.resize(nr_coordinates);
+    windows.right.resize(nr_coordinates);
+    windows.rt_start.resize(nr_coordinates);
+    windows.rt_end.resize(nr_coordinates);
+    std::vector<std::vector<double>*> out_rt(nr_coordinates), out_int(nr_coordinates);
+    std::vector<Size> out_start(nr_coordinates);
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      windows.mz[k] = extraction_coordinates[k].mz;
+      getExtractionWindow_(windows.mz[k], mz_extraction_window, ppm, windows.left[k], windows.right[k]);
+      if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0)
+      {
+        windows.rt_start[k] = extraction_coordinates[k].rt_start;
+        windows.rt_end[k] = extraction_coordinates[k].rt_end;
+      }
+      else
+      {
+        // extract the whole chromatogram
+        windows.rt_start[k] = -std::numeric_limits<double>::max();
+        windows.rt_end[k] = std::numeric_limits<double>::max();
+      }
+
+      const Size expected_size = countInRange(spectra_rt, windows.rt_start[k], windows.rt_end[k]);
+      // Time is first, intensity is second
+      out_rt[k] = &output[k]->binaryDataArrayPtrs[0]->data;
+      out_int[k] = &output[k]->binaryDataArrayPtrs[1]->data;
+      out_start[k] = out_rt[k]->size();
+      out_rt[k]->reserve(out_rt[k]->size() + expected_size);
+      out_int[k]->reserve(out_int[k]->size() + expected_size);
+    }
+
+#ifdef _OPENMP
+    // Split the spectra into contiguous blocks which are extracted in
+    // parallel, unless we are already inside a parallel region (e.g. when the
+    // caller processes several SWATH windows at once). Each block writes its
+    // points directly into the output: every block reserves one slot per
+    // spectrum within the RT range of a coordinate (known from the spectrum
+    // meta data) and the slots left unused by spectra without peaks are
+    // removed afterwards. The result is identical to the serial extraction
+    // and, apart from the slot counters, no intermediate buffer is needed.
+    const Size nr_threads = omp_get_max_threads();
+    if (!omp_in_parallel() && nr_threads > 1 && input_size >= 2 * nr_threads)
+    {
+      const Size nr_blocks = std::min(input_size, 4 * nr_threads);
 
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
-      OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
+      // sorted RTs of the spectra of each block
+      std::vector<std::vector<double> > block_rt(nr_blocks);
+      for (Size block = 0; block < nr_blocks; ++block)
+      {
+        block_rt[block].assign(scan_rt.begin() + input_size * block / nr_blocks,
+                               scan_rt.begin() + input_size * (block + 1) / nr_blocks);
+        std::sort(block_rt[block].begin(), block_rt[block].end());
+      }
 
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
+      // reserve the slots: next_slot[block][k] is the next free slot of the
+      // block in chromatogram k
+      std::vector<std::vector<UInt> > next_slot(nr_blocks, std::vector<UInt>(nr_coordinates, 0));
+#pragma omp parallel for
+      for (SignedSize k = 0; k < (SignedSize)nr_coordinates; ++k)
+      {
+        Size offset = out_start[k];
+        for (Size block = 0; block < nr_blocks; ++block)
+        {
+          next_slot[block][k] = offset;
+          offset += countInRange(block_rt[block], windows.rt_start[k], windows.rt_end[k]);
+        }
+        out_rt[k]->resize(offset);
+        out_int[k]->resize(offset);
+      }
 
-      if (sptr->getMZArray()->data.size() == 0)
-        continue;
+      SignedSize failed_block = -1;
+      String error_message;
+      Size blocks_done = 0;
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
+      startProgress(0, nr_blocks, "Extracting chromatograms");
+#pragma omp parallel
       {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
-        if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 && 
-             (current_rt < extraction_coordinates[k].rt_start || 
-              current_rt > extraction_coordinates[k].rt_end) )
+        // each thread needs its own (light) copy of the spectrum access
+        OpenSwath::SpectrumAccessPtr thread_input;
+#pragma omp critical (ChromatogramExtractorAlgorithm_clone)
+        thread_input = input->lightClone();
+
+#pragma omp for schedule(dynamic, 1)
+        for (SignedSize block = 0; block < (SignedSize)nr_blocks; ++block)
         {
-          continue;
+          try
+          {
+            const Size first = input_size * block / nr_blocks;
+            const Size last = input_size * (block + 1) / nr_blocks;
+            SlotSink sink(out_rt, out_int, next_slot[block]);
+            for (Size scan_idx = first; scan_idx < last; ++scan_idx)
+            {
+              extractSpectrum(thread_input->getSpectrumById(scan_idx), scan_rt[scan_idx], windows, sink);
+            }
+          }
+          catch (std::exception& e)
+          {
+#pragma omp critical (ChromatogramExtractorAlgorithm_error)
+            {
+              if (failed_block < 0 || block < failed_block)
+              {
+                failed_block = block;
+                error_message = e.what();
+              }
+            }
+          }
+          catch (...)
+          {
+#pragma omp critical (ChromatogramExtractorAlgorithm_error)
+            {
+              if (failed_block < 0 || block < failed_block)
+              {
+                failed_block = block;
+                error_message = "Unknown exception during chromatogram extraction";
+              }
+            }
+          }
+
+#pragma omp critical (ChromatogramExtractorAlgorithm_progress)
+          setProgress(++blocks_done);
         }
+      }
+      endProgress();
 
-        if (used_filter == 1)
+      if (failed_block >= 0)
+      {
+        // Exceptions cannot leave the parallel region. The output is restored
+        // to its state before the call and the extraction of the first failed
+        // block is repeated here, so the exception propagates with its
+        // original type. Only if the error cannot be reproduced, the recorded
+        // message is thrown.
+        restoreOutput(out_rt, out_int, out_start);
+        NullSink null_sink;
+        const Size first = input_size * failed_block / nr_blocks;
+        const Size last = input_size * (failed_block + 1) / nr_blocks;
+        for (Size scan_idx = first; scan_idx < last; ++scan_idx)
         {
-          extract_value_tophat( mz_start, mz_it, mz_end, int_it,
-                  extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+          extractSpectrum(input->getSpectrumById(scan_idx), scan_rt[scan_idx], windows, null_sink);
         }
-        else if (used_filter == 2)
+        throw Exception::BaseException(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Exception", error_message);
+      }
+
+      // remove the unused slots (the slots of a block end where the slots of
+      // the next block begin)
+#pragma omp parallel for
+      for (SignedSize k = 0; k < (SignedSize)nr_coordinates; ++k)
+      {
+        std::vector<double>& rt = *out_rt[k];
+        std::vector<double>& intensity = *out_int[k];
+        Size slot = out_start[k];
+        Size write = out_start[k];
+        for (Size block = 0; block < nr_blocks; ++block)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+          const Size used = next_slot[block][k] - slot;
+          if (write != slot)
+          {
+            std::copy(rt.begin() + slot, rt.begin() + slot + used, rt.begin() + write);
+            std::copy(intensity.begin() + slot, intensity.begin() + slot + used, intensity.begin() + write);
+          }
+          write += used;
+          slot += countInRange(block_rt[block], windows.rt_start[k], windows.rt_end[k]);
         }
+        rt.resize(write);
+        intensity.resize(write);
+      }
+      return;
+    }
+#endif
 
-        // Time is first, intensity is second
-        output[k]->binaryDataArrayPtrs[0]->data.push_back(current_rt);
-        output[k]->binaryDataArrayPtrs[1]->data.push_back(integrated_intensity);
+    //go through all spectra
+    OutputSink sink(out_rt, out_int);
+    startProgress(0, input_size, "Extracting chromatograms");
+    try
+    {
+      for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
+      {
+        setProgress(scan_idx);
+        extractSpectrum(input->getSpectrumById(scan_idx), scan_rt[scan_idx], windows, sink);
       }
     }
+    catch (...)
+    {
+      // leave the output as it was before the call (as the parallel extraction)
+      restoreOutput(out_rt, out_int, out_start);
+      throw;
+    }
     endProgress();
   }
 
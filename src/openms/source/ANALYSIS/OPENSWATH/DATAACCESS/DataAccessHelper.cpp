@@ -68,6 +68,26 @@ namespace OpenMS
     return sptr;
   }
 
+  void OpenSwathDataAccessHelper::swapToColumnarSpectrum(OpenSwath::SpectrumPtr sptr, ColumnarSpectrum<> & spectrum)
+  {
+    spectrum.swapMZArray(sptr->getMZArray()->data);
+    spectrum.swapIntensityArray(sptr->getIntensityArray()->data);
+  }
+
+  OpenSwath::SpectrumPtr OpenSwathDataAccessHelper::swapToSpectrumPtr(ColumnarSpectrum<> & spectrum)
+  {
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    spectrum.swapMZArray(mz_array->data);
+    spectrum.swapIntensityArray(intensity_array->data);
+    spectrum.clear();
+
+    OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
+    sptr->setMZArray(mz_array);
+    sptr->setIntensityArray(intensity_array);
+    return sptr;
+  }
+
   void OpenSwathDataAccessHelper::convertToOpenMSChromatogram(OpenMS::MSChromatogram<> & chromatogram, const OpenSwath::ChromatogramPtr cptr)
   {
     OpenSwath::BinaryDataArrayPtr rt_arr = cptr->getTimeArray();
@@ -36,10 +36,22 @@
 
 #include <OpenMS/FORMAT/CachedMzML.h>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+
 namespace OpenMS
 {
 
-  SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(String filename)
+  SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(String filename) :
+    meta_ms_experiment_(new MSExperimentType),
+    mapped_data_(NULL),
+    mapped_size_(0),
+    spectra_index_(new std::vector<std::streampos>),
+    chrom_index_(new std::vector<std::streampos>),
+    spectra_rt_(new std::vector<double>),
+    spectra_ms_level_(new std::vector<int>)
   {
     filename_cached_ = filename + ".cached";
     filename_ = filename;
@@ -47,27 +59,53 @@ namespace OpenMS
     // Create the index from the given file
     CachedmzML cache;
     cache.createMemdumpIndex(filename_cached_);
-    spectra_index_ = cache.getSpectraIndex();
-    chrom_index_ = cache.getChromatogramIndex();;
+    *spectra_index_ = cache.getSpectraIndex();
+    *chrom_index_ = cache.getChromatogramIndex();
+
+    // the retention times are stored in the index of the cached file
+    spectra_rt_->reserve(cache.getSpectraIndexEntries().size());
+    spectra_ms_level_->reserve(cache.getSpectraIndexEntries().size());
+    for (Size i = 0; i < cache.getSpectraIndexEntries().size(); ++i)
+    {
+      spectra_rt_->push_back(cache.getSpectraIndexEntries()[i].rt);
+      spectra_ms_level_->push_back(cache.getSpectraIndexEntries()[i].ms_level);
+    }
 
-    // open the filestream
-    ifs_.open(filename_cached_.c_str(), std::ios::binary);
+    // map the whole file read-only into memory (the mapping stays valid
+    // after the file_mapping object is destroyed)
+    try
+    {
+      boost::interprocess::file_mapping mapping(filename_cached_.c_str(), boost::interprocess::read_only);
+      mapped_region_ = boost::shared_ptr<boost::interprocess::mapped_region>(
+          new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only));
+    }
+    catch (boost::interprocess::interprocess_exception& e)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        String("Could not map cached file into memory: ") + e.what(), filename_cached_);
+    }
+    mapped_data_ = static_cast<const char*>(mapped_region_->get_address());
+    mapped_size_ = mapped_region_->get_size();
 
     // load the meta data from disk
-    MzMLFile().load(filename, meta_ms_experiment_);
+    MzMLFile().load(filename, *meta_ms_experiment_);
   }
 
   SpectrumAccessOpenMSCached::~SpectrumAccessOpenMSCached()
   {
-    ifs_.close();
   }
 
   SpectrumAccessOpenMSCached::SpectrumAccessOpenMSCached(const SpectrumAccessOpenMSCached & rhs) :
     meta_ms_experiment_(rhs.meta_ms_experiment_),
-    ifs_(rhs.filename_cached_.c_str(), std::ios::binary),
+    mapped_region_(rhs.mapped_region_),
+    mapped_data_(rhs.mapped_data_),
+    mapped_size_(rhs.mapped_size_),
     filename_(rhs.filename_),
+    filename_cached_(rhs.filename_cached_),
     spectra_index_(rhs.spectra_index_),
-    chrom_index_(rhs.chrom_index_)
+    chrom_index_(rhs.chrom_index_),
+    spectra_rt_(rhs.spectra_rt_),
+    spectra_ms_level_(rhs.spectra_ms_level_)
   {
   }
 
@@ -86,15 +124,8 @@ namespace OpenMS
     int ms_level = -1;
     double rt = -1.0;
 
-    if ( !ifs_.seekg(spectra_index_[id]) )
-    {
-      std::cerr << "Error while reading spectrum " << id << " - seekg created an error when trying to change position to " << spectra_index_[id] << "." << std::endl;
-      std::cerr << "Maybe an invalid position was supplied to seekg, this can happen for example when reading large files (>2GB) on 32bit systems." << std::endl;
-      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
-        "Error while changing position of input stream pointer.", filename_cached_);
-    }
-
-    CachedmzML::readSpectrumFast(mz_array, intensity_array, ifs_, ms_level, rt);
+    CachedmzML::readSpectrumFast(mz_array, intensity_array, mapped_data_, mapped_size_,
+        static_cast<Size>(std::streamoff((*spectra_index_)[id])), ms_level, rt);
 
     OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum);
     sptr->setMZArray(mz_array);
@@ -108,8 +139,8 @@ namespace OpenMS
     OPENMS_PRECONDITION(id < (int)getNrSpectra(), "Id cannot be larger than number of spectra");
 
     OpenSwath::SpectrumMeta meta;
-    meta.RT = meta_ms_experiment_[id].getRT();
-    meta.ms_level = meta_ms_experiment_[id].getMSLevel();
+    meta.RT = (*spectra_rt_)[id];
+    meta.ms_level = (*spectra_ms_level_)[id];
     return meta;
   }
 
@@ -121,15 +152,8 @@ namespace OpenMS
     OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
     OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
 
-    if ( !ifs_.seekg(chrom_index_[id]) )
-    {
-      std::cerr << "Error while reading chromatogram " << id << " - seekg created an error when trying to change position to " << chrom_index_[id] << "." << std::endl;
-      std::cerr << "Maybe an invalid position was supplied to seekg, this can happen for example when reading large files (>2GB) on 32bit systems." << std::endl;
-      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
-        "Error while changing position of input stream pointer.", filename_cached_);
-    }
-
-    CachedmzML::readChromatogramFast(rt_array, intensity_array, ifs_);
+    CachedmzML::readChromatogramFast(rt_array, intensity_array, mapped_data_, mapped_size_,
+        static_cast<Size>(std::streamoff((*chrom_index_)[id])));
 
     OpenSwath::ChromatogramPtr cptr(new OpenSwath::Chromatogram);
     cptr->setTimeArray(rt_array);
@@ -141,19 +165,21 @@ namespace OpenMS
   {
     OPENMS_PRECONDITION(deltaRT >= 0, "Delta RT needs to be a positive number");
 
-    // we first perform a search for the spectrum that is past the
-    // beginning of the RT domain. Then we add this spectrum and try to add
-    // further spectra as long as they are below RT + deltaRT.
+    // we first perform a binary search in the (contiguous) RT index for the
+    // spectrum that is past the beginning of the RT domain. Then we add this
+    // spectrum and try to add further spectra as long as they are below RT +
+    // deltaRT.
     std::vector<std::size_t> result;
-    MSExperimentType::ConstIterator spectrum = meta_ms_experiment_.RTBegin(RT - deltaRT);
-    if (spectrum == meta_ms_experiment_.end()) return result;
+    const std::vector<double>& rts = *spectra_rt_;
+    std::vector<double>::const_iterator spectrum = std::lower_bound(rts.begin(), rts.end(), RT - deltaRT);
+    if (spectrum == rts.end()) return result;
 
-    result.push_back(std::distance(meta_ms_experiment_.begin(), spectrum));
+    result.push_back(std::distance(rts.begin(), spectrum));
     spectrum++;
 
-    while (spectrum != meta_ms_experiment_.end() && spectrum->getRT() < RT + deltaRT)
+    while (spectrum != rts.end() && *spectrum < RT + deltaRT)
     {
-      result.push_back(spectrum - meta_ms_experiment_.begin());
+      result.push_back(std::distance(rts.begin(), spectrum));
       spectrum++;
     }
     return result;
@@ -161,31 +187,31 @@ namespace OpenMS
 
   size_t SpectrumAccessOpenMSCached::getNrSpectra() const
   {
-    return meta_ms_experiment_.size();
+    return meta_ms_experiment_->size();
   }
 
   SpectrumSettings SpectrumAccessOpenMSCached::getSpectraMetaInfo(int id) const
   {
-    return meta_ms_experiment_[id];
+    return (*meta_ms_experiment_)[id];
   }
 
   size_t SpectrumAccessOpenMSCached::getNrChromatograms() const
   {
-    return meta_ms_experiment_.getChromatograms().size();
+    return meta_ms_experiment_->getChromatograms().size();
   }
 
   ChromatogramSettings SpectrumAccessOpenMSCached::getChromatogramMetaInfo(int id) const
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
     OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of spectra");
-    return meta_ms_experiment_.getChromatograms()[id];
+    return meta_ms_experiment_->getChromatograms()[id];
   }
 
   std::string SpectrumAccessOpenMSCached::getChromatogramNativeID(int id) const
   {
     OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
     OPENMS_PRECONDITION(id < (int)getNrChromatograms(), "Id cannot be larger than number of spectra");
-    return meta_ms_experiment_.getChromatograms()[id].getNativeID();
+    return meta_ms_experiment_->getChromatograms()[id].getNativeID();
   }
 
 } //end namespace OpenMS
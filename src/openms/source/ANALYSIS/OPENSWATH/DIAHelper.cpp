@@ -36,7 +36,7 @@
 #include <utility>
 #include <boost/bind.hpp>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
-#include <OpenMS/CHEMISTRY/IsotopeDistribution.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
 
@@ -101,18 +101,24 @@ namespace OpenMS
                                          std::vector<std::pair<double, double> >& isotopesSpec, double charge,
                                          int nr_isotopes, double mannmass)
     {
-      typedef OpenMS::FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
-      // create the theoretical distribution
-      IsotopeDistribution d;
-      TheoreticalIsotopePattern isotopes;
-      d.setMaxIsotope(nr_isotopes);
+      getAveragineIsotopeDistribution(product_mz, isotopesSpec, IsotopeDistributionCache::getAveragineCache(),
+                                      charge, nr_isotopes, mannmass);
+    }
+
+    void getAveragineIsotopeDistribution(double product_mz,
+                                         std::vector<std::pair<double, double> >& isotopesSpec,
+                                         const IsotopeDistributionCache& cache, double charge,
+                                         int nr_isotopes, double mannmass)
+    {
+      // look up the theoretical distribution
+      std::vector<double> probabilities;
       //std::cout << product_mz * charge << std::endl;
-      d.estimateFromPeptideWeight(product_mz * charge);
+      cache.getIsotopeProbabilities(product_mz * charge, nr_isotopes, probabilities);
 
       double mass = product_mz;
-      for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
+      for (Size i = 0; i < probabilities.size(); ++i)
       {
-        isotopesSpec.push_back(std::make_pair(mass, it->second));
+        isotopesSpec.push_back(std::make_pair(mass, probabilities[i]));
         mass += mannmass;
       }
     } //end of dia_isotope_corr_sub
@@ -124,10 +130,11 @@ namespace OpenMS
                                         double charge)
     {
       getTheorMasses(aa, firstIsotopeMasses, charge);
+      const IsotopeDistributionCache& cache = IsotopeDistributionCache::getAveragineCache();
       for (std::size_t i = 0; i < firstIsotopeMasses.size(); ++i)
       {
         getAveragineIsotopeDistribution(firstIsotopeMasses[i], isotopeMasses,
-                                        charge);
+                                        cache, charge);
       }
     }
 
@@ -136,11 +143,19 @@ namespace OpenMS
                           std::vector<std::pair<double, double> >& isotopeMasses, //[out]
                           double charge)
     {
+      addIsotopes2Spec(spec, isotopeMasses, IsotopeDistributionCache::getAveragineCache(), charge);
+    }
+
+    void addIsotopes2Spec(const std::vector<std::pair<double, double> >& spec,
+                          std::vector<std::pair<double, double> >& isotopeMasses, //[out]
+                          const IsotopeDistributionCache& cache,
+                          double charge)
+    {
 
       for (std::size_t i = 0; i < spec.size(); ++i)
       {
         std::vector<std::pair<double, double> > isotopes;
-        getAveragineIsotopeDistribution(spec[i].first, isotopes, charge);
+        getAveragineIsotopeDistribution(spec[i].first, isotopes, cache, charge);
         for (Size j = 0; j < isotopes.size(); ++j)
         {
           isotopes[j].second *= spec[i].second; //multiple isotope intensity by spec intensity
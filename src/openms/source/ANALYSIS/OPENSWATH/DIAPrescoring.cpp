@@ -36,6 +36,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/SpectrumHelpers.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/StatsHelpers.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/TransitionHelper.h>
 
@@ -138,7 +139,7 @@ namespace OpenMS
     std::vector<double> firstIstotope, theomasses;
     DIAHelpers::extractFirst(res, firstIstotope);
     std::vector<std::pair<double, double> > spectrum, spectrum2;
-    DIAHelpers::addIsotopes2Spec(res, spectrum, nr_charges_);
+    DIAHelpers::addIsotopes2Spec(res, spectrum, *isotope_cache_, nr_charges_);
     spectrum2.resize(spectrum.size());
     std::copy(spectrum.begin(), spectrum.end(), spectrum2.begin());
     //std::cout << spectrum.size() << std::endl;
@@ -198,16 +199,18 @@ namespace OpenMS
     defaultsToParam_();
   }
 
-  DiaPrescore::DiaPrescore(double dia_extract_window, int nr_isotopes, int nr_charges) :
+  DiaPrescore::DiaPrescore(double dia_extract_window, int nr_isotopes, int nr_charges, const IsotopeDistributionCache* isotope_cache) :
     DefaultParamHandler("DIAPrescore"),
     dia_extract_window_(dia_extract_window),
     nr_isotopes_(nr_isotopes),
-    nr_charges_(nr_charges)
+    nr_charges_(nr_charges),
+    isotope_cache_(isotope_cache != 0 ? isotope_cache : &IsotopeDistributionCache::getAveragineCache())
   {
   }
 
   DiaPrescore::DiaPrescore() :
-    DefaultParamHandler("DIAPrescore")
+    DefaultParamHandler("DIAPrescore"),
+    isotope_cache_(&IsotopeDistributionCache::getAveragineCache())
   {
     defineDefaults();
   }
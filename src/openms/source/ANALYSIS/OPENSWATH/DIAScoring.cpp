@@ -35,7 +35,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAScoring.h>
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/DATASTRUCTURES/ListUtils.h>
-#include <OpenMS/CHEMISTRY/IsotopeDistribution.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithmPickedHelperStructs.h>
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/FeatureFinderAlgorithm.h>
@@ -56,7 +56,8 @@ const double C13C12_MASSDIFF_U = 1.0033548;
 namespace OpenMS
 {
   DIAScoring::DIAScoring() :
-    DefaultParamHandler("DIAScoring")
+    DefaultParamHandler("DIAScoring"),
+    isotope_cache_(&IsotopeDistributionCache::getAveragineCache())
   {
 
     defaults_.setValue("dia_extraction_window", 0.05, "DIA extraction window in Th.");
@@ -237,7 +238,7 @@ namespace OpenMS
   void DIAScoring::score_with_isotopes(SpectrumPtrType spectrum, const std::vector<TransitionType>& transitions,
                                        double& dotprod, double& manhattan)
   {
-    OpenMS::DiaPrescore dp(dia_extract_window_, dia_nr_isotopes_, dia_nr_charges_);
+    OpenMS::DiaPrescore dp(dia_extract_window_, dia_nr_isotopes_, dia_nr_charges_, isotope_cache_);
     dp.score(spectrum, transitions, dotprod, manhattan);
   }
 
@@ -344,15 +345,10 @@ namespace OpenMS
 
     typedef OpenMS::FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern TheoreticalIsotopePattern;
 
-    // create the theoretical distribution
-    IsotopeDistribution d;
+    // look up the theoretical distribution
     TheoreticalIsotopePattern isotopes;
-    d.setMaxIsotope(dia_nr_isotopes_ + 1);
-    d.estimateFromPeptideWeight(product_mz * putative_fragment_charge);
-    for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
-    {
-      isotopes.intensity.push_back(it->second);
-    }
+    isotope_cache_->getIsotopeProbabilities(product_mz * putative_fragment_charge,
+                                            dia_nr_isotopes_ + 1, isotopes.intensity);
 
     //FEATURE ISO pattern for peptide sequence..
 
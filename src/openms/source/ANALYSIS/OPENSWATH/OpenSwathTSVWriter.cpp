@@ -0,0 +1,488 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathTSVWriter.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/FORMAT/ColumnarTableFile.h>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+#include <cstdio>
+#include <deque>
+#include <sstream>
+
+namespace OpenMS
+{
+
+  /**
+    @brief Writes text to a stream and a columnar table from a background thread
+
+    Producers (any number of threads) hand over text with write(), which is
+    queued and written out in the order of arrival by a separate thread.
+    The queue is bounded: if more than max_queued_bytes are waiting, write()
+    blocks until the writer thread has caught up (backpressure).
+
+    If a table is given, every line of the text is split at tabs and added
+    as a row to the table (unless the text is marked as text only, e.g. the
+    header line).
+  */
+  class OpenSwathAsyncWriter :
+    public QThread
+  {
+    /// queued text and whether it is added to the table
+    typedef std::pair<String, bool> QueuedText;
+
+    std::ostream* os_;
+    ColumnarTableFile* table_;
+    Size max_queued_bytes_;
+    std::deque<QueuedText> queue_;
+    Size queued_bytes_;
+    bool finished_;
+    String error_;
+    QMutex mutex_;
+    QWaitCondition data_available_;
+    QWaitCondition space_available_;
+
+public:
+
+    OpenSwathAsyncWriter(std::ostream* os, ColumnarTableFile* table, Size max_queued_bytes) :
+      os_(os),
+      table_(table),
+      max_queued_bytes_(max_queued_bytes),
+      queued_bytes_(0),
+      finished_(false)
+    {
+    }
+
+    /// Queues @p data for writing (blocks while the queue is full)
+    void write(const String& data, bool text_only = false)
+    {
+      if (data.empty()) return;
+
+      QMutexLocker locker(&mutex_);
+      while (queued_bytes_ >= max_queued_bytes_)
+      {
+        space_available_.wait(&mutex_);
+      }
+      queue_.push_back(QueuedText(data, !text_only));
+      queued_bytes_ += data.size();
+      data_available_.wakeOne();
+    }
+
+    /// Writes all queued data and waits for the writer thread to exit, returns the error that stopped the table output (if any)
+    String finish()
+    {
+      {
+        QMutexLocker locker(&mutex_);
+        finished_ = true;
+        data_available_.wakeOne();
+      }
+      wait();
+      return error_;
+    }
+
+protected:
+
+    /// adds every (non-empty) line of @p text as a row to the table
+    void addRows_(const String& text)
+    {
+      std::vector<String> fields;
+      Size line_start = 0;
+      while (line_start < text.size())
+      {
+        Size line_end = text.find('\n', line_start);
+        if (line_end == String::npos) line_end = text.size();
+        if (line_end > line_start)
+        {
+          String(text.begin() + line_start, text.begin() + line_end).split('\t', fields);
+          table_->addRow(fields);
+        }
+        line_start = line_end + 1;
+      }
+    }
+
+    void run()
+    {
+      std::deque<QueuedText> current;
+      while (true)
+      {
+        {
+          QMutexLocker locker(&mutex_);
+          while (queue_.empty() && !finished_)
+          {
+            data_available_.wait(&mutex_);
+          }
+          if (queue_.empty())
+          {
+            break; // finished and nothing left to write
+          }
+          // take everything that is queued and write it without holding the lock
+          current.swap(queue_);
+          queued_bytes_ = 0;
+          space_available_.wakeAll();
+        }
+        for (std::deque<QueuedText>::const_iterator it = current.begin(); it != current.end(); ++it)
+        {
+          if (os_ != 0) *os_ << it->first;
+          if (table_ != 0 && it->second)
+          {
+            // exceptions must not leave the thread: report them in finish()
+            try
+            {
+              addRows_(it->first);
+            }
+            catch (Exception::BaseException& e)
+            {
+              error_ = e.what();
+              table_ = 0;
+            }
+          }
+        }
+        current.clear();
+      }
+      if (os_ != 0) os_->flush();
+    }
+  };
+
+  OpenSwathTSVWriter::OpenSwathTSVWriter(const String& output_filename, const String& input_filename,
+                                         bool ms1_scores, bool uis_scores, Size max_queued_bytes,
+                                         const String& columnar_filename) :
+    input_filename_(input_filename),
+    doWrite_(!output_filename.empty() || !columnar_filename.empty()),
+    use_ms1_traces_(ms1_scores),
+    enable_uis_scoring_(uis_scores),
+    table_(0),
+    writer_(0)
+  {
+    if (!output_filename.empty())
+    {
+      ofs_.open(output_filename.c_str());
+      if (!ofs_)
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, output_filename);
+      }
+    }
+    if (!columnar_filename.empty())
+    {
+      table_ = new ColumnarTableFile();
+      try
+      {
+        table_->create(columnar_filename, getColumnNames());
+      }
+      catch (...)
+      {
+        delete table_;
+        throw;
+      }
+    }
+    if (doWrite_)
+    {
+      writer_ = new OpenSwathAsyncWriter(output_filename.empty() ? 0 : &ofs_, table_, max_queued_bytes);
+      writer_->start();
+    }
+  }
+
+  OpenSwathTSVWriter::~OpenSwathTSVWriter()
+  {
+    finish_();
+  }
+
+  bool OpenSwathTSVWriter::isActive() const
+  {
+    return doWrite_;
+  }
+
+  String OpenSwathTSVWriter::finish_()
+  {
+    String error;
+    if (doWrite_)
+    {
+      error = writer_->finish();
+      delete writer_;
+      writer_ = 0;
+      if (ofs_.is_open()) ofs_.close();
+      if (table_ != 0)
+      {
+        table_->close();
+        delete table_;
+        table_ = 0;
+      }
+      doWrite_ = false;
+    }
+    return error;
+  }
+
+  void OpenSwathTSVWriter::close()
+  {
+    String error = finish_();
+    if (!error.empty())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Error writing the columnar table: " + error);
+    }
+  }
+
+  std::vector<String> OpenSwathTSVWriter::getColumnNames() const
+  {
+    std::stringstream header;
+    header << "transition_group_id\tpeptide_group_label\trun_id\tfilename\tRT\tid\tSequence\tFullPeptideName" <<
+      "\tCharge\tm/z\tIntensity\tProteinName\tdecoy\tassay_rt\tdelta_rt\tleftWidth" <<
+      "\tmain_var_xx_swath_prelim_score\tnorm_RT\tnr_peaks\tpeak_apices_sum\tpotentialOutlier" <<
+      "\trightWidth\trt_score\tsn_ratio\ttotal_xic\tvar_bseries_score\tvar_dotprod_score" <<
+      "\tvar_intensity_score\tvar_isotope_correlation_score\tvar_isotope_overlap_score" <<
+      "\tvar_library_corr\tvar_library_dotprod\tvar_library_manhattan\tvar_library_rmsd" <<
+      "\tvar_library_rootmeansquare\tvar_library_sangle\tvar_log_sn_score\tvar_manhatt_score" <<
+      "\tvar_massdev_score\tvar_massdev_score_weighted\tvar_norm_rt_score\tvar_xcorr_coelution" <<
+      "\tvar_xcorr_coelution_weighted\tvar_xcorr_shape\tvar_xcorr_shape_weighted" <<
+      "\tvar_yseries_score\tvar_elution_model_fit_score";
+    if (use_ms1_traces_)
+    {
+      header << "\tvar_ms1_ppm_diff\tvar_ms1_isotope_corr\tvar_ms1_isotope_overlap\tvar_ms1_xcorr_coelution\tvar_ms1_xcorr_shape";
+    }
+    header << "\txx_lda_prelim_score\txx_swath_prelim_score";
+    if (use_ms1_traces_)
+    {
+      header << "\taggr_prec_Peak_Area\taggr_prec_Peak_Apex\taggr_prec_Fragment_Annotation";
+    }
+    header << "\taggr_Peak_Area\taggr_Peak_Apex\taggr_Fragment_Annotation";
+    if (enable_uis_scoring_)
+    {
+      header << "\tuis_target_transition_names"
+          << "\tuis_target_var_ind_log_intensity"
+          << "\tuis_target_num_transitions"
+          << "\tuis_target_var_ind_xcorr_coelution"
+          << "\tuis_target_main_var_ind_xcorr_shape"
+          << "\tuis_target_var_ind_log_sn_score"
+          << "\tuis_target_var_ind_massdev_score"
+          << "\tuis_target_var_ind_isotope_correlation"
+          << "\tuis_target_var_ind_isotope_overlap"
+          << "\tuis_decoy_transition_names"
+          << "\tuis_decoy_var_ind_log_intensity"
+          << "\tuis_decoy_num_transitions"
+          << "\tuis_decoy_var_ind_xcorr_coelution"
+          << "\tuis_decoy_main_var_ind_xcorr_shape"
+          << "\tuis_decoy_var_ind_log_sn_score"
+          << "\tuis_decoy_var_ind_massdev_score"
+          << "\tuis_decoy_var_ind_isotope_correlation"
+          << "\tuis_decoy_var_ind_isotope_overlap";
+    }
+
+    std::vector<String> names;
+    String(header.str()).split('\t', names);
+    return names;
+  }
+
+  void OpenSwathTSVWriter::writeHeader()
+  {
+    if (doWrite_) writer_->write(ListUtils::concatenate(getColumnNames(), "\t") + "\n", true);
+  }
+
+  String OpenSwathTSVWriter::prepareLine(const OpenSwath::LightPeptide& pep,
+      const OpenSwath::LightTransition* transition,
+      FeatureMap& output, String id) const
+  {
+      String result = "";
+      String decoy = "0"; // 0 = false
+      if (transition->decoy) 
+      {
+        decoy = "1";
+      }
+
+      for (FeatureMap::iterator feature_it = output.begin(); feature_it != output.end(); ++feature_it)
+      {
+
+        char intensity_char[40];
+        char intensity_apex_char[40];
+        String aggr_Peak_Area = "";
+        String aggr_Peak_Apex = "";
+        String aggr_Fragment_Annotation = "";
+        String aggr_prec_Peak_Area = "";
+        String aggr_prec_Peak_Apex = "";
+        String aggr_prec_Fragment_Annotation = "";
+        for (std::vector<Feature>::iterator sub_it = feature_it->getSubordinates().begin(); sub_it != feature_it->getSubordinates().end(); ++sub_it)
+        {
+          sprintf(intensity_char, "%f", sub_it->getIntensity());
+          sprintf(intensity_apex_char, "%f", (double)sub_it->getMetaValue("peak_apex_int"));
+          if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS2")
+          {
+            aggr_Peak_Area += (String)intensity_char + ";";
+            aggr_Peak_Apex += (String)intensity_apex_char + ";";
+            aggr_Fragment_Annotation += (String)sub_it->getMetaValue("native_id") + ";";
+          }
+          else if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS1")
+          {
+            aggr_prec_Peak_Area += (String)intensity_char + ";";
+            aggr_Peak_Apex += (String)intensity_apex_char + ";";
+            aggr_prec_Fragment_Annotation += (String)sub_it->getMetaValue("native_id") + ";";
+          }
+        }
+        if (!feature_it->getSubordinates().empty())
+        {
+          aggr_Peak_Area = aggr_Peak_Area.substr(0, aggr_Peak_Area.size() - 1);
+          aggr_Peak_Apex = aggr_Peak_Apex.substr(0, aggr_Peak_Apex.size() - 1);
+          aggr_Fragment_Annotation = aggr_Fragment_Annotation.substr(0, aggr_Fragment_Annotation.size() - 1);
+          aggr_prec_Peak_Area = aggr_prec_Peak_Area.substr(0, aggr_prec_Peak_Area.size() - 1);
+          aggr_prec_Peak_Apex = aggr_prec_Peak_Apex.substr(0, aggr_prec_Peak_Apex.size() - 1);
+          aggr_prec_Fragment_Annotation = aggr_prec_Fragment_Annotation.substr(0, aggr_prec_Fragment_Annotation.size() - 1);
+        }
+
+        String full_peptide_name = "";
+        for (int loc = -1; loc <= (int)pep.sequence.size(); loc++)
+        {
+          if (loc > -1 && loc < (int)pep.sequence.size())
+          {
+            full_peptide_name += pep.sequence[loc];
+          }
+          // C-terminal and N-terminal modifications may be at positions -1 or pep.sequence
+          for (Size modloc = 0; modloc < pep.modifications.size(); modloc++)
+          {
+            if (pep.modifications[modloc].location == loc)
+            {
+              full_peptide_name += "(" + pep.modifications[modloc].unimod_id + ")";
+            }
+          }
+        }
+
+        // Compute peptide group label (use the provided label or use the
+        // transition group).
+        String group_label = pep.peptide_group_label;
+        if (group_label.empty()) group_label = id;
+        if (group_label == "light") group_label = id; // legacy fix since there are many TraMLs floating around which have "light" in there
+
+        String line = "";
+        line += id + "_run0"
+          + "\t" + group_label
+          + "\t" + "0"
+          + "\t" + input_filename_
+          + "\t" + (String)feature_it->getRT()
+          + "\t" + "f_" + feature_it->getUniqueId()  // TODO might not be unique!!!
+          + "\t" + pep.sequence
+          + "\t" + full_peptide_name
+          + "\t" + (String)pep.charge
+          + "\t" + (String)transition->precursor_mz
+          + "\t" + (String)feature_it->getIntensity()
+          + "\t" + pep.protein_refs[0] // TODO what about other proteins?
+          + "\t" + decoy
+          // Note: missing MetaValues will just produce a DataValue::EMPTY which lead to an empty column
+          + "\t" + (String)feature_it->getMetaValue("assay_rt")
+          + "\t" + (String)feature_it->getMetaValue("delta_rt")
+          + "\t" + (String)feature_it->getMetaValue("leftWidth")
+          + "\t" + (String)feature_it->getMetaValue("main_var_xx_swath_prelim_score")
+          + "\t" + (String)feature_it->getMetaValue("norm_RT")
+          + "\t" + (String)feature_it->getMetaValue("nr_peaks")
+          + "\t" + (String)feature_it->getMetaValue("peak_apices_sum")
+          + "\t" + (String)feature_it->getMetaValue("potentialOutlier")
+          + "\t" + (String)feature_it->getMetaValue("rightWidth")
+          + "\t" + (String)feature_it->getMetaValue("rt_score")
+          + "\t" + (String)feature_it->getMetaValue("sn_ratio")
+          + "\t" + (String)feature_it->getMetaValue("total_xic")
+          + "\t" + (String)feature_it->getMetaValue("var_bseries_score")
+          + "\t" + (String)feature_it->getMetaValue("var_dotprod_score")
+          + "\t" + (String)feature_it->getMetaValue("var_intensity_score")
+          + "\t" + (String)feature_it->getMetaValue("var_isotope_correlation_score")
+          + "\t" + (String)feature_it->getMetaValue("var_isotope_overlap_score")
+          + "\t" + (String)feature_it->getMetaValue("var_library_corr")
+          + "\t" + (String)feature_it->getMetaValue("var_library_dotprod")
+          + "\t" + (String)feature_it->getMetaValue("var_library_manhattan")
+          + "\t" + (String)feature_it->getMetaValue("var_library_rmsd")
+          + "\t" + (String)feature_it->getMetaValue("var_library_rootmeansquare")
+          + "\t" + (String)feature_it->getMetaValue("var_library_sangle")
+          + "\t" + (String)feature_it->getMetaValue("var_log_sn_score")
+          + "\t" + (String)feature_it->getMetaValue("var_manhatt_score")
+          + "\t" + (String)feature_it->getMetaValue("var_massdev_score")
+          + "\t" + (String)feature_it->getMetaValue("var_massdev_score_weighted")
+          + "\t" + (String)feature_it->getMetaValue("var_norm_rt_score")
+          + "\t" + (String)feature_it->getMetaValue("var_xcorr_coelution")
+          + "\t" + (String)feature_it->getMetaValue("var_xcorr_coelution_weighted")
+          + "\t" + (String)feature_it->getMetaValue("var_xcorr_shape")
+          + "\t" + (String)feature_it->getMetaValue("var_xcorr_shape_weighted")
+          + "\t" + (String)feature_it->getMetaValue("var_yseries_score")
+          + "\t" + (String)feature_it->getMetaValue("var_elution_model_fit_score");
+
+          if (use_ms1_traces_) 
+          {
+            line += "\t" + (String)feature_it->getMetaValue("var_ms1_ppm_diff")
+            + "\t" + (String)feature_it->getMetaValue("var_ms1_isotope_correlation")
+            + "\t" + (String)feature_it->getMetaValue("var_ms1_isotope_overlap")
+            + "\t" + (String)feature_it->getMetaValue("var_ms1_xcorr_coelution")
+            + "\t" + (String)feature_it->getMetaValue("var_ms1_xcorr_shape");
+          }
+
+          line += "\t" + (String)feature_it->getMetaValue("xx_lda_prelim_score")
+          + "\t" + (String)feature_it->getMetaValue("xx_swath_prelim_score");
+          if (use_ms1_traces_) 
+          {
+            line += "\t" + aggr_prec_Peak_Area + "\t" + aggr_prec_Peak_Apex + "\t" + aggr_prec_Fragment_Annotation;
+          }
+          line += "\t" + aggr_Peak_Area + "\t" + aggr_Peak_Apex + "\t" + aggr_Fragment_Annotation;
+          if (enable_uis_scoring_)
+          {
+            line += "\t" + (String)feature_it->getMetaValue("id_target_transition_names")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_log_intensity")
+            + "\t" + (String)feature_it->getMetaValue("id_target_num_transitions")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_xcorr_coelution")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_xcorr_shape")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_log_sn_score")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_massdev_score")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_isotope_correlation")
+            + "\t" + (String)feature_it->getMetaValue("id_target_ind_isotope_overlap")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_transition_names")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_log_intensity")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_num_transitions")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_xcorr_coelution")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_xcorr_shape")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_log_sn_score")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_massdev_score")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_isotope_correlation")
+            + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_isotope_overlap");
+          }
+          line += "\n";          result += line;
+      } // end of iteration
+    return result;
+  }
+
+  void OpenSwathTSVWriter::writeLine(const String& line)
+  {
+    if (doWrite_) writer_->write(line);
+  }
+
+  void OpenSwathTSVWriter::writeLines(const std::vector<String>& to_output)
+  {
+    for (Size i = 0; i < to_output.size(); i++) { writeLine(to_output[i]); }
+  }
+
+}
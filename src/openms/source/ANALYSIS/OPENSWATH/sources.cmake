@@ -10,6 +10,7 @@ MRMRTNormalizer.cpp
 TransitionTSVReader.cpp
 SwathMapMassCorrection.cpp
 OpenSwathHelper.cpp
+OpenSwathTSVWriter.cpp
 OpenSwathScoring.cpp
 ChromatogramExtractor.cpp
 ChromatogramExtractorAlgorithm.cpp
@@ -166,37 +166,9 @@ namespace OpenMS
 
   void IsotopeDistribution::estimateFromPeptideWeight(double average_weight)
   {
-    const ElementDB * db = ElementDB::getInstance();
-
-    vector<String> names;
-    names.push_back("C");
-    names.push_back("H");
-    names.push_back("N");
-    names.push_back("O");
-    names.push_back("S");
-
-    //Averagine element count divided by averagine weight
     vector<double> factors;
-    factors.push_back(4.9384 / 111.1254);
-    factors.push_back(7.7583 / 111.1254);
-    factors.push_back(1.3577 / 111.1254);
-    factors.push_back(1.4773 / 111.1254);
-    factors.push_back(0.0417 / 111.1254);
-
-    //initialize distribution
-    distribution_.clear();
-    distribution_.push_back(make_pair(0u, 1.0));
-
-    for (Size i = 0; i != names.size(); ++i)
-    {
-      ContainerType single, conv_dist;
-      //calculate distribution for single element
-      ContainerType dist(db->getElement(names[i])->getIsotopeDistribution().getContainer());
-      convolvePow_(single, dist, (Size) Math::round(average_weight * factors[i]));
-      //convolve it with the existing distributions
-      conv_dist = distribution_;
-      convolve_(distribution_, single, conv_dist);
-    }
+    getAveragineFactors(PEPTIDE, factors);
+    estimateFromFactors_(average_weight, factors);
   }
 
 
@@ -213,45 +185,92 @@ namespace OpenMS
 
   void IsotopeDistribution::estimateFromWeightAndComp(double average_weight, double C, double H, double N, double O, double S, double P)
   {
-      const ElementDB * db = ElementDB::getInstance();
+      vector<double> factors;
+      getCompositionFactors_(C, H, N, O, S, P, factors);
+      estimateFromFactors_(average_weight, factors);
+  }
+
+  void IsotopeDistribution::estimateFromAveragineWeight(double average_weight, Averagine averagine)
+  {
+    switch (averagine)
+    {
+    case RNA:
+      estimateFromRNAWeight(average_weight);
+      break;
+
+    case DNA:
+      estimateFromDNAWeight(average_weight);
+      break;
 
-      vector<String> names;
-      names.push_back("C");
-      names.push_back("H");
-      names.push_back("N");
-      names.push_back("O");
-      names.push_back("S");
-      names.push_back("P");
+    default:
+      estimateFromPeptideWeight(average_weight);
+      break;
+    }
+  }
+
+  void IsotopeDistribution::getAveragineFactors(Averagine averagine, std::vector<double> & factors)
+  {
+    // same compositions as estimateFromRNAWeight() / estimateFromDNAWeight()
+    if (averagine == RNA)
+    {
+      getCompositionFactors_(9.75, 12.25, 3.75, 7, 0, 1, factors);
+      return;
+    }
+    if (averagine == DNA)
+    {
+      getCompositionFactors_(9.75, 12.25, 3.75, 6, 0, 1, factors);
+      return;
+    }
+
+    //Averagine element count divided by averagine weight
+    factors.clear();
+    factors.push_back(4.9384 / 111.1254);
+    factors.push_back(7.7583 / 111.1254);
+    factors.push_back(1.3577 / 111.1254);
+    factors.push_back(1.4773 / 111.1254);
+    factors.push_back(0.0417 / 111.1254);
+  }
+
+  void IsotopeDistribution::getCompositionFactors_(double C, double H, double N, double O, double S, double P, std::vector<double> & factors)
+  {
+      const ElementDB * db = ElementDB::getInstance();
 
       //Averagine element count divided by averagine weight
-      vector<double> factors;
       double monoTotal = (C*db->getElement("C")->getMonoWeight() +
                          H*db->getElement("H")->getMonoWeight() +
                          N*db->getElement("N")->getMonoWeight() +
                          O*db->getElement("O")->getMonoWeight() +
                          S*db->getElement("S")->getMonoWeight() +
                          P*db->getElement("P")->getMonoWeight());
+      factors.clear();
       factors.push_back(C / monoTotal);
       factors.push_back(H / monoTotal);
       factors.push_back(N / monoTotal);
       factors.push_back(O / monoTotal);
       factors.push_back(S / monoTotal);
       factors.push_back(P / monoTotal);
+  }
 
-      //initialize distribution
-      distribution_.clear();
-      distribution_.push_back(make_pair(0u, 1.0));
+  void IsotopeDistribution::estimateFromFactors_(double average_weight, const std::vector<double> & factors)
+  {
+    const ElementDB * db = ElementDB::getInstance();
 
-      for (Size i = 0; i != names.size(); ++i)
-      {
-        ContainerType single, conv_dist;
-        //calculate distribution for single element
-        ContainerType dist(db->getElement(names[i])->getIsotopeDistribution().getContainer());
-        convolvePow_(single, dist, (Size) Math::round(average_weight * factors[i]));
-        //convolve it with the existing distributions
-        conv_dist = distribution_;
-        convolve_(distribution_, single, conv_dist);
-      }
+    const char * names[] = { "C", "H", "N", "O", "S", "P" };
+
+    //initialize distribution
+    distribution_.clear();
+    distribution_.push_back(make_pair(0u, 1.0));
+
+    for (Size i = 0; i != factors.size(); ++i)
+    {
+      ContainerType single, conv_dist;
+      //calculate distribution for single element
+      ContainerType dist(db->getElement(names[i])->getIsotopeDistribution().getContainer());
+      convolvePow_(single, dist, (Size) Math::round(average_weight * factors[i]));
+      //convolve it with the existing distributions
+      conv_dist = distribution_;
+      convolve_(distribution_, single, conv_dist);
+    }
   }
 
   bool IsotopeDistribution::operator==(const IsotopeDistribution & isotope_distribution) const
@@ -41,10 +41,13 @@
 #include <OpenMS/config.h>
 
 #include <QtCore/QString>
+#include <QtCore/QAtomicInt>
 
+#include <algorithm>
 #include <cstddef>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -53,11 +56,51 @@ using namespace std;
 namespace OpenMS
 {
 
+  template <typename T>
+  struct DataValue::Shared_
+  {
+    explicit Shared_(const T& v) :
+      ref(1), value(v)
+    {
+    }
+
+    /// number of DataValues using this storage
+    QAtomicInt ref;
+    /// the stored value (never modified after construction)
+    const T value;
+  };
+
+  namespace
+  {
+    /// Acquires a reference to shared storage (NULL is allowed)
+    template <typename T>
+    inline void acquire(T* shared)
+    {
+      if (shared != 0)
+      {
+        shared->ref.ref();
+      }
+    }
+
+    /// Releases a reference to shared storage and deletes it if it was the last one (NULL is allowed)
+    template <typename T>
+    inline void release(T* shared)
+    {
+      if (shared != 0 && !shared->ref.deref())
+      {
+        delete shared;
+      }
+    }
+
+    /// Unit returned for values without unit
+    const String empty_unit;
+  }
+
   const DataValue DataValue::EMPTY;
 
   // default ctor
   DataValue::DataValue() :
-    value_type_(EMPTY_VALUE), unit_("")
+    value_type_(EMPTY_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
   }
 
@@ -71,163 +114,212 @@ namespace OpenMS
   //    ctor for all supported types a DataValue object can hold
   //--------------------------------------------------------------------
   DataValue::DataValue(long double p) :
-    value_type_(DOUBLE_VALUE), unit_("")
+    value_type_(DOUBLE_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.dou_ = p;
   }
 
   DataValue::DataValue(double p) :
-    value_type_(DOUBLE_VALUE), unit_("")
+    value_type_(DOUBLE_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.dou_ = p;
   }
 
   DataValue::DataValue(float p) :
-    value_type_(DOUBLE_VALUE), unit_("")
+    value_type_(DOUBLE_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.dou_ = p;
   }
 
   DataValue::DataValue(short int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(unsigned short int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(unsigned int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(long int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(unsigned long int p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(long long p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(unsigned long long p) :
-    value_type_(INT_VALUE), unit_("")
+    value_type_(INT_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
     data_.ssize_ = p;
   }
 
   DataValue::DataValue(const char* p) :
-    value_type_(STRING_VALUE), unit_("")
+    value_type_(STRING_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.str_ = new String(p);
+    setString_(p, strlen(p));
   }
 
   DataValue::DataValue(const string& p) :
-    value_type_(STRING_VALUE), unit_("")
+    value_type_(STRING_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.str_ = new String(p);
+    setString_(p.c_str(), p.size());
   }
 
   DataValue::DataValue(const QString& p) :
-    value_type_(STRING_VALUE), unit_("")
+    value_type_(STRING_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.str_ = new String(p);
+    String tmp(p);
+    setString_(tmp.c_str(), tmp.size());
   }
 
   DataValue::DataValue(const String& p) :
-    value_type_(STRING_VALUE), unit_("")
+    value_type_(STRING_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.str_ = new String(p);
+    setString_(p.c_str(), p.size());
   }
 
   DataValue::DataValue(const StringList& p) :
-    value_type_(STRING_LIST), unit_("")
+    value_type_(STRING_LIST), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.str_list_ = new StringList(p);
+    data_.str_list_ = new Shared_<StringList>(p);
   }
 
   DataValue::DataValue(const IntList& p) :
-    value_type_(INT_LIST), unit_("")
+    value_type_(INT_LIST), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.int_list_ = new IntList(p);
+    data_.int_list_ = new Shared_<IntList>(p);
   }
 
   DataValue::DataValue(const DoubleList& p) :
-    value_type_(DOUBLE_LIST), unit_("")
+    value_type_(DOUBLE_LIST), short_string_(false), short_string_length_(0), unit_(0)
   {
-    data_.dou_list_ = new DoubleList(p);
+    data_.dou_list_ = new Shared_<DoubleList>(p);
   }
 
   //--------------------------------------------------------------------
   //                       copy constructor
   //--------------------------------------------------------------------
   DataValue::DataValue(const DataValue& p) :
-    value_type_(p.value_type_), data_(p.data_)
+    value_type_(EMPTY_VALUE), short_string_(false), short_string_length_(0), unit_(0)
   {
-    if (value_type_ == STRING_VALUE)
+    copy_(p);
+  }
+
+  void DataValue::clear_()
+  {
+    if (value_type_ == STRING_LIST)
     {
-      data_.str_ = new String(*(p.data_.str_));
+      release(data_.str_list_);
     }
-    else if (value_type_ == STRING_LIST)
+    else if (value_type_ == STRING_VALUE && !short_string_)
     {
-      data_.str_list_ = new StringList(*(p.data_.str_list_));
+      release(data_.str_);
     }
     else if (value_type_ == INT_LIST)
     {
-      data_.int_list_ = new IntList(*(p.data_.int_list_));
+      release(data_.int_list_);
     }
     else if (value_type_ == DOUBLE_LIST)
     {
-      data_.dou_list_ = new DoubleList(*(p.data_.dou_list_));
+      release(data_.dou_list_);
     }
+    release(unit_);
 
-    if (p.hasUnit())
-    {
-      unit_ = p.unit_;
-    }
+    value_type_ = EMPTY_VALUE;
+    short_string_ = false;
+    short_string_length_ = 0;
+    unit_ = 0;
   }
 
-  void DataValue::clear_()
+  void DataValue::copy_(const DataValue& p)
   {
+    data_ = p.data_;
+    value_type_ = p.value_type_;
+    short_string_ = p.short_string_;
+    short_string_length_ = p.short_string_length_;
+    unit_ = p.unit_;
+
     if (value_type_ == STRING_LIST)
     {
-      delete(data_.str_list_);
+      acquire(data_.str_list_);
     }
-    else if (value_type_ == STRING_VALUE)
+    else if (value_type_ == STRING_VALUE && !short_string_)
     {
-      delete(data_.str_);
+      acquire(data_.str_);
     }
     else if (value_type_ == INT_LIST)
     {
-      delete(data_.int_list_);
+      acquire(data_.int_list_);
     }
     else if (value_type_ == DOUBLE_LIST)
     {
-      delete(data_.dou_list_);
+      acquire(data_.dou_list_);
     }
+    acquire(unit_);
+  }
 
-    value_type_ = EMPTY_VALUE;
-    unit_ = "";
+  void DataValue::setString_(const char* str, Size length)
+  {
+    value_type_ = STRING_VALUE;
+    if (length <= SHORT_STRING_CAPACITY)
+    {
+      memcpy(data_.chars_, str, length);
+      data_.chars_[length] = '\0';
+      short_string_ = true;
+      short_string_length_ = (unsigned char)length;
+    }
+    else
+    {
+      data_.str_ = new Shared_<String>(String(str, length));
+      short_string_ = false;
+      short_string_length_ = 0;
+    }
+  }
+
+  const char* DataValue::stringData_() const
+  {
+    return short_string_ ? data_.chars_ : data_.str_->value.c_str();
+  }
+
+  Size DataValue::stringLength_() const
+  {
+    return short_string_ ? short_string_length_ : data_.str_->value.size();
+  }
+
+  int DataValue::compareStrings_(const DataValue& a, const DataValue& b)
+  {
+    Size a_length = a.stringLength_(), b_length = b.stringLength_();
+    int cmp = memcmp(a.stringData_(), b.stringData_(), std::min(a_length, b_length));
+    if (cmp != 0) return cmp;
+    if (a_length < b_length) return -1;
+    if (a_length > b_length) return 1;
+    return 0;
   }
 
   //--------------------------------------------------------------------
@@ -239,43 +331,21 @@ namespace OpenMS
     if (this == &p)
       return *this;
 
-    // clean up
     clear_();
-
-    // assign
-    if (p.value_type_ == STRING_LIST)
-    {
-      data_.str_list_ = new StringList(*(p.data_.str_list_));
-    }
-    else if (p.value_type_ == STRING_VALUE)
-    {
-      data_.str_ = new String(*(p.data_.str_));
-    }
-    else if (p.value_type_ == INT_LIST)
-    {
-      data_.int_list_ = new IntList(*(p.data_.int_list_));
-    }
-    else if (p.value_type_ == DOUBLE_LIST)
-    {
-      data_.dou_list_ = new DoubleList(*(p.data_.dou_list_));
-    }
-    else
-    {
-      data_ = p.data_;
-    }
-
-    // copy type
-    value_type_     = p.value_type_;
-
-    // copy unit if necessary
-    if (p.hasUnit())
-    {
-      unit_ = p.unit_;
-    }
+    copy_(p);
 
     return *this;
   }
 
+  void DataValue::swap(DataValue& rhs)
+  {
+    std::swap(data_, rhs.data_);
+    std::swap(value_type_, rhs.value_type_);
+    std::swap(short_string_, rhs.short_string_);
+    std::swap(short_string_length_, rhs.short_string_length_);
+    std::swap(unit_, rhs.unit_);
+  }
+
   //--------------------------------------------------------------------
   //                assignment conversion operator
   //--------------------------------------------------------------------
@@ -283,39 +353,36 @@ namespace OpenMS
   DataValue& DataValue::operator=(const char* arg)
   {
     clear_();
-    data_.str_ = new String(arg);
-    value_type_ = STRING_VALUE;
+    setString_(arg, strlen(arg));
     return *this;
   }
 
   DataValue& DataValue::operator=(const std::string& arg)
   {
     clear_();
-    data_.str_ = new String(arg);
-    value_type_ = STRING_VALUE;
+    setString_(arg.c_str(), arg.size());
     return *this;
   }
 
   DataValue& DataValue::operator=(const String& arg)
   {
     clear_();
-    data_.str_ = new String(arg);
-    value_type_ = STRING_VALUE;
+    setString_(arg.c_str(), arg.size());
     return *this;
   }
 
   DataValue& DataValue::operator=(const QString& arg)
   {
+    String tmp(arg);
     clear_();
-    data_.str_ = new String(arg);
-    value_type_ = STRING_VALUE;
+    setString_(tmp.c_str(), tmp.size());
     return *this;
   }
 
   DataValue& DataValue::operator=(const StringList& arg)
   {
     clear_();
-    data_.str_list_ = new StringList(arg);
+    data_.str_list_ = new Shared_<StringList>(arg);
     value_type_ = STRING_LIST;
     return *this;
   }
@@ -323,7 +390,7 @@ namespace OpenMS
   DataValue& DataValue::operator=(const IntList& arg)
   {
     clear_();
-    data_.int_list_ = new IntList(arg);
+    data_.int_list_ = new Shared_<IntList>(arg);
     value_type_ = INT_LIST;
     return *this;
   }
@@ -331,7 +398,7 @@ namespace OpenMS
   DataValue& DataValue::operator=(const DoubleList& arg)
   {
     clear_();
-    data_.dou_list_ = new DoubleList(arg);
+    data_.dou_list_ = new Shared_<DoubleList>(arg);
     value_type_ = DOUBLE_LIST;
     return *this;
   }
@@ -560,7 +627,7 @@ namespace OpenMS
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Could not convert non-string DataValue to string");
     }
-    return *(data_.str_);
+    return std::string(stringData_(), stringLength_());
   }
 
   DataValue::operator StringList() const
@@ -583,7 +650,7 @@ namespace OpenMS
   {
     switch (value_type_)
     {
-    case DataValue::STRING_VALUE: return const_cast<const char*>(data_.str_->c_str());
+    case DataValue::STRING_VALUE: return stringData_();
 
     case DataValue::EMPTY_VALUE: return NULL;
 
@@ -597,7 +664,7 @@ namespace OpenMS
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Could not convert non-StringList DataValue to StringList");
     }
-    return *(data_.str_list_);
+    return data_.str_list_->value;
   }
 
   IntList DataValue::toIntList() const
@@ -606,7 +673,7 @@ namespace OpenMS
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Could not convert non-IntList DataValue to IntList");
     }
-    return *(data_.int_list_);
+    return data_.int_list_->value;
   }
 
   DoubleList DataValue::toDoubleList() const
@@ -615,7 +682,7 @@ namespace OpenMS
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Could not convert non-DoubleList DataValue to DoubleList");
     }
-    return *(data_.dou_list_);
+    return data_.dou_list_->value;
   }
 
   // Convert DataValues to String
@@ -626,13 +693,13 @@ namespace OpenMS
     {
     case DataValue::EMPTY_VALUE: break;
 
-    case DataValue::STRING_VALUE: return *(data_.str_);
+    case DataValue::STRING_VALUE: return String(stringData_(), stringLength_());
 
-    case DataValue::STRING_LIST: ss << *(data_.str_list_); break;
+    case DataValue::STRING_LIST: ss << data_.str_list_->value; break;
 
-    case DataValue::INT_LIST: ss << *(data_.int_list_); break;
+    case DataValue::INT_LIST: ss << data_.int_list_->value; break;
 
-    case DataValue::DOUBLE_LIST: ss << *(data_.dou_list_); break;
+    case DataValue::DOUBLE_LIST: ss << data_.dou_list_->value; break;
 
     case DataValue::INT_VALUE: ss << data_.ssize_; break;
 
@@ -650,7 +717,7 @@ namespace OpenMS
     {
     case DataValue::EMPTY_VALUE: break;
 
-    case DataValue::STRING_VALUE: result = QString::fromStdString(*(data_.str_)); break;
+    case DataValue::STRING_VALUE: result = QString::fromStdString(std::string(stringData_(), stringLength_())); break;
 
     case DataValue::STRING_LIST: result = QString::fromStdString(this->toString()); break;
 
@@ -673,12 +740,15 @@ namespace OpenMS
     {
       throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Could not convert non-string DataValue to bool.");
     }
-    else if (*(data_.str_) != "true" &&  *(data_.str_) != "false")
+    else if (strcmp(stringData_(), "true") == 0)
     {
-      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, String("Could not convert '") + *(data_.str_) + "' to bool. Valid stings are 'true' and 'false'.");
+      return true;
     }
-
-    return *(data_.str_) == "true";
+    else if (strcmp(stringData_(), "false") != 0)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, String("Could not convert '") + toString() + "' to bool. Valid stings are 'true' and 'false'.");
+    }
+    return false;
   }
 
   // ----------------- Comparator ----------------------
@@ -691,13 +761,13 @@ namespace OpenMS
       {
       case DataValue::EMPTY_VALUE: return b.value_type_ == DataValue::EMPTY_VALUE;
 
-      case DataValue::STRING_VALUE: return *(a.data_.str_) == *(b.data_.str_);
+      case DataValue::STRING_VALUE: return DataValue::compareStrings_(a, b) == 0;
 
-      case DataValue::STRING_LIST: return *(a.data_.str_list_) == *(b.data_.str_list_);
+      case DataValue::STRING_LIST: return a.data_.str_list_->value == b.data_.str_list_->value;
 
-      case DataValue::INT_LIST: return *(a.data_.int_list_) == *(b.data_.int_list_);
+      case DataValue::INT_LIST: return a.data_.int_list_->value == b.data_.int_list_->value;
 
-      case DataValue::DOUBLE_LIST: return *(a.data_.dou_list_) == *(b.data_.dou_list_);
+      case DataValue::DOUBLE_LIST: return a.data_.dou_list_->value == b.data_.dou_list_->value;
 
       case DataValue::INT_VALUE: return a.data_.ssize_ == b.data_.ssize_;
 
@@ -715,13 +785,13 @@ namespace OpenMS
       {
       case DataValue::EMPTY_VALUE: return false;
 
-      case DataValue::STRING_VALUE: return *(a.data_.str_) < *(b.data_.str_);
+      case DataValue::STRING_VALUE: return DataValue::compareStrings_(a, b) < 0;
 
-      case DataValue::STRING_LIST: return a.data_.str_list_->size() < b.data_.str_list_->size();
+      case DataValue::STRING_LIST: return a.data_.str_list_->value.size() < b.data_.str_list_->value.size();
 
-      case DataValue::INT_LIST: return a.data_.int_list_->size() < b.data_.int_list_->size();
+      case DataValue::INT_LIST: return a.data_.int_list_->value.size() < b.data_.int_list_->value.size();
 
-      case DataValue::DOUBLE_LIST: return a.data_.dou_list_->size() < b.data_.dou_list_->size();
+      case DataValue::DOUBLE_LIST: return a.data_.dou_list_->value.size() < b.data_.dou_list_->value.size();
 
       case DataValue::INT_VALUE: return a.data_.ssize_ < b.data_.ssize_;
 
@@ -739,13 +809,13 @@ namespace OpenMS
       {
       case DataValue::EMPTY_VALUE: return false;
 
-      case DataValue::STRING_VALUE: return *(a.data_.str_) > *(b.data_.str_);
+      case DataValue::STRING_VALUE: return DataValue::compareStrings_(a, b) > 0;
 
-      case DataValue::STRING_LIST: return a.data_.str_list_->size() > b.data_.str_list_->size();
+      case DataValue::STRING_LIST: return a.data_.str_list_->value.size() > b.data_.str_list_->value.size();
 
-      case DataValue::INT_LIST: return a.data_.int_list_->size() > b.data_.int_list_->size();
+      case DataValue::INT_LIST: return a.data_.int_list_->value.size() > b.data_.int_list_->value.size();
 
-      case DataValue::DOUBLE_LIST: return a.data_.dou_list_->size() > b.data_.dou_list_->size();
+      case DataValue::DOUBLE_LIST: return a.data_.dou_list_->value.size() > b.data_.dou_list_->value.size();
 
       case DataValue::INT_VALUE: return a.data_.ssize_ > b.data_.ssize_;
 
@@ -766,13 +836,13 @@ namespace OpenMS
   {
     switch (p.value_type_)
     {
-    case DataValue::STRING_VALUE: os << *(p.data_.str_); break;
+    case DataValue::STRING_VALUE: os.write(p.stringData_(), p.stringLength_()); break;
 
-    case DataValue::STRING_LIST: os << *(p.data_.str_list_); break;
+    case DataValue::STRING_LIST: os << p.data_.str_list_->value; break;
 
-    case DataValue::INT_LIST: os << *(p.data_.int_list_); break;
+    case DataValue::INT_LIST: os << p.data_.int_list_->value; break;
 
-    case DataValue::DOUBLE_LIST: os << *(p.data_.dou_list_); break;
+    case DataValue::DOUBLE_LIST: os << p.data_.dou_list_->value; break;
 
     case DataValue::INT_VALUE: os << p.data_.ssize_; break;
 
@@ -787,12 +857,13 @@ namespace OpenMS
 
   const String& DataValue::getUnit() const
   {
-    return unit_;
+    return unit_ != 0 ? unit_->value : empty_unit;
   }
 
   void DataValue::setUnit(const OpenMS::String& unit)
   {
-    unit_ = unit;
+    release(unit_);
+    unit_ = unit.empty() ? 0 : new Shared_<String>(unit);
   }
 
 } //namespace
@@ -34,13 +34,16 @@
 
 #include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 
-#include <OpenMS/CHEMISTRY/IsotopeDistribution.h>
+#include <algorithm>
 
 namespace OpenMS
 {
 
-  IsotopeDistributionCache::IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage, double intensity_percentage_optional) :
-    mass_window_width_(mass_window_width)
+  IsotopeDistributionCache::IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage, double intensity_percentage_optional,
+                                                     Size max_isotopes, IsotopeDistribution::Averagine averagine) :
+    mass_window_width_(mass_window_width),
+    max_isotopes_(max_isotopes),
+    averagine_(averagine)
   {
     Size num_isotopes = std::ceil(max_mass / mass_window_width) + 1;
 
@@ -51,70 +54,127 @@ namespace OpenMS
     for (Size index = 0; index < num_isotopes; ++index)
     {
       //log_ << "Calculating iso dist for mass: " << 0.5*mass_window_width_ + index * mass_window_width_ << std::endl;
-      IsotopeDistribution d;
-      d.setMaxIsotope(20);
-      d.estimateFromPeptideWeight(0.5 * mass_window_width + index * mass_window_width);
-
-      //trim left and right. And store the number of isotopes on the left, to reconstruct the monoisotopic peak
-      Size size_before = d.size();
-      d.trimLeft(intensity_percentage_optional);
-      isotope_distributions_[index].trimmed_left = size_before - d.size();
-      d.trimRight(intensity_percentage_optional);
+      estimate_(0.5 * mass_window_width + index * mass_window_width, intensity_percentage, intensity_percentage_optional, isotope_distributions_[index]);
+    }
+  }
 
-      for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
+  IsotopeDistributionCache::IsotopeDistributionCache(double max_mass, Size max_isotopes, IsotopeDistribution::Averagine averagine) :
+    mass_window_width_(0),
+    max_isotopes_(max_isotopes),
+    averagine_(averagine)
+  {
+    // the averagine composition changes whenever Math::round(mass * factor) of one of the elements
+    // does, i.e. at (k + 0.5) / factor. Collect these masses up to the first one beyond max_mass.
+    std::vector<double> factors;
+    IsotopeDistribution::getAveragineFactors(averagine, factors);
+    for (Size i = 0; i < factors.size(); ++i)
+    {
+      if (factors[i] <= 0)
       {
-        isotope_distributions_[index].intensity.push_back(it->second);
-        //log_ << " - " << it->second << std::endl;
+        continue;
       }
-
-      //determine the number of optional peaks at the beginning/end
-      Size begin = 0;
-      Size end = 0;
-      bool is_begin = true;
-      bool is_end = false;
-      for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
+      for (Size k = 0;; ++k)
       {
-        if (isotope_distributions_[index].intensity[i] < intensity_percentage)
+        double mass = (k + 0.5) / factors[i];
+        window_ends_.push_back(mass);
+        if (mass > max_mass)
         {
-          if (!is_end && !is_begin)
-            is_end = true;
-          if (is_begin)
-            ++begin;
-          else if (is_end)
-            ++end;
-        }
-        else if (is_begin)
-        {
-          is_begin = false;
+          break;
         }
       }
-      isotope_distributions_[index].optional_begin = begin;
-      isotope_distributions_[index].optional_end = end;
+    }
+    std::sort(window_ends_.begin(), window_ends_.end());
+    window_ends_.erase(std::unique(window_ends_.begin(), window_ends_.end()), window_ends_.end());
+    window_ends_.erase(std::upper_bound(window_ends_.begin(), window_ends_.end(), max_mass) + 1, window_ends_.end());
+
+    // one distribution per composition, estimated in the middle of its mass range
+    isotope_distributions_.resize(window_ends_.size());
+    for (Size index = 0; index < window_ends_.size(); ++index)
+    {
+      double window_begin = (index == 0) ? 0.0 : window_ends_[index - 1];
+      estimate_(0.5 * (window_begin + window_ends_[index]), 0, 0, isotope_distributions_[index]);
+    }
+  }
+
+  void IsotopeDistributionCache::estimate_(double mass, double intensity_percentage, double intensity_percentage_optional, TheoreticalIsotopePattern & pattern) const
+  {
+    IsotopeDistribution d;
+    d.setMaxIsotope(max_isotopes_);
+    d.estimateFromAveragineWeight(mass, averagine_);
+
+    //trim left and right. And store the number of isotopes on the left, to reconstruct the monoisotopic peak
+    Size size_before = d.size();
+    d.trimLeft(intensity_percentage_optional);
+    pattern.trimmed_left = size_before - d.size();
+    d.trimRight(intensity_percentage_optional);
+
+    for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
+    {
+      pattern.intensity.push_back(it->second);
+      //log_ << " - " << it->second << std::endl;
+    }
 
-      //scale the distribution to a maximum of 1
-      double max = 0.0;
-      for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
+    //determine the number of optional peaks at the beginning/end
+    Size begin = 0;
+    Size end = 0;
+    bool is_begin = true;
+    bool is_end = false;
+    for (Size i = 0; i < pattern.intensity.size(); ++i)
+    {
+      if (pattern.intensity[i] < intensity_percentage)
       {
-        if (isotope_distributions_[index].intensity[i] > max)
-        {
-          max = isotope_distributions_[index].intensity[i];
-        }
+        if (!is_end && !is_begin)
+          is_end = true;
+        if (is_begin)
+          ++begin;
+        else if (is_end)
+          ++end;
       }
+      else if (is_begin)
+      {
+        is_begin = false;
+      }
+    }
+    pattern.optional_begin = begin;
+    pattern.optional_end = end;
 
-      isotope_distributions_[index].max = max;
-
-      for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
+    //scale the distribution to a maximum of 1
+    double max = 0.0;
+    for (Size i = 0; i < pattern.intensity.size(); ++i)
+    {
+      if (pattern.intensity[i] > max)
       {
-        isotope_distributions_[index].intensity[i] /= max;
+        max = pattern.intensity[i];
       }
     }
+
+    pattern.max = max;
+
+    for (Size i = 0; i < pattern.intensity.size(); ++i)
+    {
+      pattern.intensity[i] /= max;
+    }
+  }
+
+  Size IsotopeDistributionCache::getIndex_(double mass) const
+  {
+    if (mass_window_width_ > 0)
+    {
+      //calculate index in the vector
+      return static_cast<Size>(std::floor(mass / mass_window_width_));
+    }
+    if (mass < 0)
+    {
+      return isotope_distributions_.size();
+    }
+    return std::upper_bound(window_ends_.begin(), window_ends_.end(), mass) - window_ends_.begin();
   }
 
   // Returns the isotope distribution for a certain mass window
   const IsotopeDistributionCache::TheoreticalIsotopePattern& IsotopeDistributionCache::getIsotopeDistribution(double mass) const
   {
     //calculate index in the vector
-    Size index = static_cast<Size>(std::floor(mass / mass_window_width_));
+    Size index = getIndex_(mass);
 
     if (index >= isotope_distributions_.size())
     {
@@ -125,4 +185,53 @@ namespace OpenMS
     return isotope_distributions_[index];
   }
 
+  void IsotopeDistributionCache::getIsotopeProbabilities(double mass, Size nr_isotopes, std::vector<double> & probabilities) const
+  {
+    probabilities.clear();
+
+    Size index = getIndex_(mass);
+    if (index >= isotope_distributions_.size() || nr_isotopes == 0 || nr_isotopes > max_isotopes_)
+    {
+      IsotopeDistribution d;
+      d.setMaxIsotope(nr_isotopes);
+      d.estimateFromAveragineWeight(mass, averagine_);
+      for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
+      {
+        probabilities.push_back(it->second);
+      }
+      return;
+    }
+
+    // undo the scaling (and the trimming on the left) of the cached distribution
+    const TheoreticalIsotopePattern & pattern = isotope_distributions_[index];
+    probabilities.resize(std::min(nr_isotopes, pattern.trimmed_left + pattern.intensity.size()), 0.0);
+    for (Size i = pattern.trimmed_left; i < probabilities.size(); ++i)
+    {
+      probabilities[i] = pattern.intensity[i - pattern.trimmed_left] * pattern.max;
+    }
+  }
+
+  const IsotopeDistributionCache & IsotopeDistributionCache::getAveragineCache(IsotopeDistribution::Averagine averagine)
+  {
+    static IsotopeDistributionCache * caches[IsotopeDistribution::SIZE_OF_AVERAGINE] = { 0 };
+
+    if (averagine >= IsotopeDistribution::SIZE_OF_AVERAGINE)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unknown averagine model", String(averagine));
+    }
+
+    IsotopeDistributionCache * cache = 0;
+#ifdef _OPENMP
+#pragma omp critical (IsotopeDistributionCache_getAveragineCache)
+#endif
+    {
+      if (caches[averagine] == 0)
+      {
+        caches[averagine] = new IsotopeDistributionCache(20000.0, 10, averagine);
+      }
+      cache = caches[averagine];
+    }
+    return *cache;
+  }
+
 }
@@ -38,6 +38,24 @@
 #include <QtCore/QList>
 #include <QtCore/QString>
 
+// SIMD kernels are compiled with function-level target attributes (GCC >=
+// 4.9, clang >= 3.8) or plain intrinsics (MSVC) and selected at runtime, so
+// no special compiler flags are needed for this file.
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  ((defined(__clang__) && (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8))) || \
+  (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define OPENMS_BASE64_SIMD
+#define OPENMS_BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define OPENMS_BASE64_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1700 && (defined(_M_X64) || defined(_M_IX86))
+#define OPENMS_BASE64_SIMD
+#define OPENMS_BASE64_TARGET_SSSE3
+#define OPENMS_BASE64_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 using namespace std;
 
 namespace OpenMS
@@ -52,81 +70,324 @@ namespace OpenMS
 
     binary  ->    char = val
 
-       0    ->     A   = 65  
-                   ...     
-      25    ->     Z   = 90  
-      26    ->     a   = 97  
-                   ...     
-      51    ->     z   = 122 
-      52    ->     0   = 48  
-                   ...     
-      61    ->     9   = 57  
-      62    ->     +   = 43  
-      63    ->     /   = 47  
-      
-   
-   While decoding we have to map a character to its base 64 target using the
-   base 64 mapping:
-
-    char = val      ->      target 
-   
-     A   = 65       ->        0
-     ...     
-     Z   = 90       ->       25
-     a   = 97       ->       26
-     ...     
-     z   = 122      ->       51
-     0   = 48       ->       52
-     ...     
-     9   = 57       ->       61
-     +   = 43       ->       62
-     /   = 47       ->       63
-
-
-  this can be done by first subtracting 43 from each value
-  and then looking up a value in a table as found in the code,
-  e.g. lookup[char - 43] - 62
-
-  The following string can be produced by this Python snippet:
-
-offset = 62
-s = ""
-s += chr(62 + offset)
-s += '$' * 3
-s += "".join([ chr(52 + i + offset) for i in range(10) ])
-s += '$' * 7
-s += "".join([ chr(i + offset) for i in range(26) ])
-s += '$' * 6
-s += "".join([ chr(26 + i + offset) for i in range(26) ])
-print s
-
-"|$$$rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\]^_`abcdefghijklmnopq"
-
-  however, this is basically just convenience to produce printable characters.
-  We could also go for a direct mapping:
-
-s = '$' * 42
-s += hex(62)
-s += '$' * 3
-s += "".join([ hex(52 + i) for i in range(10) ])
-s += '$' * 7
-s += "".join([ hex(i) for i in range(26) ])
-s += '$' * 6
-s += "".join([ hex(26 + i) for i in range(26) ])
-print s
-
-"$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$0x3e$$$0x340x350x360x370x380x390x3a0x3b0x3c0x3d$$$$$$$0x00x10x20x30x40x50x60x70x80x90xa0xb0xc0xd0xe0xf0x100x110x120x130x140x150x160x170x180x19$$$$$$0x1a0x1b0x1c0x1d0x1e0x1f0x200x210x220x230x240x250x260x270x280x290x2a0x2b0x2c0x2d0x2e0x2f0x300x310x320x33"
-
-  which would allow lookup[char] without any adding or subtraction step (but
-  needs a 42 byte extra memory in the local cache).
+       0    ->     A   = 65
+                   ...
+      25    ->     Z   = 90
+      26    ->     a   = 97
+                   ...
+      51    ->     z   = 122
+      52    ->     0   = 48
+                   ...
+      61    ->     9   = 57
+      62    ->     +   = 43
+      63    ->     /   = 47
+
+   While decoding we map each character directly to its 6 bit value using a
+   table of 256 entries (characters outside of the Base64 alphabet, including
+   the padding character '=', are mapped to 0).
+
+   The table can be produced by this Python snippet:
+
+enc = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+t = [0] * 256
+for i, c in enumerate(enc): t[ord(c)] = i
+print ", ".join([str(v) for v in t])
 
   */
 
-
   const char Base64::encoder_[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  const char Base64::decoder_[] = "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+  const Byte Base64::decoder_[256] =
+  {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 62,  0,  0,  0, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61,  0,  0,  0,  0,  0,  0,
+     0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,  0,  0,  0,  0,  0,
+     0, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+  };
+
+  namespace
+  {
+    /// Cached result of the CPU feature detection (-1: not yet detected)
+    int supported_kernel = -1;
+
+    /// Scalar decoding of @p in_size characters, see Base64::decodeBytes_
+    Size decodeScalar(const char* in, Size in_size, Byte* out, Size max_out, const Byte* table)
+    {
+      Size written = 0;
+      for (Size i = 0; i < in_size && written < max_out; i += 4)
+      {
+        // decode 4 Base64-Chars to 3 Byte (missing characters count as zero)
+        UInt32 a = table[(unsigned char)in[i]];
+        UInt32 b = (i + 1 < in_size) ? table[(unsigned char)in[i + 1]] : 0;
+        UInt32 c = (i + 2 < in_size) ? table[(unsigned char)in[i + 2]] : 0;
+        UInt32 d = (i + 3 < in_size) ? table[(unsigned char)in[i + 3]] : 0;
+        UInt32 int_24bit = (a << 18) | (b << 12) | (c << 6) | d;
+
+        out[written++] = (Byte)(int_24bit >> 16);
+        if (written < max_out) out[written++] = (Byte)(int_24bit >> 8);
+        if (written < max_out) out[written++] = (Byte)(int_24bit);
+      }
+      return written;
+    }
+
+    /// Scalar encoding of @p in_size bytes, see Base64::encodeBytes_
+    Size encodeScalar(const Byte* in, Size in_size, char* out, const char* encoder)
+    {
+      Size written = 0;
+      for (Size i = 0; i < in_size; i += 3)
+      {
+        // construct 24-bit integer from (up to) 3 bytes
+        UInt32 int_24bit = in[i] << 16;
+        if (i + 1 < in_size) int_24bit |= in[i + 1] << 8;
+        if (i + 2 < in_size) int_24bit |= in[i + 2];
+
+        out[written] = encoder[(int_24bit >> 18) & 0x3F];
+        out[written + 1] = encoder[(int_24bit >> 12) & 0x3F];
+        out[written + 2] = (i + 1 < in_size) ? encoder[(int_24bit >> 6) & 0x3F] : '=';
+        out[written + 3] = (i + 2 < in_size) ? encoder[int_24bit & 0x3F] : '=';
+        written += 4;
+      }
+      return written;
+    }
+
+    /// Scalar byte order reversal
+    void swapScalar(Byte* data, Size count, Size element_size)
+    {
+      if (element_size == 4)
+      {
+        for (Size i = 0; i < count; ++i, data += 4)
+        {
+          std::swap(data[0], data[3]);
+          std::swap(data[1], data[2]);
+        }
+      }
+      else
+      {
+        for (Size i = 0; i < count; ++i, data += 8)
+        {
+          std::reverse(data, data + 8);
+        }
+      }
+    }
+
+#ifdef OPENMS_BASE64_SIMD
+
+    /*
+      The SIMD kernels follow the algorithms described by W. Mula and
+      D. Lemire ("Faster Base64 Encoding and Decoding Using AVX2
+      Instructions", ACM Transactions on the Web, 2018): characters are
+      validated and translated with nibble lookup tables (pshufb) and the
+      resulting 6 bit values are packed with multiply-add instructions.
 
-  Base64::Base64()
+      Each kernel only processes full blocks, stops early enough to never
+      read or write beyond the given buffers and returns the number of
+      processed characters (decoding) or bytes (encoding). The remainder is
+      processed by the next smaller kernel. Blocks containing characters
+      outside the Base64 alphabet are decoded with the scalar code.
+    */
+
+    OPENMS_BASE64_TARGET_SSSE3
+    Size decodeSSSE3(const char* in, Size in_size, Byte* out, Size max_out, const Byte* table)
+    {
+      const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+      const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i mask_2f = _mm_set1_epi8(0x2F);
+      const __m128i merge_ab = _mm_set1_epi32(0x01400140);
+      const __m128i merge_abc = _mm_set1_epi32(0x00011000);
+      const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+      // 16 characters yield 12 bytes, but 16 bytes are stored
+      Size i = 0, o = 0;
+      while (i + 24 <= in_size && o + 16 <= max_out)
+      {
+        const __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+        {
+          decodeScalar(in + i, 16, out + o, 12, table);
+        }
+        else
+        {
+          const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask_2f), hi_nibbles));
+          const __m128i values = _mm_add_epi8(str, roll);
+          const __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, merge_ab), merge_abc);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_shuffle_epi8(merged, pack));
+        }
+        i += 16;
+        o += 12;
+      }
+      return i;
+    }
+
+    OPENMS_BASE64_TARGET_AVX2
+    Size decodeAVX2(const char* in, Size in_size, Byte* out, Size max_out, const Byte* table)
+    {
+      const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                                              0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+      const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                              0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+      const __m256i merge_ab = _mm256_set1_epi32(0x01400140);
+      const __m256i merge_abc = _mm256_set1_epi32(0x00011000);
+      const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                            2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+      const __m256i join_lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+      // 32 characters yield 24 bytes, but 32 bytes are stored
+      Size i = 0, o = 0;
+      while (i + 48 <= in_size && o + 32 <= max_out)
+      {
+        const __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())) != 0)
+        {
+          decodeScalar(in + i, 32, out + o, 24, table);
+        }
+        else
+        {
+          const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask_2f), hi_nibbles));
+          const __m256i values = _mm256_add_epi8(str, roll);
+          const __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, merge_ab), merge_abc);
+          const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(merged, pack), join_lanes);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), packed);
+        }
+        i += 32;
+        o += 24;
+      }
+      return i;
+    }
+
+    OPENMS_BASE64_TARGET_SSSE3
+    inline __m128i encodeBlockSSSE3(__m128i input)
+    {
+      // split 3 bytes into 4 x 6 bit values (one per byte)
+      const __m128i shuffled = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+      const __m128i t0 = _mm_and_si128(shuffled, _mm_set1_epi32(0x0FC0FC00));
+      const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+      const __m128i t2 = _mm_and_si128(shuffled, _mm_set1_epi32(0x003F03F0));
+      const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+      const __m128i indices = _mm_or_si128(t1, t3);
+
+      // translate 6 bit values to characters
+      const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+      return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, result), indices);
+    }
+
+    OPENMS_BASE64_TARGET_SSSE3
+    Size encodeSSSE3(const Byte* in, Size in_size, char* out)
+    {
+      // 12 bytes yield 16 characters, but 16 bytes are loaded
+      Size i = 0, o = 0;
+      while (i + 16 <= in_size)
+      {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), encodeBlockSSSE3(input));
+        i += 12;
+        o += 16;
+      }
+      return i;
+    }
+
+    OPENMS_BASE64_TARGET_AVX2
+    Size encodeAVX2(const Byte* in, Size in_size, char* out)
+    {
+      const __m256i split = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+      const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                                 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                 '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+      // 24 bytes yield 32 characters, 12 bytes are taken from each 16 byte load
+      Size i = 0, o = 0;
+      while (i + 28 <= in_size)
+      {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+        const __m256i input = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        const __m256i shuffled = _mm256_shuffle_epi8(input, split);
+        const __m256i t0 = _mm256_and_si256(shuffled, _mm256_set1_epi32(0x0FC0FC00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(shuffled, _mm256_set1_epi32(0x003F03F0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, result), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + o), result);
+        i += 24;
+        o += 32;
+      }
+      return i;
+    }
+
+    OPENMS_BASE64_TARGET_SSSE3
+    Size swapSSSE3(Byte* data, Size count, Size element_size)
+    {
+      const __m128i reverse = (element_size == 4) ?
+                              _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+                              _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      const Size bytes = count * element_size;
+      Size i = 0;
+      for (; i + 16 <= bytes; i += 16)
+      {
+        __m128i* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), reverse));
+      }
+      return i / element_size;
+    }
+
+    OPENMS_BASE64_TARGET_AVX2
+    Size swapAVX2(Byte* data, Size count, Size element_size)
+    {
+      const __m256i reverse = (element_size == 4) ?
+                              _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                               3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12) :
+                              _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                               7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+      const Size bytes = count * element_size;
+      Size i = 0;
+      for (; i + 32 <= bytes; i += 32)
+      {
+        __m256i* p = reinterpret_cast<__m256i*>(data + i);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), reverse));
+      }
+      return i / element_size;
+    }
+
+#endif
+
+  }
+
+  Base64::Base64() :
+    kernel_(getSupportedKernel())
   {
   }
 
@@ -134,6 +395,164 @@ print s
   {
   }
 
+  Base64::Kernel Base64::getSupportedKernel()
+  {
+    if (supported_kernel < 0)
+    {
+      int kernel = KERNEL_SCALAR;
+#if defined(OPENMS_BASE64_SIMD) && defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      const int max_id = info[0];
+      __cpuid(info, 1);
+      const bool ssse3 = (info[2] & (1 << 9)) != 0;
+      const bool os_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+      bool avx2 = false;
+      if (max_id >= 7)
+      {
+        __cpuidex(info, 7, 0);
+        avx2 = os_avx && (info[1] & (1 << 5)) != 0;
+      }
+      if (avx2) kernel = KERNEL_AVX2;
+      else if (ssse3) kernel = KERNEL_SSSE3;
+#elif defined(OPENMS_BASE64_SIMD)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) kernel = KERNEL_AVX2;
+      else if (__builtin_cpu_supports("ssse3")) kernel = KERNEL_SSSE3;
+#endif
+      supported_kernel = kernel; // concurrent detection yields the same result
+    }
+    return static_cast<Kernel>(supported_kernel);
+  }
+
+  void Base64::setKernel(Kernel kernel)
+  {
+    kernel_ = std::min(kernel, getSupportedKernel());
+  }
+
+  Base64::Kernel Base64::getKernel() const
+  {
+    return kernel_;
+  }
+
+  Size Base64::decodeBytes_(const char* in, Size in_size, Byte* out, Size max_out) const
+  {
+    Size in_done = 0;
+#ifdef OPENMS_BASE64_SIMD
+    if (kernel_ == KERNEL_AVX2)
+    {
+      in_done += decodeAVX2(in, in_size, out, max_out, decoder_);
+    }
+    if (kernel_ >= KERNEL_SSSE3)
+    {
+      const Size out_done = in_done / 4 * 3;
+      in_done += decodeSSSE3(in + in_done, in_size - in_done, out + out_done, max_out - out_done, decoder_);
+    }
+#endif
+    const Size out_done = in_done / 4 * 3;
+    return out_done + decodeScalar(in + in_done, in_size - in_done, out + out_done, max_out - out_done, decoder_);
+  }
+
+  Size Base64::encodeBytes_(const Byte* in, Size in_size, char* out) const
+  {
+    Size in_done = 0;
+#ifdef OPENMS_BASE64_SIMD
+    if (kernel_ == KERNEL_AVX2)
+    {
+      in_done += encodeAVX2(in, in_size, out);
+    }
+    if (kernel_ >= KERNEL_SSSE3)
+    {
+      in_done += encodeSSSE3(in + in_done, in_size - in_done, out + in_done / 3 * 4);
+    }
+#endif
+    const Size out_done = in_done / 3 * 4;
+    return out_done + encodeScalar(in + in_done, in_size - in_done, out + out_done, encoder_);
+  }
+
+  void Base64::swapBytes_(Byte* data, Size count, Size element_size) const
+  {
+    Size done = 0;
+#ifdef OPENMS_BASE64_SIMD
+    if (kernel_ == KERNEL_AVX2)
+    {
+      done += swapAVX2(data, count, element_size);
+    }
+    if (kernel_ >= KERNEL_SSSE3)
+    {
+      done += swapSSSE3(data + done * element_size, count - done, element_size);
+    }
+#endif
+    swapScalar(data + done * element_size, count - done, element_size);
+  }
+
+  void Base64::encodeElements_(Byte* data, Size count, Size element_size, ByteOrder to_byte_order, String& out, bool zlib_compression) const
+  {
+    const Size input_bytes = element_size * count;
+    const bool swap = needsByteSwap_(to_byte_order);
+
+    //encode with compression
+    if (zlib_compression)
+    {
+      //Change endianness if necessary
+      if (swap)
+      {
+        swapBytes_(data, count, element_size);
+      }
+
+      unsigned long sourceLen =   (unsigned long)input_bytes;
+      unsigned long compressed_length =       //compressBound((unsigned long)in.size());
+                                        sourceLen + (sourceLen >> 12) + (sourceLen >> 14) + 11; // taken from zlib's compress.c, as we cannot use compressBound*
+      //
+      // (*) compressBound is not defined in the QtCore lib, which forces the linker under windows to link in our zlib.
+      //     This leads to multiply defined symbols as compress() is then defined twice.
+
+      String compressed;
+      int zlib_error;
+      do
+      {
+        compressed.resize(compressed_length);
+        zlib_error = compress(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_length, reinterpret_cast<Bytef*>(data), (unsigned long)input_bytes);
+
+        switch (zlib_error)
+        {
+        case Z_MEM_ERROR:
+          throw Exception::OutOfMemory(__FILE__, __LINE__, __PRETTY_FUNCTION__, compressed_length);
+
+        case Z_BUF_ERROR:
+          compressed_length *= 2;
+        }
+      }
+      while (zlib_error == Z_BUF_ERROR);
+
+      if (zlib_error != Z_OK)
+      {
+        throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Compression error?");
+      }
+
+      out.resize((compressed_length + 2) / 3 * 4); //resize output array in order to have enough space for all characters
+      encodeBytes_(reinterpret_cast<const Byte*>(compressed.c_str()), compressed_length, &out[0]);
+    }
+    //encode without compression
+    else
+    {
+      out.resize((input_bytes + 2) / 3 * 4); //resize output array in order to have enough space for all characters
+
+      // swap and encode blocks of 3 KB (a multiple of 3, 4 and 8 bytes) so
+      // that the swapped data is still in the cache when it is encoded
+      const Size block_bytes = 3072;
+      for (Size done = 0; done < input_bytes; done += block_bytes)
+      {
+        const Size bytes = std::min(block_bytes, input_bytes - done);
+        if (swap)
+        {
+          swapBytes_(data + done, bytes / element_size, element_size);
+        }
+        encodeBytes_(data + done, bytes, &out[done / 3 * 4]);
+      }
+    }
+  }
+
   void Base64::encodeStrings(const std::vector<String>& in, String& out, bool zlib_compression, bool append_null_byte)
   {
     out.clear();
@@ -188,43 +607,7 @@ print s
       it = reinterpret_cast<Byte*>(&str[0]);
       end = it + str.size();
     }
-    Byte* to = reinterpret_cast<Byte*>(&out[0]);
-    Size written = 0;
-
-    while (it != end)
-    {
-      Int int_24bit = 0;
-      Int padding_count = 0;
-
-      // construct 24-bit integer from 3 bytes
-      for (Size i = 0; i < 3; i++)
-      {
-        if (it != end)
-        {
-          int_24bit |= *it++ << ((2 - i) * 8);
-        }
-        else
-        {
-          padding_count++;
-        }
-      }
-
-      // write out 4 characters
-      for (Int i = 3; i >= 0; i--)
-      {
-        to[i] = encoder_[int_24bit & 0x3F];
-        int_24bit >>= 6;
-      }
-
-      // fixup for padding
-      if (padding_count > 0)
-        to[3] = '=';
-      if (padding_count > 1)
-        to[2] = '=';
-
-      to += 4;
-      written += 4;
-    }
+    Size written = encodeBytes_(it, end - it, &out[0]);
 
     out.resize(written); //no more space is needed
   }
@@ -34,9 +34,28 @@
 
 #include <OpenMS/FORMAT/CachedMzML.h>
 
+#include <cstring>
+
 namespace OpenMS
 {
 
+  namespace
+  {
+    /// size of the trailer at the end of the file (counts, index offset and identifier)
+    const Size TRAILER_SIZE = 2 * sizeof(UInt64) + sizeof(Int64) + sizeof(Int32);
+
+    /// size of the index entry of a single spectrum
+    const Size SPECTRUM_INDEX_ENTRY_SIZE = sizeof(Int64) + sizeof(double) + sizeof(Int32) + 2 * sizeof(double);
+
+    /// copy a single field from a memory buffer (buffers are not necessarily aligned)
+    template <typename T>
+    inline void readField(const char* buffer, Size& pos, T& value)
+    {
+      std::memcpy(&value, buffer + pos, sizeof(T));
+      pos += sizeof(T);
+    }
+  }
+
   CachedmzML::CachedmzML()
   {
   }
@@ -52,17 +71,37 @@ namespace OpenMS
 
     spectra_index_ = rhs.spectra_index_;
     chrom_index_ = rhs.chrom_index_;
+    spectra_index_entries_ = rhs.spectra_index_entries_;
+    np_config_mz_ = rhs.np_config_mz_;
+    np_config_int_ = rhs.np_config_int_;
 
     return *this;
   }
 
+  void CachedmzML::setNumpressConfigurationMassTime(MSNumpressCoder::NumpressConfig config)
+  {
+    np_config_mz_ = config;
+  }
+
+  MSNumpressCoder::NumpressConfig CachedmzML::getNumpressConfigurationMassTime() const
+  {
+    return np_config_mz_;
+  }
+
+  void CachedmzML::setNumpressConfigurationIntensity(MSNumpressCoder::NumpressConfig config)
+  {
+    np_config_int_ = config;
+  }
+
+  MSNumpressCoder::NumpressConfig CachedmzML::getNumpressConfigurationIntensity() const
+  {
+    return np_config_int_;
+  }
+
   void CachedmzML::writeMemdump(MapType& exp, String out)
   {
     std::ofstream ofs(out.c_str(), std::ios::binary);
-    Size exp_size = exp.size();
-    Size chrom_size = exp.getChromatograms().size();
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
-    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    writeHeader_(ofs);
 
     startProgress(0, exp.size() + exp.getChromatograms().size(), "storing binary data");
     for (Size i = 0; i < exp.size(); i++)
@@ -77,8 +116,7 @@ namespace OpenMS
       writeChromatogram_(exp.getChromatograms()[i], ofs);
     }
 
-    ofs.write((char*)&exp_size, sizeof(exp_size));
-    ofs.write((char*)&chrom_size, sizeof(chrom_size));
+    writeFooter_(ofs);
     ofs.close();
     endProgress();
   }
@@ -91,23 +129,11 @@ namespace OpenMS
       throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
     }
 
-    Size exp_size, chrom_size;
-    Peak1D current_peak;
+    UInt64 exp_size, chrom_size;
+    readHeaderAndTrailer_(ifs, filename, exp_size, chrom_size);
 
-    int file_identifier;
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
-    {
-      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
-        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
-    }
-
-    ifs.seekg(0, ifs.end); // set file pointer to end
-    ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
-    ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
-    ifs.read((char*)&exp_size, sizeof(exp_size));
-    ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
+    // spectra and chromatograms are stored consecutively after the header
+    ifs.seekg(sizeof(Int32) + sizeof(Int32), ifs.beg);
 
     exp_reading.reserve(exp_size);
     startProgress(0, exp_size + chrom_size, "reading binary data");
@@ -142,6 +168,66 @@ namespace OpenMS
     return chrom_index_;
   }
 
+  const std::vector<CachedmzML::SpectrumIndexEntry>& CachedmzML::getSpectraIndexEntries() const
+  {
+    return spectra_index_entries_;
+  }
+
+  Int64 CachedmzML::readHeaderAndTrailer_(std::ifstream& ifs, const String& filename, UInt64& exp_size, UInt64& chrom_size) const
+  {
+    Int32 file_identifier = -1, file_version = -1;
+    ifs.seekg(0, ifs.beg);
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    if (!ifs || file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
+    }
+    if (file_version != CACHED_MZML_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Cached mzML file has version " + String(file_version) + " but only version " + 
+        String(CACHED_MZML_FILE_VERSION) + " is supported, please re-create the cached file. Aborting!", filename);
+    }
+
+    // The trailer at the end of the file contains the number of spectra and
+    // chromatograms as well as the position of the index, followed by the
+    // file identifier again (which allows to detect truncated files).
+    ifs.seekg(0, ifs.end);
+    Int64 file_size = static_cast<Int64>(ifs.tellg());
+    Int64 index_offset = -1;
+    Int32 trailer_identifier = -1;
+    if (file_size >= static_cast<Int64>(sizeof(Int32) + sizeof(Int32) + TRAILER_SIZE))
+    {
+      ifs.seekg(file_size - static_cast<Int64>(TRAILER_SIZE), ifs.beg);
+      ifs.read((char*)&exp_size, sizeof(exp_size));
+      ifs.read((char*)&chrom_size, sizeof(chrom_size));
+      ifs.read((char*)&index_offset, sizeof(index_offset));
+      ifs.read((char*)&trailer_identifier, sizeof(trailer_identifier));
+    }
+    const Int64 header_size = static_cast<Int64>(sizeof(Int32) + sizeof(Int32));
+    if (!ifs || trailer_identifier != CACHED_MZML_FILE_IDENTIFIER || index_offset < header_size ||
+        index_offset > file_size - static_cast<Int64>(TRAILER_SIZE))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Cached mzML file is truncated or corrupt (invalid trailer). Aborting!", filename);
+    }
+
+    // The index fills the space between its offset and the trailer. Check
+    // the number of spectra and chromatograms against it, so that a corrupt
+    // trailer cannot cause a huge allocation.
+    const UInt64 index_size = static_cast<UInt64>(file_size - static_cast<Int64>(TRAILER_SIZE) - index_offset);
+    if (exp_size > index_size / SPECTRUM_INDEX_ENTRY_SIZE ||
+        chrom_size * sizeof(Int64) != index_size - exp_size * SPECTRUM_INDEX_ENTRY_SIZE ||
+        chrom_size > index_size / sizeof(Int64))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Cached mzML file is truncated or corrupt (the number of spectra and chromatograms does not match the index). Aborting!", filename);
+    }
+    return index_offset;
+  }
+
   void CachedmzML::createMemdumpIndex(String filename)
   {
     std::ifstream ifs(filename.c_str(), std::ios::binary);
@@ -150,53 +236,53 @@ namespace OpenMS
       throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
     }
 
-    Size exp_size, chrom_size;
-    Peak1D current_peak;
-
-    ifs.seekg(0, ifs.beg); // set file pointer to beginning, start reading
     spectra_index_.clear();
     chrom_index_.clear();
-    int file_identifier;
-    int extra_offset = sizeof(dbl_field_) + sizeof(int_field_);
-    int chrom_offset = 0;
+    spectra_index_entries_.clear();
 
-    ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    UInt64 exp_size, chrom_size;
+    Int64 index_offset = readHeaderAndTrailer_(ifs, filename, exp_size, chrom_size);
+
+    // The index is stored at the end of the file, read it in one go
+    Size index_size = exp_size * SPECTRUM_INDEX_ENTRY_SIZE + chrom_size * sizeof(Int64);
+    std::vector<char> buffer(index_size + 1);
+    ifs.seekg(index_offset, ifs.beg);
+    ifs.read(&buffer[0], index_size);
+    if (!ifs)
     {
       throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
-          "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
+        "Cached mzML file is truncated or corrupt (could not read index). Aborting!", filename);
     }
 
-    // For spectra and chromatograms go through file, read the size of the
-    // spectrum/chromatogram and record the starting index of the element, then
-    // skip ahead to the next spectrum/chromatogram.
-
-    ifs.seekg(0, ifs.end); // set file pointer to end
-    ifs.seekg(ifs.tellg(), ifs.beg); // set file pointer to end, in forward direction
-    ifs.seekg(- static_cast<int>(sizeof(exp_size) + sizeof(chrom_size)), ifs.cur); // move two fields to the left, start reading
-    ifs.read((char*)&exp_size, sizeof(exp_size));
-    ifs.read((char*)&chrom_size, sizeof(chrom_size));
-    ifs.seekg(sizeof(file_identifier), ifs.beg); // set file pointer to beginning (after identifier), start reading
-
-    startProgress(0, exp_size + chrom_size, "Creating index for binary spectra");
+    startProgress(0, exp_size + chrom_size, "Reading index for binary spectra");
+    spectra_index_.reserve(exp_size);
+    spectra_index_entries_.reserve(exp_size);
+    Size pos = 0;
     for (Size i = 0; i < exp_size; i++)
     {
       setProgress(i);
 
-      Size spec_size;
-      spectra_index_.push_back(ifs.tellg());
-      ifs.read((char*)&spec_size, sizeof(spec_size));
-      ifs.seekg(extra_offset + (sizeof(DatumSingleton)) * 2 * (spec_size), ifs.cur);
+      Int64 offset;
+      Int32 ms_level;
+      SpectrumIndexEntry entry;
+      readField(&buffer[0], pos, offset);
+      readField(&buffer[0], pos, entry.rt);
+      readField(&buffer[0], pos, ms_level);
+      readField(&buffer[0], pos, entry.precursor_lower_mz);
+      readField(&buffer[0], pos, entry.precursor_upper_mz);
+      entry.ms_level = ms_level;
+      spectra_index_.push_back(std::streampos(offset));
+      spectra_index_entries_.push_back(entry);
     }
 
+    chrom_index_.reserve(chrom_size);
     for (Size i = 0; i < chrom_size; i++)
     {
       setProgress(i);
 
-      Size ch_size;
-      chrom_index_.push_back(ifs.tellg());
-      ifs.read((char*)&ch_size, sizeof(ch_size));
-      ifs.seekg(chrom_offset + (sizeof(DatumSingleton)) * 2 * (ch_size), ifs.cur);
+      Int64 offset;
+      readField(&buffer[0], pos, offset);
+      chrom_index_.push_back(std::streampos(offset));
     }
 
     ifs.close();
@@ -242,35 +328,219 @@ namespace OpenMS
     MzMLFile().store(out_meta, exp);
   }
 
-  void CachedmzML::readSpectrum_(Datavector& data1, Datavector& data2, std::ifstream& ifs, int& ms_level, double& rt) const
+  void CachedmzML::decodeBinaryArray_(const char* data, UInt64 byte_count, Int32 encoding,
+                                      UInt64 expected_size, Datavector& result)
   {
-    Size spec_size = -1;
-    ifs.read((char*)&spec_size, sizeof(spec_size));
-    ifs.read((char*)&ms_level, sizeof(ms_level));
-    ifs.read((char*)&rt, sizeof(rt));
+    MSNumpressCoder::NumpressConfig config;
+    switch (encoding)
+    {
+    case ENCODING_FLOAT64:
+    {
+      if (byte_count != expected_size * sizeof(double)) break;
+      result.resize(expected_size);
+      if (expected_size > 0) std::memcpy(&result[0], data, byte_count);
+      return;
+    }
+
+    case ENCODING_FLOAT32:
+    {
+      if (byte_count != expected_size * sizeof(float)) break;
+      result.resize(expected_size);
+      float value;
+      for (Size i = 0; i < expected_size; i++)
+      {
+        std::memcpy(&value, data + i * sizeof(float), sizeof(float));
+        result[i] = value;
+      }
+      return;
+    }
 
-    data1.resize(spec_size);
-    data2.resize(spec_size);
+    case ENCODING_NUMPRESS_LINEAR:
+      config.np_compression = MSNumpressCoder::LINEAR;
+      break;
 
-    if (spec_size > 0)
+    case ENCODING_NUMPRESS_PIC:
+      config.np_compression = MSNumpressCoder::PIC;
+      break;
+
+    case ENCODING_NUMPRESS_SLOF:
+      config.np_compression = MSNumpressCoder::SLOF;
+      break;
+
+    default:
+      break;
+    }
+
+    if (config.np_compression != MSNumpressCoder::NONE)
     {
-      ifs.read((char*)&data1[0], spec_size * sizeof(DatumSingleton));
-      ifs.read((char*)&data2[0], spec_size * sizeof(DatumSingleton));
+      try
+      {
+        MSNumpressCoder().decodeNPRaw(reinterpret_cast<const unsigned char*>(data), byte_count, result, config);
+      }
+      catch (Exception::ConversionError&)
+      {
+        result.clear();
+      }
+      if (result.size() == expected_size) return;
     }
+
+    throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+      "Could not decode binary data array with encoding " + String(encoding) + ", something is wrong here. Aborting.", "filestream");
   }
 
-  void CachedmzML::readChromatogram_(Datavector& data1, Datavector& data2, std::ifstream& ifs) const
+  void CachedmzML::readBinaryArray_(std::ifstream& ifs, UInt64 expected_size, Datavector& result)
   {
-    Size spec_size = -1;
-    ifs.read((char*)&spec_size, sizeof(spec_size));
-    data1.resize(spec_size);
-    data2.resize(spec_size);
+    Int32 encoding = -1;
+    UInt64 byte_count = 0;
+    ifs.read((char*)&encoding, sizeof(encoding));
+    ifs.read((char*)&byte_count, sizeof(byte_count));
+    // uncompressed data can never be larger than 8 bytes per value
+    if (!ifs || byte_count > expected_size * sizeof(double) + 16)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid binary data array length, something is wrong here. Aborting.", "filestream");
+    }
 
-    if (spec_size > 0)
+    if (encoding == ENCODING_FLOAT64 && byte_count == expected_size * sizeof(double))
     {
-      ifs.read((char*)&data1[0], spec_size * sizeof(DatumSingleton));
-      ifs.read((char*)&data2[0], spec_size * sizeof(DatumSingleton));
+      // read directly into the result
+      result.resize(expected_size);
+      if (expected_size > 0) ifs.read((char*)&result[0], byte_count);
+      return;
     }
+
+    std::vector<char> buffer(byte_count + 1);
+    ifs.read(&buffer[0], byte_count);
+    decodeBinaryArray_(&buffer[0], byte_count, encoding, expected_size, result);
+  }
+
+  void CachedmzML::readBinaryArray_(const char* buffer, Size buffer_size, Size& pos,
+                                    UInt64 expected_size, Datavector& result)
+  {
+    Int32 encoding = -1;
+    UInt64 byte_count = 0;
+    if (buffer_size - pos < sizeof(encoding) + sizeof(byte_count))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid binary data array length, something is wrong here. Aborting.", "memory buffer");
+    }
+    readField(buffer, pos, encoding);
+    readField(buffer, pos, byte_count);
+    if (byte_count > buffer_size - pos)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid binary data array length, something is wrong here. Aborting.", "memory buffer");
+    }
+
+    decodeBinaryArray_(buffer + pos, byte_count, encoding, expected_size, result);
+    pos += byte_count;
+  }
+
+  void CachedmzML::readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
+                                    OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level,
+                                    double& rt)
+  {
+    UInt64 spec_size = -1;
+    Int32 level = -1;
+    ifs.read((char*) &spec_size, sizeof(spec_size));
+    ifs.read((char*) &level, sizeof(level));
+    ifs.read((char*) &rt, sizeof(rt));
+
+    if (!ifs || static_cast<Int64>(spec_size) < 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid spectrum length, something is wrong here. Aborting.", "filestream");
+    }
+    ms_level = level;
+
+    readBinaryArray_(ifs, spec_size, data1->data);
+    readBinaryArray_(ifs, spec_size, data2->data);
+  }
+
+  void CachedmzML::readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
+                                        OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs)
+  {
+    UInt64 chrom_size = -1;
+    ifs.read((char*) &chrom_size, sizeof(chrom_size));
+
+    if (!ifs || static_cast<Int64>(chrom_size) < 0)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid chromatogram length, something is wrong here. Aborting.", "filestream");
+    }
+
+    readBinaryArray_(ifs, chrom_size, data1->data);
+    readBinaryArray_(ifs, chrom_size, data2->data);
+  }
+
+  void CachedmzML::readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1,
+                                    OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size,
+                                    Size pos, int& ms_level, double& rt)
+  {
+    UInt64 spec_size = -1;
+    Int32 level = -1;
+    const Size header_size = sizeof(spec_size) + sizeof(level) + sizeof(rt);
+    if (pos > buffer_size || buffer_size - pos < header_size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid spectrum length, something is wrong here. Aborting.", "memory buffer");
+    }
+
+    readField(buffer, pos, spec_size);
+    readField(buffer, pos, level);
+    readField(buffer, pos, rt);
+
+    // each value needs at least half a byte (numpress), check for truncated buffers
+    if (static_cast<Int64>(spec_size) < 0 || spec_size > 2 * (buffer_size - pos))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid spectrum length, something is wrong here. Aborting.", "memory buffer");
+    }
+    ms_level = level;
+
+    readBinaryArray_(buffer, buffer_size, pos, spec_size, data1->data);
+    readBinaryArray_(buffer, buffer_size, pos, spec_size, data2->data);
+  }
+
+  void CachedmzML::readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1,
+                                        OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size,
+                                        Size pos)
+  {
+    UInt64 chrom_size = -1;
+    if (pos > buffer_size || buffer_size - pos < sizeof(chrom_size))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid chromatogram length, something is wrong here. Aborting.", "memory buffer");
+    }
+
+    readField(buffer, pos, chrom_size);
+
+    if (static_cast<Int64>(chrom_size) < 0 || chrom_size > 2 * (buffer_size - pos))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+        "Read an invalid chromatogram length, something is wrong here. Aborting.", "memory buffer");
+    }
+
+    readBinaryArray_(buffer, buffer_size, pos, chrom_size, data1->data);
+    readBinaryArray_(buffer, buffer_size, pos, chrom_size, data2->data);
+  }
+
+  void CachedmzML::readSpectrum_(Datavector& data1, Datavector& data2, std::ifstream& ifs, int& ms_level, double& rt) const
+  {
+    OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    readSpectrumFast(mz_array, intensity_array, ifs, ms_level, rt);
+    data1.swap(mz_array->data);
+    data2.swap(intensity_array->data);
+  }
+
+  void CachedmzML::readChromatogram_(Datavector& data1, Datavector& data2, std::ifstream& ifs) const
+  {
+    OpenSwath::BinaryDataArrayPtr rt_array(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+    readChromatogramFast(rt_array, intensity_array, ifs);
+    data1.swap(rt_array->data);
+    data2.swap(intensity_array->data);
   }
 
   void CachedmzML::readSpectrum_(SpectrumType& spectrum, std::ifstream& ifs) const
@@ -312,56 +582,145 @@ namespace OpenMS
 
   }
 
-  void CachedmzML::writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs)
+  void CachedmzML::writeHeader_(std::ofstream& ofs)
+  {
+    spectra_index_.clear();
+    chrom_index_.clear();
+    spectra_index_entries_.clear();
+
+    Int32 file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+    Int32 file_version = CACHED_MZML_FILE_VERSION;
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&file_version, sizeof(file_version));
+  }
+
+  void CachedmzML::writeFooter_(std::ofstream& ofs)
   {
-    Size exp_size = spectrum.size();
+    Int64 index_offset = static_cast<Int64>(ofs.tellp());
+
+    for (Size i = 0; i < spectra_index_.size(); i++)
+    {
+      Int64 offset = static_cast<Int64>(spectra_index_[i]);
+      Int32 ms_level = spectra_index_entries_[i].ms_level;
+      ofs.write((char*)&offset, sizeof(offset));
+      ofs.write((char*)&spectra_index_entries_[i].rt, sizeof(double));
+      ofs.write((char*)&ms_level, sizeof(ms_level));
+      ofs.write((char*)&spectra_index_entries_[i].precursor_lower_mz, sizeof(double));
+      ofs.write((char*)&spectra_index_entries_[i].precursor_upper_mz, sizeof(double));
+    }
+    for (Size i = 0; i < chrom_index_.size(); i++)
+    {
+      Int64 offset = static_cast<Int64>(chrom_index_[i]);
+      ofs.write((char*)&offset, sizeof(offset));
+    }
+
+    UInt64 exp_size = spectra_index_.size();
+    UInt64 chrom_size = chrom_index_.size();
+    Int32 file_identifier = CACHED_MZML_FILE_IDENTIFIER;
     ofs.write((char*)&exp_size, sizeof(exp_size));
-    int_field_ = spectrum.getMSLevel();
-    ofs.write((char*)&int_field_, sizeof(int_field_));
-    dbl_field_ = spectrum.getRT();
-    ofs.write((char*)&dbl_field_, sizeof(dbl_field_));
+    ofs.write((char*)&chrom_size, sizeof(chrom_size));
+    ofs.write((char*)&index_offset, sizeof(index_offset));
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+  }
 
-    // Catch empty spectrum: we do not write any data and since the "size" we
-    // just wrote is zero, no data will be read
-    if (spectrum.empty())
+  void CachedmzML::writeBinaryArray_(const Datavector& data, const MSNumpressCoder::NumpressConfig& config,
+                                     bool single_precision, std::ofstream& ofs)
+  {
+    Int32 encoding = single_precision ? ENCODING_FLOAT32 : ENCODING_FLOAT64;
+    if (config.np_compression != MSNumpressCoder::NONE && !data.empty())
     {
-      return;
+      String numpressed;
+      MSNumpressCoder().encodeNPRaw(data, numpressed, config);
+      // fall back to uncompressed storage if the error tolerance cannot be met
+      if (!numpressed.empty())
+      {
+        switch (config.np_compression)
+        {
+        case MSNumpressCoder::LINEAR: encoding = ENCODING_NUMPRESS_LINEAR; break;
+        case MSNumpressCoder::PIC: encoding = ENCODING_NUMPRESS_PIC; break;
+        case MSNumpressCoder::SLOF: encoding = ENCODING_NUMPRESS_SLOF; break;
+        default: break;
+        }
+        UInt64 byte_count = numpressed.size();
+        ofs.write((char*)&encoding, sizeof(encoding));
+        ofs.write((char*)&byte_count, sizeof(byte_count));
+        ofs.write(numpressed.c_str(), byte_count);
+        return;
+      }
+    }
+
+    if (single_precision)
+    {
+      std::vector<float> float_data(data.begin(), data.end());
+      UInt64 byte_count = float_data.size() * sizeof(float);
+      ofs.write((char*)&encoding, sizeof(encoding));
+      ofs.write((char*)&byte_count, sizeof(byte_count));
+      if (!float_data.empty()) ofs.write((char*)&float_data.front(), byte_count);
+    }
+    else
+    {
+      UInt64 byte_count = data.size() * sizeof(double);
+      ofs.write((char*)&encoding, sizeof(encoding));
+      ofs.write((char*)&byte_count, sizeof(byte_count));
+      if (!data.empty()) ofs.write((char*)&data.front(), byte_count);
+    }
+  }
+
+  void CachedmzML::writeSpectrum_(const SpectrumType& spectrum, std::ofstream& ofs)
+  {
+    SpectrumIndexEntry entry;
+    entry.rt = spectrum.getRT();
+    entry.ms_level = spectrum.getMSLevel();
+    if (!spectrum.getPrecursors().empty())
+    {
+      const Precursor& prec = spectrum.getPrecursors()[0];
+      entry.precursor_lower_mz = prec.getMZ() - prec.getIsolationWindowLowerOffset();
+      entry.precursor_upper_mz = prec.getMZ() + prec.getIsolationWindowUpperOffset();
     }
+    spectra_index_.push_back(ofs.tellp());
+    spectra_index_entries_.push_back(entry);
+
+    UInt64 exp_size = spectrum.size();
+    Int32 ms_level = spectrum.getMSLevel();
+    double rt = spectrum.getRT();
+    ofs.write((char*)&exp_size, sizeof(exp_size));
+    ofs.write((char*)&ms_level, sizeof(ms_level));
+    ofs.write((char*)&rt, sizeof(rt));
 
     Datavector mz_data;
     Datavector int_data;
+    mz_data.reserve(spectrum.size());
+    int_data.reserve(spectrum.size());
     for (Size j = 0; j < spectrum.size(); j++)
     {
       mz_data.push_back(spectrum[j].getMZ());
       int_data.push_back(spectrum[j].getIntensity());
     }
 
-    ofs.write((char*)&mz_data.front(), mz_data.size() * sizeof(mz_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+    writeBinaryArray_(mz_data, np_config_mz_, false, ofs);
+    writeBinaryArray_(int_data, np_config_int_, true, ofs);
   }
 
   void CachedmzML::writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs)
   {
-    Size exp_size = chromatogram.size();
-    ofs.write((char*)&exp_size, sizeof(exp_size));
+    chrom_index_.push_back(ofs.tellp());
 
-    // Catch empty chromatogram: we do not write any data and since the "size" we
-    // just wrote is zero, no data will be read
-    if (chromatogram.empty())
-    {
-      return;
-    }
+    UInt64 exp_size = chromatogram.size();
+    ofs.write((char*)&exp_size, sizeof(exp_size));
 
     Datavector rt_data;
     Datavector int_data;
+    rt_data.reserve(chromatogram.size());
+    int_data.reserve(chromatogram.size());
     for (Size j = 0; j < chromatogram.size(); j++)
     {
       rt_data.push_back(chromatogram[j].getRT());
       int_data.push_back(chromatogram[j].getIntensity());
     }
-    ofs.write((char*)&rt_data.front(), rt_data.size() * sizeof(rt_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+
+    // chromatogram intensities are double, storing them as float would lose precision
+    writeBinaryArray_(rt_data, np_config_mz_, false, ofs);
+    writeBinaryArray_(int_data, np_config_int_, false, ofs);
   }
 
 }
-
@@ -0,0 +1,377 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/ColumnarTableFile.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <boost/spirit/include/qi.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    enum ColumnType
+    {
+      NUMBERS = 0,
+      TEXT = 1
+    };
+
+    /// parses @p value as a number (rejects text such as "nan" or "inf", which is kept as text)
+    inline bool parseNumber(const String& value, double& number)
+    {
+      Size pos = (!value.empty() && (value[0] == '-' || value[0] == '+')) ? 1 : 0;
+      if (pos >= value.size() || !(std::isdigit((unsigned char)value[pos]) || value[pos] == '.'))
+      {
+        return false;
+      }
+      String::ConstIterator it = value.begin();
+      return boost::spirit::qi::parse(it, value.end(), boost::spirit::qi::double_, number) && it == value.end();
+    }
+
+    template <typename T>
+    inline void writeValue(std::ofstream& ofs, const T& value)
+    {
+      ofs.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T>
+    inline void writeArray(std::ofstream& ofs, const std::vector<T>& values)
+    {
+      if (!values.empty())
+      {
+        ofs.write((const char*)&values[0], values.size() * sizeof(T));
+      }
+    }
+
+    inline void writeString(std::ofstream& ofs, const String& value)
+    {
+      writeValue(ofs, static_cast<UInt64>(value.size()));
+      ofs.write(value.c_str(), value.size());
+    }
+
+    inline void throwCorruptFile(const String& filename)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Columnar table file is truncated or corrupt. Aborting!", filename);
+    }
+
+    template <typename T>
+    inline void readValue(std::ifstream& ifs, const String& filename, T& value)
+    {
+      ifs.read((char*)&value, sizeof(T));
+      if (!ifs)
+      {
+        throwCorruptFile(filename);
+      }
+    }
+
+    /// reads @p count elements, @p file_size is used to reject corrupt counts before allocating memory
+    template <typename T>
+    inline void readArray(std::ifstream& ifs, const String& filename, Int64 file_size, UInt64 count, std::vector<T>& values)
+    {
+      Int64 remaining = file_size - static_cast<Int64>(ifs.tellg());
+      if (remaining < 0 || count > static_cast<UInt64>(remaining) / sizeof(T))
+      {
+        throwCorruptFile(filename);
+      }
+      values.resize(count);
+      if (count > 0)
+      {
+        ifs.read((char*)&values[0], count * sizeof(T));
+        if (!ifs)
+        {
+          throwCorruptFile(filename);
+        }
+      }
+    }
+
+    inline void readString(std::ifstream& ifs, const String& filename, Int64 file_size, String& value)
+    {
+      UInt64 size;
+      readValue(ifs, filename, size);
+      std::vector<char> buffer;
+      readArray(ifs, filename, file_size, size, buffer);
+      value = buffer.empty() ? String() : String(&buffer[0], &buffer[0] + buffer.size());
+    }
+
+    /// text of a value of a numeric block
+    inline String numberToString(double number)
+    {
+      return (number != number) ? String() : String(number);
+    }
+
+    /// converts a numeric column (read so far) to a text column
+    void convertToText(ColumnarTableFile::Column& column)
+    {
+      column.strings.reserve(column.numbers.size());
+      for (Size i = 0; i < column.numbers.size(); ++i)
+      {
+        column.strings.push_back(numberToString(column.numbers[i]));
+      }
+      column.numbers.clear();
+      column.numeric = false;
+    }
+  }
+
+  ColumnarTableFile::ColumnarTableFile() :
+    rows_per_block_(0),
+    block_rows_(0)
+  {
+  }
+
+  ColumnarTableFile::~ColumnarTableFile()
+  {
+    close();
+  }
+
+  void ColumnarTableFile::create(const String& filename, const std::vector<String>& column_names, Size rows_per_block)
+  {
+    if (isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "A table is already being written to '" + filename_ + "'.");
+    }
+    ofs_.open(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs_)
+    {
+      ofs_.clear();
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    filename_ = filename;
+    rows_per_block_ = std::max(rows_per_block, Size(1));
+    block_rows_ = 0;
+    block_.assign(column_names.size(), std::vector<String>());
+
+    writeValue(ofs_, static_cast<Int32>(COLUMNAR_TABLE_FILE_IDENTIFIER));
+    writeValue(ofs_, static_cast<Int32>(COLUMNAR_TABLE_FILE_VERSION));
+    writeValue(ofs_, static_cast<UInt64>(column_names.size()));
+    for (Size i = 0; i < column_names.size(); ++i)
+    {
+      writeString(ofs_, column_names[i]);
+    }
+  }
+
+  void ColumnarTableFile::addRow(const std::vector<String>& values)
+  {
+    if (!isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "No table is being written.");
+    }
+    if (values.size() > block_.size())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Row has " + String(values.size()) + " values, but the table has only " + String(block_.size()) + " columns.");
+    }
+    for (Size i = 0; i < block_.size(); ++i)
+    {
+      block_[i].push_back(i < values.size() ? values[i] : String());
+    }
+    if (++block_rows_ >= rows_per_block_)
+    {
+      writeBlock_();
+    }
+  }
+
+  void ColumnarTableFile::writeBlock_()
+  {
+    if (block_rows_ == 0) return;
+
+    writeValue(ofs_, static_cast<UInt64>(block_rows_));
+    std::vector<double> numbers(block_rows_);
+    std::vector<UInt32> lengths(block_rows_);
+    for (Size i = 0; i < block_.size(); ++i)
+    {
+      const std::vector<String>& values = block_[i];
+      bool numeric = true;
+      for (Size k = 0; k < block_rows_ && numeric; ++k)
+      {
+        if (values[k].empty())
+        {
+          numbers[k] = std::numeric_limits<double>::quiet_NaN();
+        }
+        else
+        {
+          numeric = parseNumber(values[k], numbers[k]);
+        }
+      }
+
+      if (numeric)
+      {
+        writeValue(ofs_, static_cast<Byte>(NUMBERS));
+        writeArray(ofs_, numbers);
+      }
+      else
+      {
+        writeValue(ofs_, static_cast<Byte>(TEXT));
+        for (Size k = 0; k < block_rows_; ++k)
+        {
+          lengths[k] = static_cast<UInt32>(values[k].size());
+        }
+        writeArray(ofs_, lengths);
+        for (Size k = 0; k < block_rows_; ++k)
+        {
+          ofs_.write(values[k].c_str(), values[k].size());
+        }
+      }
+      block_[i].clear();
+    }
+    block_rows_ = 0;
+  }
+
+  void ColumnarTableFile::close()
+  {
+    if (!isOpen()) return;
+
+    writeBlock_();
+    writeValue(ofs_, static_cast<UInt64>(0));
+    writeValue(ofs_, static_cast<Int32>(COLUMNAR_TABLE_FILE_IDENTIFIER));
+    ofs_.close();
+    block_.clear();
+  }
+
+  bool ColumnarTableFile::isOpen() const
+  {
+    return ofs_.is_open();
+  }
+
+  void ColumnarTableFile::load(const String& filename, std::vector<Column>& columns) const
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+    if (ifs.fail())
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    ifs.seekg(0, ifs.end);
+    Int64 file_size = static_cast<Int64>(ifs.tellg());
+    ifs.seekg(0, ifs.beg);
+
+    // header
+    Int32 file_identifier = -1, file_version = -1;
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    if (!ifs || file_identifier != COLUMNAR_TABLE_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "File might not be a columnar table file (wrong file magic number). Aborting!", filename);
+    }
+    if (file_version != COLUMNAR_TABLE_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Columnar table file has version " + String(file_version) + " but only version " +
+        String(COLUMNAR_TABLE_FILE_VERSION) + " is supported. Aborting!", filename);
+    }
+
+    UInt64 column_count;
+    readValue(ifs, filename, column_count);
+    // every column name takes at least 8 bytes
+    if (column_count > static_cast<UInt64>(file_size) / sizeof(UInt64))
+    {
+      throwCorruptFile(filename);
+    }
+    columns.assign(column_count, Column());
+    for (Size i = 0; i < columns.size(); ++i)
+    {
+      readString(ifs, filename, file_size, columns[i].name);
+    }
+
+    // blocks
+    std::vector<double> numbers;
+    std::vector<UInt32> lengths;
+    std::vector<char> characters;
+    UInt64 rows;
+    readValue(ifs, filename, rows);
+    while (rows > 0)
+    {
+      for (Size i = 0; i < columns.size(); ++i)
+      {
+        Column& column = columns[i];
+        Byte type;
+        readValue(ifs, filename, type);
+        if (type == NUMBERS)
+        {
+          readArray(ifs, filename, file_size, rows, numbers);
+          if (column.numeric)
+          {
+            column.numbers.insert(column.numbers.end(), numbers.begin(), numbers.end());
+          }
+          else
+          {
+            for (Size k = 0; k < numbers.size(); ++k)
+            {
+              column.strings.push_back(numberToString(numbers[k]));
+            }
+          }
+        }
+        else if (type == TEXT)
+        {
+          readArray(ifs, filename, file_size, rows, lengths);
+          UInt64 total_length = 0;
+          for (Size k = 0; k < lengths.size(); ++k)
+          {
+            total_length += lengths[k];
+          }
+          readArray(ifs, filename, file_size, total_length, characters);
+          if (column.numeric)
+          {
+            convertToText(column);
+          }
+          const char* value = characters.empty() ? 0 : &characters[0];
+          for (Size k = 0; k < lengths.size(); ++k)
+          {
+            column.strings.push_back(lengths[k] == 0 ? String() : String(value, value + lengths[k]));
+            value += lengths[k];
+          }
+        }
+        else
+        {
+          throwCorruptFile(filename);
+        }
+      }
+      readValue(ifs, filename, rows);
+    }
+
+    // trailer
+    readValue(ifs, filename, file_identifier);
+    if (file_identifier != COLUMNAR_TABLE_FILE_IDENTIFIER)
+    {
+      throwCorruptFile(filename);
+    }
+  }
+
+}
@@ -129,6 +129,7 @@ namespace OpenMS
     targetMap[FileTypes::PSQ] = "psq";
     targetMap[FileTypes::MRM] = "mrm";
     targetMap[FileTypes::PSMS] = "psms";
+    targetMap[FileTypes::PEPIDX] = "pepidx";
 
     return targetMap;
   }
@@ -201,6 +201,20 @@ namespace OpenMS
             data_[i].size = data_[i].floats_64.size();
           }
         }
+        else if (data_[i].precision == BinaryData::PRE_32 &&
+                 (data_[i].meta.getName() == "m/z array" || data_[i].meta.getName() == "time array"))
+        {
+          // m/z and RT are doubles: decode and convert in one pass instead
+          // of converting every value from floats_32 later
+          decoder_.decodeAndConvert<float>(data_[i].base64, Base64::BYTEORDER_LITTLEENDIAN, data_[i].floats_64, data_[i].compression);
+          data_[i].precision = BinaryData::PRE_64;
+          if (data_[i].size != data_[i].floats_64.size())
+          {
+            MzMLHandlerHelper::warning(0, String("Float binary data array '") + data_[i].meta.getName() + 
+                "' has length " + data_[i].floats_64.size() + ", but should have length " + data_[i].size + ".");
+            data_[i].size = data_[i].floats_64.size();
+          }
+        }
         else if (data_[i].precision == BinaryData::PRE_32)
         {
           decoder_.decode(data_[i].base64, Base64::BYTEORDER_LITTLEENDIAN, data_[i].floats_32, data_[i].compression);
@@ -37,6 +37,9 @@
 #include <OpenMS/FORMAT/HANDLERS/IndexedMzMLDecoder.h>
 #include <OpenMS/FORMAT/HANDLERS/MzMLSpectrumDecoder.h>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 namespace OpenMS
 {
 
@@ -46,13 +49,16 @@ namespace OpenMS
     // Find offset
     //-------------------------------------------------------------
 
+    spectra_offsets_ = boost::shared_ptr<OffsetVector>(new OffsetVector);
+    chromatograms_offsets_ = boost::shared_ptr<OffsetVector>(new OffsetVector);
+
     index_offset_ = IndexedMzMLDecoder().findIndexListOffset(filename);
-    int res = IndexedMzMLDecoder().parseOffsets(filename, index_offset_, spectra_offsets_, chromatograms_offsets_);
+    int res = IndexedMzMLDecoder().parseOffsets(filename, index_offset_, *spectra_offsets_, *chromatograms_offsets_);
 
     spectra_before_chroms_ = true;
-    if (!spectra_offsets_.empty() && !chromatograms_offsets_.empty())
+    if (!spectra_offsets_->empty() && !chromatograms_offsets_->empty())
     {
-      if (spectra_offsets_[0].second < chromatograms_offsets_[0].second) spectra_before_chroms_ = true;
+      if ((*spectra_offsets_)[0].second < (*chromatograms_offsets_)[0].second) spectra_before_chroms_ = true;
       else spectra_before_chroms_ = false;
     }
 
@@ -60,7 +66,18 @@ namespace OpenMS
     else parsing_success_ = false;
   }
 
-  IndexedMzMLFile::IndexedMzMLFile(String filename) 
+  IndexedMzMLFile::IndexedMzMLFile() :
+    spectra_offsets_(new OffsetVector),
+    chromatograms_offsets_(new OffsetVector),
+    index_offset_(0),
+    spectra_before_chroms_(true),
+    parsing_success_(false),
+    skip_xml_checks_(false)
+  {
+  }
+
+  IndexedMzMLFile::IndexedMzMLFile(String filename) :
+    skip_xml_checks_(false)
   {
     openFile(filename);
   }
@@ -71,9 +88,10 @@ namespace OpenMS
     chromatograms_offsets_(source.chromatograms_offsets_),
     index_offset_(source.index_offset_),
     spectra_before_chroms_(source.spectra_before_chroms_),
-    // do not copy the filestream itself but open a new filestream using the same file
-    filestream_(source.filename_.c_str()),
-    parsing_success_(source.parsing_success_)
+    // the mapping is read-only and can be shared
+    mapped_region_(source.mapped_region_),
+    parsing_success_(source.parsing_success_),
+    skip_xml_checks_(source.skip_xml_checks_)
   {
   }
 
@@ -83,13 +101,24 @@ namespace OpenMS
 
   void IndexedMzMLFile::openFile(String filename) 
   {
-    if (filestream_.is_open())
-    {
-      filestream_.close();
-    }
     filename_ = filename;
-    filestream_.open(filename.c_str());
+    mapped_region_.reset();
     parseFooter_(filename);
+
+    if (!parsing_success_) return;
+
+    // map the whole file read-only into memory; if this is not possible
+    // (e.g. on 32 bit systems), readRange_ falls back to file streams
+    try
+    {
+      boost::interprocess::file_mapping mapping(filename.c_str(), boost::interprocess::read_only);
+      mapped_region_ = boost::shared_ptr<boost::interprocess::mapped_region>(
+          new boost::interprocess::mapped_region(mapping, boost::interprocess::read_only));
+    }
+    catch (boost::interprocess::interprocess_exception& /* e */)
+    {
+      mapped_region_.reset();
+    }
   }
 
   bool IndexedMzMLFile::getParsingSuccess() const
@@ -99,15 +128,15 @@ namespace OpenMS
 
   size_t IndexedMzMLFile::getNrSpectra() const
   {
-    return spectra_offsets_.size();
+    return spectra_offsets_->size();
   }
 
   size_t IndexedMzMLFile::getNrChromatograms() const
   {
-    return chromatograms_offsets_.size();
+    return chromatograms_offsets_->size();
   }
 
-  OpenMS::Interfaces::SpectrumPtr IndexedMzMLFile::getSpectrumById(int id)
+  void IndexedMzMLFile::getSpectrumRange_(int id, std::streampos& startidx, std::streampos& endidx) const
   {
     int spectrumToGet = id;
 
@@ -122,13 +151,13 @@ namespace OpenMS
         "id needs to be smaller than the number of spectra, was " + String(id) 
         + " maximal allowed is " + String(getNrSpectra()) ));
 
-    std::streampos startidx = -1;
-    std::streampos endidx = -1;
+    const OffsetVector& spectra_offsets = *spectra_offsets_;
+    const OffsetVector& chromatograms_offsets = *chromatograms_offsets_;
 
+    startidx = spectra_offsets[spectrumToGet].second;
     if (spectrumToGet == int(getNrSpectra() - 1))
     {
-      startidx = spectra_offsets_[spectrumToGet].second;
-      if (chromatograms_offsets_.empty() || !spectra_before_chroms_)
+      if (chromatograms_offsets.empty() || !spectra_before_chroms_)
       {
         // just take everything until the index starts
         endidx = index_offset_;
@@ -136,41 +165,16 @@ namespace OpenMS
       else
       {
         // just take everything until the chromatograms start
-        endidx = chromatograms_offsets_[0].second;
+        endidx = chromatograms_offsets[0].second;
       }
     }
     else
     {
-      startidx = spectra_offsets_[spectrumToGet].second;
-      endidx = spectra_offsets_[spectrumToGet + 1].second;
+      endidx = spectra_offsets[spectrumToGet + 1].second;
     }
-
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
-
-#ifdef DEBUG_READER
-    // print the full text we just read
-    std::cout << text << std::endl;
-#endif
-
-    OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
-    MzMLSpectrumDecoder d;
-    d.setSkipXMLChecks(skip_xml_checks_ );
-    d.domParseSpectrum(text, sptr);
-
-#ifdef DEBUG_READER
-    std::cout << sptr->getIntensityArray()->data.size() << " int and mz : " << sptr->getMZArray()->data.size() << std::endl;
-#endif
-
-    return sptr;
   }
 
-  OpenMS::Interfaces::ChromatogramPtr IndexedMzMLFile::getChromatogramById(int id)
+  void IndexedMzMLFile::getChromatogramRange_(int id, std::streampos& startidx, std::streampos& endidx) const
   {
     int chromToGet = id;
 
@@ -182,44 +186,186 @@ namespace OpenMS
           String( "id needs to be positive, was " + String(id) ));
     if (chromToGet >= (int)getNrChromatograms())
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, String( 
-        "id needs to be smaller than the number of spectra, was " + String(id) 
-        + " maximal allowed is " + String(getNrSpectra()) ));
+        "id needs to be smaller than the number of chromatograms, was " + String(id) 
+        + " maximal allowed is " + String(getNrChromatograms()) ));
 
-    std::streampos startidx = -1;
-    std::streampos endidx = -1;
+    const OffsetVector& spectra_offsets = *spectra_offsets_;
+    const OffsetVector& chromatograms_offsets = *chromatograms_offsets_;
 
+    startidx = chromatograms_offsets[chromToGet].second;
     if (chromToGet == int(getNrChromatograms() - 1))
     {
-      startidx = chromatograms_offsets_[chromToGet].second;
-      if (spectra_offsets_.empty() || spectra_before_chroms_)
+      if (spectra_offsets.empty() || spectra_before_chroms_)
       {
         // just take everything until the index starts
         endidx = index_offset_;
       }
       else
       {
-        // just take everything until the chromatograms start
-        endidx = spectra_offsets_[0].second;
+        // just take everything until the spectra start
+        endidx = spectra_offsets[0].second;
       }
     }
     else
     {
-      startidx = chromatograms_offsets_[chromToGet].second;
-      endidx = chromatograms_offsets_[chromToGet + 1].second;
+      endidx = chromatograms_offsets[chromToGet + 1].second;
     }
+  }
 
-    std::streampos readl = endidx - startidx;
-    char* buffer = new char[readl + std::streampos(1)];
-    filestream_.seekg(startidx, filestream_.beg);
-    filestream_.read(buffer, readl);
-    buffer[readl] = '\0';
-    std::string text(buffer);
-    delete[] buffer;
+  void IndexedMzMLFile::readRange_(std::streampos startidx, std::streampos endidx, std::string& text) const
+  {
+    if (endidx < startidx || startidx < std::streampos(0))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+          "Invalid offsets in index, cannot read file", filename_);
+    }
+    const size_t start = static_cast<size_t>(startidx);
+    const size_t readl = static_cast<size_t>(endidx - startidx);
+
+    if (mapped_region_)
+    {
+      if (start + readl > mapped_region_->get_size())
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, 
+            "Offsets in index point beyond the end of the file", filename_);
+      }
+      text.assign(static_cast<const char*>(mapped_region_->get_address()) + start, readl);
+    }
+    else
+    {
+      // use a stream per call (no shared file position)
+      std::ifstream filestream(filename_.c_str(), std::ios::binary);
+      text.resize(readl);
+      filestream.seekg(startidx, filestream.beg);
+      if (readl > 0) filestream.read(&text[0], readl);
+      text.resize(filestream.gcount());
+    }
+
+    // the decoders expect a null-terminated string
+    size_t null_pos = text.find('\0');
+    if (null_pos != std::string::npos) text.resize(null_pos);
 
 #ifdef DEBUG_READER
     // print the full text we just read
     std::cout << text << std::endl;
 #endif
+  }
+
+  OpenMS::Interfaces::SpectrumPtr IndexedMzMLFile::getSpectrumById(int id) const
+  {
+    std::streampos startidx = -1;
+    std::streampos endidx = -1;
+    getSpectrumRange_(id, startidx, endidx);
+
+    std::string text;
+    readRange_(startidx, endidx, text);
+
+    OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
+    MzMLSpectrumDecoder d;
+    d.setSkipXMLChecks(skip_xml_checks_ );
+    d.domParseSpectrum(text, sptr);
+
+#ifdef DEBUG_READER
+    std::cout << sptr->getIntensityArray()->data.size() << " int and mz : " << sptr->getMZArray()->data.size() << std::endl;
+#endif
+
+    return sptr;
+  }
+
+  std::vector<OpenMS::Interfaces::SpectrumPtr> IndexedMzMLFile::getSpectraByIds(const std::vector<int>& ids) const
+  {
+    // validate all ids and compute their file regions before reading anything
+    std::vector<std::streampos> startidx(ids.size());
+    std::vector<std::streampos> endidx(ids.size());
+    for (Size i = 0; i < ids.size(); ++i)
+    {
+      getSpectrumRange_(ids[i], startidx[i], endidx[i]);
+    }
+
+    // read runs of consecutive ids (adjacent in the file) at once and split
+    // them into the individual spectra afterwards
+    std::vector<std::string> texts(ids.size());
+    Size run_start = 0;
+    while (run_start < ids.size())
+    {
+      Size run_end = run_start + 1;
+      while (run_end < ids.size() && ids[run_end] == ids[run_end - 1] + 1)
+      {
+        ++run_end;
+      }
+
+      std::string run_text;
+      readRange_(startidx[run_start], endidx[run_end - 1], run_text);
+      for (Size i = run_start; i < run_end; ++i)
+      {
+        const size_t offset = static_cast<size_t>(startidx[i] - startidx[run_start]);
+        if (offset < run_text.size())
+        {
+          texts[i] = run_text.substr(offset, static_cast<size_t>(endidx[i] - startidx[i]));
+        }
+      }
+      run_start = run_end;
+    }
+
+    // decode in parallel (each thread uses its own decoder)
+    std::vector<OpenMS::Interfaces::SpectrumPtr> result(ids.size());
+    boost::shared_ptr<Exception::ParseError> parse_error;
+    String other_error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)texts.size(); ++i)
+    {
+      try
+      {
+        OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
+        MzMLSpectrumDecoder d;
+        d.setSkipXMLChecks(skip_xml_checks_);
+        d.domParseSpectrum(texts[i], sptr);
+        result[i] = sptr;
+      }
+      catch (Exception::ParseError& e)
+      {
+#ifdef _OPENMP
+#pragma omp critical (IndexedMzMLFile_error)
+#endif
+        parse_error = boost::shared_ptr<Exception::ParseError>(new Exception::ParseError(e));
+      }
+      catch (std::exception& e)
+      {
+#ifdef _OPENMP
+#pragma omp critical (IndexedMzMLFile_error)
+#endif
+        other_error = e.what();
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (IndexedMzMLFile_error)
+#endif
+        other_error = "unknown error";
+      }
+    }
+
+    if (parse_error)
+    {
+      throw *parse_error;
+    }
+    if (!other_error.empty())
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__, other_error, filename_);
+    }
+    return result;
+  }
+
+  OpenMS::Interfaces::ChromatogramPtr IndexedMzMLFile::getChromatogramById(int id) const
+  {
+    std::streampos startidx = -1;
+    std::streampos endidx = -1;
+    getChromatogramRange_(id, startidx, endidx);
+
+    std::string text;
+    readRange_(startidx, endidx, text);
 
     OpenMS::Interfaces::ChromatogramPtr sptr(new OpenMS::Interfaces::Chromatogram);
     MzMLSpectrumDecoder d;
@@ -230,68 +230,91 @@ namespace OpenMS
     decodeNPInternal_(reinterpret_cast<const unsigned char*>(in.c_str()), in.size(), out, config);
   }
 
-  void MSNumpressCoder::decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config)
+  namespace
   {
-    out.clear();
-    if (in_size == 0) return;
-
-    size_t byteCount = in_size;
-
-#ifdef NUMPRESS_DEBUG
-    std::cout << "decodeNP_: array input with length " << in_size << std::endl;
-    for (int i = 0; i < in_size; i++)
-    {
-      std::cout << "array[" << i << "] : " << (int)in[i] << std::endl;
-    }
-#endif
-
-    try
+    template <typename T>
+    size_t decodeNPRawImpl(const unsigned char* in, size_t in_size, T* out, size_t out_size, const MSNumpressCoder::NumpressConfig & config)
     {
-      size_t initialSize;
+      if (in_size == 0 || config.np_compression == MSNumpressCoder::NONE) return 0;
 
-      switch (config.np_compression)
+      if (out_size < MSNumpressCoder::getDecodedSizeBound(in_size, config.np_compression))
       {
-      case LINEAR:
-      {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeLinear(in, byteCount, &out[0]);
-        out.resize(count);
-        break;
+        throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Output buffer too small for Numpress decompression");
       }
 
-      case PIC:
+      try
       {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodePic(in, byteCount, &out[0]);
-        out.resize(count);
-        break;
-      }
+        switch (config.np_compression)
+        {
+        case MSNumpressCoder::LINEAR:
+          return numpress::MSNumpress::decodeLinear(in, in_size, out);
 
-      case SLOF:
-      {
-        initialSize = byteCount / 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeSlof(in, byteCount, &out[0]);
-        out.resize(count);
-        break;
-      }
+        case MSNumpressCoder::PIC:
+          return numpress::MSNumpress::decodePic(in, in_size, out);
 
-      case NONE:
+        case MSNumpressCoder::SLOF:
+          return numpress::MSNumpress::decodeSlof(in, in_size, out);
+
+        default:
+          break;
+        }
+      }
+      catch (...)
       {
-        return;
+        throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Error in Numpress decompression");
       }
+      return 0;
+    }
+  }
 
-      default:
-        break;
-      }
+  size_t MSNumpressCoder::getDecodedSizeBound(size_t in_size, NumpressCompression np_compression)
+  {
+    switch (np_compression)
+    {
+    case LINEAR:
+    case PIC:
+      // every value needs at least one halfbyte
+      return in_size * 2;
+
+    case SLOF:
+      // two bytes per value after the fixed point
+      return in_size / 2;
 
+    default:
+      return 0;
     }
-    catch (...)
+  }
+
+  size_t MSNumpressCoder::decodeNPRaw(const unsigned char* in, size_t in_size, double* out, size_t out_size, const NumpressConfig & config)
+  {
+    return decodeNPRawImpl(in, in_size, out, out_size, config);
+  }
+
+  size_t MSNumpressCoder::decodeNPRaw(const unsigned char* in, size_t in_size, float* out, size_t out_size, const NumpressConfig & config)
+  {
+    return decodeNPRawImpl(in, in_size, out, out_size, config);
+  }
+
+  void MSNumpressCoder::decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config)
+  {
+    out.clear();
+    if (in_size == 0) return;
+
+    size_t byteCount = in_size;
+
+#ifdef NUMPRESS_DEBUG
+    std::cout << "decodeNP_: array input with length " << in_size << std::endl;
+    for (int i = 0; i < in_size; i++)
     {
-      throw Exception::ConversionError(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Error in Numpress decompression");
+      std::cout << "array[" << i << "] : " << (int)in[i] << std::endl;
     }
+#endif
+
+    // decode into the (possibly already allocated) output vector
+    size_t initialSize = getDecodedSizeBound(byteCount, config.np_compression);
+    if (out.size() < initialSize) { out.resize(initialSize); }
+    size_t count = decodeNPRaw(in, byteCount, out.empty() ? NULL : &out[0], out.size(), config);
+    out.resize(count);
 
 #ifdef NUMPRESS_DEBUG
     std::cout << "decodeNP_: output size " << out.size() << std::endl;
@@ -0,0 +1,179 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/OnDiscSpectrumCache.h>
+
+namespace OpenMS
+{
+
+  OnDiscSpectrumCache::OnDiscSpectrumCache(Size max_bytes) :
+    max_bytes_(max_bytes),
+    bytes_(0),
+    hits_(0),
+    misses_(0)
+  {
+  }
+
+  OnDiscSpectrumCache::~OnDiscSpectrumCache()
+  {
+  }
+
+  void OnDiscSpectrumCache::setMaxBytes(Size max_bytes)
+  {
+    QMutexLocker locker(&mutex_);
+    max_bytes_ = max_bytes;
+    evict_();
+  }
+
+  Size OnDiscSpectrumCache::getMaxBytes() const
+  {
+    QMutexLocker locker(&mutex_);
+    return max_bytes_;
+  }
+
+  bool OnDiscSpectrumCache::get(Size id, OpenMS::Interfaces::SpectrumPtr& sptr)
+  {
+    QMutexLocker locker(&mutex_);
+    if (max_bytes_ == 0)
+    {
+      return false;
+    }
+
+    std::map<Size, LRUList::iterator>::iterator it = lookup_.find(id);
+    if (it == lookup_.end())
+    {
+      ++misses_;
+      return false;
+    }
+
+    // move to the front (iterators stay valid)
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+    sptr = it->second->spectrum;
+    ++hits_;
+    return true;
+  }
+
+  void OnDiscSpectrumCache::insert(Size id, const OpenMS::Interfaces::SpectrumPtr& sptr)
+  {
+    const Size bytes = estimateBytes(sptr);
+
+    QMutexLocker locker(&mutex_);
+    if (bytes > max_bytes_)
+    {
+      return;
+    }
+
+    std::map<Size, LRUList::iterator>::iterator it = lookup_.find(id);
+    if (it != lookup_.end())
+    {
+      // another thread inserted the same spectrum in the meantime
+      bytes_ -= it->second->bytes;
+      lru_list_.erase(it->second);
+      lookup_.erase(it);
+    }
+
+    CacheEntry entry;
+    entry.id = id;
+    entry.bytes = bytes;
+    entry.spectrum = sptr;
+    lru_list_.push_front(entry);
+    lookup_[id] = lru_list_.begin();
+    bytes_ += bytes;
+    evict_();
+  }
+
+  void OnDiscSpectrumCache::clear()
+  {
+    QMutexLocker locker(&mutex_);
+    lru_list_.clear();
+    lookup_.clear();
+    bytes_ = 0;
+  }
+
+  Size OnDiscSpectrumCache::size() const
+  {
+    QMutexLocker locker(&mutex_);
+    return lookup_.size();
+  }
+
+  Size OnDiscSpectrumCache::getBytes() const
+  {
+    QMutexLocker locker(&mutex_);
+    return bytes_;
+  }
+
+  Size OnDiscSpectrumCache::getHits() const
+  {
+    QMutexLocker locker(&mutex_);
+    return hits_;
+  }
+
+  Size OnDiscSpectrumCache::getMisses() const
+  {
+    QMutexLocker locker(&mutex_);
+    return misses_;
+  }
+
+  void OnDiscSpectrumCache::resetStatistics()
+  {
+    QMutexLocker locker(&mutex_);
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+  Size OnDiscSpectrumCache::estimateBytes(const OpenMS::Interfaces::SpectrumPtr& sptr)
+  {
+    Size bytes = sizeof(OpenMS::Interfaces::Spectrum);
+    if (sptr->getMZArray())
+    {
+      bytes += sizeof(OpenMS::Interfaces::BinaryDataArray) + sptr->getMZArray()->data.capacity() * sizeof(double);
+    }
+    if (sptr->getIntensityArray())
+    {
+      bytes += sizeof(OpenMS::Interfaces::BinaryDataArray) + sptr->getIntensityArray()->data.capacity() * sizeof(double);
+    }
+    return bytes;
+  }
+
+  void OnDiscSpectrumCache::evict_()
+  {
+    while (bytes_ > max_bytes_ && !lru_list_.empty())
+    {
+      bytes_ -= lru_list_.back().bytes;
+      lookup_.erase(lru_list_.back().id);
+      lru_list_.pop_back();
+    }
+  }
+
+} // namespace OpenMS
@@ -0,0 +1,331 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/OnDiscSpectrumIndex.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// Orders spectrum ids by the RT of their index entry
+    struct RTLess
+    {
+      explicit RTLess(const std::vector<OnDiscSpectrumIndex::Entry>& entries) :
+        entries_(entries)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        return entries_[a].rt < entries_[b].rt;
+      }
+
+      bool operator()(Size a, double rt) const
+      {
+        return entries_[a].rt < rt;
+      }
+
+      const std::vector<OnDiscSpectrumIndex::Entry>& entries_;
+    };
+  }
+
+  OnDiscSpectrumIndex::OnDiscSpectrumIndex()
+  {
+  }
+
+  OnDiscSpectrumIndex::~OnDiscSpectrumIndex()
+  {
+  }
+
+  void OnDiscSpectrumIndex::build(const MSExperiment<>& exp)
+  {
+    entries_.clear();
+    entries_.reserve(exp.size());
+    for (Size i = 0; i < exp.size(); ++i)
+    {
+      Entry entry;
+      entry.rt = exp[i].getRT();
+      entry.ms_level = exp[i].getMSLevel();
+      if (!exp[i].getPrecursors().empty())
+      {
+        const Precursor& prec = exp[i].getPrecursors()[0];
+        entry.precursor_lower_mz = prec.getMZ() - prec.getIsolationWindowLowerOffset();
+        entry.precursor_upper_mz = prec.getMZ() + prec.getIsolationWindowUpperOffset();
+      }
+      entries_.push_back(entry);
+    }
+    sortByRT_();
+  }
+
+  const Size OnDiscSpectrumIndex::DataFileStamp::TRAILER_SIZE;
+
+  bool OnDiscSpectrumIndex::load(const String& filename, const DataFileStamp& data_file_stamp)
+  {
+    clear();
+
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if (ifs.fail())
+    {
+      return false;
+    }
+
+    Int32 file_identifier = -1, file_version = -1;
+    DataFileStamp stored_stamp;
+    UInt64 nr_entries = 0;
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    ifs.read((char*)&stored_stamp.file_size, sizeof(UInt64));
+    ifs.read((char*)&stored_stamp.modification_time, sizeof(UInt64));
+    ifs.read((char*)&stored_stamp.trailer_checksum, sizeof(UInt64));
+    ifs.read((char*)&nr_entries, sizeof(nr_entries));
+    if (!ifs || file_identifier != ONDISC_SPECTRUM_INDEX_FILE_IDENTIFIER ||
+        file_version != ONDISC_SPECTRUM_INDEX_FILE_VERSION || stored_stamp != data_file_stamp)
+    {
+      return false;
+    }
+
+    // each entry takes 28 bytes, do not trust nr_entries before the data was read
+    const Size entry_size = sizeof(double) + sizeof(Int32) + 2 * sizeof(double);
+    std::streampos data_start = ifs.tellg();
+    ifs.seekg(0, ifs.end);
+    if (static_cast<UInt64>(ifs.tellg() - data_start) != nr_entries * entry_size)
+    {
+      return false;
+    }
+    ifs.seekg(data_start, ifs.beg);
+
+    entries_.resize(nr_entries);
+    for (Size i = 0; i < entries_.size(); ++i)
+    {
+      Int32 ms_level;
+      ifs.read((char*)&entries_[i].rt, sizeof(double));
+      ifs.read((char*)&ms_level, sizeof(ms_level));
+      ifs.read((char*)&entries_[i].precursor_lower_mz, sizeof(double));
+      ifs.read((char*)&entries_[i].precursor_upper_mz, sizeof(double));
+      entries_[i].ms_level = ms_level;
+    }
+    if (!ifs)
+    {
+      clear();
+      return false;
+    }
+
+    sortByRT_();
+    return true;
+  }
+
+  void OnDiscSpectrumIndex::store(const String& filename, const DataFileStamp& data_file_stamp) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+
+    Int32 file_identifier = ONDISC_SPECTRUM_INDEX_FILE_IDENTIFIER;
+    Int32 file_version = ONDISC_SPECTRUM_INDEX_FILE_VERSION;
+    UInt64 nr_entries = entries_.size();
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&file_version, sizeof(file_version));
+    ofs.write((char*)&data_file_stamp.file_size, sizeof(UInt64));
+    ofs.write((char*)&data_file_stamp.modification_time, sizeof(UInt64));
+    ofs.write((char*)&data_file_stamp.trailer_checksum, sizeof(UInt64));
+    ofs.write((char*)&nr_entries, sizeof(nr_entries));
+    for (Size i = 0; i < entries_.size(); ++i)
+    {
+      Int32 ms_level = entries_[i].ms_level;
+      ofs.write((char*)&entries_[i].rt, sizeof(double));
+      ofs.write((char*)&ms_level, sizeof(ms_level));
+      ofs.write((char*)&entries_[i].precursor_lower_mz, sizeof(double));
+      ofs.write((char*)&entries_[i].precursor_upper_mz, sizeof(double));
+    }
+
+    ofs.close();
+    if (ofs.fail())
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+  }
+
+  OnDiscSpectrumIndex::DataFileStamp OnDiscSpectrumIndex::getDataFileStamp(const String& data_filename)
+  {
+    std::ifstream ifs(data_filename.c_str(), std::ios::binary);
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, data_filename);
+    }
+
+    QFileInfo info(data_filename.toQString());
+    DataFileStamp stamp;
+    stamp.file_size = info.size();
+    stamp.modification_time = info.lastModified().toTime_t();
+
+    // FNV-1a over the trailer (for indexed mzML: index offset and file checksum)
+    const UInt64 trailer_size = std::min<UInt64>(stamp.file_size, DataFileStamp::TRAILER_SIZE);
+    std::vector<char> trailer(trailer_size);
+    ifs.seekg(stamp.file_size - trailer_size, ifs.beg);
+    if (trailer_size > 0)
+    {
+      ifs.read(&trailer[0], trailer_size);
+    }
+    if (!ifs)
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, data_filename);
+    }
+    UInt64 checksum = 14695981039346656037ULL;
+    for (Size i = 0; i < trailer.size(); ++i)
+    {
+      checksum ^= static_cast<unsigned char>(trailer[i]);
+      checksum *= 1099511628211ULL;
+    }
+    stamp.trailer_checksum = checksum;
+    return stamp;
+  }
+
+  String OnDiscSpectrumIndex::getIndexFilename(const String& data_filename)
+  {
+    return data_filename + ".rtidx";
+  }
+
+  Size OnDiscSpectrumIndex::size() const
+  {
+    return entries_.size();
+  }
+
+  bool OnDiscSpectrumIndex::empty() const
+  {
+    return entries_.empty();
+  }
+
+  void OnDiscSpectrumIndex::clear()
+  {
+    entries_.clear();
+    rt_order_.clear();
+  }
+
+  const OnDiscSpectrumIndex::Entry& OnDiscSpectrumIndex::getEntry(Size id) const
+  {
+    return entries_[id];
+  }
+
+  std::vector<Size> OnDiscSpectrumIndex::getSpectraByRT(double rt_min, double rt_max, int ms_level) const
+  {
+    std::vector<Size> result;
+    for (Size i = lowerBound_(rt_min); i < rt_order_.size() && entries_[rt_order_[i]].rt <= rt_max; ++i)
+    {
+      if (ms_level == 0 || entries_[rt_order_[i]].ms_level == ms_level)
+      {
+        result.push_back(rt_order_[i]);
+      }
+    }
+    return result;
+  }
+
+  std::vector<Size> OnDiscSpectrumIndex::getSpectraByPrecursor(double precursor_mz, double rt_min, double rt_max) const
+  {
+    std::vector<Size> result;
+    for (Size i = lowerBound_(rt_min); i < rt_order_.size() && entries_[rt_order_[i]].rt <= rt_max; ++i)
+    {
+      const Entry& entry = entries_[rt_order_[i]];
+      if (entry.ms_level == 2 && entry.precursor_lower_mz <= precursor_mz && precursor_mz <= entry.precursor_upper_mz)
+      {
+        result.push_back(rt_order_[i]);
+      }
+    }
+    return result;
+  }
+
+  Size OnDiscSpectrumIndex::findNearest(double rt, int ms_level) const
+  {
+    const Size pos = lowerBound_(rt);
+
+    // first matching spectrum at or after rt
+    Size after = pos;
+    while (after < rt_order_.size() && ms_level != 0 && entries_[rt_order_[after]].ms_level != ms_level)
+    {
+      ++after;
+    }
+    // last matching spectrum before rt
+    Size before = pos;
+    while (before > 0 && ms_level != 0 && entries_[rt_order_[before - 1]].ms_level != ms_level)
+    {
+      --before;
+    }
+
+    if (after == rt_order_.size() && before == 0)
+    {
+      return entries_.size();
+    }
+    if (after == rt_order_.size())
+    {
+      return rt_order_[before - 1];
+    }
+    if (before == 0)
+    {
+      return rt_order_[after];
+    }
+    if (std::fabs(entries_[rt_order_[before - 1]].rt - rt) < std::fabs(entries_[rt_order_[after]].rt - rt))
+    {
+      return rt_order_[before - 1];
+    }
+    return rt_order_[after];
+  }
+
+  void OnDiscSpectrumIndex::sortByRT_()
+  {
+    rt_order_.resize(entries_.size());
+    for (Size i = 0; i < entries_.size(); ++i)
+    {
+      rt_order_[i] = i;
+    }
+    // stable: spectra with identical RT stay in file order
+    std::stable_sort(rt_order_.begin(), rt_order_.end(), RTLess(entries_));
+  }
+
+  Size OnDiscSpectrumIndex::lowerBound_(double rt) const
+  {
+    return std::lower_bound(rt_order_.begin(), rt_order_.end(), rt, RTLess(entries_)) - rt_order_.begin();
+  }
+
+} // namespace OpenMS
@@ -0,0 +1,620 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/PeptideIndexFile.h>
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace OpenMS
+{
+
+  namespace
+  {
+    /// a digestion product: view on the protein sequence and its location
+    struct DigestedPeptide
+    {
+      StringView sequence;
+      UInt32 protein_index;
+      UInt32 position;
+    };
+
+    /// orders digestion products by sequence, then by location
+    bool digestedPeptideLess(const DigestedPeptide& a, const DigestedPeptide& b)
+    {
+      if (a.sequence < b.sequence) return true;
+      if (b.sequence < a.sequence) return false;
+      if (a.protein_index != b.protein_index) return a.protein_index < b.protein_index;
+      return a.position < b.position;
+    }
+
+    /// orders peptides (given by their index into "masses" and "sequences") by mass, then by sequence
+    struct PeptideMassLess
+    {
+      const std::vector<double>& masses;
+      const std::vector<StringView>& sequences;
+
+      PeptideMassLess(const std::vector<double>& m, const std::vector<StringView>& s) :
+        masses(m),
+        sequences(s)
+      {
+      }
+
+      bool operator()(Size a, Size b) const
+      {
+        if (masses[a] != masses[b]) return masses[a] < masses[b];
+        return sequences[a] < sequences[b];
+      }
+    };
+
+    template <typename T>
+    inline void writeValue(std::ofstream& ofs, const T& value)
+    {
+      ofs.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T>
+    inline void writeArray(std::ofstream& ofs, const std::vector<T>& values)
+    {
+      if (!values.empty())
+      {
+        ofs.write((const char*)&values[0], values.size() * sizeof(T));
+      }
+    }
+
+    inline void writeString(std::ofstream& ofs, const String& value)
+    {
+      writeValue(ofs, static_cast<UInt64>(value.size()));
+      ofs.write(value.c_str(), value.size());
+    }
+
+    inline void throwCorruptFile(const String& filename)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Peptide index file is truncated or corrupt. Aborting!", filename);
+    }
+
+    /// throws a ParseError if the stream failed
+    inline void checkStream(const std::ifstream& ifs, const String& filename)
+    {
+      if (!ifs)
+      {
+        throwCorruptFile(filename);
+      }
+    }
+
+    template <typename T>
+    inline void readValue(std::ifstream& ifs, const String& filename, T& value)
+    {
+      ifs.read((char*)&value, sizeof(T));
+      checkStream(ifs, filename);
+    }
+
+    /// reads @p count elements, @p file_size is used to reject corrupt counts before allocating memory
+    template <typename T>
+    inline void readArray(std::ifstream& ifs, const String& filename, Int64 file_size, UInt64 count, std::vector<T>& values)
+    {
+      Int64 remaining = file_size - static_cast<Int64>(ifs.tellg());
+      if (remaining < 0 || count > static_cast<UInt64>(remaining) / sizeof(T))
+      {
+        throwCorruptFile(filename);
+      }
+      values.resize(count);
+      if (count > 0)
+      {
+        ifs.read((char*)&values[0], count * sizeof(T));
+        checkStream(ifs, filename);
+      }
+    }
+
+    inline void readString(std::ifstream& ifs, const String& filename, Int64 file_size, String& value)
+    {
+      UInt64 size;
+      readValue(ifs, filename, size);
+      std::vector<char> buffer;
+      readArray(ifs, filename, file_size, size, buffer);
+      value = buffer.empty() ? String() : String(&buffer[0], &buffer[0] + buffer.size());
+    }
+  }
+
+  PeptideIndexFile::PeptideIndexFile() :
+    ProgressLogger(),
+    missed_cleavages_(0),
+    min_length_(0),
+    max_length_(0),
+    fragment_bin_size_(0.0)
+  {
+  }
+
+  PeptideIndexFile::~PeptideIndexFile()
+  {
+  }
+
+  void PeptideIndexFile::clear_()
+  {
+    enzyme_name_.clear();
+    missed_cleavages_ = 0;
+    min_length_ = 0;
+    max_length_ = 0;
+    proteins_.clear();
+    peptide_masses_.clear();
+    peptide_lengths_.clear();
+    occurrence_offsets_.clear();
+    occurrences_.clear();
+    fragment_bin_size_ = 0.0;
+    fragment_offsets_.clear();
+    fragment_postings_.clear();
+  }
+
+  void PeptideIndexFile::build(const std::vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length, Size max_length, double fragment_bin_size)
+  {
+    if (proteins.size() > std::numeric_limits<UInt32>::max())
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Too many proteins for a peptide index: " + String(proteins.size()));
+    }
+    for (Size i = 0; i < proteins.size(); ++i)
+    {
+      if (proteins[i].sequence.size() > std::numeric_limits<UInt32>::max())
+      {
+        throw Exception::InvalidParameter(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Protein sequence too long for a peptide index: " + proteins[i].identifier);
+      }
+    }
+
+    clear_();
+    enzyme_name_ = digestion.getEnzymeName();
+    missed_cleavages_ = digestion.getMissedCleavages();
+    min_length_ = min_length;
+    max_length_ = max_length;
+    proteins_ = proteins; // the digestion products are views on these sequences
+
+    // digest all proteins
+    std::vector<std::vector<StringView> > digests(proteins_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)proteins_.size(); ++i)
+    {
+      digestion.digestUnmodifiedString(proteins_[i].sequence, digests[i], min_length, max_length);
+    }
+
+    std::vector<DigestedPeptide> products;
+    for (Size i = 0; i < digests.size(); ++i)
+    {
+      const char* protein_begin = proteins_[i].sequence.data();
+      for (std::vector<StringView>::const_iterator it = digests[i].begin(); it != digests[i].end(); ++it)
+      {
+        DigestedPeptide product;
+        product.sequence = *it;
+        product.protein_index = static_cast<UInt32>(i);
+        product.position = static_cast<UInt32>(it->data() - protein_begin);
+        products.push_back(product);
+      }
+      std::vector<StringView>().swap(digests[i]);
+    }
+    std::sort(products.begin(), products.end(), digestedPeptideLess);
+
+    // distinct peptides: [group_begin[p], group_begin[p + 1]) in "products"
+    std::vector<Size> group_begin;
+    std::vector<StringView> sequences;
+    for (Size i = 0; i < products.size(); ++i)
+    {
+      if (i == 0 || products[i - 1].sequence < products[i].sequence)
+      {
+        group_begin.push_back(i);
+        sequences.push_back(products[i].sequence);
+      }
+    }
+    group_begin.push_back(products.size());
+
+    startProgress(0, sequences.size(), "computing peptide masses");
+    std::vector<double> masses(sequences.size(), 0.0);
+    for (Size p = 0; p < sequences.size(); ++p)
+    {
+      setProgress(p);
+      try
+      {
+        masses[p] = AASequence::fromString(sequences[p].getString()).getMonoWeight();
+      }
+      catch (Exception::BaseException&)
+      {
+        // e.g. unknown amino acids: keep the peptide (for protein mapping), but without a mass
+        masses[p] = 0.0;
+      }
+    }
+    endProgress();
+
+    std::vector<Size> order(sequences.size());
+    for (Size p = 0; p < order.size(); ++p)
+    {
+      order[p] = p;
+    }
+    std::sort(order.begin(), order.end(), PeptideMassLess(masses, sequences));
+
+    peptide_masses_.reserve(order.size());
+    peptide_lengths_.reserve(order.size());
+    occurrence_offsets_.reserve(order.size() + 1);
+    occurrences_.reserve(products.size());
+    occurrence_offsets_.push_back(0);
+    for (Size i = 0; i < order.size(); ++i)
+    {
+      Size p = order[i];
+      peptide_masses_.push_back(masses[p]);
+      peptide_lengths_.push_back(static_cast<UInt32>(sequences[p].size()));
+      for (Size j = group_begin[p]; j < group_begin[p + 1]; ++j)
+      {
+        occurrences_.push_back(PeptideOccurrence(products[j].protein_index, products[j].position));
+      }
+      occurrence_offsets_.push_back(occurrences_.size());
+    }
+
+    if (fragment_bin_size > 0.0)
+    {
+      buildFragmentIndex_(fragment_bin_size);
+    }
+  }
+
+  void PeptideIndexFile::buildFragmentIndex_(double fragment_bin_size)
+  {
+    fragment_bin_size_ = fragment_bin_size;
+
+    // distinct fragment bins of each peptide: [bin_offsets[p], bin_offsets[p + 1]) in "bins"
+    std::vector<UInt32> bins;
+    std::vector<UInt64> bin_offsets(1, 0);
+    bin_offsets.reserve(peptide_masses_.size() + 1);
+    UInt64 bin_count = 0;
+
+    TheoreticalSpectrumGenerator spectrum_generator;
+    startProgress(0, peptide_masses_.size(), "building fragment ion index");
+    for (Size p = 0; p < peptide_masses_.size(); ++p)
+    {
+      setProgress(p);
+      if (peptide_masses_[p] > 0.0)
+      {
+        // b and y ions with charge 1
+        RichPeakSpectrum spectrum;
+        spectrum_generator.getSpectrum(spectrum, AASequence::fromString(getPeptideSequence(p).getString()), 1);
+
+        Size first = bins.size();
+        for (RichPeakSpectrum::ConstIterator it = spectrum.begin(); it != spectrum.end(); ++it)
+        {
+          double bin = std::floor(it->getMZ() / fragment_bin_size_);
+          if (bin >= 0.0 && bin < std::numeric_limits<UInt32>::max())
+          {
+            bins.push_back(static_cast<UInt32>(bin));
+          }
+        }
+        std::sort(bins.begin() + first, bins.end());
+        bins.erase(std::unique(bins.begin() + first, bins.end()), bins.end());
+        if (bins.size() > first)
+        {
+          bin_count = std::max(bin_count, static_cast<UInt64>(bins.back()) + 1);
+        }
+      }
+      bin_offsets.push_back(bins.size());
+    }
+    endProgress();
+
+    // counting sort by bin; peptides are visited in ascending order, so the postings of every bin are sorted
+    fragment_offsets_.assign(bin_count + 1, 0);
+    for (Size i = 0; i < bins.size(); ++i)
+    {
+      ++fragment_offsets_[bins[i] + 1];
+    }
+    for (Size b = 0; b < bin_count; ++b)
+    {
+      fragment_offsets_[b + 1] += fragment_offsets_[b];
+    }
+
+    fragment_postings_.resize(bins.size());
+    std::vector<UInt64> next(fragment_offsets_.begin(), fragment_offsets_.end() - 1);
+    for (Size p = 0; p < peptide_masses_.size(); ++p)
+    {
+      for (UInt64 i = bin_offsets[p]; i < bin_offsets[p + 1]; ++i)
+      {
+        fragment_postings_[next[bins[i]]++] = static_cast<UInt32>(p);
+      }
+    }
+  }
+
+  void PeptideIndexFile::store(const String& filename) const
+  {
+    std::ofstream ofs(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+
+    // header
+    writeValue(ofs, static_cast<Int32>(PEPTIDE_INDEX_FILE_IDENTIFIER));
+    writeValue(ofs, static_cast<Int32>(PEPTIDE_INDEX_FILE_VERSION));
+
+    // settings
+    writeString(ofs, enzyme_name_);
+    writeValue(ofs, static_cast<UInt64>(missed_cleavages_));
+    writeValue(ofs, static_cast<UInt64>(min_length_));
+    writeValue(ofs, static_cast<UInt64>(max_length_));
+    writeValue(ofs, fragment_bin_size_);
+
+    // proteins
+    writeValue(ofs, static_cast<UInt64>(proteins_.size()));
+    for (Size i = 0; i < proteins_.size(); ++i)
+    {
+      writeString(ofs, proteins_[i].identifier);
+      writeString(ofs, proteins_[i].description);
+      writeString(ofs, proteins_[i].sequence);
+    }
+
+    // peptides
+    writeValue(ofs, static_cast<UInt64>(peptide_masses_.size()));
+    writeArray(ofs, peptide_masses_);
+    writeArray(ofs, peptide_lengths_);
+    writeArray(ofs, occurrence_offsets_);
+    std::vector<UInt32> occurrences(2 * occurrences_.size());
+    for (Size i = 0; i < occurrences_.size(); ++i)
+    {
+      occurrences[2 * i] = occurrences_[i].protein_index;
+      occurrences[2 * i + 1] = occurrences_[i].position;
+    }
+    writeValue(ofs, static_cast<UInt64>(occurrences_.size()));
+    writeArray(ofs, occurrences);
+
+    // fragment ion index
+    UInt64 bin_count = fragment_offsets_.empty() ? 0 : fragment_offsets_.size() - 1;
+    writeValue(ofs, bin_count);
+    if (bin_count > 0)
+    {
+      writeArray(ofs, fragment_offsets_);
+    }
+    writeValue(ofs, static_cast<UInt64>(fragment_postings_.size()));
+    writeArray(ofs, fragment_postings_);
+
+    // trailer
+    writeValue(ofs, static_cast<Int32>(PEPTIDE_INDEX_FILE_IDENTIFIER));
+    ofs.close();
+  }
+
+  void PeptideIndexFile::load(const String& filename)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+    if (ifs.fail())
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, __PRETTY_FUNCTION__, filename);
+    }
+    ifs.seekg(0, ifs.end);
+    Int64 file_size = static_cast<Int64>(ifs.tellg());
+    ifs.seekg(0, ifs.beg);
+
+    clear_();
+
+    // header
+    Int32 file_identifier = -1, file_version = -1;
+    ifs.read((char*)&file_identifier, sizeof(file_identifier));
+    ifs.read((char*)&file_version, sizeof(file_version));
+    if (!ifs || file_identifier != PEPTIDE_INDEX_FILE_IDENTIFIER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "File might not be a peptide index file (wrong file magic number). Aborting!", filename);
+    }
+    if (file_version != PEPTIDE_INDEX_FILE_VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, __PRETTY_FUNCTION__,
+        "Peptide index file has version " + String(file_version) + " but only version " +
+        String(PEPTIDE_INDEX_FILE_VERSION) + " is supported, please re-create the index. Aborting!", filename);
+    }
+
+    // settings
+    UInt64 missed_cleavages, min_length, max_length;
+    readString(ifs, filename, file_size, enzyme_name_);
+    readValue(ifs, filename, missed_cleavages);
+    readValue(ifs, filename, min_length);
+    readValue(ifs, filename, max_length);
+    readValue(ifs, filename, fragment_bin_size_);
+    missed_cleavages_ = missed_cleavages;
+    min_length_ = min_length;
+    max_length_ = max_length;
+
+    // proteins
+    UInt64 protein_count;
+    readValue(ifs, filename, protein_count);
+    // every protein needs at least three string sizes
+    if (protein_count > static_cast<UInt64>(file_size) / (3 * sizeof(UInt64)))
+    {
+      throwCorruptFile(filename);
+    }
+    proteins_.resize(protein_count);
+    startProgress(0, protein_count, "reading proteins");
+    for (Size i = 0; i < proteins_.size(); ++i)
+    {
+      setProgress(i);
+      readString(ifs, filename, file_size, proteins_[i].identifier);
+      readString(ifs, filename, file_size, proteins_[i].description);
+      readString(ifs, filename, file_size, proteins_[i].sequence);
+    }
+    endProgress();
+
+    // peptides
+    UInt64 peptide_count, occurrence_count;
+    std::vector<UInt32> occurrences;
+    readValue(ifs, filename, peptide_count);
+    readArray(ifs, filename, file_size, peptide_count, peptide_masses_);
+    readArray(ifs, filename, file_size, peptide_count, peptide_lengths_);
+    readArray(ifs, filename, file_size, peptide_count + 1, occurrence_offsets_);
+    readValue(ifs, filename, occurrence_count);
+    readArray(ifs, filename, file_size, 2 * occurrence_count, occurrences);
+    occurrences_.resize(occurrence_count);
+    for (Size i = 0; i < occurrences_.size(); ++i)
+    {
+      occurrences_[i] = PeptideOccurrence(occurrences[2 * i], occurrences[2 * i + 1]);
+    }
+
+    // fragment ion index
+    UInt64 bin_count, posting_count;
+    readValue(ifs, filename, bin_count);
+    if (bin_count > 0)
+    {
+      readArray(ifs, filename, file_size, bin_count + 1, fragment_offsets_);
+    }
+    readValue(ifs, filename, posting_count);
+    readArray(ifs, filename, file_size, posting_count, fragment_postings_);
+
+    // trailer (detects truncated files)
+    Int32 trailer_identifier = -1;
+    readValue(ifs, filename, trailer_identifier);
+    if (trailer_identifier != PEPTIDE_INDEX_FILE_IDENTIFIER)
+    {
+      throwCorruptFile(filename);
+    }
+
+    // consistency of the offsets (all accesses rely on them)
+    bool consistent = (occurrence_offsets_.front() == 0) && (occurrence_offsets_.back() == occurrence_count);
+    for (Size i = 0; consistent && i < peptide_count; ++i)
+    {
+      consistent = (occurrence_offsets_[i] < occurrence_offsets_[i + 1]);
+    }
+    for (Size i = 0; consistent && i < peptide_count; ++i)
+    {
+      for (UInt64 j = occurrence_offsets_[i]; consistent && j < occurrence_offsets_[i + 1]; ++j)
+      {
+        const PeptideOccurrence& occurrence = occurrences_[j];
+        consistent = (occurrence.protein_index < proteins_.size()) &&
+                     (static_cast<Size>(occurrence.position) + peptide_lengths_[i] <= proteins_[occurrence.protein_index].sequence.size());
+      }
+    }
+    if (bin_count > 0)
+    {
+      consistent = consistent && (fragment_offsets_.front() == 0) && (fragment_offsets_.back() == posting_count);
+      for (Size b = 0; consistent && b < bin_count; ++b)
+      {
+        consistent = (fragment_offsets_[b] <= fragment_offsets_[b + 1]);
+      }
+      for (Size i = 0; consistent && i < fragment_postings_.size(); ++i)
+      {
+        consistent = (fragment_postings_[i] < peptide_count);
+      }
+    }
+    else
+    {
+      consistent = consistent && (posting_count == 0);
+    }
+    if (!consistent)
+    {
+      throwCorruptFile(filename);
+    }
+  }
+
+  const String& PeptideIndexFile::getEnzymeName() const
+  {
+    return enzyme_name_;
+  }
+
+  Size PeptideIndexFile::getMissedCleavages() const
+  {
+    return missed_cleavages_;
+  }
+
+  Size PeptideIndexFile::getMinLength() const
+  {
+    return min_length_;
+  }
+
+  Size PeptideIndexFile::getMaxLength() const
+  {
+    return max_length_;
+  }
+
+  const std::vector<FASTAFile::FASTAEntry>& PeptideIndexFile::getProteins() const
+  {
+    return proteins_;
+  }
+
+  Size PeptideIndexFile::getPeptideCount() const
+  {
+    return peptide_masses_.size();
+  }
+
+  double PeptideIndexFile::getPeptideMass(Size index) const
+  {
+    return peptide_masses_[index];
+  }
+
+  StringView PeptideIndexFile::getPeptideSequence(Size index) const
+  {
+    const PeptideOccurrence& first = occurrences_[occurrence_offsets_[index]];
+    return StringView(proteins_[first.protein_index].sequence).substr(first.position, first.position + peptide_lengths_[index] - 1);
+  }
+
+  void PeptideIndexFile::getPeptideOccurrences(Size index, std::vector<PeptideOccurrence>& occurrences) const
+  {
+    occurrences.assign(occurrences_.begin() + occurrence_offsets_[index], occurrences_.begin() + occurrence_offsets_[index + 1]);
+  }
+
+  std::pair<Size, Size> PeptideIndexFile::getPeptidesInMassRange(double min_mass, double max_mass) const
+  {
+    std::vector<double>::const_iterator first = std::lower_bound(peptide_masses_.begin(), peptide_masses_.end(), min_mass);
+    std::vector<double>::const_iterator last = std::upper_bound(first, peptide_masses_.end(), max_mass);
+    return std::make_pair(Size(first - peptide_masses_.begin()), Size(last - peptide_masses_.begin()));
+  }
+
+  bool PeptideIndexFile::hasFragmentIndex() const
+  {
+    return fragment_bin_size_ > 0.0;
+  }
+
+  double PeptideIndexFile::getFragmentBinSize() const
+  {
+    return fragment_bin_size_;
+  }
+
+  void PeptideIndexFile::getPeptidesWithFragment(double mz, std::vector<Size>& peptides) const
+  {
+    peptides.clear();
+    if (!hasFragmentIndex() || mz < 0.0)
+    {
+      return;
+    }
+    double bin = std::floor(mz / fragment_bin_size_);
+    if (bin + 1.0 >= fragment_offsets_.size())
+    {
+      return; // beyond the last bin (or no bins at all)
+    }
+    Size b = static_cast<Size>(bin);
+    peptides.assign(fragment_postings_.begin() + fragment_offsets_[b], fragment_postings_.begin() + fragment_offsets_[b + 1]);
+  }
+
+}
@@ -7,6 +7,7 @@ Base64.cpp
 Bzip2Ifstream.cpp
 Bzip2InputStream.cpp
 CachedMzML.cpp
+ColumnarTableFile.cpp
 CompressedInputSource.cpp
 CVMappingFile.cpp
 ConsensusXMLFile.cpp
@@ -46,6 +47,8 @@ MzMLFile.cpp
 MzXMLFile.cpp
 OMSSACSVFile.cpp
 OMSSAXMLFile.cpp
+OnDiscSpectrumCache.cpp
+OnDiscSpectrumIndex.cpp
 ParamXMLFile.cpp
 PTMXMLFile.cpp
 PeakTypeEstimator.cpp
@@ -53,6 +56,7 @@ PepNovoInfile.cpp
 PepNovoOutfile.cpp
 PepXMLFile.cpp
 PepXMLFileMascot.cpp
+PeptideIndexFile.cpp
 PercolatorOutfile.cpp
 ProtXMLFile.cpp
 SequestInfile.cpp
@@ -29,6 +29,7 @@ StandardTypes.cpp
 ChromatogramPeak.cpp
 MSChromatogram.cpp
 ChromatogramTools.cpp
+ColumnarSpectrum.cpp
 )
 
 ### add path to the filenames
@@ -36,6 +36,12 @@
 #include <iostream>
 #include <OpenMS/MATH/MISC/MSNumpress.h>
 
+// SSE2 is part of the x86-64 baseline, so no runtime detection is needed
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MS_NUMPRESS_SSE2
+#include <emmintrin.h>
+#endif
+
 
 namespace ms {
 namespace numpress {
@@ -206,6 +212,64 @@ static void decodeInt(
 
 
 
+/**
+ * Lookup tables for decodeIntFast, indexed by the count halfbyte:
+ * mask of the halfbytes stored after the count, leading 0xf halfbytes and 
+ * total number of halfbytes used by the int.
+ */
+static const unsigned int HEAD_MASK[16] = {
+	0xffffffff, 0x0fffffff, 0x00ffffff, 0x000fffff, 0x0000ffff, 0x00000fff, 0x000000ff, 0x0000000f, 
+	0x00000000, 0x0fffffff, 0x00ffffff, 0x000fffff, 0x0000ffff, 0x00000fff, 0x000000ff, 0x0000000f
+};
+static const unsigned int HEAD_ONES[16] = {
+	0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+	0x00000000, 0xf0000000, 0xff000000, 0xfff00000, 0xffff0000, 0xfffff000, 0xffffff00, 0xfffffff0
+};
+static const unsigned char HEAD_LENGTH[16] = {
+	9, 8, 7, 6, 5, 4, 3, 2, 
+	1, 8, 7, 6, 5, 4, 3, 2
+};
+
+
+
+/**
+ * Decodes an int starting at halfbyte hbi (= 2 * byte index + half) of data,
+ * equivalent to decodeInt. Instead of extracting one halfbyte after the 
+ * other, 8 bytes are loaded into a 64 bit word, the halfbytes are brought 
+ * into stream order with a few shifts and masks and the int is cut out 
+ * with the lookup tables above. 
+ * The caller has to guarantee that data[hbi/2] ... data[hbi/2 + 7] are 
+ * readable; in this case the corrupt input check of decodeInt never applies.
+ * Returns the number of halfbytes used by the int.
+ */
+static inline size_t decodeIntFast(
+		const unsigned char *data,
+		size_t hbi,
+		unsigned int *res
+) {
+	const unsigned char *p = data + (hbi >> 1);
+	unsigned long long w = 
+		  static_cast<unsigned long long>(p[0])
+		| (static_cast<unsigned long long>(p[1]) << 8)
+		| (static_cast<unsigned long long>(p[2]) << 16)
+		| (static_cast<unsigned long long>(p[3]) << 24)
+		| (static_cast<unsigned long long>(p[4]) << 32)
+		| (static_cast<unsigned long long>(p[5]) << 40)
+		| (static_cast<unsigned long long>(p[6]) << 48)
+		| (static_cast<unsigned long long>(p[7]) << 56);
+
+	// swap the halfbytes of each byte: the k-th halfbyte of the stream is 
+	// then stored at bits 4k ... 4k+3
+	w = ((w >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((w & 0x0f0f0f0f0f0f0f0fULL) << 4);
+	w >>= 4 * (hbi & 1);
+
+	unsigned int head = static_cast<unsigned int>(w & 0xf);
+	*res = (static_cast<unsigned int>(w >> 4) & HEAD_MASK[head]) | HEAD_ONES[head];
+	return HEAD_LENGTH[head];
+}
+
+
+
 
 /////////////////////////////////////////////////////////////
 
@@ -337,10 +401,11 @@ size_t encodeLinear(
 
 
 
-size_t decodeLinear(
+template <typename T>
+static size_t decodeLinearImpl(
 		const unsigned char *data,
 		const size_t dataSize,
-		double *result
+		T *result
 ) {
 	size_t i;
 	size_t ri = 0;
@@ -369,7 +434,7 @@ size_t decodeLinear(
 	for (i=0; i<4; i++) {
 		ints[1] = ints[1] | ((0xff & (init = data[8+i])) << (i*8));
 	}
-	result[0] = ints[1] / fixedPoint;
+	result[0] = static_cast<T>(ints[1] / fixedPoint);
 
 	if (dataSize == 12) return 1;
 	if (dataSize < 16) 
@@ -379,11 +444,26 @@ size_t decodeLinear(
 	for (i=0; i<4; i++) {
 		ints[2] = ints[2] | ((0xff & (init = data[12+i])) << (i*8));
 	}
-	result[1] = ints[2] / fixedPoint;
+	result[1] = static_cast<T>(ints[2] / fixedPoint);
 		
-	half = 0;
 	ri = 2;
-	di = 16;
+
+	// bulk of the data: at least 8 bytes left, no corruption checks needed
+	size_t hbi = 2 * 16;
+	while ((hbi >> 1) + 8 <= dataSize) {
+		ints[0] = ints[1];
+		ints[1] = ints[2];
+		hbi += decodeIntFast(data, hbi, &buff);
+		diff = static_cast<int>(buff);
+
+		extrapol = ints[1] + (ints[1] - ints[0]);
+		y = extrapol + diff;
+		result[ri++] 	= static_cast<T>(y / fixedPoint);
+		ints[2] 		= y;
+	}
+
+	half = hbi & 1;
+	di = hbi >> 1;
 	
 	//printf("   di     ri      half    int[0]    int[1]    extrapol   diff\n");
 	
@@ -403,7 +483,7 @@ size_t decodeLinear(
 		extrapol = ints[1] + (ints[1] - ints[0]);
 		y = extrapol + diff;
 		//printf(" %d \n", diff);
-		result[ri++] 	= y / fixedPoint;
+		result[ri++] 	= static_cast<T>(y / fixedPoint);
 		ints[2] 		= y;
 	}
 
@@ -412,6 +492,26 @@ size_t decodeLinear(
 
 
 
+size_t decodeLinear(
+		const unsigned char *data,
+		const size_t dataSize,
+		double *result
+) {
+	return decodeLinearImpl(data, dataSize, result);
+}
+
+
+
+size_t decodeLinear(
+		const unsigned char *data,
+		const size_t dataSize,
+		float *result
+) {
+	return decodeLinearImpl(data, dataSize, result);
+}
+
+
+
 void encodeLinear(
 		const std::vector<double> &data, 
 		std::vector<unsigned char> &result,
@@ -591,21 +691,31 @@ size_t encodePic(
 
 
 
-size_t decodePic(
+template <typename T>
+static size_t decodePicImpl(
 		const unsigned char *data,
 		const size_t dataSize,
-		double *result
+		T *result
 ) {
 	size_t ri;
 	unsigned int x;
 	size_t di;
 	size_t half;
+	size_t hbi;
 
 	//printf("ri      di      half    dSize   count\n");
 	
-	half = 0;
 	ri = 0;
-	di = 0;
+
+	// bulk of the data: at least 8 bytes left, no corruption checks needed
+	hbi = 0;
+	while ((hbi >> 1) + 8 <= dataSize) {
+		hbi += decodeIntFast(data, hbi, &x);
+		result[ri++] = static_cast<T>(x);
+	}
+
+	half = hbi & 1;
+	di = hbi >> 1;
 	
 	while (di < dataSize) {
 		if (di == (dataSize - 1) && half == 1) {
@@ -619,7 +729,7 @@ size_t decodePic(
 		//printf("%7d %7d %7d %7d %7d\n", ri, di, half, dataSize, count);
 		
 		//printf("count: %d \n", count);
-		result[ri++] = static_cast<double>(x);
+		result[ri++] = static_cast<T>(x);
 	}
 
 	return ri;
@@ -627,6 +737,26 @@ size_t decodePic(
 
 
 
+size_t decodePic(
+		const unsigned char *data,
+		const size_t dataSize,
+		double *result
+) {
+	return decodePicImpl(data, dataSize, result);
+}
+
+
+
+size_t decodePic(
+		const unsigned char *data,
+		const size_t dataSize,
+		float *result
+) {
+	return decodePicImpl(data, dataSize, result);
+}
+
+
+
 void encodePic(
 		const std::vector<double> &data,  
 		std::vector<unsigned char> &result
@@ -707,14 +837,17 @@ size_t encodeSlof(
 
 
 
-size_t decodeSlof(
+template <typename T>
+static size_t decodeSlofImpl(
 		const unsigned char *data, 
 		const size_t dataSize, 
-		double *result
+		T *result
 ) {
-	size_t i, ri;
-	unsigned short x;
+	size_t i, j, ri, n;
 	double fixedPoint;
+	// fixed point values of one block, small enough to stay in L1 cache
+	const size_t BLOCK_SIZE = 256;
+	double block[BLOCK_SIZE];
 
 	if (dataSize < 8) 
 		throw "[MSNumpress::decodeSlof] Corrupt input data: not enough bytes to read fixed point! ";
@@ -722,15 +855,56 @@ size_t decodeSlof(
 	ri = 0;
 	fixedPoint = decodeFixedPoint(data);
 
-	for (i=8; i<dataSize; i+=2) {
-		x = static_cast<unsigned short>(data[i] | (data[i+1] << 8));
-		result[ri++] = exp(x / fixedPoint) - 1;
+	i = 8;
+	while (i < dataSize) {
+		// 1. x / fixedPoint for a block of values
+		n = 0;
+#ifdef MS_NUMPRESS_SSE2
+		const __m128d fp = _mm_set1_pd(fixedPoint);
+		const __m128i zero = _mm_setzero_si128();
+		for (; n + 4 <= BLOCK_SIZE && i + 8 <= dataSize; n += 4, i += 8) {
+			// 4 little endian unsigned shorts -> 4 ints -> 2 x 2 doubles
+			__m128i x = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i)), zero);
+			_mm_storeu_pd(block + n, _mm_div_pd(_mm_cvtepi32_pd(x), fp));
+			_mm_storeu_pd(block + n + 2, _mm_div_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), fp));
+		}
+#endif
+		for (; n < BLOCK_SIZE && i < dataSize; n++, i += 2) {
+			unsigned short x = static_cast<unsigned short>(data[i] | (data[i+1] << 8));
+			block[n] = x / fixedPoint;
+		}
+
+		// 2. exp() of the block, zero intensities (exp(0) - 1 == 0) are 
+		// frequent in profile data and skipped
+		for (j = 0; j < n; j++) {
+			result[ri++] = static_cast<T>(block[j] == 0 ? 0.0 : exp(block[j]) - 1);
+		}
 	}
 	return ri;
 }
 
 
 
+size_t decodeSlof(
+		const unsigned char *data, 
+		const size_t dataSize, 
+		double *result
+) {
+	return decodeSlofImpl(data, dataSize, result);
+}
+
+
+
+size_t decodeSlof(
+		const unsigned char *data, 
+		const size_t dataSize, 
+		float *result
+) {
+	return decodeSlofImpl(data, dataSize, result);
+}
+
+
+
 void encodeSlof(
 		const std::vector<double> &data,  
 		std::vector<unsigned char> &result,
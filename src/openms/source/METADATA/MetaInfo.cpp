@@ -34,6 +34,8 @@
 
 #include <OpenMS/METADATA/MetaInfo.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -74,20 +76,47 @@ namespace OpenMS
     return !(operator==(rhs));
   }
 
+  namespace
+  {
+    /// Orders index/value pairs by index only
+    struct IndexLess
+    {
+      bool operator()(const std::pair<UInt, DataValue> & lhs, UInt rhs) const
+      {
+        return lhs.first < rhs;
+      }
+
+      bool operator()(UInt lhs, const std::pair<UInt, DataValue> & rhs) const
+      {
+        return lhs < rhs.first;
+      }
+    };
+  }
+
+  MetaInfo::ValueVector::iterator MetaInfo::lowerBound_(UInt index)
+  {
+    return lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+  }
+
+  MetaInfo::ValueVector::const_iterator MetaInfo::lowerBound_(UInt index) const
+  {
+    return lower_bound(index_to_value_.begin(), index_to_value_.end(), index, IndexLess());
+  }
+
   const DataValue & MetaInfo::getValue(const String & name) const
   {
-    map<UInt, DataValue>::const_iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
+    UInt index = registry_.getIndex(name);
+    if (index == UInt(-1))
     {
-      return it->second;
+      return DataValue::EMPTY;
     }
-    return DataValue::EMPTY;
+    return getValue(index);
   }
 
   const DataValue & MetaInfo::getValue(UInt index) const
   {
-    map<UInt, DataValue>::const_iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    ValueVector::const_iterator it = lowerBound_(index);
+    if (it != index_to_value_.end() && it->first == index)
     {
       return it->second;
     }
@@ -97,13 +126,21 @@ namespace OpenMS
   void MetaInfo::setValue(const String & name, const DataValue & value)
   {
     UInt index = registry_.registerName(name); // no-op if name is already registered
-    index_to_value_[index] = value;
+    setValue(index, value);
   }
 
   void MetaInfo::setValue(UInt index, const DataValue & value)
   {
     // @TODO: check if that index is registered in MetaInfoRegistry?
-    index_to_value_[index] = value;
+    ValueVector::iterator it = lowerBound_(index);
+    if (it != index_to_value_.end() && it->first == index)
+    {
+      it->second = value;
+    }
+    else
+    {
+      index_to_value_.insert(it, make_pair(index, value));
+    }
   }
 
   MetaInfoRegistry & MetaInfo::registry()
@@ -116,29 +153,30 @@ namespace OpenMS
     UInt index = registry_.getIndex(name);
     if (index != UInt(-1))
     {
-      return (index_to_value_.find(index) != index_to_value_.end());
+      return exists(index);
     }
     return false;
   }
 
   bool MetaInfo::exists(UInt index) const
   {
-    return (index_to_value_.find(index) != index_to_value_.end());
+    ValueVector::const_iterator it = lowerBound_(index);
+    return it != index_to_value_.end() && it->first == index;
   }
 
   void MetaInfo::removeValue(const String & name)
   {
-    map<UInt, DataValue>::iterator it = index_to_value_.find(registry_.getIndex(name));
-    if (it != index_to_value_.end())
+    UInt index = registry_.getIndex(name);
+    if (index != UInt(-1))
     {
-      index_to_value_.erase(it);
+      removeValue(index);
     }
   }
 
   void MetaInfo::removeValue(UInt index)
   {
-    map<UInt, DataValue>::iterator it = index_to_value_.find(index);
-    if (it != index_to_value_.end())
+    ValueVector::iterator it = lowerBound_(index);
+    if (it != index_to_value_.end() && it->first == index)
     {
       index_to_value_.erase(it);
     }
@@ -148,7 +186,7 @@ namespace OpenMS
   {
     keys.resize(index_to_value_.size());
     UInt i = 0;
-    for (map<UInt, DataValue>::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
+    for (ValueVector::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
     {
       keys[i++] = registry_.getName(it->first);
     }
@@ -158,7 +196,7 @@ namespace OpenMS
   {
     keys.resize(index_to_value_.size());
     UInt i = 0;
-    for (map<UInt, DataValue>::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
+    for (ValueVector::const_iterator it = index_to_value_.begin(); it != index_to_value_.end(); ++it)
     {
       keys[i++] = it->first;
     }
@@ -36,13 +36,16 @@
 
 #include <OpenMS/METADATA/MetaInfoRegistry.h>
 
+#include <QtCore/QReadWriteLock>
+
 using namespace std;
 
 namespace OpenMS
 {
 
   MetaInfoRegistry::MetaInfoRegistry() :
-    next_index_(1024), name_to_index_(), index_to_name_(), index_to_description_(), index_to_unit_()
+    next_index_(1024), name_to_index_(), index_to_name_(), index_to_description_(), index_to_unit_(),
+    lock_(new QReadWriteLock())
   {
     name_to_index_["isotopic_range"] = 1;
     index_to_name_[1] = "isotopic_range";
@@ -110,216 +113,180 @@ namespace OpenMS
     index_to_unit_[13] = "";
   }
 
-  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs)
+  MetaInfoRegistry::MetaInfoRegistry(const MetaInfoRegistry& rhs) :
+    lock_(new QReadWriteLock())
   {
     *this = rhs;
   }
 
   MetaInfoRegistry::~MetaInfoRegistry()
   {
+    delete lock_;
   }
 
   MetaInfoRegistry& MetaInfoRegistry::operator=(const MetaInfoRegistry& rhs)
   {
     if (this == &rhs) return *this;
 
-#pragma omp critical (MetaInfoRegistry)
+    // never hold both locks at the same time (a = b and b = a in two threads
+    // would deadlock): copy rhs under its lock, then swap the copy in
+    UInt next_index;
+    map<String, UInt> name_to_index;
+    map<UInt, String> index_to_name;
+    map<UInt, String> index_to_description;
+    map<UInt, String> index_to_unit;
     {
-      next_index_ = rhs.next_index_;
-      name_to_index_ = rhs.name_to_index_;
-      index_to_name_ = rhs.index_to_name_;
-      index_to_description_ = rhs.index_to_description_;
-      index_to_unit_ = rhs.index_to_unit_;
+      QReadLocker rhs_locker(rhs.lock_);
+      next_index = rhs.next_index_;
+      name_to_index = rhs.name_to_index_;
+      index_to_name = rhs.index_to_name_;
+      index_to_description = rhs.index_to_description_;
+      index_to_unit = rhs.index_to_unit_;
     }
+
+    QWriteLocker locker(lock_);
+    next_index_ = next_index;
+    name_to_index_.swap(name_to_index);
+    index_to_name_.swap(index_to_name);
+    index_to_description_.swap(index_to_description);
+    index_to_unit_.swap(index_to_unit);
     return *this;
   }
 
   UInt MetaInfoRegistry::registerName(const String& name, const String& description, const String& unit)
   {
-    UInt rv;
-#pragma omp critical (MetaInfoRegistry)
+    // fast path: most calls are for names that are already registered
     {
-      map<String, UInt>::iterator it = name_to_index_.find(name);
-      if (it == name_to_index_.end())
-      {
-        name_to_index_[name] = next_index_;
-        index_to_name_[next_index_] = name;
-        index_to_description_[next_index_] = description;
-        index_to_unit_[next_index_] = unit;
-        rv = next_index_++;
-      }
-      else
+      QReadLocker locker(lock_);
+      map<String, UInt>::const_iterator it = name_to_index_.find(name);
+      if (it != name_to_index_.end())
       {
-        rv = it->second;
+        return it->second;
       }
     }
-    return rv;
+
+    QWriteLocker locker(lock_);
+    // another thread may have registered the name in the meantime
+    map<String, UInt>::iterator it = name_to_index_.find(name);
+    if (it != name_to_index_.end())
+    {
+      return it->second;
+    }
+    name_to_index_[name] = next_index_;
+    index_to_name_[next_index_] = name;
+    index_to_description_[next_index_] = description;
+    index_to_unit_[next_index_] = unit;
+    return next_index_++;
   }
 
   void MetaInfoRegistry::setDescription(UInt index, const String& description)
   {
-    map<UInt, String>::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    QWriteLocker locker(lock_);
+    map<UInt, String>::iterator pos = index_to_description_.find(index);
+    if (pos == index_to_description_.end())
     {
-      pos = index_to_description_.find(index);
-      if (pos != index_to_description_.end())
-      {
-        pos->second = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
     }
+    pos->second = description;
   }
 
   void MetaInfoRegistry::setDescription(const String& name, const String& description)
   {
-    map<String, UInt>::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    QWriteLocker locker(lock_);
+    map<String, UInt>::iterator pos = name_to_index_.find(name);
+    if (pos == name_to_index_.end())
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_description_[pos->second] = description;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered name!", name);
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered name!", name);
     }
+    index_to_description_[pos->second] = description;
   }
 
   void MetaInfoRegistry::setUnit(UInt index, const String& unit)
   {
-    map<UInt, String>::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    QWriteLocker locker(lock_);
+    map<UInt, String>::iterator pos = index_to_unit_.find(index);
+    if (pos == index_to_unit_.end())
     {
-      pos = index_to_unit_.find(index);
-      if (pos != index_to_unit_.end())
-      {
-        pos->second = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
     }
+    pos->second = unit;
   }
 
   void MetaInfoRegistry::setUnit(const String& name, const String& unit)
   {
-    map<String, UInt>::iterator pos;
-#pragma omp critical (MetaInfoRegistry)
+    QWriteLocker locker(lock_);
+    map<String, UInt>::iterator pos = name_to_index_.find(name);
+    if (pos == name_to_index_.end())
     {
-      pos = name_to_index_.find(name);
-      if (pos != name_to_index_.end())
-      {
-        index_to_unit_[pos->second] = unit;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered name!", name);
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered name!", name);
     }
+    index_to_unit_[pos->second] = unit;
   }
 
   UInt MetaInfoRegistry::getIndex(const String& name) const
   {
-    UInt rv = UInt(-1);
-#pragma omp critical (MetaInfoRegistry)
+    QReadLocker locker(lock_);
+    map<String, UInt>::const_iterator it = name_to_index_.find(name);
+    if (it != name_to_index_.end())
     {
-      map<String, UInt>::const_iterator it = name_to_index_.find(name);
-      if (it != name_to_index_.end())
-      {
-        rv = it->second;
-      }
+      return it->second;
     }
-    return rv;
+    return UInt(-1);
   }
 
   String MetaInfoRegistry::getDescription(UInt index) const
   {
-    String result;
-#pragma omp critical (MetaInfoRegistry)
+    QReadLocker locker(lock_);
+    map<UInt, String>::const_iterator it = index_to_description_.find(index);
+    if (it == index_to_description_.end())
     {
-      map<UInt, String>::const_iterator it = index_to_description_.find(index);
-      if (it == index_to_description_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
     }
-    return result;
+    return it->second;
   }
 
   String MetaInfoRegistry::getDescription(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    QReadLocker locker(lock_);
+    map<String, UInt>::const_iterator pos = name_to_index_.find(name);
+    if (pos == name_to_index_.end())
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered Name!", name);
     }
-    else
-    {
-#pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_description_.find(index))->second;
-      }
-    }
-    return rv;
+    return index_to_description_.find(pos->second)->second;
   }
 
   String MetaInfoRegistry::getUnit(UInt index) const
   {
-    String result;
-#pragma omp critical (MetaInfoRegistry)
+    QReadLocker locker(lock_);
+    map<UInt, String>::const_iterator it = index_to_unit_.find(index);
+    if (it == index_to_unit_.end())
     {
-      map<UInt, String>::const_iterator it = index_to_unit_.find(index);
-      if (it == index_to_unit_.end())
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
-      }
-      result = it->second;
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
     }
-    return result;
+    return it->second;
   }
 
   String MetaInfoRegistry::getUnit(const String& name) const
   {
-    String rv;
-    UInt index = getIndex(name); // this has to be outside the OpenMP "critical" block!
-    if (index == UInt(-1)) // not found
+    QReadLocker locker(lock_);
+    map<String, UInt>::const_iterator pos = name_to_index_.find(name);
+    if (pos == name_to_index_.end())
     {
       throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered Name!", name);
     }
-    else
-    {
-#pragma omp critical (MetaInfoRegistry)
-      {
-        rv = (index_to_unit_.find(index))->second;
-      }
-    }
-    return rv;
+    return index_to_unit_.find(pos->second)->second;
   }
 
   String MetaInfoRegistry::getName(UInt index) const
   {
-    String rv;
-#pragma omp critical (MetaInfoRegistry)
+    QReadLocker locker(lock_);
+    map<UInt, String>::const_iterator it = index_to_name_.find(index);
+    if (it == index_to_name_.end())
     {
-      map<UInt, String>::const_iterator it = index_to_name_.find(index);
-      if (it != index_to_name_.end())
-      {
-        rv = it->second;
-      }
-      else
-      {
-        throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
-      }
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Unregistered index!", String(index));
     }
-    return rv;
+    return it->second;
   }
 
 } //namespace
@@ -51,6 +51,7 @@
 
 #include <boost/math/special_functions/fpclassify.hpp>
 
+#include <cmath>
 #include <numeric>
 #include <fstream>
 #include <algorithm>
@@ -396,71 +397,8 @@ namespace OpenMS
     //new scope to make local variables disappear
     {
       double max_mass = map_.getMaxMZ() * charge_high;
-      Size num_isotopes = std::ceil(max_mass / mass_window_width_) + 1;
-      ff_->startProgress(0, num_isotopes, "Precalculating isotope distributions");
-
-      //reserve enough space
-      isotope_distributions_.resize(num_isotopes);
-
-      //calculate distribution if necessary
-      for (Size index = 0; index < num_isotopes; ++index)
-      {
-        //if(debug_) log_ << "Calculating iso dist for mass: " << 0.5*mass_window_width_ + index * mass_window_width_ << std::endl;
-        IsotopeDistribution d;
-        d.setMaxIsotope(max_isotopes);
-        d.estimateFromPeptideWeight(0.5 * mass_window_width_ + index * mass_window_width_);
-        //trim left and right. And store the number of isotopes on the left, to reconstruct the monoisotopic peak
-        Size size_before = d.size();
-        d.trimLeft(intensity_percentage_optional_);
-        isotope_distributions_[index].trimmed_left = size_before - d.size();
-        d.trimRight(intensity_percentage_optional_);
-
-        for (IsotopeDistribution::Iterator it = d.begin(); it != d.end(); ++it)
-        {
-          isotope_distributions_[index].intensity.push_back(it->second);
-          //if(debug_) log_ << " - " << it->second << std::endl;
-        }
-
-        //determine the number of optional peaks at the beginning/end
-        Size begin = 0;
-        Size end = 0;
-        bool is_begin = true;
-        bool is_end = false;
-
-        for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
-        {
-          if (isotope_distributions_[index].intensity[i] < intensity_percentage_)
-          {
-            if (!is_end && !is_begin) is_end = true;
-            if (is_begin) ++begin;
-            else if (is_end)
-              ++end;
-          }
-          else if (is_begin)
-          {
-            is_begin = false;
-          }
-        }
-        isotope_distributions_[index].optional_begin = begin;
-        isotope_distributions_[index].optional_end = end;
-        //scale the distribution to a maximum of 1
-        double max = 0.0;
-        for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
-        {
-          if (isotope_distributions_[index].intensity[i] > max)
-          {
-            max = isotope_distributions_[index].intensity[i];
-          }
-        }
-        isotope_distributions_[index].max = max;
-        for (Size i = 0; i < isotope_distributions_[index].intensity.size(); ++i)
-        {
-          isotope_distributions_[index].intensity[i] /= max;
-        }
-
-        //if(debug_) log_ << " - optional begin/end:" << begin << " / " << end << std::endl;
-      }
-
+      ff_->startProgress(0, 1, "Precalculating isotope distributions");
+      isotope_distributions_.reset(new IsotopeDistributionCache(max_mass, mass_window_width_, intensity_percentage_, intensity_percentage_optional_, max_isotopes));
       ff_->endProgress();
     }
 
@@ -615,13 +553,27 @@ namespace OpenMS
 
       // We do not want to store features whose seeds lie within other
       // features with higher intensity. We thus store this information in
-      // the map seeds_in_features which contains for each seed i a vector
+      // the vector seeds_in_features which contains for each seed i a vector
       // of other seeds that are contained in the corresponding feature i.
+      // Each thread only writes the entry of its own seed, so no locking is
+      // needed.
       //
       // The features are stored in an temporary feature map until it is
       // decided whether they are contained within a seed of higher
       // intensity.
-      std::map<Size, std::vector<Size> > seeds_in_features;
+      std::vector<std::vector<Size> > seeds_in_features(seeds.size());
+
+      // seed positions sorted by m/z, to find the seeds inside a feature
+      // without going through all seeds
+      std::vector<std::pair<double, Size> > seeds_by_mz(seeds.size());
+      std::vector<double> seed_rts(seeds.size());
+      for (Size i = 0; i < seeds.size(); ++i)
+      {
+        seeds_by_mz[i] = std::make_pair(map_[seeds[i].spectrum][seeds[i].peak].getMZ(), i);
+        seed_rts[i] = map_[seeds[i].spectrum].getRT();
+      }
+      std::sort(seeds_by_mz.begin(), seeds_by_mz.end());
+
       typedef std::map<Size, Feature> FeatureMapType;
       FeatureMapType tmp_feature_map;
       int gl_progress = 0;
@@ -842,20 +794,17 @@ namespace OpenMS
               }
 
               //----------------------------------------------------------------
-              //Remember all seeds that lie inside the convex hull of the new feature
+              //Remember all seeds (of lower intensity) that lie inside the convex hull of the new feature
               DBoundingBox<2> bb = f.getConvexHull().getBoundingBox();
-              for (Size j = i + 1; j < seeds.size(); ++j)
+              std::vector<Size> in_bb;
+              findPositionsInBoundingBox_(seeds_by_mz, seed_rts, bb, i, in_bb);
+              std::vector<Size>& contained = seeds_in_features[i];
+              for (Size k = 0; k < in_bb.size(); ++k)
               {
-                double rt = map_[seeds[j].spectrum].getRT();
-                double mz = map_[seeds[j].spectrum][seeds[j].peak].getMZ();
-                if (bb.encloses(rt, mz) && f.encloses(rt, mz))
+                Size j = in_bb[k];
+                if (f.encloses(seed_rts[j], map_[seeds[j].spectrum][seeds[j].peak].getMZ()))
                 {
-#ifdef _OPENMP
-#pragma omp critical (FeatureFinderAlgorithmPicked_SEEDSINFEATURES)
-#endif
-                  {
-                    seeds_in_features[i].push_back(j);
-                  }
+                  contained.push_back(j);
                 }
               }
             }
@@ -867,16 +816,11 @@ namespace OpenMS
       // features of seeds with higher intensities. Only if the seed is not
       // used in any feature with higher intensity, we can add it to the
       // features_ list.
-      std::vector<Size> seeds_contained;
+      std::vector<bool> seeds_contained(seeds.size(), false);
       for (std::map<Size, Feature>::iterator iter = tmp_feature_map.begin(); iter != tmp_feature_map.end(); ++iter)
       {
         Size seed_nr = iter->first;
-        bool is_used = false;
-        for (Size i = 0; i < seeds_contained.size(); ++i)
-        {
-          if (seed_nr == seeds_contained[i]) { is_used = true; break; }
-        }
-        if (!is_used)
+        if (!seeds_contained[seed_nr])
         {
           ++feature_candidates;
 
@@ -885,11 +829,10 @@ namespace OpenMS
           ++feature_nr_global;
           features_->push_back(iter->second);
 
-          std::vector<Size> curr_seed = seeds_in_features[seed_nr];
+          const std::vector<Size>& curr_seed = seeds_in_features[seed_nr];
           for (Size k = 0; k < curr_seed.size(); ++k)
           {
-            seeds_contained.push_back(curr_seed[k]);
-
+            seeds_contained[curr_seed[k]] = true;
           }
         }
       }
@@ -903,7 +846,7 @@ namespace OpenMS
     //Step 4:
     //Resolve contradicting and overlapping features
     //------------------------------------------------------------------
-    ff_->startProgress(0, features_->size() * features_->size(), "Resolving overlapping features");
+    ff_->startProgress(0, features_->size(), "Resolving overlapping features");
     if (debug_) log_ << "Resolving intersecting features (" << features_->size() << " candidates)" << std::endl;
     //sort features according to m/z in order to speed up the resolution
     features_->sortByMZ();
@@ -920,21 +863,24 @@ namespace OpenMS
       }
     }
 
+    //find the pairs of features whose overall convex hulls overlap
+    std::vector<std::vector<Size> > intersecting_bbs;
+    findIntersectingBoundingBoxes_(bbs, intersecting_bbs);
+
     Size removed(0);
     //intersect
     for (Size i = 0; i < features_->size(); ++i)
     {
+      ff_->setProgress(i);
       Feature& f1((*features_)[i]);
-      for (Size j = i + 1; j < features_->size(); ++j)
+      for (Size k = 0; k < intersecting_bbs[i].size(); ++k)
       {
-        ff_->setProgress(i * features_->size() + j);
+        Size j = intersecting_bbs[i][k];
         Feature& f2((*features_)[j]);
         //features that are more than 2 times the maximum m/z span apart do not overlap => abort
         if (f2.getMZ() - f1.getMZ() > 2.0 * max_mz_span) break;
         //do nothing if one of the features is already removed
         if (f1.getIntensity() == 0.0 || f2.getIntensity() == 0.0) continue;
-        //do nothing if the overall convex hulls do not overlap
-        if (!bbs[i].intersects(bbs[j])) continue;
         //act depending on the intersection
         double intersection = intersection_(f1, f2);
 
@@ -1134,18 +1080,105 @@ namespace OpenMS
     return overlap / std::min(s1, s2);
   }
 
-  const FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern& FeatureFinderAlgorithmPicked::getIsotopeDistribution_(double mass) const
+  void FeatureFinderAlgorithmPicked::findIntersectingBoundingBoxes_(const std::vector<DBoundingBox<2> >& bbs, std::vector<std::vector<Size> >& intersecting)
   {
-    //calculate index in the vector
-    Size index = (Size) std::floor(mass / mass_window_width_);
+    intersecting.clear();
+    intersecting.resize(bbs.size());
+    if (bbs.size() < 2) return;
+
+    //overall extent and average box size
+    double rt_min = bbs[0].minPosition()[0], rt_max = bbs[0].maxPosition()[0];
+    double mz_min = bbs[0].minPosition()[1], mz_max = bbs[0].maxPosition()[1];
+    double rt_width_sum = 0.0, mz_width_sum = 0.0;
+    for (Size i = 0; i < bbs.size(); ++i)
+    {
+      rt_min = std::min(rt_min, bbs[i].minPosition()[0]);
+      rt_max = std::max(rt_max, bbs[i].maxPosition()[0]);
+      mz_min = std::min(mz_min, bbs[i].minPosition()[1]);
+      mz_max = std::max(mz_max, bbs[i].maxPosition()[1]);
+      rt_width_sum += bbs[i].width();
+      mz_width_sum += bbs[i].height();
+    }
+
+    //grid cells of the average box size, so a box covers only a few cells;
+    //the cells are enlarged until the grid has at most four cells per box
+    //(this bounds the memory of the grid, not the cells covered by one box)
+    double rt_cell = std::max(rt_width_sum / bbs.size(), (rt_max - rt_min) / bbs.size());
+    double mz_cell = std::max(mz_width_sum / bbs.size(), (mz_max - mz_min) / bbs.size());
+    if (rt_cell <= 0.0) rt_cell = 1.0;
+    if (mz_cell <= 0.0) mz_cell = 1.0;
+    while ((std::floor((rt_max - rt_min) / rt_cell) + 1.0) * (std::floor((mz_max - mz_min) / mz_cell) + 1.0) > 4.0 * bbs.size())
+    {
+      rt_cell *= 2.0;
+      mz_cell *= 2.0;
+    }
+    const Size rt_bins = (Size)std::floor((rt_max - rt_min) / rt_cell) + 1;
+    const Size mz_bins = (Size)std::floor((mz_max - mz_min) / mz_cell) + 1;
+
+    //cell ranges covered by each box
+    std::vector<Size> rt_first(bbs.size()), rt_last(bbs.size()), mz_first(bbs.size()), mz_last(bbs.size());
+    std::vector<std::vector<Size> > cells(rt_bins * mz_bins);
+    for (Size i = 0; i < bbs.size(); ++i)
+    {
+      rt_first[i] = std::min((Size)std::floor((bbs[i].minPosition()[0] - rt_min) / rt_cell), rt_bins - 1);
+      rt_last[i] = std::min((Size)std::floor((bbs[i].maxPosition()[0] - rt_min) / rt_cell), rt_bins - 1);
+      mz_first[i] = std::min((Size)std::floor((bbs[i].minPosition()[1] - mz_min) / mz_cell), mz_bins - 1);
+      mz_last[i] = std::min((Size)std::floor((bbs[i].maxPosition()[1] - mz_min) / mz_cell), mz_bins - 1);
+      for (Size r = rt_first[i]; r <= rt_last[i]; ++r)
+      {
+        for (Size m = mz_first[i]; m <= mz_last[i]; ++m)
+        {
+          cells[r * mz_bins + m].push_back(i);
+        }
+      }
+    }
+
+    //intersecting boxes share at least one cell
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)bbs.size(); ++i)
+    {
+      std::vector<Size>& result = intersecting[i];
+      for (Size r = rt_first[i]; r <= rt_last[i]; ++r)
+      {
+        for (Size m = mz_first[i]; m <= mz_last[i]; ++m)
+        {
+          const std::vector<Size>& cell = cells[r * mz_bins + m];
+          //cells are filled in index order
+          for (std::vector<Size>::const_iterator it = std::upper_bound(cell.begin(), cell.end(), (Size)i); it != cell.end(); ++it)
+          {
+            if (bbs[i].intersects(bbs[*it]))
+            {
+              result.push_back(*it);
+            }
+          }
+        }
+      }
+      std::sort(result.begin(), result.end());
+      result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+  }
 
-    if (index >= isotope_distributions_.size())
+  void FeatureFinderAlgorithmPicked::findPositionsInBoundingBox_(const std::vector<std::pair<double, Size> >& positions_by_mz, const std::vector<double>& rts, const DBoundingBox<2>& bb, Size min_index, std::vector<Size>& result)
+  {
+    result.clear();
+    std::vector<std::pair<double, Size> >::const_iterator it_mz = std::lower_bound(positions_by_mz.begin(), positions_by_mz.end(), std::make_pair(bb.minPosition()[1], Size(0)));
+    for (; it_mz != positions_by_mz.end() && it_mz->first <= bb.maxPosition()[1]; ++it_mz)
     {
-      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "IsotopeDistribution not precalculated. Maximum allowed index is " + String(isotope_distributions_.size()), String(index));
+      Size j = it_mz->second;
+      if (j <= min_index) continue;
+      if (bb.encloses(rts[j], it_mz->first))
+      {
+        result.push_back(j);
+      }
     }
+    std::sort(result.begin(), result.end());
+  }
 
-    //Return distribution
-    return isotope_distributions_[index];
+  const FeatureFinderAlgorithmPickedHelperStructs::TheoreticalIsotopePattern& FeatureFinderAlgorithmPicked::getIsotopeDistribution_(double mass) const
+  {
+    return isotope_distributions_->getIsotopeDistribution(mass);
   }
 
   double FeatureFinderAlgorithmPicked::findBestIsotopeFit_(const Seed& center, UInt charge, IsotopePattern& best_pattern) const
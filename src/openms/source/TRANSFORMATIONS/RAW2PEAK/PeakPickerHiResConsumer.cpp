@@ -0,0 +1,81 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Erhan Kenar $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+
+namespace OpenMS
+{
+
+  PeakPickerHiResConsumer::PeakPickerHiResConsumer(const PeakPickerHiRes& pp, bool check_spectrum_type) :
+    pp_(pp),
+    ms_levels_(pp.getParameters().getValue("ms_levels").toIntList()),
+    check_spectrum_type_(check_spectrum_type)
+  {
+  }
+
+  PeakPickerHiResConsumer::~PeakPickerHiResConsumer()
+  {
+  }
+
+  void PeakPickerHiResConsumer::setExpectedSize(Size /* expectedSpectra */, Size /* expectedChromatograms */)
+  {
+    // do nothing
+  }
+
+  void PeakPickerHiResConsumer::setExperimentalSettings(const ExperimentalSettings& /* exp */)
+  {
+    // do nothing
+  }
+
+  void PeakPickerHiResConsumer::consumeSpectrum(SpectrumType& s)
+  {
+    if (!ListUtils::contains(ms_levels_, s.getMSLevel())) return;
+
+    if (s.getType() == SpectrumSettings::PEAKS && check_spectrum_type_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Error: Centroided data provided but profile spectra expected.");
+    }
+
+    SpectrumType s_out;
+    pp_.pick(s, s_out);
+    s = s_out;
+  }
+
+  void PeakPickerHiResConsumer::consumeChromatogram(ChromatogramType& c)
+  {
+    ChromatogramType c_out;
+    pp_.pick(c, c_out);
+    c = c_out;
+  }
+
+} //end namespace OpenMS
@@ -94,9 +94,13 @@ public:
     typedef boost::shared_ptr<OpenSwath::IFeature> FeatureType;
     //@}
 
+    /// Default constructor
+    MRMScoring();
+
     /** @name Accessors */
     //@{
     /// non-mutable access to the Cross-correlation matrix
+    /// (only the pairs computed by the last initialization are filled in)
     const XCorrMatrixType& getXCorrMatrix() const;
     //@}
 
@@ -152,13 +156,50 @@ public:
 
 private:
 
+    /// Computes the cross-correlation of the given pairs of a rows x cols matrix and stores their maxima
+    void computeXCorrMatrix_(const std::vector<std::vector<double> >& traces1,
+                             const std::vector<std::vector<double> >& traces2,
+                             const std::vector<std::pair<std::size_t, std::size_t> >& pairs,
+                             std::size_t rows, std::size_t cols);
+
+    /// Returns the maximum (lag and value) of the cross-correlation of entry (i, j)
+    const std::pair<int, double>& getXCorrMax_(std::size_t i, std::size_t j) const
+    {
+      return xcorr_max_[i * xcorr_cols_ + j];
+    }
+
+    /// Reads the intensities of the given features
+    static void getIntensities_(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids,
+                                std::vector<std::vector<double> >& intensities);
+
     /** @name Members */
     //@{
-    /// the precomputed cross correlation matrix
-    XCorrMatrixType xcorr_matrix_;
+    /// number of rows of the cross correlation matrix
+    std::size_t xcorr_rows_;
+
+    /// number of columns of the cross correlation matrix
+    std::size_t xcorr_cols_;
+
+    /// maximal lag of the cross correlation (the length of the traces)
+    int xcorr_maxdelay_;
+
+    /// the precomputed cross correlations (dense, 2 * xcorr_maxdelay_ + 1 values per computed pair)
+    std::vector<double> xcorr_values_;
+
+    /// the computed pairs (in the order of xcorr_values_)
+    std::vector<std::pair<std::size_t, std::size_t> > xcorr_pairs_;
+
+    /// maximum (lag and value) of each entry of the cross correlation matrix (row-major)
+    std::vector<std::pair<int, double> > xcorr_max_;
+
+    /// the cross correlation matrix in map form (built on demand by getXCorrMatrix)
+    mutable XCorrMatrixType xcorr_matrix_;
+
+    /// whether xcorr_matrix_ is up to date
+    mutable bool xcorr_matrix_valid_;
 
-    /// the precomputed cross correlation with the MS1 trace
-    std::vector<XCorrArrayType> ms1_xcorr_vector_;
+    /// maximum (lag and value) of the precomputed cross correlation with the MS1 trace
+    std::vector<std::pair<int, double> > ms1_xcorr_max_;
     //@}
 
   };
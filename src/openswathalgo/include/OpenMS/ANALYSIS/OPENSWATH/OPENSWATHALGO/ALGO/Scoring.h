@@ -35,8 +35,10 @@
 #ifndef OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 #define OPENMS_ANALYSIS_OPENSWATH_OPENSWATHALGO_ALGO_SCORING_H
 
+#include <cstddef>
 #include <numeric>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h>
@@ -106,9 +108,35 @@ namespace OpenSwath
     OPENSWATHALGO_DLLAPI XCorrArrayType calculateCrossCorrelation(std::vector<double>& data1,
                                                       std::vector<double>& data2, int maxdelay, int lag);
 
+    /** @brief Calculate the normalized crosscorrelation of several pairs of traces at once
+
+      Computes the same values as normalizedCrossCorrelation(traces1[i],
+      traces2[j], n, 1) for each requested pair (i, j) where n is the length
+      of the traces (all traces need to have the same length). The results
+      are stored in dense form in a single contiguous array: the 2n + 1
+      values of the p-th pair (lags -n to n) start at result[p * (2n + 1)].
+
+      Each trace is standardized only once. If the traces have at least
+      @p fft_threshold data points, the correlation of all lags is computed
+      via FFT in O(n log n) instead of O(n^2) per pair (the results then
+      agree with the direct computation up to floating point rounding).
+      Pairs with a trace without variance (which standardizes to non-finite
+      values) are always computed directly.
+
+      @note The input traces are not modified.
+    */
+    OPENSWATHALGO_DLLAPI void normalizedCrossCorrelationPairs(const std::vector<std::vector<double> >& traces1,
+                                                              const std::vector<std::vector<double> >& traces2,
+                                                              const std::vector<std::pair<std::size_t, std::size_t> >& pairs,
+                                                              std::vector<double>& result,
+                                                              std::size_t fft_threshold = 100);
+
     /// Find best peak in an cross-correlation (highest apex)
     OPENSWATHALGO_DLLAPI XCorrArrayType::iterator xcorrArrayGetMaxPeak(XCorrArrayType & array);
 
+    /// Find best peak (highest apex) in a dense cross-correlation array of the lags -maxdelay to maxdelay (returns lag and value)
+    OPENSWATHALGO_DLLAPI std::pair<int, double> xcorrArrayGetMaxPeak(const double* array, int maxdelay);
+
     /// Standardize a vector (subtract mean, divide by standard deviation)
     OPENSWATHALGO_DLLAPI void standardize_data(std::vector<double>& data);
 
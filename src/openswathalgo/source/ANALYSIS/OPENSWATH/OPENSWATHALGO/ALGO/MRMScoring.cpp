@@ -44,71 +44,121 @@
 namespace OpenSwath
 {
 
+  MRMScoring::MRMScoring() :
+    xcorr_rows_(0),
+    xcorr_cols_(0),
+    xcorr_maxdelay_(0),
+    xcorr_matrix_valid_(true)
+  {
+  }
+
   const MRMScoring::XCorrMatrixType& MRMScoring::getXCorrMatrix() const
   {
+    if (!xcorr_matrix_valid_)
+    {
+      // convert the dense arrays into the map representation
+      xcorr_matrix_.clear();
+      xcorr_matrix_.resize(xcorr_rows_, std::vector<XCorrArrayType>(xcorr_cols_));
+      const std::size_t array_size = 2 * xcorr_maxdelay_ + 1;
+      for (std::size_t p = 0; p < xcorr_pairs_.size(); ++p)
+      {
+        XCorrArrayType& array = xcorr_matrix_[xcorr_pairs_[p].first][xcorr_pairs_[p].second];
+        for (std::size_t k = 0; k < array_size; ++k)
+        {
+          array[boost::numeric_cast<int>(k) - xcorr_maxdelay_] = xcorr_values_[p * array_size + k];
+        }
+      }
+      xcorr_matrix_valid_ = true;
+    }
     return xcorr_matrix_;
   }
 
+  void MRMScoring::getIntensities_(OpenSwath::IMRMFeature* mrmfeature, const std::vector<String>& native_ids,
+                                   std::vector<std::vector<double> >& intensities)
+  {
+    intensities.resize(native_ids.size());
+    for (std::size_t i = 0; i < native_ids.size(); i++)
+    {
+      intensities[i].clear();
+      mrmfeature->getFeature(native_ids[i])->getIntensity(intensities[i]);
+    }
+  }
+
+  void MRMScoring::computeXCorrMatrix_(const std::vector<std::vector<double> >& traces1,
+                                       const std::vector<std::vector<double> >& traces2,
+                                       const std::vector<std::pair<std::size_t, std::size_t> >& pairs,
+                                       std::size_t rows, std::size_t cols)
+  {
+    xcorr_rows_ = rows;
+    xcorr_cols_ = cols;
+    xcorr_pairs_ = pairs;
+    xcorr_maxdelay_ = pairs.empty() ? 0 : boost::numeric_cast<int>(traces1[pairs[0].first].size());
+    Scoring::normalizedCrossCorrelationPairs(traces1, traces2, pairs, xcorr_values_);
+
+    // the scores only need the maximum of each cross correlation
+    const std::size_t array_size = 2 * xcorr_maxdelay_ + 1;
+    xcorr_max_.assign(rows * cols, std::make_pair(0, 0.0));
+    for (std::size_t p = 0; p < pairs.size(); ++p)
+    {
+      xcorr_max_[pairs[p].first * cols + pairs[p].second] =
+        Scoring::xcorrArrayGetMaxPeak(&xcorr_values_[p * array_size], xcorr_maxdelay_);
+    }
+    xcorr_matrix_valid_ = false;
+  }
+
   void MRMScoring::initializeXCorrMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids)
   {
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids.size());
+    // compute all pairs (i, j) with j >= i at once
+    std::vector<std::vector<double> > intensities;
+    getIntensities_(mrmfeature, native_ids, intensities);
+    std::vector<std::pair<std::size_t, std::size_t> > pairs;
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
       for (std::size_t j = i; j < native_ids.size(); j++)
       {
-        String native_id2 = native_ids[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        pairs.push_back(std::make_pair(i, j));
       }
     }
+    computeXCorrMatrix_(intensities, intensities, pairs, native_ids.size(), native_ids.size());
   }
 
   void MRMScoring::initializeMS1XCorr(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids, std::string precursor_id)
   {
-    std::vector<double> intensityi, intensity_ms1;
-    mrmfeature->getPrecursorFeature(precursor_id)->getIntensity(intensity_ms1);
-    ms1_xcorr_vector_.resize(native_ids.size());
+    std::vector<std::vector<double> > intensities, intensity_ms1(1);
+    getIntensities_(mrmfeature, native_ids, intensities);
+    mrmfeature->getPrecursorFeature(precursor_id)->getIntensity(intensity_ms1[0]);
+
+    std::vector<std::pair<std::size_t, std::size_t> > pairs;
+    for (std::size_t i = 0; i < native_ids.size(); i++)
+    {
+      pairs.push_back(std::make_pair(i, 0));
+    }
+    std::vector<double> xcorr_values;
+    Scoring::normalizedCrossCorrelationPairs(intensities, intensity_ms1, pairs, xcorr_values);
+
+    ms1_xcorr_max_.resize(native_ids.size());
+    const int maxdelay = native_ids.empty() ? 0 : boost::numeric_cast<int>(intensities[0].size());
     for (std::size_t i = 0; i < native_ids.size(); i++)
     {
-      String native_id = native_ids[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      intensityi.clear();
-      fi->getIntensity(intensityi);
-      ms1_xcorr_vector_[i] = Scoring::normalizedCrossCorrelation(
-        intensityi, intensity_ms1, boost::numeric_cast<int>(intensityi.size()), 1);
+      ms1_xcorr_max_[i] = Scoring::xcorrArrayGetMaxPeak(&xcorr_values[i * (2 * maxdelay + 1)], maxdelay);
     }
   }
 
   void MRMScoring::initializeXCorrIdMatrix(OpenSwath::IMRMFeature* mrmfeature, std::vector<String> native_ids_identification, std::vector<String> native_ids_detection)
   { 
-    std::vector<double> intensityi, intensityj;
-    xcorr_matrix_.resize(native_ids_identification.size());
+    std::vector<std::vector<double> > intensities_identification, intensities_detection;
+    getIntensities_(mrmfeature, native_ids_identification, intensities_identification);
+    getIntensities_(mrmfeature, native_ids_detection, intensities_detection);
+    std::vector<std::pair<std::size_t, std::size_t> > pairs;
     for (std::size_t i = 0; i < native_ids_identification.size(); i++)
-    { 
-      String native_id = native_ids_identification[i];
-      FeatureType fi = mrmfeature->getFeature(native_id);
-      xcorr_matrix_[i].resize(native_ids_detection.size());
-      intensityi.clear();
-      fi->getIntensity(intensityi);
+    {
       for (std::size_t j = 0; j < native_ids_detection.size(); j++)
       {
-        String native_id2 = native_ids_detection[j];
-        FeatureType fj = mrmfeature->getFeature(native_id2);
-        intensityj.clear();
-        fj->getIntensity(intensityj);
-        // compute normalized cross correlation
-        xcorr_matrix_[i][j] = Scoring::normalizedCrossCorrelation(intensityi, intensityj, boost::numeric_cast<int>(intensityi.size()), 1);
+        pairs.push_back(std::make_pair(i, j));
       }
     }
+    computeXCorrMatrix_(intensities_identification, intensities_detection, pairs,
+                        native_ids_identification.size(), native_ids_detection.size());
   }
 
   // see /IMSB/users/reiterl/bin/code/biognosys/trunk/libs/mrm_libs/MRM_pgroup.pm
@@ -119,17 +169,17 @@ namespace OpenSwath
   // return $deltascore_mean + $deltascore_stdev
   double MRMScoring::calcXcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
-      for (std::size_t  j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t  j = i; j < xcorr_rows_; j++)
       {
         // first is the X value (RT), should be an int
-        deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first));
+        deltas.push_back(std::abs(getXCorrMax_(i, j).first));
 #ifdef MRMSCORING_TESTING
-        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
+        std::cout << "&&_xcoel append " << std::abs(getXCorrMax_(i, j).first) << std::endl;
 #endif
       }
     }
@@ -145,21 +195,21 @@ namespace OpenSwath
 
   std::string MRMScoring::calcIndXcorrIdCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 0 && xcorr_matrix_[0].size() > 1, "Expect cross-correlation matrix of at least 2x1");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 0 && xcorr_cols_ > 1, "Expect cross-correlation matrix of at least 2x1");
 
     std::vector<double> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       double deltas_id = 0;
-      for (std::size_t  j = 0; j < xcorr_matrix_[0].size(); j++)
+      for (std::size_t  j = 0; j < xcorr_cols_; j++)
       {
         // first is the X value (RT), should be an int
-        deltas_id += std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first);
+        deltas_id += std::abs(getXCorrMax_(i, j).first);
 #ifdef MRMSCORING_TESTING
-        std::cout << "&&_xcoel append " << std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first) << std::endl;
+        std::cout << "&&_xcoel append " << std::abs(getXCorrMax_(i, j).first) << std::endl;
 #endif
       }
-      deltas.push_back(deltas_id / xcorr_matrix_[0].size());
+      deltas.push_back(deltas_id / xcorr_cols_);
     }
 
     std::stringstream ss;
@@ -176,32 +226,32 @@ namespace OpenSwath
   double MRMScoring::calcXcorrCoelutionScore_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
 #ifdef MRMSCORING_TESTING
     double weights = 0;
 #endif
     std::vector<double> deltas;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       deltas.push_back(
-        std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first)
+        std::abs(getXCorrMax_(i, i).first)
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcoel_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->first << " weight " <<
+      std::cout << "_xcoel_weighted " << i << " " << i << " " << getXCorrMax_(i, i).first << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
       weights += normalized_library_intensity[i] * normalized_library_intensity[i];
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_rows_; j++)
       {
         // first is the X value (RT), should be an int
         deltas.push_back(
-          std::abs(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first)
+          std::abs(getXCorrMax_(i, j).first)
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcoel_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->first << " weight " <<
+        std::cout << "_xcoel_weighted " << i << " " << j << " " << getXCorrMax_(i, j).first << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
         weights += normalized_library_intensity[i] * normalized_library_intensity[j];
 #endif
@@ -224,15 +274,15 @@ namespace OpenSwath
   ///
   double MRMScoring::calcXcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
-      for (std::size_t j = i; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i; j < xcorr_rows_; j++)
       {
         // second is the Y value (intensity)
-        intensities.push_back(Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second);
+        intensities.push_back(getXCorrMax_(i, j).second);
       }
     }
     OpenSwath::mean_and_stddev msc;
@@ -242,18 +292,18 @@ namespace OpenSwath
 
   std::string MRMScoring::calcIndXcorrIdShape_score()
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 0 && xcorr_matrix_[0].size() > 1, "Expect cross-correlation matrix of at least 2x1");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 0 && xcorr_cols_ > 1, "Expect cross-correlation matrix of at least 2x1");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       double intensities_id = 0;
-      for (std::size_t j = 0; j < xcorr_matrix_[0].size(); j++)
+      for (std::size_t j = 0; j < xcorr_cols_; j++)
       {
         // second is the Y value (intensity)
-        intensities_id += Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second;
+        intensities_id += getXCorrMax_(i, j).second;
       }
-      intensities.push_back(intensities_id / xcorr_matrix_[0].size());
+      intensities.push_back(intensities_id / xcorr_cols_);
     }
 
     std::stringstream ss;
@@ -270,30 +320,30 @@ namespace OpenSwath
   double MRMScoring::calcXcorrShape_score_weighted(
     const std::vector<double>& normalized_library_intensity)
   {
-    OPENSWATH_PRECONDITION(xcorr_matrix_.size() > 1, "Expect cross-correlation matrix of at least 2x2");
+    OPENSWATH_PRECONDITION(xcorr_rows_ > 1, "Expect cross-correlation matrix of at least 2x2");
 
     // TODO (hroest) : check implementation
     //         see _calc_weighted_xcorr_shape_score in MRM_pgroup.pm
     //         -- they only multiply up the intensity once
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < xcorr_matrix_.size(); i++)
+    for (std::size_t i = 0; i < xcorr_rows_; i++)
     {
       intensities.push_back(
-        Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second
+        getXCorrMax_(i, i).second
         * normalized_library_intensity[i]
         * normalized_library_intensity[i]);
 #ifdef MRMSCORING_TESTING
-      std::cout << "_xcorr_weighted " << i << " " << i << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][i])->second << " weight " <<
+      std::cout << "_xcorr_weighted " << i << " " << i << " " << getXCorrMax_(i, i).second << " weight " <<
         normalized_library_intensity[i] * normalized_library_intensity[i] << std::endl;
 #endif
-      for (std::size_t j = i + 1; j < xcorr_matrix_.size(); j++)
+      for (std::size_t j = i + 1; j < xcorr_rows_; j++)
       {
         intensities.push_back(
-          Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second
+          getXCorrMax_(i, j).second
           * normalized_library_intensity[i]
           * normalized_library_intensity[j] * 2);
 #ifdef MRMSCORING_TESTING
-        std::cout << "_xcorr_weighted " << i << " " << j << " " << Scoring::xcorrArrayGetMaxPeak(xcorr_matrix_[i][j])->second << " weight " <<
+        std::cout << "_xcorr_weighted " << i << " " << j << " " << getXCorrMax_(i, j).second << " weight " <<
           normalized_library_intensity[i] * normalized_library_intensity[j] * 2 << std::endl;
 #endif
       }
@@ -303,13 +353,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrCoelutionScore()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_max_.size() > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<int> deltas;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_max_.size(); i++)
     {
       // first is the X value (RT), should be an int
-      deltas.push_back(std::abs(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->first));
+      deltas.push_back(std::abs(ms1_xcorr_max_[i].first));
     }
 
     OpenSwath::mean_and_stddev msc;
@@ -325,13 +375,13 @@ namespace OpenSwath
 
   double MRMScoring::calcMS1XcorrShape_score()
   {
-    OPENSWATH_PRECONDITION(ms1_xcorr_vector_.size() > 1, "Expect cross-correlation vector of a size of least 2");
+    OPENSWATH_PRECONDITION(ms1_xcorr_max_.size() > 1, "Expect cross-correlation vector of a size of least 2");
 
     std::vector<double> intensities;
-    for (std::size_t i = 0; i < ms1_xcorr_vector_.size(); i++)
+    for (std::size_t i = 0; i < ms1_xcorr_max_.size(); i++)
     {
       // second is the Y value (intensity)
-      intensities.push_back(Scoring::xcorrArrayGetMaxPeak(ms1_xcorr_vector_[i])->second);
+      intensities.push_back(ms1_xcorr_max_[i].second);
     }
     OpenSwath::mean_and_stddev msc;
     msc = std::for_each(intensities.begin(), intensities.end(), msc);
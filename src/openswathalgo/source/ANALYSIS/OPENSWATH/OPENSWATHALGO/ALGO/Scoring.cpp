@@ -34,15 +34,147 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/Macros.h>
+#include <algorithm>
 #include <cmath>
+#include <complex>
 
 #include <boost/numeric/conversion/cast.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
 
 namespace OpenSwath
 {
   namespace Scoring
   {
 
+    namespace
+    {
+      typedef std::complex<double> Complex;
+
+      /// In-place iterative radix-2 FFT (the size must be a power of two); the inverse transform is not scaled
+      void fft(std::vector<Complex>& a, bool inverse)
+      {
+        const std::size_t n = a.size();
+        // bit reversal permutation
+        for (std::size_t i = 1, j = 0; i < n; ++i)
+        {
+          std::size_t bit = n >> 1;
+          for (; j & bit; bit >>= 1)
+          {
+            j ^= bit;
+          }
+          j ^= bit;
+          if (i < j)
+          {
+            std::swap(a[i], a[j]);
+          }
+        }
+        const double pi = 3.14159265358979323846;
+        for (std::size_t len = 2; len <= n; len <<= 1)
+        {
+          const double angle = 2 * pi / len * (inverse ? 1 : -1);
+          const Complex wlen(std::cos(angle), std::sin(angle));
+          for (std::size_t i = 0; i < n; i += len)
+          {
+            Complex w(1.0);
+            for (std::size_t k = 0; k < len / 2; ++k)
+            {
+              const Complex u = a[i + k];
+              const Complex v = a[i + k + len / 2] * w;
+              a[i + k] = u + v;
+              a[i + k + len / 2] = u - v;
+              w *= wlen;
+            }
+          }
+        }
+      }
+
+      /// Standardized copies of all traces
+      void standardizeTraces(const std::vector<std::vector<double> >& traces, std::vector<std::vector<double> >& result)
+      {
+        result = traces;
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+          standardize_data(result[i]);
+        }
+      }
+
+      /// Whether all values of a (standardized) trace are finite (a trace without variance standardizes to NaN/inf)
+      bool isFiniteTrace(const std::vector<double>& trace)
+      {
+        for (std::size_t i = 0; i < trace.size(); ++i)
+        {
+          if (!(boost::math::isfinite)(trace[i]))
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      /// Fourier transforms of all finite traces, zero-padded to @p fft_size (other traces get an empty transform)
+      void transformTraces(const std::vector<std::vector<double> >& traces, const std::vector<bool>& finite,
+                           std::size_t fft_size, std::vector<std::vector<Complex> >& result)
+      {
+        result.clear();
+        result.resize(traces.size());
+        // only finite traces are transformed, so that a NaN cannot spread to
+        // the trace that shares its transform
+        std::vector<std::size_t> indices;
+        for (std::size_t t = 0; t < traces.size(); ++t)
+        {
+          if (finite[t])
+          {
+            indices.push_back(t);
+          }
+        }
+        // two real traces are transformed at once (one as the real, one as
+        // the imaginary part) and then separated using the symmetry of the
+        // transform of a real sequence
+        std::vector<Complex> buffer;
+        for (std::size_t i = 0; i < indices.size(); i += 2)
+        {
+          const std::vector<double>& first = traces[indices[i]];
+          const std::vector<double>* second = (i + 1 < indices.size()) ? &traces[indices[i + 1]] : NULL;
+          buffer.assign(fft_size, Complex(0.0));
+          for (std::size_t j = 0; j < first.size(); ++j)
+          {
+            buffer[j] = Complex(first[j], second ? (*second)[j] : 0.0);
+          }
+          fft(buffer, false);
+          std::vector<Complex>& result1 = result[indices[i]];
+          result1.resize(fft_size);
+          if (second) result[indices[i + 1]].resize(fft_size);
+          for (std::size_t k = 0; k < fft_size; ++k)
+          {
+            const Complex z = buffer[k];
+            const Complex z_conj = std::conj(buffer[(fft_size - k) % fft_size]);
+            result1[k] = (z + z_conj) * 0.5;
+            if (second)
+            {
+              result[indices[i + 1]][k] = (z - z_conj) * Complex(0.0, -0.5);
+            }
+          }
+        }
+      }
+
+      /// Direct computation of the (unnormalized) correlation of the lags -n + 1 to n - 1 (same summation order as calculateCrossCorrelation)
+      void directCrossCorrelation(const double* x, const double* y, int n, double* out)
+      {
+        // the lags -n and n have no overlap and stay zero
+        for (int delay = -n + 1; delay < n; ++delay)
+        {
+          const int first = std::max(0, -delay);
+          const int last = std::min(n, n - delay);
+          double sxy = 0;
+          for (int i = first; i < last; ++i)
+          {
+            sxy += x[i] * y[i + delay];
+          }
+          out[delay + n] = sxy;
+        }
+      }
+    }
+
     void normalize_sum(double x[], unsigned int n)
     {
       double sumx = std::accumulate(&x[0], &x[0] + n, 0.0);
@@ -180,6 +312,159 @@ namespace OpenSwath
       return result;
     }
 
+    void normalizedCrossCorrelationPairs(const std::vector<std::vector<double> >& traces1,
+                                         const std::vector<std::vector<double> >& traces2,
+                                         const std::vector<std::pair<std::size_t, std::size_t> >& pairs,
+                                         std::vector<double>& result, std::size_t fft_threshold)
+    {
+      result.clear();
+      if (pairs.empty())
+      {
+        return;
+      }
+
+      const std::size_t n = traces1[pairs[0].first].size();
+      for (std::size_t p = 0; p < pairs.size(); ++p)
+      {
+        OPENSWATH_PRECONDITION(traces1[pairs[p].first].size() == n && traces2[pairs[p].second].size() == n,
+                               "All traces need to have the same length");
+      }
+      const int maxdelay = boost::numeric_cast<int>(n);
+      const std::size_t array_size = 2 * n + 1;
+      result.resize(pairs.size() * array_size, 0.0);
+
+      std::vector<std::vector<double> > data1, data2;
+      standardizeTraces(traces1, data1);
+      // if both sets of traces are the same object (e.g. all pairs within a
+      // transition group), only one copy is needed
+      const bool same_traces = (&traces1 == &traces2);
+      if (!same_traces)
+      {
+        standardizeTraces(traces2, data2);
+      }
+      const std::vector<std::vector<double> >& data2_ref = same_traces ? data1 : data2;
+
+      if (n < fft_threshold || n < 2)
+      {
+        for (std::size_t p = 0; p < pairs.size(); ++p)
+        {
+          directCrossCorrelation(&data1[pairs[p].first][0], &data2_ref[pairs[p].second][0], maxdelay, &result[p * array_size]);
+        }
+      }
+      else
+      {
+        // Traces without variance standardize to non-finite values. Their
+        // pairs are computed directly (giving the same values as
+        // normalizedCrossCorrelation), since in a shared transform the
+        // non-finite values would spread to the other trace or pair.
+        std::vector<bool> finite1(data1.size()), finite2;
+        for (std::size_t t = 0; t < data1.size(); ++t)
+        {
+          finite1[t] = isFiniteTrace(data1[t]);
+        }
+        if (!same_traces)
+        {
+          finite2.resize(data2.size());
+          for (std::size_t t = 0; t < data2.size(); ++t)
+          {
+            finite2[t] = isFiniteTrace(data2[t]);
+          }
+        }
+        const std::vector<bool>& finite2_ref = same_traces ? finite1 : finite2;
+
+        std::vector<std::size_t> fft_pairs; // indices into pairs
+        for (std::size_t p = 0; p < pairs.size(); ++p)
+        {
+          if (finite1[pairs[p].first] && finite2_ref[pairs[p].second])
+          {
+            fft_pairs.push_back(p);
+          }
+          else
+          {
+            directCrossCorrelation(&data1[pairs[p].first][0], &data2_ref[pairs[p].second][0], maxdelay, &result[p * array_size]);
+          }
+        }
+
+        // transform every trace once, then each pair needs a single inverse
+        // transform: corr(x, y)[d] = IFFT(conj(FFT(x)) * FFT(y))[d]. The
+        // transforms are zero-padded to at least 2n to avoid wrap-around.
+        std::size_t fft_size = 1;
+        while (fft_size < 2 * n)
+        {
+          fft_size <<= 1;
+        }
+        std::vector<std::vector<Complex> > transform1, transform2;
+        if (!fft_pairs.empty())
+        {
+          transformTraces(data1, finite1, fft_size, transform1);
+          if (!same_traces)
+          {
+            transformTraces(data2, finite2, fft_size, transform2);
+          }
+        }
+        const std::vector<std::vector<Complex> >& transform2_ref = same_traces ? transform1 : transform2;
+
+        // the correlation of two real traces is real, thus two pairs are
+        // computed with one inverse transform (as real and imaginary part)
+        std::vector<Complex> buffer(fft_size);
+        for (std::size_t f = 0; f < fft_pairs.size(); f += 2)
+        {
+          const std::size_t p1 = fft_pairs[f];
+          const bool has_second = f + 1 < fft_pairs.size();
+          const std::vector<Complex>& x1 = transform1[pairs[p1].first];
+          const std::vector<Complex>& y1 = transform2_ref[pairs[p1].second];
+          for (std::size_t k = 0; k < fft_size; ++k)
+          {
+            buffer[k] = std::conj(x1[k]) * y1[k];
+          }
+          double* out2 = NULL;
+          if (has_second)
+          {
+            const std::size_t p2 = fft_pairs[f + 1];
+            const std::vector<Complex>& x2 = transform1[pairs[p2].first];
+            const std::vector<Complex>& y2 = transform2_ref[pairs[p2].second];
+            for (std::size_t k = 0; k < fft_size; ++k)
+            {
+              buffer[k] += Complex(0.0, 1.0) * std::conj(x2[k]) * y2[k];
+            }
+            out2 = &result[p2 * array_size];
+          }
+          fft(buffer, true);
+
+          double* out1 = &result[p1 * array_size];
+          for (int delay = -maxdelay + 1; delay < maxdelay; ++delay)
+          {
+            const Complex& c = buffer[delay < 0 ? fft_size + delay : delay];
+            out1[delay + maxdelay] = c.real() / fft_size;
+            if (has_second)
+            {
+              out2[delay + maxdelay] = c.imag() / fft_size;
+            }
+          }
+        }
+      }
+
+      // normalize by the number of data points (as normalizedCrossCorrelation)
+      for (std::vector<double>::iterator it = result.begin(); it != result.end(); ++it)
+      {
+        *it = *it / n;
+      }
+    }
+
+    std::pair<int, double> xcorrArrayGetMaxPeak(const double* array, int maxdelay)
+    {
+      // same as for the map: the first (lowest lag) maximum wins
+      int max_idx = 0;
+      for (int i = 1; i <= 2 * maxdelay; ++i)
+      {
+        if (array[i] > array[max_idx])
+        {
+          max_idx = i;
+        }
+      }
+      return std::make_pair(max_idx - maxdelay, array[max_idx]);
+    }
+
     XCorrArrayType calcxcorr_legacy_mquest_(std::vector<double>& data1,
                                             std::vector<double>& data2, bool normalize)
     {
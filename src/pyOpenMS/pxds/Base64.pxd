@@ -17,6 +17,9 @@ cdef extern from "<OpenMS/FORMAT/Base64.h>" namespace "OpenMS":
         void encodeStrings(libcpp_vector[ String ] & in_, String &out, bool zlib_compression) nogil except +
         void decodeStrings(String & in_, libcpp_vector[ String ] &out, bool zlib_compression) nogil except +
 
+        void setKernel(Kernel kernel) nogil except +
+        Kernel getKernel() nogil except +
+
         # void decodeSingleString(const String & in, QByteArray & base64_uncompressed, bool zlib_compression);
 
 cdef extern from "<OpenMS/FORMAT/Base64.h>" namespace "OpenMS::Base64":
@@ -26,3 +29,10 @@ cdef extern from "<OpenMS/FORMAT/Base64.h>" namespace "OpenMS::Base64":
         BYTEORDER_BIGENDIAN
         BYTEORDER_LITTLEENDIAN
 
+    cdef enum Kernel "OpenMS::Base64::Kernel":
+        #wrap-attach:
+        #    Base64
+        KERNEL_SCALAR
+        KERNEL_SSSE3
+        KERNEL_AVX2
+
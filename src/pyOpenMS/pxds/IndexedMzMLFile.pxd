@@ -1,5 +1,6 @@
 from Types cimport *
 from libcpp cimport bool
+from libcpp.vector cimport vector as libcpp_vector
 from Types cimport *
 from String cimport *
 from InterfaceDataStructures cimport *
@@ -17,5 +18,6 @@ cdef extern from "<OpenMS/FORMAT/IndexedMzMLFile.h>" namespace "OpenMS":
         size_t getNrSpectra() nogil except +
         size_t getNrChromatograms() nogil except +
         shared_ptr[Spectrum] getSpectrumById(int id_) nogil except +
+        libcpp_vector[shared_ptr[Spectrum]] getSpectraByIds(libcpp_vector[int] ids) nogil except +
         shared_ptr[Chromatogram] getChromatogramById(int id_) nogil except +
 
@@ -0,0 +1,8 @@
+set(BENCHMARK_executables
+  Base64_benchmark
+  ChromatogramExtractorAlgorithm_benchmark
+  HashGrid_benchmark
+  MetaInfo_benchmark
+  MRMScoring_benchmark
+  SimpleSearchEngine_benchmark
+)
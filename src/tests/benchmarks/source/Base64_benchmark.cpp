@@ -0,0 +1,160 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/Base64.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Throughput of Base64 decoding (as used when loading mzML).
+
+  Usage: Base64_benchmark [number of values (default 10000000)] [repetitions (default 5)]
+
+  Reports the best time of all repetitions as MB of Base64 input per second:
+  - 64 bit floats decoded with each supported kernel
+  - 32 bit floats (e.g. an m/z array) decoded into doubles, once with decode()
+    followed by a conversion loop and once with decodeAndConvert()
+*/
+
+namespace
+{
+  const char* kernelName(Base64::Kernel kernel)
+  {
+    switch (kernel)
+    {
+    case Base64::KERNEL_SSSE3: return "SSSE3";
+    case Base64::KERNEL_AVX2: return "AVX2";
+    default: return "scalar";
+    }
+  }
+
+  void report(const String& name, double seconds, Size input_bytes)
+  {
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed << std::setprecision(4)
+              << seconds << " s" << std::setw(10) << std::setprecision(1) << input_bytes / seconds / 1e6 << " MB/s" << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const Size nr_values = (argc > 1) ? std::atol(argv[1]) : 10000000;
+  const Size repetitions = (argc > 2) ? std::atol(argv[2]) : 5;
+
+  // m/z-like values
+  std::srand(42);
+  std::vector<double> doubles(nr_values);
+  std::vector<float> floats(nr_values);
+  for (Size i = 0; i < nr_values; ++i)
+  {
+    doubles[i] = 200.0 + 1800.0 * std::rand() / RAND_MAX;
+    floats[i] = (float)doubles[i];
+  }
+  std::vector<double> expected_doubles(doubles);
+  std::vector<float> expected_floats(floats);
+
+  Base64 base64;
+  String encoded_64, encoded_32;
+  base64.encode(doubles, Base64::BYTEORDER_LITTLEENDIAN, encoded_64);
+  base64.encode(floats, Base64::BYTEORDER_LITTLEENDIAN, encoded_32);
+
+  std::cout << nr_values << " values, best of " << repetitions << " repetitions" << std::endl;
+
+  // 64 bit floats with each kernel
+  for (int k = Base64::KERNEL_SCALAR; k <= Base64::getSupportedKernel(); ++k)
+  {
+    base64.setKernel(static_cast<Base64::Kernel>(k));
+    double best = 1e300;
+    std::vector<double> out;
+    for (Size r = 0; r < repetitions; ++r)
+    {
+      StopWatch sw;
+      sw.start();
+      base64.decode(encoded_64, Base64::BYTEORDER_LITTLEENDIAN, out);
+      sw.stop();
+      best = std::min(best, sw.getClockTime());
+    }
+    if (out != expected_doubles) std::cerr << "Error: wrong result" << std::endl;
+    report(String("decode 64 bit (") + kernelName(base64.getKernel()) + ")", best, encoded_64.size());
+  }
+  base64.setKernel(Base64::getSupportedKernel());
+
+  // 32 bit floats into doubles: decode, then convert
+  {
+    double best = 1e300;
+    std::vector<float> tmp;
+    std::vector<double> out;
+    for (Size r = 0; r < repetitions; ++r)
+    {
+      StopWatch sw;
+      sw.start();
+      base64.decode(encoded_32, Base64::BYTEORDER_LITTLEENDIAN, tmp);
+      out.assign(tmp.begin(), tmp.end());
+      sw.stop();
+      best = std::min(best, sw.getClockTime());
+    }
+    if (tmp != expected_floats) std::cerr << "Error: wrong result" << std::endl;
+    report("decode 32 bit, then convert", best, encoded_32.size());
+  }
+
+  // 32 bit floats into doubles: fused
+  {
+    double best = 1e300;
+    std::vector<double> out;
+    for (Size r = 0; r < repetitions; ++r)
+    {
+      StopWatch sw;
+      sw.start();
+      base64.decodeAndConvert<float>(encoded_32, Base64::BYTEORDER_LITTLEENDIAN, out);
+      sw.stop();
+      best = std::min(best, sw.getClockTime());
+    }
+    for (Size i = 0; i < nr_values; ++i)
+    {
+      if (out[i] != (double)expected_floats[i])
+      {
+        std::cerr << "Error: wrong result" << std::endl;
+        break;
+      }
+    }
+    report("decodeAndConvert 32 bit -> double", best, encoded_32.size());
+  }
+
+  return 0;
+}
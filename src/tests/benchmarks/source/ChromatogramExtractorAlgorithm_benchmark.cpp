@@ -0,0 +1,195 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractorAlgorithm.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Chromatogram extraction from a SWATH window (as done by OpenSwathWorkflow).
+
+  Usage: ChromatogramExtractorAlgorithm_benchmark [number of transitions (default 100000)] [number of spectra (default 20)] [peaks per spectrum (default 20000)] [repetitions (default 3)]
+
+  The spectra contain random peaks between m/z 400 and 1400, the transitions
+  are spread over the same range and are extracted over the whole RT range.
+  For several extraction window widths, the best time of all repetitions is
+  reported for:
+  - extractChromatograms() (single sweep per spectrum)
+  - one extract_value_tophat() call per transition and spectrum (the
+    previous implementation of extractChromatograms())
+  together with the largest relative difference of the extracted intensities.
+*/
+
+namespace
+{
+  typedef ChromatogramExtractorAlgorithm::ExtractionCoordinates Coordinates;
+
+  std::vector<OpenSwath::ChromatogramPtr> emptyChromatograms(Size size)
+  {
+    std::vector<OpenSwath::ChromatogramPtr> chromatograms;
+    for (Size k = 0; k < size; ++k)
+    {
+      chromatograms.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+    return chromatograms;
+  }
+
+  /// extraction with one extract_value_tophat() call per coordinate and spectrum
+  void extractPerCoordinate(ChromatogramExtractorAlgorithm& extractor, OpenSwath::SpectrumAccessPtr input,
+                            std::vector<OpenSwath::ChromatogramPtr>& output, const std::vector<Coordinates>& coordinates,
+                            double mz_extraction_window, bool ppm)
+  {
+    for (Size scan_idx = 0; scan_idx < input->getNrSpectra(); ++scan_idx)
+    {
+      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
+      const double current_rt = input->getSpectrumMetaById(scan_idx).RT;
+      const std::vector<double>& mz_data = sptr->getMZArray()->data;
+      if (mz_data.empty()) continue;
+      std::vector<double>::const_iterator mz_it = mz_data.begin();
+      std::vector<double>::const_iterator int_it = sptr->getIntensityArray()->data.begin();
+
+      for (Size k = 0; k < coordinates.size(); ++k)
+      {
+        if (coordinates[k].rt_end - coordinates[k].rt_start > 0 &&
+            (current_rt < coordinates[k].rt_start || current_rt > coordinates[k].rt_end))
+        {
+          continue;
+        }
+        double integrated_intensity = 0;
+        extractor.extract_value_tophat(mz_data.begin(), mz_it, mz_data.end(), int_it,
+                                       coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+        output[k]->binaryDataArrayPtrs[0]->data.push_back(current_rt);
+        output[k]->binaryDataArrayPtrs[1]->data.push_back(integrated_intensity);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const Size nr_coordinates = (argc > 1) ? std::atol(argv[1]) : 100000;
+  const Size nr_spectra = (argc > 2) ? std::atol(argv[2]) : 20;
+  const Size nr_peaks = (argc > 3) ? std::atol(argv[3]) : 20000;
+  const Size repetitions = (argc > 4) ? std::atol(argv[4]) : 3;
+  const double windows[] = {0.01, 0.05, 0.2};
+
+  std::srand(42);
+  boost::shared_ptr<MSExperiment<Peak1D> > exp(new MSExperiment<Peak1D>);
+  for (Size s = 0; s < nr_spectra; ++s)
+  {
+    MSSpectrum<Peak1D> spectrum;
+    spectrum.setRT(s * 3.0);
+    spectrum.resize(nr_peaks);
+    for (Size i = 0; i < nr_peaks; ++i)
+    {
+      spectrum[i].setMZ(400.0 + 1000.0 * std::rand() / RAND_MAX);
+      spectrum[i].setIntensity(1000.0 * std::rand() / RAND_MAX);
+    }
+    spectrum.sortByPosition();
+    exp->addSpectrum(spectrum);
+  }
+  OpenSwath::SpectrumAccessPtr input(new SpectrumAccessOpenMS(exp));
+
+  std::vector<Coordinates> coordinates(nr_coordinates);
+  for (Size k = 0; k < nr_coordinates; ++k)
+  {
+    coordinates[k].mz = 400.0 + 1000.0 * std::rand() / RAND_MAX;
+    coordinates[k].rt_start = 0.0;
+    coordinates[k].rt_end = -1.0;
+    coordinates[k].id = String(k);
+  }
+  std::sort(coordinates.begin(), coordinates.end(), Coordinates::SortExtractionCoordinatesByMZ);
+
+  std::cout << nr_coordinates << " transitions, " << nr_spectra << " spectra of " << nr_peaks
+            << " peaks, best of " << repetitions << " repetitions" << std::endl;
+  std::cout << std::setw(10) << "window" << std::setw(14) << "sweep" << std::setw(18) << "per coordinate"
+            << std::setw(10) << "speedup" << std::setw(14) << "max. diff." << std::endl;
+
+  ChromatogramExtractorAlgorithm extractor;
+  for (Size w = 0; w < sizeof(windows) / sizeof(windows[0]); ++w)
+  {
+    double best_sweep = 1e300, best_old = 1e300;
+    std::vector<OpenSwath::ChromatogramPtr> output, output_old;
+    for (Size r = 0; r < repetitions; ++r)
+    {
+      output = emptyChromatograms(nr_coordinates);
+      StopWatch sw;
+      sw.start();
+      extractor.extractChromatograms(input, output, coordinates, windows[w], false, "tophat");
+      sw.stop();
+      best_sweep = std::min(best_sweep, sw.getClockTime());
+
+      output_old = emptyChromatograms(nr_coordinates);
+      sw.reset();
+      sw.start();
+      extractPerCoordinate(extractor, input, output_old, coordinates, windows[w], false);
+      sw.stop();
+      best_old = std::min(best_old, sw.getClockTime());
+    }
+
+    double max_diff = 0.0;
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      const std::vector<double>& intensities = output[k]->binaryDataArrayPtrs[1]->data;
+      const std::vector<double>& intensities_old = output_old[k]->binaryDataArrayPtrs[1]->data;
+      if (intensities.size() != intensities_old.size())
+      {
+        std::cerr << "Error: different number of data points" << std::endl;
+        return 1;
+      }
+      for (Size i = 0; i < intensities.size(); ++i)
+      {
+        const double diff = std::fabs(intensities[i] - intensities_old[i]);
+        if (diff > 0.0) max_diff = std::max(max_diff, diff / std::fabs(intensities_old[i]));
+      }
+    }
+
+    std::cout << std::setw(7) << std::fixed << std::setprecision(2) << windows[w] << " Th"
+              << std::setw(12) << std::setprecision(3) << best_sweep << " s" << std::setw(16) << best_old << " s"
+              << std::setw(9) << std::setprecision(1) << best_old / best_sweep << "x"
+              << std::scientific << std::setw(14) << std::setprecision(1) << max_diff << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,160 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/COMPARISON/CLUSTERING/HashGrid.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Building a HashGrid and querying neighbourhoods (as done by QTClusterFinder).
+
+  Usage: HashGrid_benchmark [number of points (default 1000000)] [repetitions (default 3)]
+
+  The points are spread uniformly over an LC-MS map (RT 0-6000 s, m/z
+  200-2000) with the default cell size of QTClusterFinder (100 s, 0.3 m/z).
+  Reports the best time of all repetitions for:
+  - building the grid with single insert() calls and with the range insert()
+  - neighbourhood queries: for (up to 10^6 of) the points, all points in the
+    3x3 cells around it are checked against the cell size (queries per second)
+*/
+
+namespace
+{
+  typedef HashGrid<Size> Grid;
+
+  void report(const String& name, double seconds, Size count, const String& unit)
+  {
+    std::cout << std::left << std::setw(30) << name << std::right << std::setw(10) << std::fixed << std::setprecision(4)
+              << seconds << " s" << std::setw(14) << std::setprecision(0) << count / seconds << " " << unit << std::endl;
+  }
+
+  Size countNeighbors(const Grid& grid, const Grid::ClusterCenter& position)
+  {
+    Size count = 0;
+    const Grid::CellIndex index = grid.cell_index(position);
+    for (Int64 i = index[0] - 1; i <= index[0] + 1; ++i)
+    {
+      for (Int64 j = index[1] - 1; j <= index[1] + 1; ++j)
+      {
+        const Grid::CellContent* cell = grid.grid_find(Grid::CellIndex(i, j));
+        if (cell == 0) continue;
+        for (Grid::const_cell_iterator it = cell->begin(); it != cell->end(); ++it)
+        {
+          if (std::fabs(it->first[0] - position[0]) <= grid.cell_dimension[0] &&
+              std::fabs(it->first[1] - position[1]) <= grid.cell_dimension[1])
+          {
+            ++count;
+          }
+        }
+      }
+    }
+    return count;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const Size nr_points = (argc > 1) ? std::atol(argv[1]) : 1000000;
+  const Size repetitions = (argc > 2) ? std::atol(argv[2]) : 3;
+  const Grid::ClusterCenter cell_dimension(100.0, 0.3);
+
+  std::srand(42);
+  std::vector<Grid::value_type> points(nr_points);
+  for (Size i = 0; i < nr_points; ++i)
+  {
+    points[i] = std::make_pair(Grid::ClusterCenter(6000.0 * std::rand() / RAND_MAX,
+                                                   200.0 + 1800.0 * std::rand() / RAND_MAX), i);
+  }
+
+  std::cout << nr_points << " points, best of " << repetitions << " repetitions" << std::endl;
+
+  double best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    Grid grid(cell_dimension);
+    for (std::vector<Grid::value_type>::const_iterator it = points.begin(); it != points.end(); ++it)
+    {
+      grid.insert(*it);
+    }
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("insert (single)", best, nr_points, "points/s");
+
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    Grid tmp(cell_dimension);
+    tmp.insert(points.begin(), points.end());
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("insert (range)", best, nr_points, "points/s");
+
+  Grid grid(cell_dimension);
+  grid.insert(points.begin(), points.end());
+
+  const Size nr_queries = std::min(nr_points, Size(1000000));
+  const Size step = nr_points / nr_queries;
+  best = 1e300;
+  Size neighbors = 0;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    neighbors = 0;
+    for (Size q = 0; q < nr_queries; ++q)
+    {
+      neighbors += countNeighbors(grid, points[q * step].first);
+    }
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("neighbourhood queries", best, nr_queries, "queries/s");
+  std::cout << "average neighbourhood size: " << std::setprecision(2) << double(neighbors) / nr_queries << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,188 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/MRMScoring.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/StatsHelpers.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/DATAACCESS/MockObjects.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Cross-correlation scores of OpenSwath transition groups (MRMScoring).
+
+  Usage: MRMScoring_benchmark [number of transition groups (default 1000)] [transitions per group (default 6)] [repetitions (default 3)]
+
+  Every transition group consists of Gaussian peaks with random shifts and
+  noise. For a range of trace lengths, the xcorr coelution and shape scores
+  of all groups are computed:
+  - map-based: normalizedCrossCorrelation() and the std::map peak search for
+    every pair of transitions (as MRMScoring did before the dense arrays)
+  - MRMScoring: initializeXCorrMatrix() (dense arrays, FFT for long traces)
+  Reports the best time of all repetitions per transition group and the
+  largest score difference between the two computations.
+*/
+
+namespace
+{
+  double uniform()
+  {
+    return double(std::rand()) / RAND_MAX;
+  }
+
+  void fillGroup(OpenSwath::MockMRMFeature& feature, std::vector<std::string>& native_ids,
+                 Size nr_transitions, Size length)
+  {
+    native_ids.clear();
+    const double width = length / 10.0 + 1.0;
+    for (Size t = 0; t < nr_transitions; ++t)
+    {
+      std::ostringstream id;
+      id << "transition_" << t;
+      native_ids.push_back(id.str());
+
+      boost::shared_ptr<OpenSwath::MockFeature> trace(new OpenSwath::MockFeature());
+      const double apex = length / 2.0 + (uniform() - 0.5) * width;
+      const double height = 100.0 + 1000.0 * uniform();
+      trace->m_intensity_vec.resize(length);
+      for (Size i = 0; i < length; ++i)
+      {
+        const double d = (i - apex) / width;
+        trace->m_intensity_vec[i] = height * std::exp(-d * d) + 10.0 * uniform();
+      }
+      feature.m_features[native_ids.back()] = trace;
+    }
+  }
+
+  /// the scores as computed from one std::map per pair of transitions
+  void mapBasedScores(OpenSwath::MockMRMFeature& feature, const std::vector<std::string>& native_ids,
+                      double& coelution, double& shape)
+  {
+    std::vector<int> deltas;
+    std::vector<double> intensities;
+    for (Size i = 0; i < native_ids.size(); ++i)
+    {
+      for (Size j = i; j < native_ids.size(); ++j)
+      {
+        std::vector<double> data1, data2;
+        feature.getFeature(native_ids[i])->getIntensity(data1);
+        feature.getFeature(native_ids[j])->getIntensity(data2);
+        OpenSwath::Scoring::XCorrArrayType xcorr = OpenSwath::Scoring::normalizedCrossCorrelation(data1, data2, (int)data1.size(), 1);
+        OpenSwath::Scoring::XCorrArrayType::iterator max_peak = OpenSwath::Scoring::xcorrArrayGetMaxPeak(xcorr);
+        deltas.push_back(std::abs(max_peak->first));
+        intensities.push_back(max_peak->second);
+      }
+    }
+    OpenSwath::mean_and_stddev msc;
+    msc = std::for_each(deltas.begin(), deltas.end(), msc);
+    coelution = msc.mean() + msc.sample_stddev();
+    OpenSwath::mean_and_stddev msc_shape;
+    msc_shape = std::for_each(intensities.begin(), intensities.end(), msc_shape);
+    shape = msc_shape.mean();
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const Size nr_groups = (argc > 1) ? std::atol(argv[1]) : 1000;
+  const Size nr_transitions = (argc > 2) ? std::atol(argv[2]) : 6;
+  const Size repetitions = (argc > 3) ? std::atol(argv[3]) : 3;
+  const Size lengths[] = {16, 32, 64, 128, 256, 512, 1024};
+
+  std::cout << nr_groups << " transition groups of " << nr_transitions << " transitions, best of "
+            << repetitions << " repetitions (time per transition group)" << std::endl;
+  std::cout << std::setw(8) << "length" << std::setw(16) << "map-based" << std::setw(16) << "MRMScoring"
+            << std::setw(10) << "speedup" << std::setw(16) << "max. diff." << std::endl;
+
+  std::srand(42);
+  for (Size l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+  {
+    // the map-based computation is quadratic in the trace length
+    const Size groups = lengths[l] > 256 ? std::max(Size(1), nr_groups / 10) : nr_groups;
+    std::vector<OpenSwath::MockMRMFeature> features(groups);
+    std::vector<std::vector<std::string> > native_ids(groups);
+    for (Size g = 0; g < groups; ++g)
+    {
+      fillGroup(features[g], native_ids[g], nr_transitions, lengths[l]);
+    }
+
+    std::vector<double> coelution_map(groups), shape_map(groups), coelution(groups), shape(groups);
+    double best_map = 1e300, best = 1e300;
+    for (Size r = 0; r < repetitions; ++r)
+    {
+      StopWatch sw;
+      sw.start();
+      for (Size g = 0; g < groups; ++g)
+      {
+        mapBasedScores(features[g], native_ids[g], coelution_map[g], shape_map[g]);
+      }
+      sw.stop();
+      best_map = std::min(best_map, sw.getClockTime());
+
+      sw.reset();
+      sw.start();
+      for (Size g = 0; g < groups; ++g)
+      {
+        OpenSwath::MRMScoring scoring;
+        scoring.initializeXCorrMatrix(&features[g], native_ids[g]);
+        coelution[g] = scoring.calcXcorrCoelutionScore();
+        shape[g] = scoring.calcXcorrShape_score();
+      }
+      sw.stop();
+      best = std::min(best, sw.getClockTime());
+    }
+
+    double max_diff = 0.0;
+    for (Size g = 0; g < groups; ++g)
+    {
+      max_diff = std::max(max_diff, std::fabs(coelution[g] - coelution_map[g]));
+      max_diff = std::max(max_diff, std::fabs(shape[g] - shape_map[g]));
+    }
+
+    std::cout << std::setw(8) << lengths[l] << std::fixed << std::setprecision(1)
+              << std::setw(13) << best_map / groups * 1e6 << " us" << std::setw(13) << best / groups * 1e6 << " us"
+              << std::setw(9) << best_map / best << "x" << std::scientific << std::setprecision(1) << std::setw(16) << max_diff << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,247 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/METADATA/PeptideHit.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/METADATA/ProteinIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+#include <OpenMS/SYSTEM/SysInfo.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Memory and speed of meta values (MetaInfo / MetaInfoRegistry).
+
+  Usage: MetaInfo_benchmark [number of peptide hits (default 1000000)] [meta values per object (default 4)] [repetitions (default 3)]
+
+  Reports:
+  - the memory per PeptideHit (without sequence) carrying the meta values,
+    from the memory consumption of the process
+  - the best time of all repetitions for setting and getting all meta
+    values by name, getting them by index and copying all hits
+  - the best time of all repetitions for loading an idXML file with these
+    hits (10 per peptide identification) and a featureXML file with one
+    feature per peptide identification (both carrying the meta values)
+*/
+
+namespace
+{
+  void report(const String& name, double seconds, Size count)
+  {
+    std::cout << std::left << std::setw(36) << name << std::right << std::setw(10) << std::fixed << std::setprecision(4)
+              << seconds << " s" << std::setw(14) << std::setprecision(0) << count / seconds << " /s" << std::endl;
+  }
+
+  template <typename T>
+  void setMetaValues(T& object, const std::vector<String>& names, Size i)
+  {
+    for (Size k = 0; k < names.size(); ++k)
+    {
+      if (k % 2 == 0) object.setMetaValue(names[k], double(i + k) / 7.0);
+      else object.setMetaValue(names[k], String(i + k));
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const Size nr_hits = (argc > 1) ? std::atol(argv[1]) : 1000000;
+  const Size nr_values = (argc > 2) ? std::atol(argv[2]) : 4;
+  const Size repetitions = (argc > 3) ? std::atol(argv[3]) : 3;
+
+  std::vector<String> names;
+  std::vector<UInt> indices;
+  for (Size k = 0; k < nr_values; ++k)
+  {
+    names.push_back(String("benchmark_value_") + k);
+    indices.push_back(MetaInfoInterface::metaRegistry().registerName(names.back(), ""));
+  }
+
+  std::cout << nr_hits << " peptide hits with " << nr_values << " meta values, best of "
+            << repetitions << " repetitions" << std::endl;
+
+  // memory per hit
+  size_t mem_before = 0, mem_after = 0;
+  SysInfo::getProcessMemoryConsumption(mem_before);
+  std::vector<PeptideHit> hits(nr_hits);
+  for (Size i = 0; i < nr_hits; ++i)
+  {
+    setMetaValues(hits[i], names, i);
+  }
+  SysInfo::getProcessMemoryConsumption(mem_after);
+  std::cout << "memory per PeptideHit: " << (mem_after - mem_before) * 1024.0 / nr_hits << " bytes (sizeof(PeptideHit): "
+            << sizeof(PeptideHit) << " bytes)" << std::endl;
+
+  double best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    for (Size i = 0; i < nr_hits; ++i)
+    {
+      setMetaValues(hits[i], names, i + r);
+    }
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("setMetaValue (name)", best, nr_hits * nr_values);
+
+  Size checksum = 0;
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    for (Size i = 0; i < nr_hits; ++i)
+    {
+      for (Size k = 0; k < nr_values; ++k)
+      {
+        checksum += hits[i].getMetaValue(names[k]).valueType();
+      }
+    }
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("getMetaValue (name)", best, nr_hits * nr_values);
+
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    for (Size i = 0; i < nr_hits; ++i)
+    {
+      for (Size k = 0; k < nr_values; ++k)
+      {
+        checksum += hits[i].getMetaValue(indices[k]).valueType();
+      }
+    }
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("getMetaValue (index)", best, nr_hits * nr_values);
+
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    std::vector<PeptideHit> copy(hits);
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+    checksum += copy.size();
+  }
+  report("copy PeptideHits", best, nr_hits);
+  if (checksum == 0) std::cerr << "Error: nothing read" << std::endl;
+
+  // files with the hits
+  std::vector<ProteinIdentification> proteins(1);
+  proteins[0].setIdentifier("benchmark");
+  proteins[0].setSearchEngine("benchmark");
+  proteins[0].setScoreType("score");
+  std::vector<PeptideIdentification> peptides(nr_hits / 10 + 1);
+  FeatureMap features;
+  const String residues = "ACDEFGHIKLMNPQRSTVWY";
+  for (Size i = 0; i < nr_hits; ++i)
+  {
+    PeptideIdentification& peptide = peptides[i / 10];
+    String sequence = "PEPTIDE";
+    sequence += residues[i % residues.size()];
+    sequence += residues[(i / residues.size()) % residues.size()];
+    hits[i].setSequence(AASequence::fromString(sequence + "K"));
+    hits[i].setScore(double(i % 100));
+    peptide.insertHit(hits[i]);
+  }
+  for (Size p = 0; p < peptides.size(); ++p)
+  {
+    peptides[p].setIdentifier("benchmark");
+    peptides[p].setScoreType("score");
+    peptides[p].setRT(double(p));
+    peptides[p].setMZ(400.0 + p % 1000);
+    setMetaValues(peptides[p], names, p);
+
+    Feature feature;
+    feature.setRT(double(p));
+    feature.setMZ(400.0 + p % 1000);
+    feature.setIntensity(1000.0);
+    feature.setUniqueId(p + 1);
+    setMetaValues(feature, names, p);
+    features.push_back(feature);
+  }
+  hits.clear();
+
+  const String id_file = File::getTempDirectory() + "/MetaInfo_benchmark.idXML";
+  const String feature_file = File::getTempDirectory() + "/MetaInfo_benchmark.featureXML";
+  IdXMLFile().store(id_file, proteins, peptides);
+  FeatureXMLFile().store(feature_file, features);
+
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    std::vector<ProteinIdentification> loaded_proteins;
+    std::vector<PeptideIdentification> loaded_peptides;
+    StopWatch sw;
+    sw.start();
+    IdXMLFile().load(id_file, loaded_proteins, loaded_peptides);
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("load idXML (peptide hits)", best, nr_hits);
+
+  best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    FeatureMap loaded_features;
+    StopWatch sw;
+    sw.start();
+    FeatureXMLFile().load(feature_file, loaded_features);
+    sw.stop();
+    best = std::min(best, sw.getClockTime());
+  }
+  report("load featureXML (features)", best, features.size());
+
+  File::remove(id_file);
+  File::remove(feature_file);
+
+  return 0;
+}
@@ -0,0 +1,234 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CHEMISTRY/AASequence.h>
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/CONCEPT/Constants.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/MSExperiment.h>
+#include <OpenMS/KERNEL/StandardTypes.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/METADATA/ProteinIdentification.h>
+#include <OpenMS/SYSTEM/File.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace OpenMS;
+
+/**
+  Database search with the SimpleSearchEngine TOPP tool.
+
+  Usage: SimpleSearchEngine_benchmark <SimpleSearchEngine executable> [number of spectra (default 10000)] [repetitions (default 3)] [FASTA database, e.g. a human proteome (default: 20000 random proteins)]
+
+  Without a database, random proteins with the amino acid composition of
+  the human proteome are generated. The spectra are the b and y ions of
+  random tryptic peptides of the database (random intensities, charge 2
+  precursors) plus 50 random noise peaks each. The tool is run on one
+  thread with default settings (10 ppm precursor and fragment tolerance,
+  one missed cleavage, no modifications), and the best time of all
+  repetitions is reported together with the fraction of spectra whose top
+  hit is the peptide they were generated from.
+
+  To compare two versions of the tool, run the benchmark once with each
+  executable.
+*/
+
+namespace
+{
+  double random01()
+  {
+    return double(std::rand()) / RAND_MAX;
+  }
+
+  /// random protein sequence with the amino acid composition of the human proteome
+  String randomProtein(Size length)
+  {
+    static const char residues[] = "ARNDCQEGHILKMFPSTWYV";
+    static const double frequencies[] = {7.0, 5.6, 3.6, 4.7, 2.3, 4.8, 7.1, 6.6, 2.6, 4.3,
+                                         10.0, 5.7, 2.1, 3.7, 6.3, 8.3, 5.4, 1.2, 2.7, 6.0};
+    String sequence;
+    sequence.reserve(length);
+    for (Size i = 0; i < length; ++i)
+    {
+      double r = random01() * 100.0;
+      Size k = 0;
+      while (k < 19 && r >= frequencies[k])
+      {
+        r -= frequencies[k];
+        ++k;
+      }
+      sequence += residues[k];
+    }
+    return sequence;
+  }
+
+  /// peptide without amino acids that cannot be used to generate a spectrum
+  bool isUsablePeptide(const String& sequence)
+  {
+    return sequence.size() >= 7 && sequence.size() <= 40 && sequence.find_first_of("BJOUXZ*") == String::npos;
+  }
+
+  PeakSpectrum simulateSpectrum(const TheoreticalSpectrumGenerator& generator, const AASequence& peptide, Size index)
+  {
+    RichPeakSpectrum theoretical;
+    generator.getSpectrum(theoretical, peptide, 1);
+
+    PeakSpectrum spectrum;
+    for (Size i = 0; i < theoretical.size(); ++i)
+    {
+      Peak1D peak;
+      peak.setMZ(theoretical[i].getMZ());
+      peak.setIntensity(100.0 + 900.0 * random01());
+      spectrum.push_back(peak);
+    }
+    const double mass = peptide.getMonoWeight();
+    for (Size i = 0; i < 50; ++i)
+    {
+      Peak1D peak;
+      peak.setMZ(100.0 + (mass - 100.0) * random01());
+      peak.setIntensity(10.0 + 200.0 * random01());
+      spectrum.push_back(peak);
+    }
+    spectrum.sortByPosition();
+
+    Precursor precursor;
+    precursor.setCharge(2);
+    precursor.setMZ((mass + 2.0 * Constants::PROTON_MASS_U) / 2.0);
+    spectrum.getPrecursors().push_back(precursor);
+    spectrum.setMSLevel(2);
+    spectrum.setRT(double(index));
+    spectrum.setNativeID(String("index=") + index);
+    return spectrum;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <SimpleSearchEngine executable> [number of spectra (default 10000)] [repetitions (default 3)] [FASTA database (default: 20000 random proteins)]" << std::endl;
+    return 1;
+  }
+  const String executable = argv[1];
+  const Size nr_spectra = (argc > 2) ? std::atol(argv[2]) : 10000;
+  const Size repetitions = (argc > 3) ? std::atol(argv[3]) : 3;
+
+  std::srand(42);
+  std::vector<FASTAFile::FASTAEntry> database;
+  if (argc > 4)
+  {
+    FASTAFile().load(argv[4], database);
+  }
+  else
+  {
+    for (Size p = 0; p < 20000; ++p)
+    {
+      database.push_back(FASTAFile::FASTAEntry(String("PROT_") + p, "", randomProtein(150 + std::rand() % 800)));
+    }
+  }
+
+  EnzymaticDigestion digestor;
+  digestor.setEnzyme("Trypsin");
+  digestor.setMissedCleavages(0);
+  TheoreticalSpectrumGenerator generator;
+  PeakMap spectra;
+  std::vector<String> true_peptides;
+  while (spectra.size() < nr_spectra)
+  {
+    const String& protein = database[std::rand() % database.size()].sequence;
+    if (protein.find_first_of("BJOUXZ*") != String::npos) continue;
+    std::vector<AASequence> peptides;
+    digestor.digest(AASequence::fromString(protein), peptides);
+    if (peptides.empty()) continue;
+    const AASequence& peptide = peptides[std::rand() % peptides.size()];
+    if (!isUsablePeptide(peptide.toUnmodifiedString())) continue;
+    spectra.addSpectrum(simulateSpectrum(generator, peptide, spectra.size()));
+    true_peptides.push_back(peptide.toUnmodifiedString());
+  }
+
+  const String base = File::getTempDirectory() + "/SimpleSearchEngine_benchmark";
+  FASTAFile().store(base + ".fasta", database);
+  MzMLFile().store(base + ".mzML", spectra);
+
+  const String command = "\"" + executable + "\" -in \"" + base + ".mzML\" -database \"" + base + ".fasta\" -out \""
+                         + base + ".idXML\" -threads 1 -no_progress > \"" + base + ".log\" 2>&1";
+
+  std::cout << database.size() << " proteins, " << nr_spectra << " spectra, best of " << repetitions << " repetitions" << std::endl;
+  double best = 1e300;
+  for (Size r = 0; r < repetitions; ++r)
+  {
+    StopWatch sw;
+    sw.start();
+    const int status = std::system(command.c_str());
+    sw.stop();
+    if (status != 0)
+    {
+      std::cerr << "Error: '" << command << "' failed, see " << base << ".log" << std::endl;
+      return 1;
+    }
+    best = std::min(best, sw.getClockTime());
+  }
+
+  std::vector<ProteinIdentification> proteins;
+  std::vector<PeptideIdentification> peptides;
+  IdXMLFile().load(base + ".idXML", proteins, peptides);
+  Size correct = 0;
+  for (Size i = 0; i < peptides.size(); ++i)
+  {
+    const Size index = Size(peptides[i].getRT() + 0.5);
+    if (!peptides[i].getHits().empty() && index < true_peptides.size() &&
+        peptides[i].getHits()[0].getSequence().toUnmodifiedString() == true_peptides[index])
+    {
+      ++correct;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision(2) << "search: " << best << " s (" << std::setprecision(0)
+            << nr_spectra / best << " spectra/s)" << std::endl;
+  std::cout << std::setprecision(1) << "top hit is the simulated peptide: " << 100.0 * correct / nr_spectra << " % of the spectra" << std::endl;
+
+  File::remove(base + ".fasta");
+  File::remove(base + ".mzML");
+  File::remove(base + ".idXML");
+  File::remove(base + ".log");
+  return 0;
+}
@@ -123,6 +123,7 @@ set(kernel_executables_list
   BaseFeature_test
   ChromatogramPeak_test
   ChromatogramTools_test
+  ColumnarSpectrum_test
   ComparatorUtils_test
   ConsensusFeature_test
   ConsensusMap_test
@@ -155,6 +156,7 @@ set(format_executables_list
   Bzip2Ifstream_test
   Bzip2InputStream_test
   CVMappingFile_test
+  ColumnarTableFile_test
   CompressedInputSource_test
   ConsensusXMLFile_test
   ControlledVocabulary_test
@@ -201,6 +203,8 @@ set(format_executables_list
   TraMLValidator_test
   OMSSACSVFile_test
   OMSSAXMLFile_test
+  OnDiscSpectrumCache_test
+  OnDiscSpectrumIndex_test
   PTMXMLFile_test
   ParamXMLFile_test
   PeakFileOptions_test
@@ -208,6 +212,7 @@ set(format_executables_list
   PepNovoInfile_test
   PepNovoOutfile_test
   PepXMLFileMascot_test
+  PeptideIndexFile_test
   PepXMLFile_test
   PercolatorOutfile_test
   ProtXMLFile_test
@@ -532,6 +537,7 @@ set(transformations_executables_list
   OptimizePick_test
   PeakPickerCWT_test
   PeakPickerHiRes_test
+  PeakPickerHiResConsumer_test
   PeakPickerIterative_test
   PeakPickerMaxima_test
   PeakPickerSH_test
@@ -586,6 +592,7 @@ if(NOT DISABLE_OPENSWATH)
     ChromatogramExtractorAlgorithm_test
     OpenSwathHelper_test
     OpenSwathScoring_test
+    OpenSwathTSVWriter_test
     PeakPickerMRM_test
     MRMTransitionGroupPicker_test
     DIAHelper_test
@@ -600,6 +607,7 @@ if(NOT DISABLE_OPENSWATH)
     SpectrumHelpers_test
     StatsHelpers_test
     CachedMzML_test
+    SpectrumAccessOpenMSCached_test
   )
 endif(NOT DISABLE_OPENSWATH)
 
@@ -494,6 +494,155 @@ START_SECTION((template <typename FromType> void encodeIntegers(std::vector<From
 }
 END_SECTION
 
+START_SECTION((static Kernel getSupportedKernel()))
+{
+  Base64::Kernel kernel = Base64::getSupportedKernel();
+  TEST_EQUAL(kernel >= Base64::KERNEL_SCALAR && kernel <= Base64::KERNEL_AVX2, true)
+  // detection is cached and does not change
+  TEST_EQUAL(Base64::getSupportedKernel(), kernel)
+  // a new object uses the fastest kernel
+  Base64 b64;
+  TEST_EQUAL(b64.getKernel(), kernel)
+}
+END_SECTION
+
+START_SECTION((void setKernel(Kernel kernel)))
+{
+  Base64 b64;
+  b64.setKernel(Base64::KERNEL_SCALAR);
+  TEST_EQUAL(b64.getKernel(), Base64::KERNEL_SCALAR)
+  // unsupported kernels fall back to the fastest supported one
+  b64.setKernel(Base64::KERNEL_AVX2);
+  TEST_EQUAL(b64.getKernel(), Base64::getSupportedKernel())
+}
+END_SECTION
+
+START_SECTION((Kernel getKernel() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((template <typename FromType, typename ToType> void decodeAndConvert(const String& in, ByteOrder from_byte_order, std::vector<ToType>& out, bool zlib_compression = false)))
+  TOLERANCE_ABSOLUTE(0.001)
+{
+  Base64 b64;
+  std::vector<double> res;
+
+  b64.decodeAndConvert<float>("", Base64::BYTEORDER_BIGENDIAN, res);
+  TEST_EQUAL(res.size(), 0)
+
+  // 32 bit floats directly into doubles
+  b64.decodeAndConvert<float>("Q+vIuEec9YBD7TgoR/HTgEPt23hHA8UA", Base64::BYTEORDER_BIGENDIAN, res);
+  TEST_EQUAL(res.size(), 6)
+  TEST_REAL_SIMILAR(res[0], 471.568)
+  TEST_REAL_SIMILAR(res[1], 80363)
+  TEST_REAL_SIMILAR(res[2], 474.439)
+  TEST_REAL_SIMILAR(res[3], 123815)
+  TEST_REAL_SIMILAR(res[4], 475.715)
+  TEST_REAL_SIMILAR(res[5], 33733)
+
+  b64.decodeAndConvert<float>("JhOWQ8b/l0PMTJhD", Base64::BYTEORDER_LITTLEENDIAN, res);
+  TEST_EQUAL(res.size(), 3)
+  TEST_REAL_SIMILAR(res[0], 300.15)
+  TEST_REAL_SIMILAR(res[1], 303.998)
+  TEST_REAL_SIMILAR(res[2], 304.6)
+
+  // compressed input
+  std::vector<float> in;
+  in.push_back(300.15f);
+  in.push_back(303.998f);
+  in.push_back(304.6f);
+  String encoded;
+  b64.encode(in, Base64::BYTEORDER_BIGENDIAN, encoded, true);
+  b64.decodeAndConvert<float>(encoded, Base64::BYTEORDER_BIGENDIAN, res, true);
+  TEST_EQUAL(res.size(), 3)
+  TEST_REAL_SIMILAR(res[0], 300.15)
+  TEST_REAL_SIMILAR(res[1], 303.998)
+  TEST_REAL_SIMILAR(res[2], 304.6)
+
+  // 32 bit integers into 64 bit integers
+  std::vector<Int32> ints;
+  ints.push_back(-5);
+  ints.push_back(123456789);
+  b64.encodeIntegers(ints, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+  std::vector<Int64> res_int;
+  b64.decodeAndConvert<Int32>(encoded, Base64::BYTEORDER_LITTLEENDIAN, res_int);
+  TEST_EQUAL(res_int.size(), 2)
+  TEST_EQUAL(res_int[0], -5)
+  TEST_EQUAL(res_int[1], 123456789)
+}
+END_SECTION
+
+START_SECTION([EXTRA] all kernels yield identical results)
+{
+  // lengths around the SIMD block sizes and the internal 3 KB blocks
+  Size lengths[] = {0, 1, 2, 3, 5, 6, 7, 11, 12, 13, 23, 24, 25, 47, 48, 49, 383, 384, 385, 1000, 5000};
+  srand(42);
+  for (Size l = 0; l < sizeof(lengths) / sizeof(Size); ++l)
+  {
+    std::vector<double> values;
+    for (Size i = 0; i < lengths[l]; ++i)
+    {
+      values.push_back((rand() - RAND_MAX / 2) * 0.0137);
+    }
+    std::vector<float> values_32(values.begin(), values.end());
+
+    for (Size order = 0; order < 2; ++order)
+    {
+      Base64::ByteOrder byte_order = (order == 0) ? Base64::BYTEORDER_LITTLEENDIAN : Base64::BYTEORDER_BIGENDIAN;
+
+      Base64 scalar;
+      scalar.setKernel(Base64::KERNEL_SCALAR);
+      String scalar_64, scalar_32;
+      std::vector<double> tmp = values;
+      scalar.encode(tmp, byte_order, scalar_64);
+      std::vector<float> tmp_32 = values_32;
+      scalar.encode(tmp_32, byte_order, scalar_32);
+
+      for (Size k = Base64::KERNEL_SCALAR; k <= (Size)Base64::getSupportedKernel(); ++k)
+      {
+        Base64 b64;
+        b64.setKernel((Base64::Kernel)k);
+
+        String encoded;
+        tmp = values;
+        b64.encode(tmp, byte_order, encoded);
+        TEST_EQUAL(encoded, scalar_64)
+        std::vector<double> decoded;
+        b64.decode(encoded, byte_order, decoded);
+        TEST_EQUAL(decoded == values, true)
+
+        tmp_32 = values_32;
+        b64.encode(tmp_32, byte_order, encoded);
+        TEST_EQUAL(encoded, scalar_32)
+        std::vector<float> decoded_32;
+        b64.decode(encoded, byte_order, decoded_32);
+        TEST_EQUAL(decoded_32 == values_32, true)
+        b64.decodeAndConvert<float>(encoded, byte_order, decoded);
+        TEST_EQUAL(decoded == std::vector<double>(values_32.begin(), values_32.end()), true)
+      }
+    }
+  }
+
+  // characters outside of the alphabet are handled the same by all kernels
+  std::vector<double> values(100, 1.5);
+  String encoded;
+  Base64 scalar;
+  scalar.setKernel(Base64::KERNEL_SCALAR);
+  scalar.encode(values, Base64::BYTEORDER_LITTLEENDIAN, encoded);
+  encoded[70] = '*';
+  std::vector<double> expected;
+  scalar.decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, expected);
+  for (Size k = Base64::KERNEL_SCALAR; k <= (Size)Base64::getSupportedKernel(); ++k)
+  {
+    Base64 b64;
+    b64.setKernel((Base64::Kernel)k);
+    std::vector<double> decoded;
+    b64.decode(encoded, Base64::BYTEORDER_LITTLEENDIAN, decoded);
+    TEST_EQUAL(decoded == expected, true)
+  }
+}
+END_SECTION
+
 ptr = new Base64;
 
 START_SECTION(inline UInt32 endianize32(const UInt32& n))
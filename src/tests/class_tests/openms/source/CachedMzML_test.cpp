@@ -222,6 +222,34 @@ START_SECTION(( void readMemdump(MapType& exp_reading, String filename) const ))
 }
 END_SECTION
 
+START_SECTION(( [EXTRA] chromatogram intensities are stored in double precision ))
+{
+  // 16777217 is the smallest positive integer that has no float representation
+  MSExperiment<> exp;
+  MSChromatogram<> chrom;
+  ChromatogramPeak p;
+  p.setRT(10.0);
+  p.setIntensity(16777217.0);
+  chrom.push_back(p);
+  p.setRT(20.0);
+  p.setIntensity(1.0 + 1e-10);
+  chrom.push_back(p);
+  exp.addChromatogram(chrom);
+
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  CachedmzML cache;
+  cache.writeMemdump(exp, tmp_filename);
+
+  MSExperiment<> exp_new;
+  cache.readMemdump(exp_new, tmp_filename);
+  TEST_EQUAL(exp_new.getChromatograms().size(), 1)
+  TEST_EQUAL(exp_new.getChromatogram(0).size(), 2)
+  TEST_EQUAL(exp_new.getChromatogram(0)[0].getIntensity() == 16777217.0, true)
+  TEST_EQUAL(exp_new.getChromatogram(0)[1].getIntensity() == 1.0 + 1e-10, true)
+}
+END_SECTION
+
 START_SECTION(( void createMemdumpIndex(String filename) ))
 {
   std::string tmp_filename;
@@ -246,6 +274,139 @@ START_SECTION(( void createMemdumpIndex(String filename) ))
   NEW_TMP_FILE(unused_tmp_filename);
   TEST_EXCEPTION(Exception::FileNotFound, cache.createMemdumpIndex(unused_tmp_filename) )
   TEST_EXCEPTION(Exception::ParseError, cache.createMemdumpIndex(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML") ) )
+
+  // a file of an older format version
+  {
+    std::ofstream ofs(unused_tmp_filename.c_str(), std::ios::binary);
+    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+    int file_version = CACHED_MZML_FILE_VERSION - 1;
+    ofs.write((char*)&file_identifier, sizeof(file_identifier));
+    ofs.write((char*)&file_version, sizeof(file_version));
+  }
+  TEST_EXCEPTION(Exception::ParseError, cache.createMemdumpIndex(unused_tmp_filename) )
+
+  // a truncated file (without index and trailer)
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    std::ofstream ofs(unused_tmp_filename.c_str(), std::ios::binary);
+    ofs.write(content.data(), content.size() / 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, cache.createMemdumpIndex(unused_tmp_filename) )
+
+  // corrupt numbers of spectra and chromatograms in the trailer are detected
+  // before anything is allocated (the trailer consists of the number of
+  // spectra and chromatograms, the index offset and the file identifier)
+  const Size trailer_size = 2 * sizeof(UInt64) + sizeof(Int64) + sizeof(Int32);
+  for (Size field = 0; field < 2; ++field)
+  {
+    {
+      std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+      std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+      UInt64 huge_count = UInt64(1) << 60;
+      content.replace(content.size() - trailer_size + field * sizeof(UInt64), sizeof(UInt64), (const char*)&huge_count, sizeof(UInt64));
+      std::ofstream ofs(unused_tmp_filename.c_str(), std::ios::binary);
+      ofs.write(content.data(), content.size());
+    }
+    TEST_EXCEPTION(Exception::ParseError, cache.createMemdumpIndex(unused_tmp_filename) )
+    MSExperiment<> exp_corrupt;
+    TEST_EXCEPTION(Exception::ParseError, cache.readMemdump(exp_corrupt, unused_tmp_filename) )
+  }
+}
+END_SECTION
+
+START_SECTION(( const std::vector<SpectrumIndexEntry>& getSpectraIndexEntries() const ))
+{
+  const std::vector<CachedmzML::SpectrumIndexEntry>& entries = cache_.getSpectraIndexEntries();
+  TEST_EQUAL(entries.size(), 4)
+  for (Size i = 0; i < entries.size(); i++)
+  {
+    TEST_REAL_SIMILAR(entries[i].rt, exp.getSpectrum(i).getRT())
+    TEST_EQUAL(entries[i].ms_level, exp.getSpectrum(i).getMSLevel())
+  }
+}
+END_SECTION
+
+START_SECTION(( void setNumpressConfigurationMassTime(MSNumpressCoder::NumpressConfig config) ))
+{
+  CachedmzML cache;
+  MSNumpressCoder::NumpressConfig config;
+  config.np_compression = MSNumpressCoder::LINEAR;
+  config.estimate_fixed_point = true;
+  cache.setNumpressConfigurationMassTime(config);
+  TEST_EQUAL(cache.getNumpressConfigurationMassTime().np_compression, MSNumpressCoder::LINEAR)
+}
+END_SECTION
+
+START_SECTION(( MSNumpressCoder::NumpressConfig getNumpressConfigurationMassTime() const ))
+{
+  CachedmzML cache;
+  TEST_EQUAL(cache.getNumpressConfigurationMassTime().np_compression, MSNumpressCoder::NONE)
+}
+END_SECTION
+
+START_SECTION(( void setNumpressConfigurationIntensity(MSNumpressCoder::NumpressConfig config) ))
+{
+  CachedmzML cache;
+  MSNumpressCoder::NumpressConfig config;
+  config.np_compression = MSNumpressCoder::SLOF;
+  config.estimate_fixed_point = true;
+  cache.setNumpressConfigurationIntensity(config);
+  TEST_EQUAL(cache.getNumpressConfigurationIntensity().np_compression, MSNumpressCoder::SLOF)
+}
+END_SECTION
+
+START_SECTION(( MSNumpressCoder::NumpressConfig getNumpressConfigurationIntensity() const ))
+{
+  CachedmzML cache;
+  TEST_EQUAL(cache.getNumpressConfigurationIntensity().np_compression, MSNumpressCoder::NONE)
+}
+END_SECTION
+
+START_SECTION(( [EXTRA] numpress compressed cache ))
+{
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  std::string tmp_filename_uncompressed;
+  NEW_TMP_FILE(tmp_filename_uncompressed);
+
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+
+  CachedmzML cache;
+  cache.writeMemdump(exp, tmp_filename_uncompressed);
+
+  MSNumpressCoder::NumpressConfig config_mz;
+  config_mz.np_compression = MSNumpressCoder::LINEAR;
+  config_mz.estimate_fixed_point = true;
+  config_mz.numpressErrorTolerance = 1e-6;
+  MSNumpressCoder::NumpressConfig config_int;
+  config_int.np_compression = MSNumpressCoder::SLOF;
+  config_int.estimate_fixed_point = true;
+  cache.setNumpressConfigurationMassTime(config_mz);
+  cache.setNumpressConfigurationIntensity(config_int);
+  cache.writeMemdump(exp, tmp_filename);
+
+  // the compressed file is smaller
+  std::ifstream ifs_compressed(tmp_filename.c_str(), std::ios::binary | std::ios::ate);
+  std::ifstream ifs_uncompressed(tmp_filename_uncompressed.c_str(), std::ios::binary | std::ios::ate);
+  TEST_EQUAL(ifs_compressed.tellg() < ifs_uncompressed.tellg(), true)
+
+  MSExperiment<> exp_new;
+  cache.readMemdump(exp_new, tmp_filename);
+  TEST_EQUAL(exp_new.size(), exp.size())
+  TEST_EQUAL(exp_new.getChromatograms().size(), exp.getChromatograms().size())
+  TOLERANCE_RELATIVE(1.0 + 1e-4)
+  for (Size k = 0; k < exp.size(); k++)
+  {
+    TEST_EQUAL(exp_new[k].size(), exp[k].size())
+    for (Size i = 0; i < exp[k].size(); i++)
+    {
+      TEST_REAL_SIMILAR(exp_new[k][i].getMZ(), exp[k][i].getMZ())
+      TEST_REAL_SIMILAR(exp_new[k][i].getIntensity(), exp[k][i].getIntensity())
+    }
+  }
+  TOLERANCE_RELATIVE(1.0 + 1e-5)
 }
 END_SECTION
 
@@ -261,7 +422,7 @@ START_SECTION(( const std::vector<std::streampos>& getChromatogramIndex() const
 }
 END_SECTION
 
-START_SECTION(static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level, double& rt))
+START_SECTION(static void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs, int& ms_level, double& rt))
 {
 
   // Check whether spectra were written to disk correctly...
@@ -320,7 +481,7 @@ START_SECTION(static inline void readSpectrumFast(OpenSwath::BinaryDataArrayPtr
 }
 END_SECTION
 
-START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs) )
+START_SECTION( static void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, std::ifstream& ifs) )
 {
   // Check whether chromatograms were written to disk correctly...
   {
@@ -371,6 +532,73 @@ START_SECTION( static inline void readChromatogramFast(OpenSwath::BinaryDataArra
 }
 END_SECTION
 
+START_SECTION(static void readSpectrumFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size, Size pos, int& ms_level, double& rt))
+{
+  // read the complete cached file into memory
+  std::ifstream ifs_(tmp_filename.c_str(), std::ios::binary);
+  std::string buffer((std::istreambuf_iterator<char>(ifs_)), std::istreambuf_iterator<char>());
+  std::vector<std::streampos> spectra_index = cache_.getSpectraIndex();
+  TEST_EQUAL(spectra_index.size(), 4)
+
+  OpenSwath::BinaryDataArrayPtr mz_array(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+  int ms_level = -1;
+  double rt = -1.0;
+  for (Size k = 0; k < spectra_index.size(); k++)
+  {
+    CachedmzML::readSpectrumFast(mz_array, intensity_array, buffer.data(), buffer.size(),
+        static_cast<Size>(std::streamoff(spectra_index[k])), ms_level, rt);
+
+    TEST_EQUAL(mz_array->data.size(), exp.getSpectrum(k).size())
+    TEST_EQUAL(intensity_array->data.size(), exp.getSpectrum(k).size())
+    TEST_EQUAL(ms_level, exp.getSpectrum(k).getMSLevel())
+    TEST_REAL_SIMILAR(rt, exp.getSpectrum(k).getRT())
+    for (Size i = 0; i < mz_array->data.size(); i++)
+    {
+      TEST_REAL_SIMILAR(mz_array->data[i], exp.getSpectrum(k)[i].getMZ())
+      TEST_REAL_SIMILAR(intensity_array->data[i], exp.getSpectrum(k)[i].getIntensity())
+    }
+  }
+
+  // should not read after the buffer ends
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::ParseError, CachedmzML::readSpectrumFast(mz_array, intensity_array, buffer.data(), buffer.size(), buffer.size() + 1, ms_level, rt),
+    "memory buffer in: Read an invalid spectrum length, something is wrong here. Aborting.")
+
+  // should not read a spectrum that is truncated
+  Size truncated = static_cast<Size>(std::streamoff(spectra_index[1])) - 1;
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::ParseError, CachedmzML::readSpectrumFast(mz_array, intensity_array, buffer.data(), truncated, static_cast<Size>(std::streamoff(spectra_index[0])), ms_level, rt),
+    "memory buffer in: Read an invalid binary data array length, something is wrong here. Aborting.")
+}
+END_SECTION
+
+START_SECTION(static void readChromatogramFast(OpenSwath::BinaryDataArrayPtr data1, OpenSwath::BinaryDataArrayPtr data2, const char* buffer, Size buffer_size, Size pos))
+{
+  // read the complete cached file into memory
+  std::ifstream ifs_(tmp_filename.c_str(), std::ios::binary);
+  std::string buffer((std::istreambuf_iterator<char>(ifs_)), std::istreambuf_iterator<char>());
+  std::vector<std::streampos> chrom_index = cache_.getChromatogramIndex();
+  TEST_EQUAL(chrom_index.size(), 2)
+
+  OpenSwath::BinaryDataArrayPtr time_array(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr intensity_array(new OpenSwath::BinaryDataArray);
+  CachedmzML::readChromatogramFast(time_array, intensity_array, buffer.data(), buffer.size(),
+      static_cast<Size>(std::streamoff(chrom_index[0])));
+
+  TEST_EQUAL(time_array->data.size() > 0, true)
+  TEST_EQUAL(time_array->data.size(), exp.getChromatogram(0).size())
+  TEST_EQUAL(intensity_array->data.size(), exp.getChromatogram(0).size())
+  for (Size i = 0; i < time_array->data.size(); i++)
+  {
+    TEST_REAL_SIMILAR(time_array->data[i], exp.getChromatogram(0)[i].getRT())
+    TEST_REAL_SIMILAR(intensity_array->data[i], exp.getChromatogram(0)[i].getIntensity())
+  }
+
+  // should not read after the buffer ends
+  TEST_EXCEPTION_WITH_MESSAGE(Exception::ParseError, CachedmzML::readChromatogramFast(time_array, intensity_array, buffer.data(), buffer.size(), buffer.size() + 1),
+    "memory buffer in: Read an invalid chromatogram length, something is wrong here. Aborting.")
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
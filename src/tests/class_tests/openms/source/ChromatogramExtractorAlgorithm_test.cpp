@@ -39,9 +39,75 @@
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 
+/// Spectrum access which fails to provide one of the spectra (optionally only in its light clones)
+class FailingSpectrumAccess :
+  public OpenSwath::ISpectrumAccess
+{
+public:
+  FailingSpectrumAccess(OpenSwath::SpectrumAccessPtr input, int failing_id, bool fail = true) :
+    input_(input),
+    failing_id_(failing_id),
+    fail_(fail)
+  {
+  }
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const
+  {
+    return boost::shared_ptr<OpenSwath::ISpectrumAccess>(new FailingSpectrumAccess(input_->lightClone(), failing_id_));
+  }
+
+  OpenSwath::SpectrumPtr getSpectrumById(int id)
+  {
+    if (fail_ && id == failing_id_)
+    {
+      throw Exception::InvalidValue(__FILE__, __LINE__, __PRETTY_FUNCTION__, "Cannot read spectrum", String(id));
+    }
+    return input_->getSpectrumById(id);
+  }
+
+  std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const
+  {
+    return input_->getSpectraByRT(RT, deltaRT);
+  }
+
+  size_t getNrSpectra() const
+  {
+    return input_->getNrSpectra();
+  }
+
+  OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const
+  {
+    return input_->getSpectrumMetaById(id);
+  }
+
+  OpenSwath::ChromatogramPtr getChromatogramById(int id)
+  {
+    return input_->getChromatogramById(id);
+  }
+
+  std::size_t getNrChromatograms() const
+  {
+    return input_->getNrChromatograms();
+  }
+
+  std::string getChromatogramNativeID(int id) const
+  {
+    return input_->getChromatogramNativeID(id);
+  }
+
+private:
+  OpenSwath::SpectrumAccessPtr input_;
+  int failing_id_;
+  bool fail_;
+};
+
 START_TEST(ChromatogramExtractorAlgorithm, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -275,6 +341,184 @@ START_SECTION(void extract_value_tophat(const std::vector< double >::const_itera
 }
 END_SECTION
 
+START_SECTION(([EXTRA] extractChromatograms yields the same result as extract_value_tophat))
+{
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  std::vector<double> intensities (int_arr, int_arr + sizeof(int_arr) / sizeof(int_arr[0]) );
+
+  // two spectra with the same peaks (but non-zero intensity at the first and last peak)
+  intensities[0] = 50.0;
+  boost::shared_ptr<MSExperiment<Peak1D> > exp(new MSExperiment<Peak1D>);
+  for (Size s = 0; s < 2; ++s)
+  {
+    MSSpectrum<Peak1D> spectrum;
+    spectrum.setRT(100.0 + s * 10.0);
+    for (Size i = 0; i < mz.size(); ++i)
+    {
+      Peak1D peak;
+      peak.setMZ(mz[i]);
+      peak.setIntensity(intensities[i]);
+      spectrum.push_back(peak);
+    }
+    exp->addSpectrum(spectrum);
+  }
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  // coordinates below, inside, between and above the peaks (overlapping windows)
+  double coordinate_mz[] = {399.8, 399.91, 400.0, 400.005, 400.05, 400.1, 400.1, 400.28, 449.95, 499.95, 500.0, 500.05, 600.0};
+  Size nr_coordinates = sizeof(coordinate_mz) / sizeof(coordinate_mz[0]);
+
+  for (Size ppm = 0; ppm < 2; ++ppm)
+  {
+    double extract_window = ppm ? 500.0 : 0.2;
+    std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+    std::vector< OpenSwath::ChromatogramPtr > out_exp;
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+      coord.mz = coordinate_mz[k];
+      // the second spectrum is only extracted for some coordinates
+      coord.rt_start = 0;
+      coord.rt_end = (k % 3 == 0) ? 105 : -1;
+      coord.id = String(k);
+      coordinates.push_back(coord);
+      out_exp.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+
+    ChromatogramExtractorAlgorithm extractor;
+    extractor.extractChromatograms(expptr, out_exp, coordinates, extract_window, ppm == 1, "tophat");
+
+    std::vector<double>::const_iterator mz_it = mz.begin();
+    std::vector<double>::const_iterator int_it = intensities.begin();
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      double expected = 0;
+      extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, coordinate_mz[k], expected, extract_window, ppm == 1);
+
+      Size expected_size = (k % 3 == 0) ? 1 : 2;
+      TEST_EQUAL(out_exp[k]->getTimeArray()->data.size(), expected_size)
+      TEST_EQUAL(out_exp[k]->getIntensityArray()->data.size(), expected_size)
+      TEST_REAL_SIMILAR(out_exp[k]->getTimeArray()->data[0], 100.0)
+      for (Size i = 0; i < out_exp[k]->getIntensityArray()->data.size(); ++i)
+      {
+        TEST_REAL_SIMILAR(out_exp[k]->getIntensityArray()->data[i], expected)
+      }
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(([EXTRA] extractChromatograms with many unordered and empty spectra))
+{
+  // enough spectra to use the parallel extraction (if available); the RTs
+  // are not in spectrum order and every third spectrum is empty
+  std::vector<double> mz (mz_arr, mz_arr + sizeof(mz_arr) / sizeof(mz_arr[0]) );
+  boost::shared_ptr<MSExperiment<Peak1D> > exp(new MSExperiment<Peak1D>);
+  Size nr_spectra = 100;
+  for (Size s = 0; s < nr_spectra; ++s)
+  {
+    MSSpectrum<Peak1D> spectrum;
+    spectrum.setRT((s * 37) % nr_spectra);
+    if (s % 3 != 0)
+    {
+      for (Size i = 0; i < mz.size(); ++i)
+      {
+        Peak1D peak;
+        peak.setMZ(mz[i]);
+        peak.setIntensity(int_arr[i] + s);
+        spectrum.push_back(peak);
+      }
+    }
+    exp->addSpectrum(spectrum);
+  }
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  double coordinate_mz[] = {399.91, 400.1, 449.95, 500.0};
+  Size nr_coordinates = sizeof(coordinate_mz) / sizeof(coordinate_mz[0]);
+  double extract_window = 0.2;
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  std::vector< OpenSwath::ChromatogramPtr > out_exp;
+  for (Size k = 0; k < nr_coordinates; ++k)
+  {
+    ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+    coord.mz = coordinate_mz[k];
+    coord.rt_start = (k % 2 == 0) ? 0 : 20;
+    coord.rt_end = (k % 2 == 0) ? -1 : 60;
+    coord.id = String(k);
+    coordinates.push_back(coord);
+    out_exp.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+  }
+
+  ChromatogramExtractorAlgorithm extractor;
+  extractor.extractChromatograms(expptr, out_exp, coordinates, extract_window, false, "tophat");
+
+  for (Size k = 0; k < nr_coordinates; ++k)
+  {
+    // expected: one point per non-empty spectrum within the RT range, in spectrum order
+    std::vector<double> expected_rt, expected_int;
+    for (Size s = 0; s < nr_spectra; ++s)
+    {
+      double rt = (*exp)[s].getRT();
+      if ((*exp)[s].empty() || (k % 2 == 1 && (rt < 20 || rt > 60)))
+      {
+        continue;
+      }
+      std::vector<double> intensities;
+      for (Size i = 0; i < mz.size(); ++i)
+      {
+        intensities.push_back((*exp)[s][i].getIntensity());
+      }
+      std::vector<double>::const_iterator mz_it = mz.begin();
+      std::vector<double>::const_iterator int_it = intensities.begin();
+      double integrated_intensity = 0;
+      extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, coordinate_mz[k], integrated_intensity, extract_window, false);
+      expected_rt.push_back(rt);
+      expected_int.push_back(integrated_intensity);
+    }
+
+    TEST_EQUAL(out_exp[k]->getTimeArray()->data.size(), expected_rt.size())
+    TEST_EQUAL(out_exp[k]->getIntensityArray()->data.size(), expected_int.size())
+    for (Size i = 0; i < std::min(expected_rt.size(), out_exp[k]->getTimeArray()->data.size()); ++i)
+    {
+      TEST_REAL_SIMILAR(out_exp[k]->getTimeArray()->data[i], expected_rt[i])
+      TEST_REAL_SIMILAR(out_exp[k]->getIntensityArray()->data[i], expected_int[i])
+    }
+  }
+
+  // errors while reading a spectrum are passed on with their original type
+  // and the output is left as it was before the call
+  OpenSwath::SpectrumAccessPtr failing_ptr(new FailingSpectrumAccess(expptr, 50));
+  std::vector< OpenSwath::ChromatogramPtr > failing_out;
+  for (Size k = 0; k < nr_coordinates; ++k)
+  {
+    failing_out.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    failing_out.back()->getTimeArray()->data.push_back(1.0);
+    failing_out.back()->getIntensityArray()->data.push_back(2.0);
+  }
+  TEST_EXCEPTION(Exception::InvalidValue, extractor.extractChromatograms(failing_ptr, failing_out, coordinates, extract_window, false, "tophat"))
+  for (Size k = 0; k < nr_coordinates; ++k)
+  {
+    TEST_EQUAL(failing_out[k]->getTimeArray()->data.size(), 1)
+    TEST_EQUAL(failing_out[k]->getIntensityArray()->data.size(), 1)
+  }
+
+#ifdef _OPENMP
+  // an error that cannot be reproduced serially (here: only the light clones
+  // used by the threads fail) is reported with its message
+  if (omp_get_max_threads() > 1 && nr_spectra >= 2 * (Size)omp_get_max_threads())
+  {
+    OpenSwath::SpectrumAccessPtr clone_failing_ptr(new FailingSpectrumAccess(expptr, 50, false));
+    TEST_EXCEPTION(Exception::BaseException, extractor.extractChromatograms(clone_failing_ptr, failing_out, coordinates, extract_window, false, "tophat"))
+    for (Size k = 0; k < nr_coordinates; ++k)
+    {
+      TEST_EQUAL(failing_out[k]->getTimeArray()->data.size(), 1)
+      TEST_EQUAL(failing_out[k]->getIntensityArray()->data.size(), 1)
+    }
+  }
+#endif
+}
+END_SECTION
+
 START_SECTION( [ChromatogramExtractorAlgorithm::ExtractionCoordinates] static bool SortExtractionCoordinatesByMZ(const ChromatogramExtractorAlgorithm::ExtractionCoordinates &left, const ChromatogramExtractorAlgorithm::ExtractionCoordinates &right))    
 {
   NOT_TESTABLE
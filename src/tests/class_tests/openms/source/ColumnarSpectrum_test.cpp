@@ -0,0 +1,249 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/KERNEL/ColumnarSpectrum.h>
+#include <OpenMS/KERNEL/RichPeak1D.h>
+
+///////////////////////////
+
+START_TEST(ColumnarSpectrum, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+ColumnarSpectrum<>* ptr = 0;
+ColumnarSpectrum<>* nullPointer = 0;
+
+START_SECTION((ColumnarSpectrum()))
+  ptr = new ColumnarSpectrum<>();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->size(), 0)
+  TEST_EQUAL(ptr->empty(), true)
+END_SECTION
+
+START_SECTION((~ColumnarSpectrum()))
+  delete ptr;
+END_SECTION
+
+MSSpectrum<Peak1D> spectrum;
+spectrum.setRT(42.0);
+for (Size i = 0; i < 5; ++i)
+{
+  Peak1D p;
+  p.setMZ(100.0 + i);
+  p.setIntensity(10.0f * (i + 1));
+  spectrum.push_back(p);
+}
+
+START_SECTION((template <typename PeakT> ColumnarSpectrum(const MSSpectrum<PeakT>& spectrum)))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_EQUAL(columnar.size(), 5)
+  TEST_REAL_SIMILAR(columnar.getMZ(0), 100.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(4), 50.0)
+END_SECTION
+
+START_SECTION((template <typename PeakT> void assignPeaks(const MSSpectrum<PeakT>& spectrum)))
+  ColumnarSpectrum<float> columnar;
+  columnar.push_back(1.0, 1.0f);
+  columnar.assignPeaks(spectrum);
+  TEST_EQUAL(columnar.size(), 5)
+  TEST_REAL_SIMILAR(columnar.getMZ(2), 102.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(2), 30.0)
+  TEST_EQUAL(columnar.getMZArray().size(), columnar.getIntensityArray().size())
+END_SECTION
+
+START_SECTION((template <typename PeakT> void copyPeaksTo(MSSpectrum<PeakT>& spectrum) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  MSSpectrum<Peak1D> out;
+  out.setRT(13.0);
+  out.push_back(Peak1D());
+  columnar.copyPeaksTo(out);
+  TEST_EQUAL(out.size(), 5)
+  TEST_REAL_SIMILAR(out.getRT(), 13.0) // meta data is kept
+  for (Size i = 0; i < out.size(); ++i)
+  {
+    TEST_EQUAL(out[i] == spectrum[i], true)
+  }
+
+  MSSpectrum<RichPeak1D> out_rich;
+  columnar.copyPeaksTo(out_rich);
+  TEST_EQUAL(out_rich.size(), 5)
+  TEST_REAL_SIMILAR(out_rich[3].getMZ(), 103.0)
+  TEST_REAL_SIMILAR(out_rich[3].getIntensity(), 40.0)
+END_SECTION
+
+START_SECTION((void push_back(double mz, IntensityT intensity)))
+  ColumnarSpectrum<> columnar;
+  columnar.push_back(1.0, 2.0);
+  columnar.push_back(3.0, 4.0);
+  TEST_EQUAL(columnar.size(), 2)
+  TEST_REAL_SIMILAR(columnar.getMZ(1), 3.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(1), 4.0)
+END_SECTION
+
+START_SECTION((void clear()))
+  ColumnarSpectrum<> columnar(spectrum);
+  columnar.clear();
+  TEST_EQUAL(columnar.empty(), true)
+  TEST_EQUAL(columnar.getIntensityArray().size(), 0)
+END_SECTION
+
+START_SECTION((void reserve(Size n)))
+  ColumnarSpectrum<> columnar;
+  columnar.reserve(10);
+  TEST_EQUAL(columnar.size(), 0)
+  TEST_EQUAL(columnar.getMZArray().capacity() >= 10, true)
+  TEST_EQUAL(columnar.getIntensityArray().capacity() >= 10, true)
+END_SECTION
+
+START_SECTION((void resize(Size n)))
+  ColumnarSpectrum<> columnar;
+  columnar.resize(3);
+  TEST_EQUAL(columnar.size(), 3)
+  TEST_EQUAL(columnar.getIntensityArray().size(), 3)
+END_SECTION
+
+START_SECTION((void swapMZArray(MZArray& mz)))
+  ColumnarSpectrum<> columnar(spectrum);
+  std::vector<double> mz(5, 1.0);
+  const double* data = &mz[0];
+  columnar.swapMZArray(mz);
+  TEST_EQUAL(&columnar.getMZArray()[0] == data, true)
+  TEST_REAL_SIMILAR(mz[0], 100.0)
+END_SECTION
+
+START_SECTION((void swapIntensityArray(IntensityArray& intensity)))
+  ColumnarSpectrum<float> columnar(spectrum);
+  std::vector<float> intensity(5, 1.0f);
+  const float* data = &intensity[0];
+  columnar.swapIntensityArray(intensity);
+  TEST_EQUAL(&columnar.getIntensityArray()[0] == data, true)
+  TEST_REAL_SIMILAR(intensity[0], 10.0)
+END_SECTION
+
+START_SECTION((void swap(ColumnarSpectrum& other)))
+  ColumnarSpectrum<> columnar(spectrum);
+  ColumnarSpectrum<> other;
+  columnar.swap(other);
+  TEST_EQUAL(columnar.empty(), true)
+  TEST_EQUAL(other.size(), 5)
+END_SECTION
+
+START_SECTION((bool operator==(const ColumnarSpectrum& rhs) const))
+  ColumnarSpectrum<> a(spectrum), b(spectrum);
+  TEST_EQUAL(a == b, true)
+  b.getIntensityArray()[0] = 1.0;
+  TEST_EQUAL(a == b, false)
+END_SECTION
+
+START_SECTION((bool operator!=(const ColumnarSpectrum& rhs) const))
+  ColumnarSpectrum<> a(spectrum), b(spectrum);
+  TEST_EQUAL(a != b, false)
+  b.getMZArray()[0] = 1.0;
+  TEST_EQUAL(a != b, true)
+END_SECTION
+
+START_SECTION((bool isSorted() const))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_EQUAL(columnar.isSorted(), true)
+  columnar.getMZArray()[0] = 200.0;
+  TEST_EQUAL(columnar.isSorted(), false)
+END_SECTION
+
+START_SECTION((void sortByPosition()))
+  ColumnarSpectrum<> columnar;
+  columnar.push_back(3.0, 30.0);
+  columnar.push_back(1.0, 10.0);
+  columnar.push_back(2.0, 20.0);
+  columnar.push_back(1.0, 11.0);
+  columnar.sortByPosition();
+  TEST_EQUAL(columnar.isSorted(), true)
+  TEST_REAL_SIMILAR(columnar.getMZ(0), 1.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(0), 10.0) // stable
+  TEST_REAL_SIMILAR(columnar.getMZ(1), 1.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(1), 11.0)
+  TEST_REAL_SIMILAR(columnar.getMZ(2), 2.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(2), 20.0)
+  TEST_REAL_SIMILAR(columnar.getMZ(3), 3.0)
+  TEST_REAL_SIMILAR(columnar.getIntensity(3), 30.0)
+END_SECTION
+
+START_SECTION((Size MZBegin(double mz) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_EQUAL(columnar.MZBegin(50.0), 0)
+  TEST_EQUAL(columnar.MZBegin(101.0), 1)
+  TEST_EQUAL(columnar.MZBegin(101.5), 2)
+  TEST_EQUAL(columnar.MZBegin(200.0), 5)
+END_SECTION
+
+START_SECTION((Size MZEnd(double mz) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_EQUAL(columnar.MZEnd(50.0), 0)
+  TEST_EQUAL(columnar.MZEnd(101.0), 2)
+  TEST_EQUAL(columnar.MZEnd(200.0), 5)
+END_SECTION
+
+START_SECTION((Size findNearest(double mz) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  for (double mz = 90.0; mz < 110.0; mz += 0.3)
+  {
+    TEST_EQUAL(columnar.findNearest(mz), spectrum.findNearest(mz))
+  }
+  TEST_EXCEPTION(Exception::Precondition, ColumnarSpectrum<>().findNearest(100.0))
+END_SECTION
+
+START_SECTION((Int findNearest(double mz, double tolerance) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_EQUAL(columnar.findNearest(101.1, 0.2), 1)
+  TEST_EQUAL(columnar.findNearest(101.5, 0.2), -1)
+  TEST_EQUAL(ColumnarSpectrum<>().findNearest(101.1, 0.2), -1)
+END_SECTION
+
+START_SECTION((double sumIntensity(double mz_start, double mz_end) const))
+  ColumnarSpectrum<> columnar(spectrum);
+  TEST_REAL_SIMILAR(columnar.sumIntensity(101.0, 103.0), 90.0)
+  TEST_REAL_SIMILAR(columnar.sumIntensity(100.5, 100.7), 0.0)
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
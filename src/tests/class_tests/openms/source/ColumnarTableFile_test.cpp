@@ -0,0 +1,229 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/ColumnarTableFile.h>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <fstream>
+
+///////////////////////////
+
+START_TEST(ColumnarTableFile, "$Id$");
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+vector<String> column_names;
+column_names.push_back("id");
+column_names.push_back("score");
+column_names.push_back("mixed");
+
+// written in blocks of two rows: the "mixed" column is numeric in the first
+// block and contains text in the second one
+vector<vector<String> > rows(5);
+rows[0].push_back("peptide_1"); rows[0].push_back("1.5"); rows[0].push_back("1.5");
+rows[1].push_back("peptide_2"); rows[1].push_back("");    rows[1].push_back("-2");
+rows[2].push_back("peptide_3"); rows[2].push_back("1e3"); rows[2].push_back("nan");
+rows[3].push_back("peptide_4"); rows[3].push_back("0");   rows[3].push_back("");
+rows[4].push_back("peptide_5"); // missing values are empty
+
+ColumnarTableFile* ptr = 0;
+ColumnarTableFile* nullPointer = 0;
+START_SECTION(ColumnarTableFile())
+{
+  ptr = new ColumnarTableFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isOpen(), false)
+}
+END_SECTION
+
+START_SECTION(~ColumnarTableFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void create(const String& filename, const std::vector<String>& column_names, Size rows_per_block = 4096)))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  ColumnarTableFile table;
+  TEST_EXCEPTION(Exception::UnableToCreateFile, table.create("/does/not/exist/table.bin", column_names))
+  TEST_EQUAL(table.isOpen(), false)
+
+  table.create(tmp_filename, column_names);
+  TEST_EQUAL(table.isOpen(), true)
+  TEST_EXCEPTION(Exception::IllegalArgument, table.create(tmp_filename, column_names))
+  table.close();
+}
+END_SECTION
+
+START_SECTION((void addRow(const std::vector<String>& values)))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  ColumnarTableFile table;
+  TEST_EXCEPTION(Exception::IllegalArgument, table.addRow(rows[0]))
+
+  table.create(tmp_filename, column_names, 2);
+  for (Size i = 0; i < rows.size(); ++i)
+  {
+    table.addRow(rows[i]);
+  }
+  vector<String> too_long(rows[0]);
+  too_long.push_back("extra");
+  TEST_EXCEPTION(Exception::IllegalArgument, table.addRow(too_long))
+  table.close();
+
+  vector<ColumnarTableFile::Column> columns;
+  table.load(tmp_filename, columns);
+  TEST_EQUAL(columns.size(), 3)
+  ABORT_IF(columns.size() != 3)
+
+  TEST_EQUAL(columns[0].name, "id")
+  TEST_EQUAL(columns[0].numeric, false)
+  TEST_EQUAL(columns[0].strings.size(), 5)
+  TEST_EQUAL(columns[0].numbers.size(), 0)
+  ABORT_IF(columns[0].strings.size() != 5)
+  TEST_EQUAL(columns[0].strings[0], "peptide_1")
+  TEST_EQUAL(columns[0].strings[4], "peptide_5")
+
+  TEST_EQUAL(columns[1].name, "score")
+  TEST_EQUAL(columns[1].numeric, true)
+  TEST_EQUAL(columns[1].numbers.size(), 5)
+  TEST_EQUAL(columns[1].strings.size(), 0)
+  ABORT_IF(columns[1].numbers.size() != 5)
+  TEST_REAL_SIMILAR(columns[1].numbers[0], 1.5)
+  TEST_EQUAL(boost::math::isnan(columns[1].numbers[1]), true)
+  TEST_REAL_SIMILAR(columns[1].numbers[2], 1000.0)
+  TEST_REAL_SIMILAR(columns[1].numbers[3], 0.0)
+  TEST_EQUAL(boost::math::isnan(columns[1].numbers[4]), true)
+
+  // "nan" is text, so the numbers of the first block are converted back
+  TEST_EQUAL(columns[2].name, "mixed")
+  TEST_EQUAL(columns[2].numeric, false)
+  TEST_EQUAL(columns[2].strings.size(), 5)
+  TEST_EQUAL(columns[2].numbers.size(), 0)
+  ABORT_IF(columns[2].strings.size() != 5)
+  TEST_EQUAL(columns[2].strings[0], "1.5")
+  TEST_EQUAL(columns[2].strings[1], "-2")
+  TEST_EQUAL(columns[2].strings[2], "nan")
+  TEST_EQUAL(columns[2].strings[3], "")
+  TEST_EQUAL(columns[2].strings[4], "")
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  ColumnarTableFile table;
+  table.close(); // no-op
+  TEST_EQUAL(table.isOpen(), false)
+
+  // a table without rows keeps its columns
+  table.create(tmp_filename, column_names);
+  table.close();
+  TEST_EQUAL(table.isOpen(), false)
+  TEST_EXCEPTION(Exception::IllegalArgument, table.addRow(rows[0]))
+
+  vector<ColumnarTableFile::Column> columns;
+  table.load(tmp_filename, columns);
+  TEST_EQUAL(columns.size(), 3)
+  ABORT_IF(columns.size() != 3)
+  TEST_EQUAL(columns[1].name, "score")
+  TEST_EQUAL(columns[1].numeric, true)
+  TEST_EQUAL(columns[1].numbers.size(), 0)
+}
+END_SECTION
+
+START_SECTION((bool isOpen() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename, std::vector<Column>& columns) const))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  ColumnarTableFile table;
+  table.create(tmp_filename, column_names, 2);
+  for (Size i = 0; i < rows.size(); ++i)
+  {
+    table.addRow(rows[i]);
+  }
+  table.close();
+
+  vector<ColumnarTableFile::Column> columns;
+  TEST_EXCEPTION(Exception::FileNotFound, table.load(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist"), columns))
+  // not a columnar table
+  TEST_EXCEPTION(Exception::ParseError, table.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta"), columns))
+
+  // truncated file
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    String truncated_filename;
+    NEW_TMP_FILE(truncated_filename);
+    std::ofstream ofs(truncated_filename.c_str(), std::ios::binary);
+    ofs.write(content.c_str(), content.size() - 5);
+    ofs.close();
+    TEST_EXCEPTION(Exception::ParseError, table.load(truncated_filename, columns))
+  }
+
+  table.load(tmp_filename, columns);
+  TEST_EQUAL(columns.size(), 3)
+  ABORT_IF(columns.size() != 3)
+  TEST_EQUAL(columns[0].strings.size(), 5)
+  TEST_EQUAL(columns[1].numbers.size(), 5)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -33,6 +33,7 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
+#include <OpenMS/FILTERING/DATAREDUCTION/IsotopeDistributionCache.h>
 
 #ifdef USE_BOOST_UNIT_TEST
 #define BOOST_TEST_DYN_LINK
@@ -148,6 +149,38 @@ START_SECTION([EXTRA] getAveragineIsotopeDistribution_test)
 }
 END_SECTION
 
+START_SECTION([EXTRA] getAveragineIsotopeDistribution with a given cache)
+{
+  // the overloads taking a cache (used in parallel scoring) yield the same distributions
+  const OpenMS::IsotopeDistributionCache& cache = OpenMS::IsotopeDistributionCache::getAveragineCache();
+  double masses[] = { 30., 100., 500., 1500. };
+  for (unsigned int m = 0; m < 4; ++m)
+  {
+    std::vector<std::pair<double, double> > expected, tmp;
+    OpenMS::DIAHelpers::getAveragineIsotopeDistribution(masses[m], expected, 2.);
+    OpenMS::DIAHelpers::getAveragineIsotopeDistribution(masses[m], tmp, cache, 2.);
+    TEST_EQUAL(tmp.size(), expected.size())
+    for (unsigned int i = 0; i < tmp.size(); ++i)
+    {
+      TEST_REAL_SIMILAR(tmp[i].first, expected[i].first)
+      TEST_REAL_SIMILAR(tmp[i].second, expected[i].second)
+    }
+  }
+
+  std::vector<std::pair<double, double> > spec, expected, tmp;
+  spec.push_back(std::make_pair(500., 2.));
+  spec.push_back(std::make_pair(750., 1.));
+  OpenMS::DIAHelpers::addIsotopes2Spec(spec, expected, 2.);
+  OpenMS::DIAHelpers::addIsotopes2Spec(spec, tmp, cache, 2.);
+  TEST_EQUAL(tmp.size(), expected.size())
+  for (unsigned int i = 0; i < tmp.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(tmp[i].first, expected[i].first)
+    TEST_REAL_SIMILAR(tmp[i].second, expected[i].second)
+  }
+}
+END_SECTION
+
 START_SECTION([EXTRA] simulateSpectrumFromAASequence_test)
 {
   String sequence = "SYVAWDR";
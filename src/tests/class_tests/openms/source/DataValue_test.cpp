@@ -803,6 +803,47 @@ START_SECTION((DataValue& operator=(const unsigned long long)))
 }
 END_SECTION
 
+START_SECTION((void swap(DataValue& rhs)))
+{
+  DataValue a("a string that is too long to be stored inline");
+  a.setUnit("mm");
+  DataValue b(ListUtils::create<Int>("1,2,3"));
+  a.swap(b);
+  TEST_EQUAL(a.valueType(), DataValue::INT_LIST)
+  TEST_EQUAL(a.toIntList().size(), 3)
+  TEST_EQUAL(a.hasUnit(), false)
+  TEST_EQUAL(b.valueType(), DataValue::STRING_VALUE)
+  TEST_EQUAL(b.toString(), "a string that is too long to be stored inline")
+  TEST_EQUAL(b.getUnit(), "mm")
+}
+END_SECTION
+
+START_SECTION(([EXTRA] copies share long strings and lists))
+{
+  // short and long strings behave the same
+  DataValue s1("short"), s2("a string that is too long to be stored inline");
+  DataValue c1(s1), c2(s2);
+  TEST_EQUAL(c1 == s1, true)
+  TEST_EQUAL(c2 == s2, true)
+  TEST_EQUAL(c1 < c2, String("short") < String("a string that is too long to be stored inline"))
+  TEST_EQUAL(String(c2.toChar()), "a string that is too long to be stored inline")
+
+  // assigning to a copy does not affect the original
+  DataValue l1(ListUtils::create<String>("a,b,c"));
+  DataValue l2 = l1;
+  l2 = "x";
+  TEST_EQUAL(l1.toStringList().size(), 3)
+  TEST_EQUAL(l2.toString(), "x")
+
+  // destroying the original keeps the copy valid
+  DataValue* tmp = new DataValue(ListUtils::create<double>("1.5,2.5"));
+  DataValue copy(*tmp);
+  delete tmp;
+  TEST_EQUAL(copy.toDoubleList().size(), 2)
+  TEST_REAL_SIMILAR(copy.toDoubleList()[1], 2.5)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
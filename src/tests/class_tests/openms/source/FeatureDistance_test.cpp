@@ -157,6 +157,40 @@ START_SECTION((std::pair<bool, double> operator()(const BaseFeature& left, const
 }
 END_SECTION
 
+START_SECTION((double lowerBound(double rt_diff, double mz_diff, double left_mz) const))
+{
+	FeatureDistance dist(1000.0, false);
+	Param param = dist.getDefaults();
+	param.setValue("distance_RT:max_difference", 100.0);
+	param.setValue("distance_MZ:max_difference", 1.0);
+	param.setValue("distance_MZ:exponent", 1.0);
+	param.setValue("distance_intensity:weight", 1.0);
+	dist.setParameters(param);
+	BaseFeature left, right;
+	left.setRT(100.0);
+	left.setMZ(100.0);
+	left.setIntensity(0.0);
+	right.setRT(110.0);
+	right.setMZ(100.1);
+	right.setIntensity(1000.0);
+	// intensity is ignored:
+	TEST_REAL_SIMILAR(dist.lowerBound(10.0, 0.1, 100.0), 0.066666667);
+	TEST_EQUAL(dist.lowerBound(10.0, 0.1, 100.0) <= dist(left, right).second, true);
+	TEST_EQUAL(dist.lowerBound(5.0, 0.05, 100.0) <= dist(left, right).second, true);
+	TEST_REAL_SIMILAR(dist.lowerBound(0.0, 0.0, 100.0), 0.0);
+
+  // ppm for m/z
+	param.setValue("distance_intensity:weight", 0.0);
+	param.setValue("distance_RT:weight", 0.0);
+  param.setValue("distance_MZ:max_difference", 10.0);
+  param.setValue("distance_MZ:unit", "ppm");
+  dist.setParameters(param);
+  TEST_REAL_SIMILAR(dist.lowerBound(10.0, 100.0/1e6 * 5, 100.0), 0.5);
+  // larger m/z of the left feature gives a smaller bound:
+  TEST_REAL_SIMILAR(dist.lowerBound(10.0, 100.0/1e6 * 5, 200.0), 0.25);
+}
+END_SECTION
+
 START_SECTION((FeatureDistance& operator=(const FeatureDistance& other)))
 {
 	FeatureDistance dist(1000.0, true);
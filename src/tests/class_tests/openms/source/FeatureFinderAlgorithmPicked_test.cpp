@@ -44,6 +44,31 @@
 #include <OpenMS/FORMAT/ParamXMLFile.h>
 #include <OpenMS/KERNEL/RichPeak1D.h>
 
+// exposes the protected helpers
+class FFPPTest :
+  public OpenMS::FeatureFinderAlgorithmPicked
+{
+public:
+  using OpenMS::FeatureFinderAlgorithmPicked::findIntersectingBoundingBoxes_;
+  using OpenMS::FeatureFinderAlgorithmPicked::findPositionsInBoundingBox_;
+};
+
+// deterministic pseudo-random numbers in [0, 1)
+double nextRandom(OpenMS::UInt& state)
+{
+  state = state * 1103515245u + 12345u;
+  return ((state >> 8) & 0xFFFF) / 65536.0;
+}
+
+OpenMS::DBoundingBox<2> randomBox(OpenMS::UInt& state, double width)
+{
+  double rt = 1000.0 * nextRandom(state), mz = 400.0 + 1000.0 * nextRandom(state);
+  OpenMS::DBoundingBox<2> bb;
+  bb.setMin(OpenMS::DPosition<2>(rt, mz));
+  bb.setMax(OpenMS::DPosition<2>(rt + width * 30.0 * nextRandom(state), mz + width * 3.0 * nextRandom(state)));
+  return bb;
+}
+
 START_TEST(FeatureFinderAlgorithmPicked, "$Id$")
 
 /////////////////////////////////////////////////////////////
@@ -124,6 +149,86 @@ START_SECTION((virtual void run()))
 
 END_SECTION
 
+START_SECTION([EXTRA] static void findIntersectingBoundingBoxes_(const std::vector<DBoundingBox<2> >& bbs, std::vector<std::vector<Size> >& intersecting))
+{
+  UInt state = 42;
+  // small and large boxes, duplicates, points (empty width) and one box covering everything
+  std::vector<DBoundingBox<2> > bbs;
+  for (Size i = 0; i < 400; ++i)
+  {
+    bbs.push_back(randomBox(state, (i % 10 == 0) ? 10.0 : 1.0));
+  }
+  bbs.push_back(bbs[17]);
+  bbs.push_back(DBoundingBox<2>(DPosition<2>(500.0, 900.0), DPosition<2>(500.0, 900.0)));
+  bbs.push_back(DBoundingBox<2>(DPosition<2>(-1.0, 0.0), DPosition<2>(2000.0, 2000.0)));
+
+  std::vector<std::vector<Size> > intersecting;
+  FFPPTest::findIntersectingBoundingBoxes_(bbs, intersecting);
+  TEST_EQUAL(intersecting.size(), bbs.size())
+
+  // compare with the linear scan over all pairs
+  Size mismatches = 0, pairs = 0;
+  for (Size i = 0; i < bbs.size(); ++i)
+  {
+    std::vector<Size> expected;
+    for (Size j = i + 1; j < bbs.size(); ++j)
+    {
+      if (bbs[i].intersects(bbs[j])) expected.push_back(j);
+    }
+    if (expected != intersecting[i]) ++mismatches;
+    pairs += expected.size();
+  }
+  TEST_EQUAL(mismatches, 0)
+  TEST_EQUAL(pairs > bbs.size(), true) // the data contains intersections
+
+  std::vector<DBoundingBox<2> > single(1, bbs[0]);
+  FFPPTest::findIntersectingBoundingBoxes_(single, intersecting);
+  TEST_EQUAL(intersecting.size(), 1)
+  TEST_EQUAL(intersecting[0].size(), 0)
+}
+END_SECTION
+
+START_SECTION([EXTRA] static void findPositionsInBoundingBox_(const std::vector<std::pair<double, Size> >& positions_by_mz, const std::vector<double>& rts, const DBoundingBox<2>& bb, Size min_index, std::vector<Size>& result))
+{
+  UInt state = 4711;
+  std::vector<double> rts, mzs;
+  for (Size i = 0; i < 2000; ++i)
+  {
+    rts.push_back(1000.0 * nextRandom(state));
+    mzs.push_back(400.0 + 1000.0 * nextRandom(state));
+  }
+  // positions with identical m/z
+  rts.push_back(rts[5] + 1.0);
+  mzs.push_back(mzs[5]);
+  std::vector<std::pair<double, Size> > positions_by_mz;
+  for (Size i = 0; i < rts.size(); ++i)
+  {
+    positions_by_mz.push_back(std::make_pair(mzs[i], i));
+  }
+  std::sort(positions_by_mz.begin(), positions_by_mz.end());
+
+  // compare with the linear scan over all positions after min_index
+  Size mismatches = 0, found = 0;
+  std::vector<Size> result;
+  for (Size b = 0; b < 200; ++b)
+  {
+    DBoundingBox<2> bb = randomBox(state, 10.0);
+    if (b == 0) bb = DBoundingBox<2>(DPosition<2>(rts[5], mzs[5]), DPosition<2>(rts[5] + 1.0, mzs[5]));
+    Size min_index = (Size)(rts.size() * nextRandom(state));
+    std::vector<Size> expected;
+    for (Size j = min_index + 1; j < rts.size(); ++j)
+    {
+      if (bb.encloses(rts[j], mzs[j])) expected.push_back(j);
+    }
+    FFPPTest::findPositionsInBoundingBox_(positions_by_mz, rts, bb, min_index, result);
+    if (expected != result) ++mismatches;
+    found += expected.size();
+  }
+  TEST_EQUAL(mismatches, 0)
+  TEST_EQUAL(found > 0, true)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 
@@ -72,8 +72,81 @@ START_SECTION((static String getProductName()))
 END_SECTION
 
 START_SECTION((virtual void group(const std::vector< FeatureMap > &maps, ConsensusMap &out)))
-	// This is tested extensively in TEST/TOPP
-	NOT_TESTABLE;
+{
+  // This is tested extensively in TEST/TOPP - here we compare the merge strategies:
+  // 40 peptides, slightly shifted in every map, plus some features unique to each map
+  std::vector<FeatureMap> maps(5);
+  for (Size m = 0; m < maps.size(); ++m)
+  {
+    for (Size i = 0; i < 40 + m; ++i)
+    {
+      Feature feature;
+      if (i < 40)
+      {
+        feature.setRT(100.0 + 50.0 * i + 2.0 * m);
+        feature.setMZ(400.0 + 20.0 * i + 0.01 * m);
+      }
+      else
+      {
+        feature.setRT(3000.0 + 500.0 * m + 50.0 * i);
+        feature.setMZ(1500.0 + 20.0 * m);
+      }
+      feature.setIntensity(1000.0);
+      maps[m].push_back(feature);
+    }
+  }
+
+  FeatureGroupingAlgorithmUnlabeled sequential, tree;
+  Param param = tree.getParameters();
+  param.setValue("merge_strategy", "tree");
+  tree.setParameters(param);
+  ConsensusMap out_sequential, out_tree;
+  sequential.group(maps, out_sequential);
+  tree.group(maps, out_tree);
+
+  // all shared features are grouped completely, the others stay singletons:
+  Size complete_sequential = 0, complete_tree = 0;
+  double quality_sequential = 0.0, quality_tree = 0.0;
+  for (Size i = 0; i < out_sequential.size(); ++i)
+  {
+    if (out_sequential[i].size() == maps.size())
+    {
+      ++complete_sequential;
+      quality_sequential += out_sequential[i].getQuality();
+    }
+  }
+  for (Size i = 0; i < out_tree.size(); ++i)
+  {
+    if (out_tree[i].size() == maps.size())
+    {
+      ++complete_tree;
+      quality_tree += out_tree[i].getQuality();
+    }
+  }
+  TEST_EQUAL(out_sequential.size(), 50);
+  TEST_EQUAL(out_tree.size(), 50);
+  TEST_EQUAL(complete_sequential, 40);
+  TEST_EQUAL(complete_tree, 40);
+  TOLERANCE_ABSOLUTE(0.05);
+  TEST_REAL_SIMILAR(quality_tree / complete_tree, quality_sequential / complete_sequential);
+
+  // limiting the number of parallel merges does not change the result:
+  param.setValue("max_parallel_merges", 1);
+  tree.setParameters(param);
+  ConsensusMap out_limited;
+  tree.group(maps, out_limited);
+  TEST_EQUAL(out_limited.size(), out_tree.size());
+  ABORT_IF(out_limited.size() != out_tree.size());
+  for (Size i = 0; i < out_tree.size(); ++i)
+  {
+    TEST_EQUAL(out_limited[i].size(), out_tree[i].size());
+    TEST_EQUAL(out_limited[i].getQuality(), out_tree[i].getQuality());
+  }
+
+  // too few maps:
+  maps.resize(1);
+  TEST_EXCEPTION(Exception::IllegalArgument, tree.group(maps, out_tree));
+}
 END_SECTION
 
 /////////////////////////////////////////////////////////////
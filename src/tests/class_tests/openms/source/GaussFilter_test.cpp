@@ -96,6 +96,33 @@ START_SECTION((template <typename PeakType> void filter(MSSpectrum<PeakType>& sp
   //TEST_EXCEPTION(Exception::IllegalArgument,gauss.filter(spectrum))
 END_SECTION 
 
+START_SECTION((void filter(ColumnarSpectrum<>& spectrum)))
+  MSSpectrum<Peak1D> spectrum;
+  ColumnarSpectrum<> columnar;
+  for (Size i=0; i<9; ++i)
+  {
+    Peak1D p;
+    p.setMZ(500.0+0.2*i);
+    p.setIntensity(i == 4 ? 10.0f : 1.0f);
+    spectrum.push_back(p);
+    columnar.push_back(p.getMZ(), p.getIntensity());
+  }
+
+  GaussFilter gauss;
+  Param param;
+  param.setValue( "gaussian_width", 1.0);
+  gauss.setParameters(param);
+  gauss.filter(spectrum);
+  gauss.filter(columnar);
+
+  ABORT_IF(columnar.size() != spectrum.size())
+  for (Size i=0; i<spectrum.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(columnar.getMZ(i), spectrum[i].getMZ())
+    TEST_REAL_SIMILAR(columnar.getIntensity(i), spectrum[i].getIntensity())
+  }
+END_SECTION
+
 START_SECTION((template <typename PeakType> void filter(MSChromatogram<PeakType>& chromatogram)))
   MSChromatogram<ChromatogramPeak> chromatogram;
 	chromatogram.resize(5);
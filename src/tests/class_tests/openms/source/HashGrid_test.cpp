@@ -91,6 +91,37 @@ START_SECTION(cell_iterator insert(const value_type &v))
 }
 END_SECTION
 
+START_SECTION((template <typename RandomAccessIterator> void insert(RandomAccessIterator first, RandomAccessIterator last)))
+{
+  typedef OpenMS::HashGrid<int> IntGrid;
+  std::vector<IntGrid::value_type> values;
+  values.push_back(std::make_pair(IntGrid::ClusterCenter(0.5, 0.5), 1));
+  values.push_back(std::make_pair(IntGrid::ClusterCenter(3.5, 1.5), 2));
+  values.push_back(std::make_pair(IntGrid::ClusterCenter(0.2, 0.7), 3));
+  values.push_back(std::make_pair(IntGrid::ClusterCenter(3.1, 1.9), 4));
+  values.push_back(std::make_pair(IntGrid::ClusterCenter(0.9, 0.1), 5));
+
+  IntGrid t(cell_dimension);
+  t.insert(std::make_pair(IntGrid::ClusterCenter(0.0, 0.0), 0));
+  t.insert(values.begin(), values.end());
+  TEST_EQUAL(t.size(), 6);
+  TEST_EQUAL(t.grid_dimension[0], 3);
+  TEST_EQUAL(t.grid_dimension[1], 1);
+
+  // elements of a cell keep their order
+  const IntGrid::CellContent& cell1 = t.grid_at(IntGrid::CellIndex(0, 0));
+  TEST_EQUAL(cell1.size(), 4);
+  TEST_EQUAL(cell1[0].second, 0);
+  TEST_EQUAL(cell1[1].second, 1);
+  TEST_EQUAL(cell1[2].second, 3);
+  TEST_EQUAL(cell1[3].second, 5);
+  const IntGrid::CellContent& cell2 = t.grid_at(IntGrid::CellIndex(3, 1));
+  TEST_EQUAL(cell2.size(), 2);
+  TEST_EQUAL(cell2[0].second, 2);
+  TEST_EQUAL(cell2[1].second, 4);
+}
+END_SECTION
+
 START_SECTION(void erase(iterator pos))
   TestGrid t(cell_dimension);
   t.insert(std::make_pair(TestGrid::ClusterCenter(0, 0), TestGrid::mapped_type()));
@@ -235,7 +266,7 @@ START_SECTION(grid_iterator grid_end())
 }
 END_SECTION
 
-START_SECTION(const Grid::mapped_type& grid_at(const CellIndex &x) const)
+START_SECTION(const CellContent& grid_at(const CellIndex &x) const)
 {
   const TestGrid t(cell_dimension);
   const TestGrid::CellIndex i(0, 0);
@@ -243,7 +274,7 @@ START_SECTION(const Grid::mapped_type& grid_at(const CellIndex &x) const)
 }
 END_SECTION
 
-START_SECTION(Grid::mapped_type& grid_at(const CellIndex &x))
+START_SECTION(CellContent& grid_at(const CellIndex &x))
 {
   TestGrid t(cell_dimension);
   const TestGrid::CellIndex i(0, 0);
@@ -251,6 +282,42 @@ START_SECTION(Grid::mapped_type& grid_at(const CellIndex &x))
 }
 END_SECTION
 
+START_SECTION(CellIndex cell_index(const key_type &key) const)
+{
+  const TestGrid t(TestGrid::ClusterCenter(2, 0.5));
+  TEST_EQUAL(t.cell_index(TestGrid::ClusterCenter(0, 0)), TestGrid::CellIndex(0, 0));
+  TEST_EQUAL(t.cell_index(TestGrid::ClusterCenter(3.9, 1.2)), TestGrid::CellIndex(1, 2));
+  TEST_EQUAL(t.cell_index(TestGrid::ClusterCenter(-0.1, -0.5)), TestGrid::CellIndex(-1, -1));
+  TEST_EQUAL(t.size(), 0);
+}
+END_SECTION
+
+START_SECTION(const CellContent* grid_find(const CellIndex &x) const)
+{
+  TestGrid t(cell_dimension);
+  TEST_EQUAL(t.grid_find(TestGrid::CellIndex(0, 0)) == 0, true);
+  t.insert(std::make_pair(TestGrid::ClusterCenter(1.5, 2.5), TestGrid::mapped_type()));
+  TEST_EQUAL(t.grid_find(TestGrid::CellIndex(0, 0)) == 0, true);
+  TEST_EQUAL(t.grid_find(TestGrid::CellIndex(1, 2)) != 0, true);
+  TEST_EQUAL(t.grid_find(TestGrid::CellIndex(1, 2))->size(), 1);
+
+  // many cells (forces the hash table to grow)
+  for (Int i = 0; i < 1000; ++i)
+  {
+    t.insert(std::make_pair(TestGrid::ClusterCenter(i, -i), TestGrid::mapped_type()));
+  }
+  TEST_EQUAL(t.size(), 1001);
+  bool all_found = true;
+  for (Int i = 0; i < 1000; ++i)
+  {
+    const TestGrid::CellContent* cell = t.grid_find(TestGrid::CellIndex(i, -i));
+    all_found = all_found && cell != 0 && cell->size() == 1;
+  }
+  TEST_EQUAL(all_found, true);
+  TEST_EQUAL(t.grid_find(TestGrid::CellIndex(1000, -1000)) == 0, true);
+}
+END_SECTION
+
 START_SECTION([EXTRA] std::size_t hash_value(const DPosition<N, T> &b))
 {
   const DPosition<1, UInt> c1(1);
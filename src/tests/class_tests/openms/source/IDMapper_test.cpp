@@ -60,6 +60,11 @@ class IDMapper2 : public IDMapper
       return isMatch_(rt_distance, mz_theoretical, mz_observed);
     }
 
+    void increaseMatchingBox2_(DBoundingBox<2>& box)
+    {
+      increaseMatchingBox_(box);
+    }
+
 };
 
 START_TEST(IDMapper, "$Id$")
@@ -529,6 +534,33 @@ START_SECTION([EXTRA] bool isMatch_(const double rt_distance, const double mz_th
   TEST_EQUAL(mapper.isMatch2_(5, 999, 1002.1), false)
 END_SECTION
 
+START_SECTION([EXTRA] void increaseMatchingBox_(DBoundingBox<2>& box) const)
+  IDMapper2 mapper;
+  Param p = mapper.getParameters();
+  p.setValue("rt_tolerance", 5.0);
+  p.setValue("mz_tolerance", 3.0);
+  mapper.setParameters(p);
+  DBoundingBox<2> box;
+  box.enlarge(100.0, 1000.0);
+  mapper.increaseMatchingBox2_(box);
+  // all matching peptide positions are inside:
+  TEST_EQUAL(mapper.isMatch2_(5, 999.99701, 1000), true)
+  TEST_EQUAL(box.encloses(105.0, 999.99701), true)
+  TEST_EQUAL(mapper.isMatch2_(-5, 1000.00300, 1000), true)
+  TEST_EQUAL(box.encloses(95.0, 1000.00300), true)
+  TEST_EQUAL(box.encloses(100.0, 999.99), false)
+  TEST_EQUAL(box.encloses(106.0, 1000.0), false)
+  p.setValue("mz_measure","Da");
+  mapper.setParameters(p);
+  box = DBoundingBox<2>();
+  box.enlarge(100.0, 1000.0);
+  box.enlarge(110.0, 1001.0);
+  mapper.increaseMatchingBox2_(box);
+  TEST_EQUAL(box.encloses(115.0, 1004.0), true)
+  TEST_EQUAL(box.encloses(95.0, 997.0), true)
+  TEST_EQUAL(box.encloses(100.0, 996.9), false)
+END_SECTION
+
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
@@ -141,7 +141,7 @@ START_SECTION(( size_t getNrChromatograms() const ))
 }
 END_SECTION
 
-START_SECTION(( OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id)  ))
+START_SECTION(( OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id) const ))
 {
   IndexedMzMLFile file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
 
@@ -166,7 +166,7 @@ START_SECTION(( OpenMS::Interfaces::SpectrumPtr getSpectrumById(int id)  ))
 }
 END_SECTION
 
-START_SECTION(( OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id) ))
+START_SECTION(( OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id) const ))
 {
   IndexedMzMLFile file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
 
@@ -181,6 +181,64 @@ START_SECTION(( OpenMS::Interfaces::ChromatogramPtr getChromatogramById(int id)
 }
 END_SECTION
 
+START_SECTION(( std::vector<OpenMS::Interfaces::SpectrumPtr> getSpectraByIds(const std::vector<int>& ids) const ))
+{
+  IndexedMzMLFile file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+
+  // adjacent, reversed and repeated ids
+  std::vector<int> ids;
+  ids.push_back(0);
+  ids.push_back(1);
+  ids.push_back(1);
+  ids.push_back(0);
+
+  std::vector<OpenMS::Interfaces::SpectrumPtr> spectra = file.getSpectraByIds(ids);
+  TEST_EQUAL(spectra.size(), 4)
+  for (Size i = 0; i < ids.size(); ++i)
+  {
+    OpenMS::Interfaces::SpectrumPtr single = file.getSpectrumById(ids[i]);
+    TEST_EQUAL(spectra[i]->getMZArray()->data.size(), single->getMZArray()->data.size())
+    TEST_EQUAL(spectra[i]->getIntensityArray()->data.size(), single->getIntensityArray()->data.size())
+    TEST_EQUAL(spectra[i]->getMZArray()->data == single->getMZArray()->data, true)
+    TEST_EQUAL(spectra[i]->getIntensityArray()->data == single->getIntensityArray()->data, true)
+  }
+
+  TEST_EQUAL(file.getSpectraByIds(std::vector<int>()).size(), 0)
+
+  // Test Exceptions
+  ids.push_back(file.getNrSpectra());
+  TEST_EXCEPTION(Exception::IllegalArgument, file.getSpectraByIds(ids));
+  ids.back() = -1;
+  TEST_EXCEPTION(Exception::IllegalArgument, file.getSpectraByIds(ids));
+
+  {
+    IndexedMzMLFile file(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist"));
+    TEST_EXCEPTION(Exception::ParseError, file.getSpectraByIds(std::vector<int>(1, 0)));
+  }
+}
+END_SECTION
+
+START_SECTION(([EXTRA] concurrent access))
+{
+  IndexedMzMLFile file(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  IndexedMzMLFile file_copy(file);
+  OpenMS::Interfaces::SpectrumPtr spec = file.getSpectrumById(1);
+  OpenMS::Interfaces::ChromatogramPtr chrom = file.getChromatogramById(0);
+
+  int nr_errors = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+: nr_errors)
+#endif
+  for (SignedSize i = 0; i < 100; ++i)
+  {
+    const IndexedMzMLFile& f = (i % 2 == 0) ? file : file_copy;
+    if (f.getSpectrumById(1)->getMZArray()->data != spec->getMZArray()->data) ++nr_errors;
+    if (f.getChromatogramById(0)->getIntensityArray()->data != chrom->getIntensityArray()->data) ++nr_errors;
+  }
+  TEST_EQUAL(nr_errors, 0)
+}
+END_SECTION
+
 START_SECTION(([EXTRA] load broken file))
 {
 
@@ -41,9 +41,17 @@ using namespace OpenMS;
 
 START_TEST(IsotopeDistributionCache, "$Id$")
 
-START_SECTION(IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage=0, double intensity_percentage_optional=0))
+START_SECTION(IsotopeDistributionCache(double max_mass, double mass_window_width, double intensity_percentage=0, double intensity_percentage_optional=0, Size max_isotopes=20, IsotopeDistribution::Averagine averagine=IsotopeDistribution::PEPTIDE))
   IsotopeDistributionCache c(100, 1);
-END_SECTION 
+  IsotopeDistributionCache c2(1000, 10, 0, 0, 3, IsotopeDistribution::RNA);
+  TEST_EQUAL(c2.getIsotopeDistribution(500).intensity.size(), 3)
+END_SECTION
+
+START_SECTION(IsotopeDistributionCache(double max_mass, Size max_isotopes, IsotopeDistribution::Averagine averagine))
+  IsotopeDistributionCache c(1000, 5, IsotopeDistribution::PEPTIDE);
+  TEST_EQUAL(c.getIsotopeDistribution(500).intensity.size(), 5)
+  TEST_EXCEPTION(Exception::InvalidValue, c.getIsotopeDistribution(1100))
+END_SECTION
 
 START_SECTION(const TheoreticalIsotopePattern& getIsotopeDistribution(double mass) const)
   IsotopeDistributionCache c(1000, 10);
@@ -57,5 +65,47 @@ START_SECTION(const TheoreticalIsotopePattern& getIsotopeDistribution(double mas
   TEST_EQUAL(&p != &c.getIsotopeDistribution(499.9), true);
 END_SECTION
 
+START_SECTION(void getIsotopeProbabilities(double mass, Size nr_isotopes, std::vector<double> & probabilities) const)
+  IsotopeDistributionCache c(2000, 5, IsotopeDistribution::PEPTIDE);
+  std::vector<double> p;
+
+  // exact caches return what IsotopeDistribution estimates, also right next to a change of the composition
+  std::vector<double> factors;
+  IsotopeDistribution::getAveragineFactors(IsotopeDistribution::PEPTIDE, factors);
+  double masses[] = { 100.0, 523.17, 1000.0, 22.5 / factors[0] - 1e-6, 22.5 / factors[0] + 1e-6, 1999.9 };
+  for (Size i = 0; i < 6; ++i)
+  {
+    c.getIsotopeProbabilities(masses[i], 4, p);
+    IsotopeDistribution d(4);
+    d.estimateFromPeptideWeight(masses[i]);
+    TEST_EQUAL(p.size(), d.size())
+    for (Size j = 0; j < p.size(); ++j)
+    {
+      TEST_REAL_SIMILAR(p[j], d.getContainer()[j].second)
+    }
+  }
+
+  // outside of the cached range the distribution is calculated on the fly
+  c.getIsotopeProbabilities(5000.0, 8, p);
+  IsotopeDistribution d(8);
+  d.estimateFromPeptideWeight(5000.0);
+  TEST_EQUAL(p.size(), 8)
+  TEST_REAL_SIMILAR(p[7], d.getContainer()[7].second)
+END_SECTION
+
+START_SECTION(static const IsotopeDistributionCache & getAveragineCache(IsotopeDistribution::Averagine averagine=IsotopeDistribution::PEPTIDE))
+  const IsotopeDistributionCache & c = IsotopeDistributionCache::getAveragineCache();
+  TEST_EQUAL(&c == &IsotopeDistributionCache::getAveragineCache(IsotopeDistribution::PEPTIDE), true)
+  TEST_EQUAL(&c != &IsotopeDistributionCache::getAveragineCache(IsotopeDistribution::RNA), true)
+
+  std::vector<double> p;
+  IsotopeDistributionCache::getAveragineCache(IsotopeDistribution::DNA).getIsotopeProbabilities(1000.0, 3, p);
+  IsotopeDistribution d(3);
+  d.estimateFromDNAWeight(1000.0);
+  TEST_EQUAL(p.size(), 3)
+  TEST_REAL_SIMILAR(p[0], 0.644479)
+  TEST_REAL_SIMILAR(p[2], d.getContainer()[2].second)
+END_SECTION
+
 END_TEST
 
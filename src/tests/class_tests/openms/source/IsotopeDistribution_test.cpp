@@ -305,6 +305,34 @@ START_SECTION(void estimateFromWeightAndComp(double average_weight, double C, do
     TEST_EQUAL(iso.begin()->second,iso2.begin()->second);
 END_SECTION
 
+START_SECTION(void estimateFromAveragineWeight(double average_weight, Averagine averagine))
+    IsotopeDistribution iso(3), iso2(3);
+    iso.estimateFromAveragineWeight(1000.0, IsotopeDistribution::PEPTIDE);
+    iso2.estimateFromPeptideWeight(1000.0);
+    TEST_EQUAL(iso == iso2, true)
+    iso.estimateFromAveragineWeight(1000.0, IsotopeDistribution::RNA);
+    iso2.estimateFromRNAWeight(1000.0);
+    TEST_EQUAL(iso == iso2, true)
+    iso.estimateFromAveragineWeight(1000.0, IsotopeDistribution::DNA);
+    iso2.estimateFromDNAWeight(1000.0);
+    TEST_EQUAL(iso == iso2, true)
+END_SECTION
+
+START_SECTION(static void getAveragineFactors(Averagine averagine, std::vector<double> & factors))
+    std::vector<double> factors;
+    IsotopeDistribution::getAveragineFactors(IsotopeDistribution::PEPTIDE, factors);
+    TEST_EQUAL(factors.size(), 5)
+    TEST_REAL_SIMILAR(factors[0] * 111.1254, 4.9384)
+    TEST_REAL_SIMILAR(factors[4] * 111.1254, 0.0417)
+    IsotopeDistribution::getAveragineFactors(IsotopeDistribution::RNA, factors);
+    TEST_EQUAL(factors.size(), 6)
+    TEST_REAL_SIMILAR(factors[3] / factors[0], 7 / 9.75)
+    TEST_EQUAL(factors[4], 0.0)
+    IsotopeDistribution::getAveragineFactors(IsotopeDistribution::DNA, factors);
+    TEST_EQUAL(factors.size(), 6)
+    TEST_REAL_SIMILAR(factors[3] / factors[0], 6 / 9.75)
+END_SECTION
+
 START_SECTION(void trimRight(double cutoff))
 	IsotopeDistribution iso(EmpiricalFormula("C160").getIsotopeDistribution(10));
 	TEST_NOT_EQUAL(iso.size(),3)
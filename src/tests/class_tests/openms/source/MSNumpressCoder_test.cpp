@@ -37,6 +37,7 @@
 ///////////////////////////
 
 #include <OpenMS/FORMAT/MSNumpressCoder.h>
+#include <OpenMS/MATH/MISC/MSNumpress.h>
 
 ///////////////////////////
 
@@ -208,6 +209,107 @@ START_SECTION(([MSNumpressCoder::NumpressConfig] NumpressConfig()))
 }
 END_SECTION
 
+START_SECTION((static size_t getDecodedSizeBound(size_t in_size, NumpressCompression np_compression)))
+{
+  TEST_EQUAL(MSNumpressCoder::getDecodedSizeBound(100, MSNumpressCoder::LINEAR), 200)
+  TEST_EQUAL(MSNumpressCoder::getDecodedSizeBound(100, MSNumpressCoder::PIC), 200)
+  TEST_EQUAL(MSNumpressCoder::getDecodedSizeBound(108, MSNumpressCoder::SLOF), 54)
+  TEST_EQUAL(MSNumpressCoder::getDecodedSizeBound(100, MSNumpressCoder::NONE), 0)
+}
+END_SECTION
+
+START_SECTION((size_t decodeNPRaw(const unsigned char * in, size_t in_size, double * out, size_t out_size, const NumpressConfig & config)))
+{
+  std::vector<double> in = setup_test_vec2();
+  MSNumpressCoder::NumpressConfig config;
+  config.estimate_fixed_point = true;
+  config.numpressErrorTolerance = 0;
+
+  MSNumpressCoder::NumpressCompression schemes[] = {MSNumpressCoder::LINEAR, MSNumpressCoder::PIC, MSNumpressCoder::SLOF};
+  for (Size s = 0; s < 3; ++s)
+  {
+    config.np_compression = schemes[s];
+    String raw;
+    MSNumpressCoder().encodeNPRaw(in, raw, config);
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(raw.c_str());
+
+    std::vector<double> out(MSNumpressCoder::getDecodedSizeBound(raw.size(), config.np_compression));
+    size_t count = MSNumpressCoder().decodeNPRaw(bytes, raw.size(), &out[0], out.size(), config);
+    TEST_EQUAL(count, in.size())
+
+    // identical to the vector interface
+    std::vector<double> out_vector;
+    MSNumpressCoder().decodeNPRaw(bytes, raw.size(), out_vector, config);
+    TEST_EQUAL(out_vector.size(), count)
+    TEST_EQUAL(std::equal(out_vector.begin(), out_vector.end(), out.begin()), true)
+
+    // identical (bit for bit) to the definition of the encodings
+    bool identical = true;
+    for (Size i = 0; i < in.size(); ++i)
+    {
+      double expected;
+      if (config.np_compression == MSNumpressCoder::LINEAR)
+      {
+        double fixed_point = ms::numpress::MSNumpress::optimalLinearFixedPoint(&in[0], in.size());
+        expected = static_cast<long long>(in[i] * fixed_point + 0.5) / fixed_point;
+      }
+      else if (config.np_compression == MSNumpressCoder::PIC)
+      {
+        expected = static_cast<unsigned int>(in[i] + 0.5);
+      }
+      else
+      {
+        double fixed_point = ms::numpress::MSNumpress::optimalSlofFixedPoint(&in[0], in.size());
+        unsigned short x = static_cast<unsigned short>(log(in[i] + 1) * fixed_point + 0.5);
+        expected = exp(x / fixed_point) - 1;
+      }
+      if (out[i] != expected) identical = false;
+    }
+    TEST_EQUAL(identical, true)
+
+    // output buffer too small
+    TEST_EXCEPTION(Exception::ConversionError, MSNumpressCoder().decodeNPRaw(bytes, raw.size(), &out[0], in.size() / 2, config))
+  }
+
+  // corrupt data
+  config.np_compression = MSNumpressCoder::LINEAR;
+  std::vector<double> out(20);
+  const unsigned char corrupt[] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+  TEST_EXCEPTION(Exception::ConversionError, MSNumpressCoder().decodeNPRaw(corrupt, 9, &out[0], out.size(), config))
+}
+END_SECTION
+
+START_SECTION((size_t decodeNPRaw(const unsigned char * in, size_t in_size, float * out, size_t out_size, const NumpressConfig & config)))
+{
+  std::vector<double> in = setup_test_vec2();
+  MSNumpressCoder::NumpressConfig config;
+  config.estimate_fixed_point = true;
+
+  MSNumpressCoder::NumpressCompression schemes[] = {MSNumpressCoder::LINEAR, MSNumpressCoder::PIC, MSNumpressCoder::SLOF};
+  for (Size s = 0; s < 3; ++s)
+  {
+    config.np_compression = schemes[s];
+    String raw;
+    MSNumpressCoder().encodeNPRaw(in, raw, config);
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(raw.c_str());
+
+    std::vector<double> out_double;
+    MSNumpressCoder().decodeNPRaw(bytes, raw.size(), out_double, config);
+    std::vector<float> out(MSNumpressCoder::getDecodedSizeBound(raw.size(), config.np_compression));
+    size_t count = MSNumpressCoder().decodeNPRaw(bytes, raw.size(), &out[0], out.size(), config);
+    TEST_EQUAL(count, out_double.size())
+
+    // values are decoded in double precision and then converted
+    bool identical = true;
+    for (Size i = 0; i < count; ++i)
+    {
+      if (out[i] != static_cast<float>(out_double[i])) identical = false;
+    }
+    TEST_EQUAL(identical, true)
+  }
+}
+END_SECTION
+
 ///////////////////////////////////////////////////////////////////////////
 // Encode / Decode a small vector
 ///////////////////////////////////////////////////////////////////////////
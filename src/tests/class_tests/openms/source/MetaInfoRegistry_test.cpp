@@ -172,6 +172,19 @@ START_SECTION((MetaInfoRegistry& operator=(const MetaInfoRegistry& rhs)))
 	TEST_STRING_EQUAL(mir2.getUnit(1025), "sec")
 	TEST_STRING_EQUAL(mir2.getUnit("testname"), "")
 	TEST_STRING_EQUAL(mir2.getUnit("retention time"), "sec")
+
+  // concurrent a = b and b = a must not deadlock
+  MetaInfoRegistry mir3;
+  mir2.registerName("only in mir2");
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (SignedSize i = 0; i < 1000; ++i)
+  {
+    if (i % 2) mir2 = mir3;
+    else mir3 = mir2;
+  }
+  TEST_STRING_EQUAL(mir2.getName(1), mir3.getName(1))
 END_SECTION
 
 /////////////////////////////////////////////////////////////
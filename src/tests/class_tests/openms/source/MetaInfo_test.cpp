@@ -75,7 +75,27 @@ START_SECTION((void setValue(const String& name, const DataValue& value)))
 END_SECTION
 
 START_SECTION((void setValue(UInt index, const DataValue& value)))
-	NOT_TESTABLE //tested in the get method
+	// values are kept sorted by index, independent of the insertion order
+	MetaInfo tmp;
+	tmp.setValue(5, 5);
+	tmp.setValue(2, 2);
+	tmp.setValue(9, 9);
+	tmp.setValue(3, 3);
+	tmp.setValue(2, 22); // overwrite
+	vector<UInt> keys;
+	tmp.getKeys(keys);
+	TEST_EQUAL(keys.size(), 4)
+	TEST_EQUAL(keys[0], 2)
+	TEST_EQUAL(keys[1], 3)
+	TEST_EQUAL(keys[2], 5)
+	TEST_EQUAL(keys[3], 9)
+	TEST_EQUAL((Int)tmp.getValue(2), 22)
+	TEST_EQUAL((Int)tmp.getValue(9), 9)
+	TEST_EQUAL(tmp.exists(4), false)
+	TEST_EQUAL(tmp.getValue(4).isEmpty(), true)
+	tmp.removeValue(3);
+	TEST_EQUAL(tmp.exists(3), false)
+	TEST_EQUAL((Int)tmp.getValue(5), 5)
 END_SECTION
 
 START_SECTION((const DataValue& getValue(UInt index) const))
@@ -99,6 +99,44 @@ START_SECTION(( void domParseSpectrum(const std::string& in, OpenMS::Interfaces:
 }
 END_SECTION
 
+START_SECTION(([EXTRA] void domParseSpectrum(std::string& in, OpenMS::Interfaces::SpectrumPtr & sptr) ))
+{
+  // 32 bit float arrays (the m/z array is decoded and converted to double in one pass)
+  ptr = new MzMLSpectrumDecoder();
+  std::string testString = MULTI_LINE_STRING(
+      <spectrum index="2" id="index=2" defaultArrayLength="15">
+        <binaryDataArrayList count="2">
+          <binaryDataArray encodedLength="80" >
+            <cvParam cvRef="MS" accession="MS:1000521" name="32-bit float" value=""/>
+            <cvParam cvRef="MS" accession="MS:1000576" name="no compression" value=""/>
+            <cvParam cvRef="MS" accession="MS:1000514" name="m/z array" unitAccession="MS:1000040" unitName="m/z" unitCvRef="MS"/>
+            <binary>AAAAPwAAwD8AACBAAABgQAAAkEAAALBAAADQQAAA8EAAAAhBAAAYQQAAKEEAADhBAABIQQAAWEEAAGhB</binary>
+          </binaryDataArray>
+          <binaryDataArray encodedLength="80" >
+            <cvParam cvRef="MS" accession="MS:1000521" name="32-bit float" value=""/>
+            <cvParam cvRef="MS" accession="MS:1000576" name="no compression" value=""/>
+            <cvParam cvRef="MS" accession="MS:1000515" name="intensity array" value="" unitAccession="MS:1000131" unitName="number of detector counts" unitCvRef="MS"/>
+            <binary>AABwQQAAYEEAAFBBAABAQQAAMEEAACBBAAAQQQAAAEEAAOBAAADAQAAAoEAAAIBAAABAQAAAAEAAAIA/</binary>
+          </binaryDataArray>
+        </binaryDataArrayList>
+      </spectrum>
+  );
+
+  OpenMS::Interfaces::SpectrumPtr cptr(new OpenMS::Interfaces::Spectrum);
+  ptr->domParseSpectrum(testString, cptr);
+
+  TEST_EQUAL(cptr->getMZArray()->data.size(), 15)
+  TEST_EQUAL(cptr->getIntensityArray()->data.size(), 15)
+
+  TEST_REAL_SIMILAR(cptr->getMZArray()->data[0], 0.5)
+  TEST_REAL_SIMILAR(cptr->getMZArray()->data[7], 7.5)
+  TEST_REAL_SIMILAR(cptr->getMZArray()->data[14], 14.5)
+  TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[7], 8)
+  TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[14], 1)
+  delete ptr;
+}
+END_SECTION
+
 START_SECTION(([EXTRA] void domParseSpectrum(std::string& in, OpenMS::Interfaces::SpectrumPtr & sptr) ))
 {
   // missing defaultArrayLength -> should give an exception of ParseError
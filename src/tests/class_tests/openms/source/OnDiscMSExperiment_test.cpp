@@ -38,6 +38,9 @@
 ///////////////////////////
 
 #include <OpenMS/KERNEL/OnDiscMSExperiment.h>
+#include <OpenMS/SYSTEM/File.h>
+
+#include <fstream>
 
 ///////////////////////////
 
@@ -222,6 +225,97 @@ START_SECTION(OpenMS::Interfaces::ChromatogramPtr getChromatogramById(Size id))
 }
 END_SECTION
 
+START_SECTION((const OnDiscSpectrumIndex& getSpectrumIndex() const))
+{
+  OnDiscMSExperiment<> tmp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  const OnDiscSpectrumIndex& index = tmp.getSpectrumIndex();
+  TEST_EQUAL(index.size(), 2);
+  TEST_REAL_SIMILAR(index.getEntry(0).rt, 0.2961);
+  TEST_REAL_SIMILAR(index.getEntry(1).rt, 0.4738);
+  TEST_EQUAL(index.getEntry(1).ms_level, 1);
+  TEST_EQUAL(index.getSpectraByRT(0.3, 1.0).size(), 1);
+  TEST_EQUAL(index.findNearest(0.0), 0);
+
+  OnDiscMSExperiment<> failed(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"));
+  TEST_EQUAL(failed.getSpectrumIndex().empty(), true);
+}
+END_SECTION
+
+START_SECTION((void setPersistSpectrumIndex(bool persist)))
+{
+  // work on a copy of the data file, the index is stored next to it
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  {
+    std::ifstream ifs(String(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML")).c_str(), std::ios::binary);
+    std::ofstream ofs(tmp_filename.c_str(), std::ios::binary);
+    ofs << ifs.rdbuf();
+  }
+  String index_filename = OnDiscSpectrumIndex::getIndexFilename(tmp_filename);
+  TEST::tmp_file_list.push_back(index_filename); // make sure it gets removed
+
+  OnDiscMSExperiment<> tmp;
+  TEST_EQUAL(tmp.getPersistSpectrumIndex(), false);
+  tmp.setPersistSpectrumIndex(true);
+  TEST_EQUAL(tmp.getPersistSpectrumIndex(), true);
+  tmp.openFile(tmp_filename);
+  TEST_EQUAL(File::exists(index_filename), true);
+
+  // without meta data, the index can only come from the index file
+  OnDiscMSExperiment<> no_meta;
+  no_meta.openFile(tmp_filename, true);
+  TEST_EQUAL(no_meta.getSpectrumIndex().size(), 2);
+  TEST_REAL_SIMILAR(no_meta.getSpectrumIndex().getEntry(1).rt, 0.4738);
+}
+END_SECTION
+
+START_SECTION((bool getPersistSpectrumIndex() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void setCacheSize(Size max_bytes)))
+{
+  OnDiscMSExperiment<> tmp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(tmp.getCache().getMaxBytes(), 0);
+
+  // disabled by default
+  OpenMS::Interfaces::SpectrumPtr s1 = tmp.getSpectrumById(0);
+  OpenMS::Interfaces::SpectrumPtr s2 = tmp.getSpectrumById(0);
+  TEST_EQUAL(s1 == s2, false);
+  TEST_EQUAL(tmp.getCache().size(), 0);
+
+  tmp.setCacheSize(10 * 1024 * 1024);
+  TEST_EQUAL(tmp.getCache().getMaxBytes(), 10 * 1024 * 1024);
+  s1 = tmp.getSpectrumById(0);
+  s2 = tmp.getSpectrumById(0);
+  TEST_EQUAL(s1 == s2, true);
+  TEST_EQUAL(tmp.getCache().getHits(), 1);
+  TEST_EQUAL(tmp.getCache().getMisses(), 1);
+
+  MSSpectrum<> s = tmp.getSpectrum(0);
+  TEST_EQUAL(s.size(), 19914);
+  TEST_EQUAL(tmp.getCache().getHits(), 2);
+
+  // copies have their own cache with the same budget
+  OnDiscMSExperiment<> copy(tmp);
+  TEST_EQUAL(copy.getCache().getMaxBytes(), 10 * 1024 * 1024);
+  TEST_EQUAL(copy.getCache().size(), 0);
+
+  // a budget smaller than a single spectrum caches nothing
+  tmp.setCacheSize(1024);
+  TEST_EQUAL(tmp.getCache().size(), 0);
+  tmp.getSpectrumById(1);
+  TEST_EQUAL(tmp.getCache().size(), 0);
+}
+END_SECTION
+
+START_SECTION((const OnDiscSpectrumCache& getCache() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
 
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
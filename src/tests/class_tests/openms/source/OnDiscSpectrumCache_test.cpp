@@ -0,0 +1,238 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/OnDiscSpectrumCache.h>
+
+///////////////////////////
+
+using namespace OpenMS;
+
+// creates a spectrum with n peaks
+OpenMS::Interfaces::SpectrumPtr createSpectrum(Size n)
+{
+  OpenMS::Interfaces::SpectrumPtr sptr(new OpenMS::Interfaces::Spectrum);
+  sptr->getMZArray()->data.assign(n, 100.0);
+  sptr->getIntensityArray()->data.assign(n, 5.0);
+  return sptr;
+}
+
+START_TEST(OnDiscSpectrumCache, "$Id$");
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+OnDiscSpectrumCache* ptr = 0;
+OnDiscSpectrumCache* nullPointer = 0;
+START_SECTION((OnDiscSpectrumCache(Size max_bytes = 0)))
+{
+  ptr = new OnDiscSpectrumCache();
+  TEST_NOT_EQUAL(ptr, nullPointer);
+  TEST_EQUAL(ptr->getMaxBytes(), 0);
+  TEST_EQUAL(ptr->size(), 0);
+}
+END_SECTION
+
+START_SECTION((~OnDiscSpectrumCache()))
+{
+  delete ptr;
+}
+END_SECTION
+
+const Size spectrum_bytes = OnDiscSpectrumCache::estimateBytes(createSpectrum(100));
+
+START_SECTION((static Size estimateBytes(const OpenMS::Interfaces::SpectrumPtr& sptr)))
+{
+  TEST_EQUAL(spectrum_bytes >= 2 * 100 * sizeof(double), true);
+  TEST_EQUAL(OnDiscSpectrumCache::estimateBytes(createSpectrum(200)) > spectrum_bytes, true);
+}
+END_SECTION
+
+START_SECTION((void setMaxBytes(Size max_bytes)))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  TEST_EQUAL(cache.getMaxBytes(), 3 * spectrum_bytes);
+  cache.insert(0, createSpectrum(100));
+  cache.insert(1, createSpectrum(100));
+  cache.insert(2, createSpectrum(100));
+  TEST_EQUAL(cache.size(), 3);
+
+  // shrinking the budget removes the least recently used spectra
+  cache.setMaxBytes(spectrum_bytes);
+  TEST_EQUAL(cache.size(), 1);
+  OpenMS::Interfaces::SpectrumPtr sptr;
+  TEST_EQUAL(cache.get(2, sptr), true);
+  TEST_EQUAL(cache.get(0, sptr), false);
+
+  // zero disables the cache
+  cache.setMaxBytes(0);
+  TEST_EQUAL(cache.size(), 0);
+  cache.insert(0, createSpectrum(100));
+  TEST_EQUAL(cache.size(), 0);
+}
+END_SECTION
+
+START_SECTION((Size getMaxBytes() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((bool get(Size id, OpenMS::Interfaces::SpectrumPtr& sptr)))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  OpenMS::Interfaces::SpectrumPtr s0 = createSpectrum(100);
+  OpenMS::Interfaces::SpectrumPtr s1 = createSpectrum(100);
+  OpenMS::Interfaces::SpectrumPtr s2 = createSpectrum(100);
+  OpenMS::Interfaces::SpectrumPtr s3 = createSpectrum(100);
+  cache.insert(0, s0);
+  cache.insert(1, s1);
+  cache.insert(2, s2);
+
+  OpenMS::Interfaces::SpectrumPtr sptr;
+  TEST_EQUAL(cache.get(0, sptr), true);
+  TEST_EQUAL(sptr == s0, true);
+
+  // spectrum 1 is now the least recently used one
+  cache.insert(3, s3);
+  TEST_EQUAL(cache.size(), 3);
+  TEST_EQUAL(cache.get(1, sptr), false);
+  TEST_EQUAL(cache.get(2, sptr), true);
+  TEST_EQUAL(sptr == s2, true);
+  TEST_EQUAL(cache.get(3, sptr), true);
+  TEST_EQUAL(cache.get(0, sptr), true);
+
+  TEST_EQUAL(cache.getHits(), 4);
+  TEST_EQUAL(cache.getMisses(), 1);
+
+  // a disabled cache does not count lookups
+  OnDiscSpectrumCache disabled;
+  TEST_EQUAL(disabled.get(0, sptr), false);
+  TEST_EQUAL(disabled.getMisses(), 0);
+}
+END_SECTION
+
+START_SECTION((void insert(Size id, const OpenMS::Interfaces::SpectrumPtr& sptr)))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  cache.insert(0, createSpectrum(100));
+  TEST_EQUAL(cache.size(), 1);
+  TEST_EQUAL(cache.getBytes(), spectrum_bytes);
+
+  // inserting the same id again replaces the spectrum
+  OpenMS::Interfaces::SpectrumPtr s0 = createSpectrum(100);
+  cache.insert(0, s0);
+  TEST_EQUAL(cache.size(), 1);
+  TEST_EQUAL(cache.getBytes(), spectrum_bytes);
+  OpenMS::Interfaces::SpectrumPtr sptr;
+  cache.get(0, sptr);
+  TEST_EQUAL(sptr == s0, true);
+
+  // spectra larger than the budget are not cached
+  cache.insert(1, createSpectrum(1000));
+  TEST_EQUAL(cache.size(), 1);
+  TEST_EQUAL(cache.get(1, sptr), false);
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  cache.insert(0, createSpectrum(100));
+  OpenMS::Interfaces::SpectrumPtr sptr;
+  cache.get(0, sptr);
+  cache.clear();
+  TEST_EQUAL(cache.size(), 0);
+  TEST_EQUAL(cache.getBytes(), 0);
+  TEST_EQUAL(cache.getHits(), 1);
+  TEST_EQUAL(cache.get(0, sptr), false);
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getBytes() const))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  cache.insert(0, createSpectrum(100));
+  cache.insert(1, createSpectrum(100));
+  TEST_EQUAL(cache.getBytes(), 2 * spectrum_bytes);
+  cache.insert(2, createSpectrum(100));
+  cache.insert(3, createSpectrum(100));
+  TEST_EQUAL(cache.getBytes(), 3 * spectrum_bytes);
+}
+END_SECTION
+
+START_SECTION((Size getHits() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((Size getMisses() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void resetStatistics()))
+{
+  OnDiscSpectrumCache cache(3 * spectrum_bytes);
+  cache.insert(0, createSpectrum(100));
+  OpenMS::Interfaces::SpectrumPtr sptr;
+  cache.get(0, sptr);
+  cache.get(1, sptr);
+  TEST_EQUAL(cache.getHits(), 1);
+  TEST_EQUAL(cache.getMisses(), 1);
+  cache.resetStatistics();
+  TEST_EQUAL(cache.getHits(), 0);
+  TEST_EQUAL(cache.getMisses(), 0);
+  TEST_EQUAL(cache.size(), 1);
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,317 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/OnDiscSpectrumIndex.h>
+
+#include <fstream>
+
+///////////////////////////
+
+START_TEST(OnDiscSpectrumIndex, "$Id$");
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+// MS1 spectra at RT 10, 20 and 30; MS2 spectra of two SWATH windows
+// (400-425 and 425-450) in between. The MS1 spectrum at RT 30 is stored
+// before the MS2 spectra of RT 20 to test unsorted input.
+MSExperiment<> exp;
+{
+  double rts[] = {10.0, 11.0, 12.0, 20.0, 30.0, 21.0, 22.0};
+  int levels[] = {1, 2, 2, 1, 1, 2, 2};
+  double windows[] = {0.0, 412.5, 437.5, 0.0, 0.0, 412.5, 437.5};
+  for (Size i = 0; i < 7; ++i)
+  {
+    MSSpectrum<> s;
+    s.setRT(rts[i]);
+    s.setMSLevel(levels[i]);
+    if (levels[i] == 2)
+    {
+      Precursor prec;
+      prec.setMZ(windows[i]);
+      prec.setIsolationWindowLowerOffset(12.5);
+      prec.setIsolationWindowUpperOffset(12.5);
+      s.getPrecursors().push_back(prec);
+    }
+    exp.addSpectrum(s);
+  }
+}
+
+OnDiscSpectrumIndex* ptr = 0;
+OnDiscSpectrumIndex* nullPointer = 0;
+START_SECTION((OnDiscSpectrumIndex()))
+{
+  ptr = new OnDiscSpectrumIndex();
+  TEST_NOT_EQUAL(ptr, nullPointer);
+  TEST_EQUAL(ptr->empty(), true);
+}
+END_SECTION
+
+START_SECTION((~OnDiscSpectrumIndex()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void build(const MSExperiment<>& exp)))
+{
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+  TEST_EQUAL(index.size(), 7);
+  TEST_EQUAL(index.empty(), false);
+  TEST_REAL_SIMILAR(index.getEntry(4).rt, 30.0);
+  TEST_EQUAL(index.getEntry(4).ms_level, 1);
+  TEST_REAL_SIMILAR(index.getEntry(4).precursor_lower_mz, 0.0);
+  TEST_REAL_SIMILAR(index.getEntry(2).rt, 12.0);
+  TEST_EQUAL(index.getEntry(2).ms_level, 2);
+  TEST_REAL_SIMILAR(index.getEntry(2).precursor_lower_mz, 425.0);
+  TEST_REAL_SIMILAR(index.getEntry(2).precursor_upper_mz, 450.0);
+}
+END_SECTION
+
+START_SECTION((Size size() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((bool empty() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((const Entry& getEntry(Size id) const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void clear()))
+{
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+  index.clear();
+  TEST_EQUAL(index.size(), 0);
+  TEST_EQUAL(index.getSpectraByRT(0.0, 100.0).size(), 0);
+  TEST_EQUAL(index.findNearest(10.0), 0);
+}
+END_SECTION
+
+START_SECTION((std::vector<Size> getSpectraByRT(double rt_min, double rt_max, int ms_level = 0) const))
+{
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+
+  std::vector<Size> result = index.getSpectraByRT(11.0, 25.0);
+  TEST_EQUAL(result.size(), 5);
+  ABORT_IF(result.size() != 5);
+  TEST_EQUAL(result[0], 1);
+  TEST_EQUAL(result[1], 2);
+  TEST_EQUAL(result[2], 3);
+  TEST_EQUAL(result[3], 5);
+  TEST_EQUAL(result[4], 6);
+
+  result = index.getSpectraByRT(0.0, 100.0, 1);
+  TEST_EQUAL(result.size(), 3);
+  ABORT_IF(result.size() != 3);
+  TEST_EQUAL(result[0], 0);
+  TEST_EQUAL(result[1], 3);
+  TEST_EQUAL(result[2], 4);
+
+  TEST_EQUAL(index.getSpectraByRT(12.5, 19.5).size(), 0);
+  TEST_EQUAL(index.getSpectraByRT(20.0, 20.0).size(), 1);
+}
+END_SECTION
+
+START_SECTION((std::vector<Size> getSpectraByPrecursor(double precursor_mz, double rt_min, double rt_max) const))
+{
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+
+  std::vector<Size> result = index.getSpectraByPrecursor(410.0, 0.0, 100.0);
+  TEST_EQUAL(result.size(), 2);
+  ABORT_IF(result.size() != 2);
+  TEST_EQUAL(result[0], 1);
+  TEST_EQUAL(result[1], 5);
+
+  result = index.getSpectraByPrecursor(440.0, 15.0, 100.0);
+  TEST_EQUAL(result.size(), 1);
+  ABORT_IF(result.size() != 1);
+  TEST_EQUAL(result[0], 6);
+
+  TEST_EQUAL(index.getSpectraByPrecursor(500.0, 0.0, 100.0).size(), 0);
+}
+END_SECTION
+
+START_SECTION((Size findNearest(double rt, int ms_level = 0) const))
+{
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+
+  TEST_EQUAL(index.findNearest(0.0), 0);
+  TEST_EQUAL(index.findNearest(11.4), 1);
+  TEST_EQUAL(index.findNearest(11.6), 2);
+  TEST_EQUAL(index.findNearest(100.0), 4);
+  TEST_EQUAL(index.findNearest(21.0, 1), 3);
+  TEST_EQUAL(index.findNearest(26.0, 1), 4);
+  TEST_EQUAL(index.findNearest(13.0, 2), 2);
+  TEST_EQUAL(index.findNearest(19.0, 2), 5);
+  TEST_EQUAL(index.findNearest(10.0, 3), 7);
+}
+END_SECTION
+
+START_SECTION((static String getIndexFilename(const String& data_filename)))
+{
+  TEST_EQUAL(OnDiscSpectrumIndex::getIndexFilename("test.mzML"), "test.mzML.rtidx");
+}
+END_SECTION
+
+OnDiscSpectrumIndex::DataFileStamp stamp;
+stamp.file_size = 1234;
+stamp.modification_time = 1400000000;
+stamp.trailer_checksum = 42;
+
+START_SECTION((static DataFileStamp getDataFileStamp(const String& data_filename)))
+{
+  OnDiscSpectrumIndex::DataFileStamp data_stamp = OnDiscSpectrumIndex::getDataFileStamp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"));
+  TEST_EQUAL(data_stamp.file_size > 0, true);
+  TEST_EQUAL(data_stamp.modification_time > 0, true);
+  TEST_EQUAL(data_stamp == OnDiscSpectrumIndex::getDataFileStamp(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML")), true);
+
+  // same size, different content at the end of the file
+  String file_a, file_b;
+  NEW_TMP_FILE(file_a);
+  NEW_TMP_FILE(file_b);
+  {
+    std::ofstream ofs_a(file_a.c_str(), std::ios::binary);
+    ofs_a << "<indexListOffset>1000</indexListOffset>";
+    std::ofstream ofs_b(file_b.c_str(), std::ios::binary);
+    ofs_b << "<indexListOffset>2000</indexListOffset>";
+  }
+  OnDiscSpectrumIndex::DataFileStamp stamp_a = OnDiscSpectrumIndex::getDataFileStamp(file_a);
+  OnDiscSpectrumIndex::DataFileStamp stamp_b = OnDiscSpectrumIndex::getDataFileStamp(file_b);
+  TEST_EQUAL(stamp_a.file_size, stamp_b.file_size);
+  TEST_EQUAL(stamp_a.trailer_checksum != stamp_b.trailer_checksum, true);
+  TEST_EQUAL(stamp_a != stamp_b, true);
+
+  TEST_EXCEPTION(Exception::FileNotFound, OnDiscSpectrumIndex::getDataFileStamp(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")));
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename, const DataFileStamp& data_file_stamp) const))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+  index.store(tmp_filename, stamp);
+
+  OnDiscSpectrumIndex loaded;
+  TEST_EQUAL(loaded.load(tmp_filename, stamp), true);
+  TEST_EQUAL(loaded.size(), index.size());
+  for (Size i = 0; i < index.size(); ++i)
+  {
+    TEST_REAL_SIMILAR(loaded.getEntry(i).rt, index.getEntry(i).rt);
+    TEST_EQUAL(loaded.getEntry(i).ms_level, index.getEntry(i).ms_level);
+    TEST_REAL_SIMILAR(loaded.getEntry(i).precursor_lower_mz, index.getEntry(i).precursor_lower_mz);
+    TEST_REAL_SIMILAR(loaded.getEntry(i).precursor_upper_mz, index.getEntry(i).precursor_upper_mz);
+  }
+  TEST_EQUAL(loaded.getSpectraByRT(11.0, 25.0) == index.getSpectraByRT(11.0, 25.0), true);
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, index.store("/does/not/exist/index.rtidx", stamp));
+}
+END_SECTION
+
+START_SECTION((bool load(const String& filename, const DataFileStamp& data_file_stamp)))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  OnDiscSpectrumIndex index;
+  index.build(exp);
+  index.store(tmp_filename, stamp);
+
+  OnDiscSpectrumIndex loaded;
+  // outdated index (data file size changed)
+  OnDiscSpectrumIndex::DataFileStamp changed = stamp;
+  changed.file_size = 1235;
+  TEST_EQUAL(loaded.load(tmp_filename, changed), false);
+  TEST_EQUAL(loaded.empty(), true);
+  // outdated index (same size, but data file modified)
+  changed = stamp;
+  changed.modification_time += 1;
+  TEST_EQUAL(loaded.load(tmp_filename, changed), false);
+  TEST_EQUAL(loaded.empty(), true);
+  // outdated index (same size and time, but different trailer)
+  changed = stamp;
+  changed.trailer_checksum = 43;
+  TEST_EQUAL(loaded.load(tmp_filename, changed), false);
+  TEST_EQUAL(loaded.empty(), true);
+  // missing file
+  TEST_EQUAL(loaded.load(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist"), stamp), false);
+  // not an index file
+  TEST_EQUAL(loaded.load(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"), stamp), false);
+  TEST_EQUAL(loaded.empty(), true);
+
+  // truncated file
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    String truncated_filename;
+    NEW_TMP_FILE(truncated_filename);
+    std::ofstream ofs(truncated_filename.c_str(), std::ios::binary);
+    ofs.write(content.c_str(), content.size() - 5);
+    ofs.close();
+    TEST_EQUAL(loaded.load(truncated_filename, stamp), false);
+    TEST_EQUAL(loaded.empty(), true);
+  }
+
+  TEST_EQUAL(loaded.load(tmp_filename, stamp), true);
+  TEST_EQUAL(loaded.size(), 7);
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -154,6 +154,43 @@ START_SECTION(convertToOpenMSSpectrum(spectrum,sptr))
 }
 END_SECTION
 
+START_SECTION(swapToColumnarSpectrum(sptr,spectrum))
+{
+  OpenSwath::SpectrumPtr sptr(new OpenSwath::Spectrum());
+  sptr->getMZArray()->data.push_back(1.0);
+  sptr->getMZArray()->data.push_back(2.0);
+  sptr->getIntensityArray()->data.push_back(4.0);
+  sptr->getIntensityArray()->data.push_back(3.0);
+  const double* mz_data = &sptr->getMZArray()->data[0];
+
+  ColumnarSpectrum<> spectrum;
+  OpenSwathDataAccessHelper::swapToColumnarSpectrum(sptr, spectrum);
+
+  TEST_EQUAL(spectrum.size(), 2)
+  TEST_EQUAL(sptr->getMZArray()->data.size(), 0)
+  TEST_EQUAL(sptr->getIntensityArray()->data.size(), 0)
+  TEST_EQUAL(&spectrum.getMZArray()[0] == mz_data, true) // not copied
+  TEST_REAL_SIMILAR(spectrum.getMZ(1), 2.0)
+  TEST_REAL_SIMILAR(spectrum.getIntensity(1), 3.0)
+}
+END_SECTION
+
+START_SECTION(swapToSpectrumPtr(spectrum))
+{
+  ColumnarSpectrum<> spectrum;
+  spectrum.push_back(1.0, 4.0);
+  spectrum.push_back(2.0, 3.0);
+  const double* int_data = &spectrum.getIntensityArray()[0];
+
+  OpenSwath::SpectrumPtr sptr = OpenSwathDataAccessHelper::swapToSpectrumPtr(spectrum);
+
+  TEST_EQUAL(spectrum.empty(), true)
+  TEST_EQUAL(sptr->getMZArray()->data.size(), 2)
+  TEST_EQUAL(&sptr->getIntensityArray()->data[0] == int_data, true) // not copied
+  TEST_REAL_SIMILAR(sptr->getMZArray()->data[0], 1.0)
+  TEST_REAL_SIMILAR(sptr->getIntensityArray()->data[0], 4.0)
+}
+END_SECTION
 
 START_SECTION(convertTargetedExp(transition_exp_, transition_exp))
 END_SECTION
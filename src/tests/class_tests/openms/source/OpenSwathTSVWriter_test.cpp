@@ -0,0 +1,329 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathTSVWriter.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
+#include <OpenMS/FORMAT/ColumnarTableFile.h>
+#include <OpenMS/FORMAT/TextFile.h>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include <algorithm>
+
+///////////////////////////
+
+START_TEST(OpenSwathTSVWriter, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace std;
+using namespace OpenMS;
+
+OpenSwathTSVWriter* ptr = 0;
+OpenSwathTSVWriter* nullPointer = 0;
+
+START_SECTION((OpenSwathTSVWriter(const String& output_filename, const String& input_filename = "inputfile", bool ms1_scores = false, bool uis_scores = false, Size max_queued_bytes = 16 * 1024 * 1024, const String& columnar_filename = "")))
+{
+  ptr = new OpenSwathTSVWriter("");
+  TEST_NOT_EQUAL(ptr, nullPointer)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, OpenSwathTSVWriter("/does/not/exist/OpenSwathTSVWriter_test.tsv"))
+  TEST_EXCEPTION(Exception::UnableToCreateFile, OpenSwathTSVWriter("", "inputfile", false, false, 1024, "/does/not/exist/OpenSwathTSVWriter_test.bin"))
+}
+END_SECTION
+
+START_SECTION((~OpenSwathTSVWriter()))
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((bool isActive() const))
+{
+  OpenSwathTSVWriter inactive("");
+  TEST_EQUAL(inactive.isActive(), false)
+  // writing is a no-op
+  inactive.writeHeader();
+  inactive.writeLine("line\n");
+
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathTSVWriter active(filename);
+  TEST_EQUAL(active.isActive(), true)
+  active.close();
+  TEST_EQUAL(active.isActive(), false)
+
+  String columnar_filename;
+  NEW_TMP_FILE(columnar_filename)
+  OpenSwathTSVWriter columnar_only("", "inputfile", false, false, 1024, columnar_filename);
+  TEST_EQUAL(columnar_only.isActive(), true)
+}
+END_SECTION
+
+START_SECTION((void close()))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathTSVWriter writer(filename);
+  writer.writeLine("a\tb\n");
+  writer.close();
+  // closing twice (and destroying afterwards) is fine
+  writer.close();
+
+  TextFile file(filename);
+  TEST_EQUAL(file.end() - file.begin(), 1)
+  TEST_EQUAL(*file.begin(), "a\tb")
+
+  // a line with more fields than columns cannot be added to the columnar table
+  String columnar_filename;
+  NEW_TMP_FILE(columnar_filename)
+  OpenSwathTSVWriter columnar_writer("", "inputfile", false, false, 1024, columnar_filename);
+  columnar_writer.writeLine(ListUtils::concatenate(std::vector<String>(53, "x"), "\t") + "\n");
+  TEST_EXCEPTION(Exception::IllegalArgument, columnar_writer.close())
+  TEST_EQUAL(columnar_writer.isActive(), false)
+}
+END_SECTION
+
+START_SECTION((std::vector<String> getColumnNames() const))
+{
+  OpenSwathTSVWriter writer("");
+  std::vector<String> names = writer.getColumnNames();
+  TEST_EQUAL(names.size(), 52)
+  ABORT_IF(names.size() != 52)
+  TEST_EQUAL(names[0], "transition_group_id")
+  TEST_EQUAL(names[43], "var_xcorr_shape")
+  TEST_EQUAL(names.back(), "aggr_Fragment_Annotation")
+
+  OpenSwathTSVWriter writer_ms1_uis("", "inputfile", true, true);
+  TEST_EQUAL(writer_ms1_uis.getColumnNames().size(), 52 + 8 + 18)
+}
+END_SECTION
+
+START_SECTION((void writeHeader()))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  {
+    OpenSwathTSVWriter writer(filename);
+    writer.writeHeader();
+  } // destructor writes all pending lines
+
+  TextFile file(filename);
+  TEST_EQUAL(file.end() - file.begin(), 1)
+  std::vector<String> columns;
+  file.begin()->split('\t', columns);
+  TEST_EQUAL(columns.size(), 52)
+  TEST_EQUAL(columns[0], "transition_group_id")
+  TEST_EQUAL(columns.back(), "aggr_Fragment_Annotation")
+
+  String filename_ms1_uis;
+  NEW_TMP_FILE(filename_ms1_uis)
+  {
+    OpenSwathTSVWriter writer(filename_ms1_uis, "inputfile", true, true);
+    writer.writeHeader();
+  }
+  TextFile file_ms1_uis(filename_ms1_uis);
+  file_ms1_uis.begin()->split('\t', columns);
+  TEST_EQUAL(columns.size(), 52 + 8 + 18)
+  TEST_EQUAL(columns.back(), "uis_decoy_var_ind_isotope_overlap")
+}
+END_SECTION
+
+START_SECTION((String prepareLine(const OpenSwath::LightPeptide& pep, const OpenSwath::LightTransition* transition, FeatureMap& output, String id) const))
+{
+  OpenSwath::LightPeptide pep;
+  pep.sequence = "PEPTIDE";
+  pep.charge = 2;
+  pep.protein_refs.push_back("PROT1");
+  OpenSwath::LightModification mod;
+  mod.location = 6;
+  mod.unimod_id = "UniMod:4";
+  pep.modifications.push_back(mod);
+
+  OpenSwath::LightTransition transition;
+  transition.precursor_mz = 400.5;
+  transition.decoy = true;
+
+  FeatureMap output;
+  for (Size i = 0; i < 2; ++i)
+  {
+    Feature feature;
+    feature.setRT(100.0 + i);
+    feature.setIntensity(1000.0);
+    feature.setUniqueId(i + 1);
+    feature.setMetaValue("var_xcorr_shape", 0.5);
+    Feature sub;
+    sub.setIntensity(250.0);
+    sub.setMetaValue("peak_apex_int", 50.0);
+    sub.setMetaValue("FeatureLevel", "MS2");
+    sub.setMetaValue("native_id", "tr1");
+    feature.getSubordinates().push_back(sub);
+    output.push_back(feature);
+  }
+
+  OpenSwathTSVWriter writer("", "run.mzML");
+  String result = writer.prepareLine(pep, &transition, output, "tr_gr1");
+  std::vector<String> lines;
+  result.split('\n', lines);
+  TEST_EQUAL(lines.size(), 3) // two lines and the empty string after the last newline
+  TEST_EQUAL(lines[2], "")
+
+  std::vector<String> columns;
+  lines[0].split('\t', columns);
+  TEST_EQUAL(columns.size(), 52)
+  TEST_EQUAL(columns[0], "tr_gr1_run0")
+  TEST_EQUAL(columns[1], "tr_gr1")
+  TEST_EQUAL(columns[3], "run.mzML")
+  TEST_REAL_SIMILAR(columns[4].toDouble(), 100.0)
+  TEST_EQUAL(columns[5], "f_1")
+  TEST_EQUAL(columns[6], "PEPTIDE")
+  TEST_EQUAL(columns[7], "PEPTIDE(UniMod:4)")
+  TEST_EQUAL(columns[8], "2")
+  TEST_EQUAL(columns[11], "PROT1")
+  TEST_EQUAL(columns[12], "1")
+  TEST_REAL_SIMILAR(columns[43].toDouble(), 0.5) // var_xcorr_shape
+  TEST_REAL_SIMILAR(columns[49].toDouble(), 250.0) // aggr_Peak_Area
+  TEST_EQUAL(columns[51], "tr1")
+
+  lines[1].split('\t', columns);
+  TEST_EQUAL(columns.size(), 52)
+  TEST_EQUAL(columns[5], "f_2")
+}
+END_SECTION
+
+START_SECTION((void writeLine(const String& line)))
+{
+  // many threads and a tiny queue: producers have to wait for the writer
+  // thread, all lines have to arrive complete
+  String filename;
+  NEW_TMP_FILE(filename)
+  const Size nr_lines = 10000;
+  {
+    OpenSwathTSVWriter writer(filename, "inputfile", false, false, 1);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (SignedSize i = 0; i < (SignedSize)nr_lines; ++i)
+    {
+      writer.writeLine(String("tr_gr") + i + "_run0\t" + String(2 * i) + "\n");
+    }
+  }
+
+  TextFile file(filename);
+  TEST_EQUAL(Size(file.end() - file.begin()), nr_lines)
+  std::vector<Size> seen;
+  Size complete_lines = 0;
+  for (TextFile::ConstIterator it = file.begin(); it != file.end(); ++it)
+  {
+    std::vector<String> columns;
+    it->split('\t', columns);
+    Size i = columns[0].substr(5, columns[0].size() - 10).toInt();
+    if (columns.size() == 2 && columns[1].toInt() == Int(2 * i)) ++complete_lines;
+    seen.push_back(i);
+  }
+  TEST_EQUAL(complete_lines, nr_lines)
+  std::sort(seen.begin(), seen.end());
+  TEST_EQUAL(std::unique(seen.begin(), seen.end()) - seen.begin(), SignedSize(nr_lines))
+  TEST_EQUAL(seen.back(), nr_lines - 1)
+}
+END_SECTION
+
+START_SECTION((void writeLines(const std::vector<String>& to_output)))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  std::vector<String> lines;
+  lines.push_back("first\n");
+  lines.push_back("");
+  lines.push_back("second\nthird\n");
+  {
+    OpenSwathTSVWriter writer(filename, "inputfile", false, false, 8);
+    writer.writeLines(lines);
+    writer.writeLine("fourth\n");
+  }
+
+  // a single producer keeps its order
+  TextFile file(filename);
+  TEST_EQUAL(file.end() - file.begin(), 4)
+  TEST_EQUAL(*(file.begin()), "first")
+  TEST_EQUAL(*(file.begin() + 1), "second")
+  TEST_EQUAL(*(file.begin() + 2), "third")
+  TEST_EQUAL(*(file.begin() + 3), "fourth")
+
+  // the columnar table contains the same rows as the TSV file, but not the header
+  String tsv_filename, columnar_filename;
+  NEW_TMP_FILE(tsv_filename)
+  NEW_TMP_FILE(columnar_filename)
+  lines.clear();
+  lines.push_back("tr_gr1_run0\ttr_gr1\t0\trun.mzML\t100.5\n");
+  lines.push_back("tr_gr2_run0\ttr_gr2\t0\trun.mzML\t\n");
+  {
+    OpenSwathTSVWriter writer(tsv_filename, "run.mzML", false, false, 8, columnar_filename);
+    writer.writeHeader();
+    writer.writeLines(lines);
+  }
+
+  TextFile tsv_file(tsv_filename);
+  TEST_EQUAL(tsv_file.end() - tsv_file.begin(), 3)
+
+  std::vector<ColumnarTableFile::Column> columns;
+  ColumnarTableFile().load(columnar_filename, columns);
+  TEST_EQUAL(columns.size(), 52)
+  ABORT_IF(columns.size() != 52)
+  TEST_EQUAL(columns[0].name, "transition_group_id")
+  TEST_EQUAL(columns[0].numeric, false)
+  TEST_EQUAL(columns[0].strings.size(), 2)
+  ABORT_IF(columns[0].strings.size() != 2)
+  TEST_EQUAL(columns[0].strings[0], "tr_gr1_run0")
+  TEST_EQUAL(columns[0].strings[1], "tr_gr2_run0")
+  TEST_EQUAL(columns[4].name, "RT")
+  TEST_EQUAL(columns[4].numeric, true)
+  TEST_EQUAL(columns[4].numbers.size(), 2)
+  ABORT_IF(columns[4].numbers.size() != 2)
+  TEST_REAL_SIMILAR(columns[4].numbers[0], 100.5)
+  TEST_EQUAL(boost::math::isnan(columns[4].numbers[1]), true)
+  // missing fields are empty
+  TEST_EQUAL(columns[51].numbers.size(), 2)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
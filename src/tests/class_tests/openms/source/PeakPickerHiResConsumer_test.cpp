@@ -0,0 +1,181 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Erhan Kenar $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataChainingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/NoopMSDataConsumer.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+START_TEST(PeakPickerHiResConsumer, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+
+PeakPickerHiResConsumer* ptr = 0;
+PeakPickerHiResConsumer* nullPointer = 0;
+
+PeakPickerHiRes pp_hires;
+
+START_SECTION((PeakPickerHiResConsumer(const PeakPickerHiRes& pp, bool check_spectrum_type = true)))
+  ptr = new PeakPickerHiResConsumer(pp_hires);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+END_SECTION
+
+START_SECTION((virtual ~PeakPickerHiResConsumer()))
+  delete ptr;
+END_SECTION
+
+MSExperiment<> input;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_orbitrap.mzML"), input);
+
+MSExperiment<> expected;
+pp_hires.pickExperiment(input, expected);
+
+START_SECTION((virtual void consumeSpectrum(SpectrumType& s)))
+{
+  PeakPickerHiResConsumer consumer(pp_hires);
+  consumer.setExpectedSize(input.size(), 0);
+  consumer.setExperimentalSettings(input);
+
+  ABORT_IF(input.size() != expected.size())
+  for (Size i = 0; i < input.size(); ++i)
+  {
+    MSSpectrum<> s = input[i];
+    consumer.consumeSpectrum(s);
+    TEST_EQUAL(s == expected[i], true)
+  }
+
+  // centroided spectra are rejected unless the check is disabled
+  MSSpectrum<> centroided = expected[0];
+  TEST_EXCEPTION(Exception::IllegalArgument, consumer.consumeSpectrum(centroided))
+
+  PeakPickerHiResConsumer unchecked_consumer(pp_hires, false);
+  centroided = expected[0];
+  unchecked_consumer.consumeSpectrum(centroided);
+  TEST_EQUAL(centroided.getType(), SpectrumSettings::PEAKS)
+}
+END_SECTION
+
+START_SECTION(([EXTRA] consumeSpectrum with ms_levels selection))
+{
+  MSExperiment<> in_selection;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_spectrum_selection.mzML"), in_selection);
+
+  Param pp_param;
+  pp_param.setValue("ms_levels", ListUtils::create<Int>("2"));
+  PeakPickerHiRes pp_ms2;
+  pp_ms2.setParameters(pp_param);
+
+  MSExperiment<> out_selection;
+  pp_ms2.pickExperiment(in_selection, out_selection);
+
+  PeakPickerHiResConsumer consumer(pp_ms2);
+  ABORT_IF(in_selection.size() != out_selection.size())
+  for (Size i = 0; i < in_selection.size(); ++i)
+  {
+    MSSpectrum<> s = in_selection[i];
+    consumer.consumeSpectrum(s);
+    TEST_EQUAL(s == out_selection[i], true)
+    if (in_selection[i].getMSLevel() != 2)
+    {
+      TEST_EQUAL(s == in_selection[i], true)
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((virtual void consumeChromatogram(ChromatogramType& c)))
+{
+  MSExperiment<> exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  TEST_EQUAL(exp.getNrChromatograms() > 0, true)
+
+  MSChromatogram<> expected_chromatogram;
+  pp_hires.pick(exp.getChromatogram(0), expected_chromatogram);
+
+  PeakPickerHiResConsumer consumer(pp_hires);
+  MSChromatogram<> c = exp.getChromatogram(0);
+  consumer.consumeChromatogram(c);
+  TEST_EQUAL(c == expected_chromatogram, true)
+}
+END_SECTION
+
+START_SECTION(([EXTRA] chained with MSDataChainingConsumer))
+{
+  PeakPickerHiResConsumer picking_consumer(pp_hires);
+  NoopMSDataConsumer noop_consumer;
+
+  std::vector<Interfaces::IMSDataConsumer<> *> consumer_list;
+  consumer_list.push_back(&picking_consumer);
+  consumer_list.push_back(&noop_consumer);
+  MSDataChainingConsumer chaining_consumer(consumer_list);
+
+  // the picked spectra are appended to the map passed to transform
+  MSExperiment<> picked;
+  MzMLFile().transform(OPENMS_GET_TEST_DATA_PATH("PeakPickerHiRes_orbitrap.mzML"), &chaining_consumer, picked);
+
+  ABORT_IF(picked.size() != expected.size())
+  for (Size i = 0; i < picked.size(); ++i)
+  {
+    TEST_EQUAL(picked[i].getType(), SpectrumSettings::PEAKS)
+    ABORT_IF(picked[i].size() != expected[i].size())
+    for (Size k = 0; k < picked[i].size(); ++k)
+    {
+      TEST_REAL_SIMILAR(picked[i][k].getMZ(), expected[i][k].getMZ())
+      TEST_REAL_SIMILAR(picked[i][k].getIntensity(), expected[i][k].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION((virtual void setExpectedSize(Size, Size)))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((virtual void setExperimentalSettings(const ExperimentalSettings&)))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,342 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/PeptideIndexFile.h>
+#include <OpenMS/CHEMISTRY/AASequence.h>
+
+#include <fstream>
+
+///////////////////////////
+
+START_TEST(PeptideIndexFile, "$Id$");
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+// tryptic peptides (no missed cleavages): ACDK, EFGR, HIK (first protein)
+// and EFGR, LLK (second protein); sorted by mass: LLK, HIK, ACDK, EFGR
+vector<FASTAFile::FASTAEntry> proteins;
+proteins.push_back(FASTAFile::FASTAEntry("P1", "first protein", "ACDKEFGRHIK"));
+proteins.push_back(FASTAFile::FASTAEntry("P2", "second protein", "EFGRLLK"));
+
+EnzymaticDigestion digestion;
+digestion.setEnzyme("Trypsin");
+digestion.setMissedCleavages(0);
+
+PeptideIndexFile* ptr = 0;
+PeptideIndexFile* nullPointer = 0;
+START_SECTION(PeptideIndexFile())
+{
+  ptr = new PeptideIndexFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getPeptideCount(), 0)
+  TEST_EQUAL(ptr->hasFragmentIndex(), false)
+}
+END_SECTION
+
+START_SECTION(~PeptideIndexFile())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION((void build(const std::vector<FASTAFile::FASTAEntry>& proteins, const EnzymaticDigestion& digestion, Size min_length, Size max_length, double fragment_bin_size = 0.0)))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0);
+  TEST_EQUAL(index.getProteins().size(), 2)
+  TEST_EQUAL(index.getPeptideCount(), 4)
+  TEST_EQUAL(index.getPeptideSequence(0).getString(), "LLK")
+  TEST_EQUAL(index.getPeptideSequence(1).getString(), "HIK")
+  TEST_EQUAL(index.getPeptideSequence(2).getString(), "ACDK")
+  TEST_EQUAL(index.getPeptideSequence(3).getString(), "EFGR")
+  for (Size i = 0; i < index.getPeptideCount(); ++i)
+  {
+    TEST_REAL_SIMILAR(index.getPeptideMass(i), AASequence::fromString(index.getPeptideSequence(i).getString()).getMonoWeight())
+  }
+  TEST_EQUAL(index.hasFragmentIndex(), false)
+
+  // length restrictions
+  index.build(proteins, digestion, 4, 0);
+  TEST_EQUAL(index.getPeptideCount(), 2)
+  index.build(proteins, digestion, 1, 3);
+  TEST_EQUAL(index.getPeptideCount(), 2)
+
+  // missed cleavages
+  EnzymaticDigestion digestion_mc(digestion);
+  digestion_mc.setMissedCleavages(1);
+  index.build(proteins, digestion_mc, 1, 0);
+  TEST_EQUAL(index.getPeptideCount(), 7) // additionally ACDKEFGR, EFGRHIK, EFGRLLK
+  TEST_EQUAL(index.getMissedCleavages(), 1)
+}
+END_SECTION
+
+START_SECTION((const String& getEnzymeName() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 2, 30);
+  TEST_EQUAL(index.getEnzymeName(), "Trypsin")
+}
+END_SECTION
+
+START_SECTION((Size getMissedCleavages() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 2, 30);
+  TEST_EQUAL(index.getMissedCleavages(), 0)
+}
+END_SECTION
+
+START_SECTION((Size getMinLength() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 2, 30);
+  TEST_EQUAL(index.getMinLength(), 2)
+}
+END_SECTION
+
+START_SECTION((Size getMaxLength() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 2, 30);
+  TEST_EQUAL(index.getMaxLength(), 30)
+}
+END_SECTION
+
+START_SECTION((const std::vector<FASTAFile::FASTAEntry>& getProteins() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0);
+  TEST_EQUAL(index.getProteins().size(), 2)
+  TEST_EQUAL(index.getProteins()[1].identifier, "P2")
+  TEST_EQUAL(index.getProteins()[1].description, "second protein")
+  TEST_EQUAL(index.getProteins()[1].sequence, "EFGRLLK")
+}
+END_SECTION
+
+START_SECTION((Size getPeptideCount() const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((double getPeptideMass(Size index) const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((StringView getPeptideSequence(Size index) const))
+{
+  NOT_TESTABLE // tested above
+}
+END_SECTION
+
+START_SECTION((void getPeptideOccurrences(Size index, std::vector<PeptideOccurrence>& occurrences) const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0);
+  vector<PeptideIndexFile::PeptideOccurrence> occurrences;
+  index.getPeptideOccurrences(3, occurrences); // EFGR
+  TEST_EQUAL(occurrences.size(), 2)
+  TEST_EQUAL(occurrences[0].protein_index, 0)
+  TEST_EQUAL(occurrences[0].position, 4)
+  TEST_EQUAL(occurrences[1].protein_index, 1)
+  TEST_EQUAL(occurrences[1].position, 0)
+  index.getPeptideOccurrences(0, occurrences); // LLK
+  TEST_EQUAL(occurrences.size(), 1)
+  TEST_EQUAL(occurrences[0].protein_index, 1)
+  TEST_EQUAL(occurrences[0].position, 4)
+}
+END_SECTION
+
+START_SECTION((std::pair<Size, Size> getPeptidesInMassRange(double min_mass, double max_mass) const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0);
+  pair<Size, Size> range = index.getPeptidesInMassRange(400.0, 500.0); // ACDK
+  TEST_EQUAL(range.first, 2)
+  TEST_EQUAL(range.second, 3)
+  range = index.getPeptidesInMassRange(0.0, 10000.0);
+  TEST_EQUAL(range.first, 0)
+  TEST_EQUAL(range.second, 4)
+  range = index.getPeptidesInMassRange(1000.0, 2000.0);
+  TEST_EQUAL(range.first, range.second)
+  range = index.getPeptidesInMassRange(index.getPeptideMass(1), index.getPeptideMass(1)); // bounds are inclusive
+  TEST_EQUAL(range.first, 1)
+  TEST_EQUAL(range.second, 2)
+}
+END_SECTION
+
+START_SECTION((bool hasFragmentIndex() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0, 1.0);
+  TEST_EQUAL(index.hasFragmentIndex(), true)
+  index.build(proteins, digestion, 1, 0);
+  TEST_EQUAL(index.hasFragmentIndex(), false)
+}
+END_SECTION
+
+START_SECTION((double getFragmentBinSize() const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0, 0.5);
+  TEST_REAL_SIMILAR(index.getFragmentBinSize(), 0.5)
+}
+END_SECTION
+
+START_SECTION((void getPeptidesWithFragment(double mz, std::vector<Size>& peptides) const))
+{
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0, 1.0);
+  vector<Size> peptides;
+  // y1 ion of lysine: LLK, HIK and ACDK
+  index.getPeptidesWithFragment(AASequence::fromString("K").getMonoWeight(Residue::YIon, 1), peptides);
+  TEST_EQUAL(peptides.size(), 3)
+  ABORT_IF(peptides.size() != 3)
+  TEST_EQUAL(peptides[0], 0)
+  TEST_EQUAL(peptides[1], 1)
+  TEST_EQUAL(peptides[2], 2)
+  // y1 ion of arginine (EFGR), same bin as b2 of ACDK
+  index.getPeptidesWithFragment(AASequence::fromString("R").getMonoWeight(Residue::YIon, 1), peptides);
+  TEST_EQUAL(peptides.size(), 2)
+  ABORT_IF(peptides.size() != 2)
+  TEST_EQUAL(peptides[0], 2)
+  TEST_EQUAL(peptides[1], 3)
+  // no fragments
+  index.getPeptidesWithFragment(10.0, peptides);
+  TEST_EQUAL(peptides.empty(), true)
+  index.getPeptidesWithFragment(5000.0, peptides);
+  TEST_EQUAL(peptides.empty(), true)
+  index.getPeptidesWithFragment(-1.0, peptides);
+  TEST_EQUAL(peptides.empty(), true)
+
+  // no fragment index
+  index.build(proteins, digestion, 1, 0);
+  index.getPeptidesWithFragment(AASequence::fromString("K").getMonoWeight(Residue::YIon, 1), peptides);
+  TEST_EQUAL(peptides.empty(), true)
+}
+END_SECTION
+
+START_SECTION((void store(const String& filename) const))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 30, 1.0);
+  index.store(tmp_filename);
+
+  PeptideIndexFile loaded;
+  loaded.load(tmp_filename);
+  TEST_EQUAL(loaded.getEnzymeName(), index.getEnzymeName())
+  TEST_EQUAL(loaded.getMissedCleavages(), index.getMissedCleavages())
+  TEST_EQUAL(loaded.getMinLength(), 1)
+  TEST_EQUAL(loaded.getMaxLength(), 30)
+  TEST_EQUAL(loaded.getProteins().size(), 2)
+  TEST_EQUAL(loaded.getProteins()[0].identifier, "P1")
+  TEST_EQUAL(loaded.getProteins()[0].description, "first protein")
+  TEST_EQUAL(loaded.getProteins()[0].sequence, "ACDKEFGRHIK")
+  TEST_EQUAL(loaded.getPeptideCount(), index.getPeptideCount())
+  for (Size i = 0; i < index.getPeptideCount(); ++i)
+  {
+    TEST_EQUAL(loaded.getPeptideSequence(i).getString(), index.getPeptideSequence(i).getString())
+    TEST_REAL_SIMILAR(loaded.getPeptideMass(i), index.getPeptideMass(i))
+    vector<PeptideIndexFile::PeptideOccurrence> occurrences, loaded_occurrences;
+    index.getPeptideOccurrences(i, occurrences);
+    loaded.getPeptideOccurrences(i, loaded_occurrences);
+    TEST_EQUAL(loaded_occurrences.size(), occurrences.size())
+  }
+  TEST_EQUAL(loaded.hasFragmentIndex(), true)
+  vector<Size> peptides, loaded_peptides;
+  double mz = AASequence::fromString("K").getMonoWeight(Residue::YIon, 1);
+  index.getPeptidesWithFragment(mz, peptides);
+  loaded.getPeptidesWithFragment(mz, loaded_peptides);
+  TEST_EQUAL(loaded_peptides == peptides, true)
+
+  // without fragment index
+  index.build(proteins, digestion, 1, 0);
+  index.store(tmp_filename);
+  loaded.load(tmp_filename);
+  TEST_EQUAL(loaded.getPeptideCount(), 4)
+  TEST_EQUAL(loaded.hasFragmentIndex(), false)
+
+  TEST_EXCEPTION(Exception::UnableToCreateFile, index.store("/does/not/exist/database.pepidx"))
+}
+END_SECTION
+
+START_SECTION((void load(const String& filename)))
+{
+  String tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  PeptideIndexFile index;
+  index.build(proteins, digestion, 1, 0, 1.0);
+  index.store(tmp_filename);
+
+  PeptideIndexFile loaded;
+  TEST_EXCEPTION(Exception::FileNotFound, loaded.load(OPENMS_GET_TEST_DATA_PATH("fileDoesNotExist")))
+  // not an index file
+  TEST_EXCEPTION(Exception::ParseError, loaded.load(OPENMS_GET_TEST_DATA_PATH("FASTAFile_test.fasta")))
+
+  // truncated file
+  {
+    std::ifstream ifs(tmp_filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    String truncated_filename;
+    NEW_TMP_FILE(truncated_filename);
+    std::ofstream ofs(truncated_filename.c_str(), std::ios::binary);
+    ofs.write(content.c_str(), content.size() - 5);
+    ofs.close();
+    TEST_EXCEPTION(Exception::ParseError, loaded.load(truncated_filename))
+  }
+
+  loaded.load(tmp_filename);
+  TEST_EQUAL(loaded.getPeptideCount(), 4)
+  TEST_EQUAL(loaded.getPeptideSequence(3).getString(), "EFGR")
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -254,6 +254,58 @@ START_SECTION((void run(const std::vector<FeatureMap >& input_maps, ConsensusMap
 }
 END_SECTION
 
+START_SECTION(([EXTRA] clusters of equal quality))
+{
+  // two pairs of features with the same distance, i.e. all four clusters
+  // have the same quality; which of them is linked first depends on the
+  // order of the grid, but the pairs have to be found either way
+  vector<FeatureMap > input(2);
+  Feature feat_a, feat_b, feat_c, feat_d;
+  feat_a.setPosition(DPosition<2>(50.0, 500.0));
+  feat_a.setUniqueId(0);
+  feat_d.setPosition(DPosition<2>(10.0, 500.0));
+  feat_d.setUniqueId(1);
+  input[0].push_back(feat_a);
+  input[0].push_back(feat_d);
+  feat_b.setPosition(DPosition<2>(48.0, 500.0));
+  feat_b.setUniqueId(2);
+  feat_c.setPosition(DPosition<2>(12.0, 500.0));
+  feat_c.setUniqueId(3);
+  input[1].push_back(feat_b);
+  input[1].push_back(feat_c);
+  input[0].updateRanges();
+  input[1].updateRanges();
+
+  QTClusterFinder finder;
+  Param param = finder.getDefaults();
+  param.setValue("distance_RT:max_difference", 5.0);
+  param.setValue("distance_MZ:max_difference", 0.1);
+  finder.setParameters(param);
+  ConsensusMap result;
+  finder.run(input, result);
+  TEST_EQUAL(result.size(), 2);
+  ABORT_IF(result.size() != 2);
+  TEST_REAL_SIMILAR(result[0].getQuality(), result[1].getQuality())
+  result.sortByRT();
+
+  ConsensusFeature::HandleSetType group1 = result[0].getFeatures();
+  ConsensusFeature::HandleSetType group2 = result[1].getFeatures();
+  TEST_EQUAL(group1.size(), 2);
+  TEST_EQUAL(group2.size(), 2);
+  ABORT_IF(group1.size() != 2 || group2.size() != 2);
+
+  ConsensusFeature::HandleSetType::const_iterator it = group1.begin();
+  TEST_EQUAL(*it == FeatureHandle(0, feat_d), true);
+  ++it;
+  TEST_EQUAL(*it == FeatureHandle(1, feat_c), true);
+
+  it = group2.begin();
+  TEST_EQUAL(*it == FeatureHandle(0, feat_a), true);
+  ++it;
+  TEST_EQUAL(*it == FeatureHandle(1, feat_b), true);
+}
+END_SECTION
+
 START_SECTION((void run(const std::vector<ConsensusMap>& input_maps, ConsensusMap& result_map)))
 {
 	NOT_TESTABLE; // same as "run" for feature maps (tested above)
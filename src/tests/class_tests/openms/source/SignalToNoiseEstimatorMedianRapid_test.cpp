@@ -148,6 +148,23 @@ START_SECTION( (NoiseEstimator estimateNoise(std::vector<double>& mz_array, std:
 }
 END_SECTION
 
+START_SECTION( (NoiseEstimator estimateNoise(const ColumnarSpectrum<>& spectrum)))
+{
+  ColumnarSpectrum<> spectrum;
+  for (Size i = 0; i < 40; ++i)
+  {
+    spectrum.push_back(200.0 + 10.0 * i, (i < 20) ? 1.0 : 3.0);
+  }
+
+  SignalToNoiseEstimatorMedianRapid sne(200);
+  SignalToNoiseEstimatorMedianRapid::NoiseEstimator e = sne.estimateNoise(spectrum);
+  SignalToNoiseEstimatorMedianRapid::NoiseEstimator e_vec = sne.estimateNoise(spectrum.getMZArray(), spectrum.getIntensityArray());
+  TEST_REAL_SIMILAR(e.get_noise_even(200), 1.0)
+  TEST_REAL_SIMILAR(e.get_noise_even(500), 3.0)
+  TEST_REAL_SIMILAR(e.get_noise_value(410), e_vec.get_noise_value(410))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
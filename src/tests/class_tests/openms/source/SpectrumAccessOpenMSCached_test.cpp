@@ -0,0 +1,214 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry               
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+// 
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution 
+//    may be used to endorse or promote products derived from this software 
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS. 
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING 
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, 
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, 
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; 
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// 
+// --------------------------------------------------------------------------
+// $Maintainer: Hannes Roest $
+// $Authors: Hannes Roest $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSCached.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/CachedMzML.h>
+#include <OpenMS/FORMAT/MzMLFile.h>
+
+using namespace OpenMS;
+using namespace std;
+
+START_TEST(SpectrumAccessOpenMSCached, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// Create a cached file (meta data in tmp_filename, binary data in tmp_filename.cached)
+std::string tmp_filename;
+NEW_TMP_FILE(tmp_filename);
+MSExperiment<> exp;
+MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+{
+  CachedmzML cache;
+  cache.writeMemdump(exp, tmp_filename + ".cached");
+  cache.writeMetadata(exp, tmp_filename, true);
+}
+
+SpectrumAccessOpenMSCached* ptr = 0;
+SpectrumAccessOpenMSCached* nullPointer = 0;
+
+START_SECTION(SpectrumAccessOpenMSCached(String filename))
+{
+  ptr = new SpectrumAccessOpenMSCached(tmp_filename);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+
+  std::string unused_tmp_filename;
+  NEW_TMP_FILE(unused_tmp_filename);
+  TEST_EXCEPTION(Exception::FileNotFound, SpectrumAccessOpenMSCached spectrum_acc(unused_tmp_filename))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessOpenMSCached())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(size_t getNrSpectra() const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  TEST_EQUAL(spectrum_acc.getNrSpectra(), 4)
+}
+END_SECTION
+
+START_SECTION(size_t getNrChromatograms() const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  TEST_EQUAL(spectrum_acc.getNrChromatograms(), 2)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumById(int id))
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  for (Size k = 0; k < exp.size(); k++)
+  {
+    OpenSwath::SpectrumPtr sptr = spectrum_acc.getSpectrumById(k);
+    TEST_EQUAL(sptr->getMZArray()->data.size(), exp[k].size())
+    TEST_EQUAL(sptr->getIntensityArray()->data.size(), exp[k].size())
+    for (Size i = 0; i < exp[k].size(); i++)
+    {
+      TEST_REAL_SIMILAR(sptr->getMZArray()->data[i], exp[k][i].getMZ())
+      TEST_REAL_SIMILAR(sptr->getIntensityArray()->data[i], exp[k][i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::ChromatogramPtr getChromatogramById(int id))
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  for (Size k = 0; k < exp.getChromatograms().size(); k++)
+  {
+    OpenSwath::ChromatogramPtr cptr = spectrum_acc.getChromatogramById(k);
+    TEST_EQUAL(cptr->getTimeArray()->data.size(), exp.getChromatogram(k).size())
+    for (Size i = 0; i < exp.getChromatogram(k).size(); i++)
+    {
+      TEST_REAL_SIMILAR(cptr->getTimeArray()->data[i], exp.getChromatogram(k)[i].getRT())
+      TEST_REAL_SIMILAR(cptr->getIntensityArray()->data[i], exp.getChromatogram(k)[i].getIntensity())
+    }
+  }
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumMeta getSpectrumMetaById(int id) const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  OpenSwath::SpectrumMeta meta = spectrum_acc.getSpectrumMetaById(0);
+  TEST_REAL_SIMILAR(meta.RT, exp[0].getRT())
+  TEST_EQUAL(meta.ms_level, exp[0].getMSLevel())
+}
+END_SECTION
+
+START_SECTION(std::vector<std::size_t> getSpectraByRT(double RT, double deltaRT) const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  std::vector<std::size_t> result = spectrum_acc.getSpectraByRT(exp[1].getRT(), 0.0);
+  TEST_EQUAL(result.size(), 1)
+  TEST_EQUAL(result[0], 1)
+}
+END_SECTION
+
+START_SECTION(SpectrumSettings getSpectraMetaInfo(int id) const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  TEST_EQUAL(spectrum_acc.getSpectraMetaInfo(0).getNativeID(), exp[0].getNativeID())
+}
+END_SECTION
+
+START_SECTION(ChromatogramSettings getChromatogramMetaInfo(int id) const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  TEST_EQUAL(spectrum_acc.getChromatogramMetaInfo(0).getNativeID(), exp.getChromatogram(0).getNativeID())
+}
+END_SECTION
+
+START_SECTION(std::string getChromatogramNativeID(int id) const)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  TEST_EQUAL(spectrum_acc.getChromatogramNativeID(1), exp.getChromatogram(1).getNativeID())
+}
+END_SECTION
+
+START_SECTION(SpectrumAccessOpenMSCached(const SpectrumAccessOpenMSCached & rhs))
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  SpectrumAccessOpenMSCached copy(spectrum_acc);
+  TEST_EQUAL(copy.getNrSpectra(), spectrum_acc.getNrSpectra())
+  TEST_EQUAL(copy.getSpectrumById(2)->getMZArray()->data.size(), exp[2].size())
+}
+END_SECTION
+
+START_SECTION(boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const)
+{
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> clone;
+  {
+    SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+    clone = spectrum_acc.lightClone();
+  }
+  // the clone keeps the shared mapping alive after the original is gone
+  TEST_EQUAL(clone->getNrSpectra(), 4)
+  TEST_EQUAL(clone->getNrChromatograms(), 2)
+  OpenSwath::SpectrumPtr sptr = clone->getSpectrumById(3);
+  TEST_EQUAL(sptr->getMZArray()->data.size(), exp[3].size())
+}
+END_SECTION
+
+START_SECTION([EXTRA] concurrent access to the same object)
+{
+  SpectrumAccessOpenMSCached spectrum_acc(tmp_filename);
+  Size nr_errors = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+: nr_errors)
+#endif
+  for (SignedSize i = 0; i < 400; i++)
+  {
+    Size k = i % exp.size();
+    OpenSwath::SpectrumPtr sptr = spectrum_acc.getSpectrumById(k);
+    if (sptr->getMZArray()->data.size() != exp[k].size()) nr_errors++;
+  }
+  TEST_EQUAL(nr_errors, 0)
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
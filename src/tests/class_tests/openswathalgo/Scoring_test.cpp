@@ -35,6 +35,7 @@
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/OpenSwathAlgoConfig.h"
 
 #include "OpenMS/ANALYSIS/OPENSWATH/OPENSWATHALGO/ALGO/Scoring.h"
+#include <cmath>
 
 #ifdef USE_BOOST_UNIT_TEST
 
@@ -262,6 +263,134 @@ BOOST_AUTO_TEST_CASE(test_MRMFeatureScoring_calcxcorr_legacy_mquest_)
 }
 END_SECTION
 
+BOOST_AUTO_TEST_CASE(test_normalizedCrossCorrelationPairs)
+{
+  static const double arr1[] = {0,1,3,5,2,0};
+  static const double arr2[] = {1,3,5,2,0,0};
+  std::vector<std::vector<double> > traces(2);
+  traces[0] = std::vector<double>(arr1, arr1 + sizeof(arr1) / sizeof(arr1[0]));
+  traces[1] = std::vector<double>(arr2, arr2 + sizeof(arr2) / sizeof(arr2[0]));
+
+  std::vector<std::pair<std::size_t, std::size_t> > pairs;
+  pairs.push_back(std::make_pair(0, 0));
+  pairs.push_back(std::make_pair(0, 1));
+  pairs.push_back(std::make_pair(1, 1));
+
+  // direct computation and FFT (threshold 0) both give the values of normalizedCrossCorrelation
+  std::vector<double> result_direct, result_fft;
+  Scoring::normalizedCrossCorrelationPairs(traces, traces, pairs, result_direct);
+  Scoring::normalizedCrossCorrelationPairs(traces, traces, pairs, result_fft, 0);
+  TEST_EQUAL(result_direct.size(), 3 * 13)
+  TEST_EQUAL(result_fft.size(), 3 * 13)
+
+  for (std::size_t p = 0; p < pairs.size(); p++)
+  {
+    std::vector<double> data1 = traces[pairs[p].first];
+    std::vector<double> data2 = traces[pairs[p].second];
+    std::map<int, double> expected = Scoring::normalizedCrossCorrelation(data1, data2, 6, 1);
+    for (int delay = -5; delay <= 5; delay++)
+    {
+      TEST_REAL_SIMILAR(result_direct[p * 13 + delay + 6], expected[delay])
+      TEST_REAL_SIMILAR(result_fft[p * 13 + delay + 6], expected[delay])
+    }
+    TEST_EQUAL(result_direct[p * 13], 0.0)
+    TEST_EQUAL(result_fft[p * 13 + 12], 0.0)
+  }
+
+  // values from test_MRMFeatureScoring_normalizedCrossCorrelation
+  TEST_REAL_SIMILAR(result_direct[13 + 2 + 6], -0.7374631)
+  TEST_REAL_SIMILAR(result_direct[13 + 0 + 6],  0.4159292)
+  TEST_REAL_SIMILAR(result_direct[13 - 1 + 6],  0.8215339)
+
+  // the input is not modified
+  TEST_EQUAL(traces[0][3], 5.0)
+
+  // longer traces: FFT and direct computation find the same maxima
+  std::vector<std::vector<double> > long_traces(3, std::vector<double>(150));
+  for (std::size_t i = 0; i < 150; i++)
+  {
+    long_traces[0][i] = std::exp(-(i - 70.0) * (i - 70.0) / 50.0) + 0.1 * std::sin(i * 0.7);
+    long_traces[1][i] = std::exp(-(i - 74.0) * (i - 74.0) / 60.0) + 0.1 * std::cos(i * 1.3);
+    long_traces[2][i] = std::exp(-(i - 66.0) * (i - 66.0) / 40.0) + 0.05 * std::sin(i * 2.1);
+  }
+  pairs.clear();
+  for (std::size_t i = 0; i < 3; i++)
+  {
+    for (std::size_t j = i; j < 3; j++)
+    {
+      pairs.push_back(std::make_pair(i, j));
+    }
+  }
+  Scoring::normalizedCrossCorrelationPairs(long_traces, long_traces, pairs, result_direct, 1000);
+  Scoring::normalizedCrossCorrelationPairs(long_traces, long_traces, pairs, result_fft, 0);
+  for (std::size_t p = 0; p < pairs.size(); p++)
+  {
+    std::vector<double> data1 = long_traces[pairs[p].first];
+    std::vector<double> data2 = long_traces[pairs[p].second];
+    std::map<int, double> expected = Scoring::normalizedCrossCorrelation(data1, data2, 150, 1);
+    Scoring::XCorrArrayType::iterator expected_max = Scoring::xcorrArrayGetMaxPeak(expected);
+    std::pair<int, double> max_direct = Scoring::xcorrArrayGetMaxPeak(&result_direct[p * 301], 150);
+    std::pair<int, double> max_fft = Scoring::xcorrArrayGetMaxPeak(&result_fft[p * 301], 150);
+    TEST_EQUAL(max_direct.first, expected_max->first)
+    TEST_EQUAL(max_fft.first, expected_max->first)
+    TEST_REAL_SIMILAR(max_direct.second, expected_max->second)
+    TEST_REAL_SIMILAR(max_fft.second, expected_max->second)
+  }
+  // the traces are shifted by 4 points against each other
+  TEST_EQUAL(Scoring::xcorrArrayGetMaxPeak(&result_fft[1 * 301], 150).first, 4)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_normalizedCrossCorrelationPairs_flat_trace)
+{
+  // traces without variance (e.g. a dead transition) must not affect the
+  // other pairs when the FFT is used (n > fft_threshold)
+  std::vector<std::vector<double> > traces(4, std::vector<double>(120));
+  for (std::size_t i = 0; i < 120; i++)
+  {
+    traces[0][i] = std::exp(-(i - 60.0) * (i - 60.0) / 50.0);
+    traces[1][i] = 0.0;
+    traces[2][i] = std::exp(-(i - 63.0) * (i - 63.0) / 50.0);
+    traces[3][i] = 5.0;
+  }
+  std::vector<std::pair<std::size_t, std::size_t> > pairs;
+  for (std::size_t i = 0; i < 4; i++)
+  {
+    for (std::size_t j = i; j < 4; j++)
+    {
+      pairs.push_back(std::make_pair(i, j));
+    }
+  }
+  std::vector<double> result;
+  Scoring::normalizedCrossCorrelationPairs(traces, traces, pairs, result, 100);
+  TEST_EQUAL(result.size(), pairs.size() * 241)
+  for (std::size_t p = 0; p < pairs.size(); p++)
+  {
+    std::vector<double> data1 = traces[pairs[p].first];
+    std::vector<double> data2 = traces[pairs[p].second];
+    std::map<int, double> expected = Scoring::normalizedCrossCorrelation(data1, data2, 120, 1);
+    Scoring::XCorrArrayType::iterator expected_max = Scoring::xcorrArrayGetMaxPeak(expected);
+    std::pair<int, double> max_peak = Scoring::xcorrArrayGetMaxPeak(&result[p * 241], 120);
+    TEST_EQUAL(max_peak.first, expected_max->first)
+    TEST_REAL_SIMILAR(max_peak.second, expected_max->second)
+  }
+  // pair (0, 2) is shifted by 3 points
+  std::pair<int, double> max_peak = Scoring::xcorrArrayGetMaxPeak(&result[2 * 241], 120);
+  TEST_EQUAL(max_peak.first, 3)
+  TEST_REAL_SIMILAR(max_peak.second, 0.9956675)
+}
+END_SECTION
+
+BOOST_AUTO_TEST_CASE(test_xcorrArrayGetMaxPeak_dense)
+{
+  static const double arr[] = {0.0, 0.2, 0.8, 0.5, 0.8, 0.0, 0.0};
+  std::pair<int, double> max_peak = Scoring::xcorrArrayGetMaxPeak(arr, 3);
+  // ties are resolved towards the lowest lag (as for the map)
+  TEST_EQUAL(max_peak.first, -1)
+  TEST_REAL_SIMILAR(max_peak.second, 0.8)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
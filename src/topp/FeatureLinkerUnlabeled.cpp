@@ -152,7 +152,34 @@ protected:
     // load input
     ConsensusMap out_map;
     StringList ms_run_locations;
-    if (file_type == FileTypes::FEATUREXML)
+    if ((file_type == FileTypes::FEATUREXML) &&
+        (algorithm_param.getValue("merge_strategy") == "tree"))
+    {
+      // hierarchical merging needs all maps in memory ("max_parallel_merges"
+      // does not change that, it only limits the concurrent merges)
+      vector<FeatureMap> maps(ins.size());
+      FeatureXMLFile f;
+      f.getOptions().setLoadConvexHull(false);
+      f.getOptions().setLoadSubordinates(false);
+      for (Size i = 0; i < ins.size(); ++i)
+      {
+        f.load(ins[i], maps[i]);
+        const StringList& ms_runs = maps[i].getPrimaryMSRunPath();
+        ms_run_locations.insert(ms_run_locations.end(), ms_runs.begin(), ms_runs.end());
+      }
+      // group
+      algorithm->group(maps, out_map);
+
+      // set file descriptions:
+      for (Size i = 0; i < ins.size(); ++i)
+      {
+        out_map.getFileDescriptions()[i].filename = ins[i];
+        out_map.getFileDescriptions()[i].size = maps[i].size();
+        out_map.getFileDescriptions()[i].unique_id = maps[i].getUniqueId();
+      }
+      out_map.updateRanges();
+    }
+    else if (file_type == FileTypes::FEATUREXML)
     {
       // use map with highest number of features as reference:
       Size max_count(0);
@@ -34,10 +34,12 @@
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiRes.h>
+#include <OpenMS/TRANSFORMATIONS/RAW2PEAK/PeakPickerHiResConsumer.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 #include <OpenMS/FORMAT/PeakTypeEstimator.h>
 
 #include <OpenMS/FORMAT/DATAACCESS/MSDataWritingConsumer.h>
+#include <OpenMS/FORMAT/DATAACCESS/MSDataChainingConsumer.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -124,44 +126,6 @@ public:
 
 protected:
 
-  /**
-    @brief Helper class for the Low Memory peak-picking
-  */
-  class PPHiResMzMLConsumer :
-    public MSDataWritingConsumer
-  {
-
-  public:
-
-    PPHiResMzMLConsumer(String filename, const PeakPickerHiRes& pp) :
-      MSDataWritingConsumer(filename),
-      ms_levels_(pp.getParameters().getValue("ms_levels").toIntList())
-    {
-      pp_ = pp;
-    }
-
-    void processSpectrum_(MapType::SpectrumType& s)
-    {
-      if (!ListUtils::contains(ms_levels_, s.getMSLevel())) {return;}
-
-      MapType::SpectrumType sout;
-      pp_.pick(s, sout);
-      s = sout;  // todo: swap? (requires implementation)
-    }
-
-    void processChromatogram_(MapType::ChromatogramType & c)
-    {
-      MapType::ChromatogramType c_out;
-      pp_.pick(c, c_out);
-      c = c_out;
-    }
-
-  private:
-
-    PeakPickerHiRes pp_;
-    std::vector<Int> ms_levels_;
-  };
-
   void registerOptionsAndFlags_()
   {
     registerInputFile_("in", "<file>", "", "input profile data file ");
@@ -183,17 +147,24 @@ protected:
   ExitCodes doLowMemAlgorithm(const PeakPickerHiRes& pp)
   {
     ///////////////////////////////////
-    // Create the consumer object, add data processing
+    // Create the consumer objects (picking, then writing), add data processing
     ///////////////////////////////////
-    PPHiResMzMLConsumer pp_consumer(out, pp);
-    pp_consumer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+    bool check_spectrum_type = !getFlag_("force");
+    PeakPickerHiResConsumer pp_consumer(pp, check_spectrum_type);
+    PlainMSDataWritingConsumer writing_consumer(out);
+    writing_consumer.addDataProcessing(getProcessingInfo_(DataProcessing::PEAK_PICKING));
+
+    std::vector<Interfaces::IMSDataConsumer<> *> consumer_list;
+    consumer_list.push_back(&pp_consumer);
+    consumer_list.push_back(&writing_consumer);
+    MSDataChainingConsumer chaining_consumer(consumer_list);
 
     ///////////////////////////////////
     // Create new MSDataReader and set our consumer
     ///////////////////////////////////
     MzMLFile mz_data_file;
     mz_data_file.setLogType(log_type_);
-    mz_data_file.transform(in, &pp_consumer);
+    mz_data_file.transform(in, &chaining_consumer);
 
     return EXECUTION_OK;
   }
@@ -37,6 +37,7 @@
 #include <OpenMS/DATASTRUCTURES/SeqanIncludeWrapper.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/PeptideIndexFile.h>
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/SYSTEM/File.h>
 #include <OpenMS/FORMAT/FileHandler.h>
@@ -84,6 +85,9 @@ using namespace std;
   PeptideIndexer supports relative database filenames, which (when not found in the current working directory) are looked up in the directories specified
   by @p OpenMS.ini:id_db_dir (see @subpage TOPP_advanced).
 
+  Instead of a FASTA file, a peptide index created by @ref UTILS_PeptideIndexBuilder can be given as database (@p fasta), which loads faster for large databases.
+  Only its proteins are used, i.e. the digestion settings of the index do not matter.
+
   By default this tool will fail if an unmatched peptide occurs, i.e. if the database does not contain the corresponding protein.
   You can force it to return successfully in this case by using the flag @p allow_unmatched.
 
@@ -469,8 +473,8 @@ protected:
   {
     registerInputFile_("in", "<file>", "", "Input idXML file containing the identifications.");
     setValidFormats_("in", ListUtils::create<String>("idXML"));
-    registerInputFile_("fasta", "<file>", "", "Input sequence database in FASTA format. Non-existing relative filenames are looked up via 'OpenMS.ini:id_db_dir'", true, false, ListUtils::create<String>("skipexists"));
-    setValidFormats_("fasta", ListUtils::create<String>("fasta"));
+    registerInputFile_("fasta", "<file>", "", "Input sequence database in FASTA format (or a peptide index created by PeptideIndexBuilder, which is faster to load). Non-existing relative filenames are looked up via 'OpenMS.ini:id_db_dir'", true, false, ListUtils::create<String>("skipexists"));
+    setValidFormats_("fasta", ListUtils::create<String>("fasta,pepidx"));
     registerOutputFile_("out", "<file>", "", "Output idXML file.");
     setValidFormats_("out", ListUtils::create<String>("idXML"));
     registerStringOption_("decoy_string", "<string>", "_rev", "String that was appended (or prefixed - see 'prefix' flag below) to the accessions in the protein database to indicate decoy proteins.", false);
@@ -549,7 +553,17 @@ protected:
 
     // we stream the Fasta file
     vector<FASTAFile::FASTAEntry> proteins;
-    FASTAFile().load(db_name, proteins);
+    if (FileHandler::getTypeByFileName(db_name) == FileTypes::PEPIDX)
+    {
+      // only the proteins are needed (peptides are matched independent of the digestion of the index)
+      PeptideIndexFile peptide_db;
+      peptide_db.load(db_name);
+      proteins = peptide_db.getProteins();
+    }
+    else
+    {
+      FASTAFile().load(db_name, proteins);
+    }
 
     vector<ProteinIdentification> prot_ids;
     vector<PeptideIdentification> pep_ids;
@@ -56,6 +56,11 @@ using namespace std;
   it in a binary format that contains ONLY the spectra and chromatogram data
   (no metadata).
  
+  The binary format stores an index (including the retention time, MS level
+  and precursor isolation window of each spectrum) at the end of the file.
+  Intensities are stored using 32 bit precision, optionally both m/z and
+  intensity arrays can be compressed using MSNumpress (-lossy_compression).
+ 
   This is implemented using the write_memdump and read_memdump functions.
   For reading there are 2 options
   - read the whole file into the OpenMS datastructures
@@ -99,6 +104,7 @@ class TOPPOpenSwathMzMLFileCacher
     //setValidFormats_("out_meta",ListUtils::create<String>("mzML"));
 
     registerFlag_("convert_back", "Convert back to mzML");
+    registerFlag_("lossy_compression", "Store m/z and intensity arrays using MSNumpress (linear and slof) compression (lossy, relative error < 1e-4)");
 
   }
 
@@ -119,6 +125,18 @@ class TOPPOpenSwathMzMLFileCacher
       cacher.setLogType(log_type_);
       f.setLogType(log_type_);
 
+      if (getFlag_("lossy_compression"))
+      {
+        MSNumpressCoder::NumpressConfig config_mz;
+        config_mz.np_compression = MSNumpressCoder::LINEAR;
+        config_mz.estimate_fixed_point = true;
+        MSNumpressCoder::NumpressConfig config_int;
+        config_int.np_compression = MSNumpressCoder::SLOF;
+        config_int.estimate_fixed_point = true;
+        cacher.setNumpressConfigurationMassTime(config_mz);
+        cacher.setNumpressConfigurationIntensity(config_int);
+      }
+
       f.load(in,exp);
       cacher.writeMemdump(exp, out_cached);
       cacher.writeMetadata(exp, out_meta, true);
@@ -64,6 +64,7 @@
 
 // Helpers
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathTSVWriter.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 
@@ -76,6 +77,10 @@
 
 #include <assert.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #define OPENSWATH_WORKFLOW_DEBUG
 
 using namespace OpenMS;
@@ -85,254 +90,10 @@ static bool SortPairDoubleByFirst(const std::pair<double,double> & left, const s
   return left.first < right.first;
 }
 
-// The workflow class and the TSV writer
+// The workflow class
 namespace OpenMS
 {
 
-  /**
-   * @brief Class to write out an OpenSwath TSV output (mProphet input)
-   *
-   */
-  class OpenSwathTSVWriter
-  {
-    std::ofstream ofs;
-    String input_filename_;
-    bool doWrite_;
-    bool use_ms1_traces_;
-    bool enable_uis_scoring_;
-
-  public:
-
-    OpenSwathTSVWriter(String output_filename, String input_filename = "inputfile", bool ms1_scores = false, bool uis_scores = false) :
-      ofs(output_filename.c_str()),
-      input_filename_(input_filename),
-      doWrite_(!output_filename.empty()),
-      use_ms1_traces_(ms1_scores),
-      enable_uis_scoring_(uis_scores)
-      {}
-
-    bool isActive() 
-    {
-      return doWrite_;
-    }
-
-    void writeHeader()
-    {
-      ofs << "transition_group_id\tpeptide_group_label\trun_id\tfilename\tRT\tid\tSequence\tFullPeptideName" <<
-        "\tCharge\tm/z\tIntensity\tProteinName\tdecoy\tassay_rt\tdelta_rt\tleftWidth" <<
-        "\tmain_var_xx_swath_prelim_score\tnorm_RT\tnr_peaks\tpeak_apices_sum\tpotentialOutlier" <<
-        "\trightWidth\trt_score\tsn_ratio\ttotal_xic\tvar_bseries_score\tvar_dotprod_score" <<
-        "\tvar_intensity_score\tvar_isotope_correlation_score\tvar_isotope_overlap_score" <<
-        "\tvar_library_corr\tvar_library_dotprod\tvar_library_manhattan\tvar_library_rmsd" <<
-        "\tvar_library_rootmeansquare\tvar_library_sangle\tvar_log_sn_score\tvar_manhatt_score" <<
-        "\tvar_massdev_score\tvar_massdev_score_weighted\tvar_norm_rt_score\tvar_xcorr_coelution" <<
-        "\tvar_xcorr_coelution_weighted\tvar_xcorr_shape\tvar_xcorr_shape_weighted" <<
-        "\tvar_yseries_score\tvar_elution_model_fit_score";
-      if (use_ms1_traces_)
-      {
-        ofs << "\tvar_ms1_ppm_diff\tvar_ms1_isotope_corr\tvar_ms1_isotope_overlap\tvar_ms1_xcorr_coelution\tvar_ms1_xcorr_shape";
-      }
-      ofs << "\txx_lda_prelim_score\txx_swath_prelim_score";
-      if (use_ms1_traces_)
-      {
-        ofs << "\taggr_prec_Peak_Area\taggr_prec_Peak_Apex\taggr_prec_Fragment_Annotation";
-      }
-      ofs << "\taggr_Peak_Area\taggr_Peak_Apex\taggr_Fragment_Annotation";
-      if (enable_uis_scoring_)
-      {
-        ofs << "\tuis_target_transition_names"
-            << "\tuis_target_var_ind_log_intensity"
-            << "\tuis_target_num_transitions"
-            << "\tuis_target_var_ind_xcorr_coelution"
-            << "\tuis_target_main_var_ind_xcorr_shape"
-            << "\tuis_target_var_ind_log_sn_score"
-            << "\tuis_target_var_ind_massdev_score"
-            << "\tuis_target_var_ind_isotope_correlation"
-            << "\tuis_target_var_ind_isotope_overlap"
-            << "\tuis_decoy_transition_names"
-            << "\tuis_decoy_var_ind_log_intensity"
-            << "\tuis_decoy_num_transitions"
-            << "\tuis_decoy_var_ind_xcorr_coelution"
-            << "\tuis_decoy_main_var_ind_xcorr_shape"
-            << "\tuis_decoy_var_ind_log_sn_score"
-            << "\tuis_decoy_var_ind_massdev_score"
-            << "\tuis_decoy_var_ind_isotope_correlation"
-            << "\tuis_decoy_var_ind_isotope_overlap";
-      }
-      ofs << "\n";
-    }
-
-    String prepareLine(const OpenSwath::LightPeptide& pep,
-        const OpenSwath::LightTransition* transition,
-        FeatureMap& output, String id)
-    {
-        String result = "";
-        String decoy = "0"; // 0 = false
-        if (transition->decoy) 
-        {
-          decoy = "1";
-        }
-
-        for (FeatureMap::iterator feature_it = output.begin(); feature_it != output.end(); ++feature_it)
-        {
-
-          char intensity_char[40];
-          char intensity_apex_char[40];
-          String aggr_Peak_Area = "";
-          String aggr_Peak_Apex = "";
-          String aggr_Fragment_Annotation = "";
-          String aggr_prec_Peak_Area = "";
-          String aggr_prec_Peak_Apex = "";
-          String aggr_prec_Fragment_Annotation = "";
-          for (std::vector<Feature>::iterator sub_it = feature_it->getSubordinates().begin(); sub_it != feature_it->getSubordinates().end(); ++sub_it)
-          {
-            sprintf(intensity_char, "%f", sub_it->getIntensity());
-            sprintf(intensity_apex_char, "%f", (double)sub_it->getMetaValue("peak_apex_int"));
-            if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS2")
-            {
-              aggr_Peak_Area += (String)intensity_char + ";";
-              aggr_Peak_Apex += (String)intensity_apex_char + ";";
-              aggr_Fragment_Annotation += (String)sub_it->getMetaValue("native_id") + ";";
-            }
-            else if (sub_it->metaValueExists("FeatureLevel") && sub_it->getMetaValue("FeatureLevel") == "MS1")
-            {
-              aggr_prec_Peak_Area += (String)intensity_char + ";";
-              aggr_Peak_Apex += (String)intensity_apex_char + ";";
-              aggr_prec_Fragment_Annotation += (String)sub_it->getMetaValue("native_id") + ";";
-            }
-          }
-          if (!feature_it->getSubordinates().empty())
-          {
-            aggr_Peak_Area = aggr_Peak_Area.substr(0, aggr_Peak_Area.size() - 1);
-            aggr_Peak_Apex = aggr_Peak_Apex.substr(0, aggr_Peak_Apex.size() - 1);
-            aggr_Fragment_Annotation = aggr_Fragment_Annotation.substr(0, aggr_Fragment_Annotation.size() - 1);
-            aggr_prec_Peak_Area = aggr_prec_Peak_Area.substr(0, aggr_prec_Peak_Area.size() - 1);
-            aggr_prec_Peak_Apex = aggr_prec_Peak_Apex.substr(0, aggr_prec_Peak_Apex.size() - 1);
-            aggr_prec_Fragment_Annotation = aggr_prec_Fragment_Annotation.substr(0, aggr_prec_Fragment_Annotation.size() - 1);
-          }
-
-          String full_peptide_name = "";
-          for (int loc = -1; loc <= (int)pep.sequence.size(); loc++)
-          {
-            if (loc > -1 && loc < (int)pep.sequence.size())
-            {
-              full_peptide_name += pep.sequence[loc];
-            }
-            // C-terminal and N-terminal modifications may be at positions -1 or pep.sequence
-            for (Size modloc = 0; modloc < pep.modifications.size(); modloc++)
-            {
-              if (pep.modifications[modloc].location == loc)
-              {
-                full_peptide_name += "(" + pep.modifications[modloc].unimod_id + ")";
-              }
-            }
-          }
-
-          // Compute peptide group label (use the provided label or use the
-          // transition group).
-          String group_label = pep.peptide_group_label;
-          if (group_label.empty()) group_label = id;
-          if (group_label == "light") group_label = id; // legacy fix since there are many TraMLs floating around which have "light" in there
-
-          String line = "";
-          line += id + "_run0"
-            + "\t" + group_label
-            + "\t" + "0"
-            + "\t" + input_filename_
-            + "\t" + (String)feature_it->getRT()
-            + "\t" + "f_" + feature_it->getUniqueId()  // TODO might not be unique!!!
-            + "\t" + pep.sequence
-            + "\t" + full_peptide_name
-            + "\t" + (String)pep.charge
-            + "\t" + (String)transition->precursor_mz
-            + "\t" + (String)feature_it->getIntensity()
-            + "\t" + pep.protein_refs[0] // TODO what about other proteins?
-            + "\t" + decoy
-            // Note: missing MetaValues will just produce a DataValue::EMPTY which lead to an empty column
-            + "\t" + (String)feature_it->getMetaValue("assay_rt")
-            + "\t" + (String)feature_it->getMetaValue("delta_rt")
-            + "\t" + (String)feature_it->getMetaValue("leftWidth")
-            + "\t" + (String)feature_it->getMetaValue("main_var_xx_swath_prelim_score")
-            + "\t" + (String)feature_it->getMetaValue("norm_RT")
-            + "\t" + (String)feature_it->getMetaValue("nr_peaks")
-            + "\t" + (String)feature_it->getMetaValue("peak_apices_sum")
-            + "\t" + (String)feature_it->getMetaValue("potentialOutlier")
-            + "\t" + (String)feature_it->getMetaValue("rightWidth")
-            + "\t" + (String)feature_it->getMetaValue("rt_score")
-            + "\t" + (String)feature_it->getMetaValue("sn_ratio")
-            + "\t" + (String)feature_it->getMetaValue("total_xic")
-            + "\t" + (String)feature_it->getMetaValue("var_bseries_score")
-            + "\t" + (String)feature_it->getMetaValue("var_dotprod_score")
-            + "\t" + (String)feature_it->getMetaValue("var_intensity_score")
-            + "\t" + (String)feature_it->getMetaValue("var_isotope_correlation_score")
-            + "\t" + (String)feature_it->getMetaValue("var_isotope_overlap_score")
-            + "\t" + (String)feature_it->getMetaValue("var_library_corr")
-            + "\t" + (String)feature_it->getMetaValue("var_library_dotprod")
-            + "\t" + (String)feature_it->getMetaValue("var_library_manhattan")
-            + "\t" + (String)feature_it->getMetaValue("var_library_rmsd")
-            + "\t" + (String)feature_it->getMetaValue("var_library_rootmeansquare")
-            + "\t" + (String)feature_it->getMetaValue("var_library_sangle")
-            + "\t" + (String)feature_it->getMetaValue("var_log_sn_score")
-            + "\t" + (String)feature_it->getMetaValue("var_manhatt_score")
-            + "\t" + (String)feature_it->getMetaValue("var_massdev_score")
-            + "\t" + (String)feature_it->getMetaValue("var_massdev_score_weighted")
-            + "\t" + (String)feature_it->getMetaValue("var_norm_rt_score")
-            + "\t" + (String)feature_it->getMetaValue("var_xcorr_coelution")
-            + "\t" + (String)feature_it->getMetaValue("var_xcorr_coelution_weighted")
-            + "\t" + (String)feature_it->getMetaValue("var_xcorr_shape")
-            + "\t" + (String)feature_it->getMetaValue("var_xcorr_shape_weighted")
-            + "\t" + (String)feature_it->getMetaValue("var_yseries_score")
-            + "\t" + (String)feature_it->getMetaValue("var_elution_model_fit_score");
-
-            if (use_ms1_traces_) 
-            {
-              line += "\t" + (String)feature_it->getMetaValue("var_ms1_ppm_diff")
-              + "\t" + (String)feature_it->getMetaValue("var_ms1_isotope_correlation")
-              + "\t" + (String)feature_it->getMetaValue("var_ms1_isotope_overlap")
-              + "\t" + (String)feature_it->getMetaValue("var_ms1_xcorr_coelution")
-              + "\t" + (String)feature_it->getMetaValue("var_ms1_xcorr_shape");
-            }
-
-            line += "\t" + (String)feature_it->getMetaValue("xx_lda_prelim_score")
-            + "\t" + (String)feature_it->getMetaValue("xx_swath_prelim_score");
-            if (use_ms1_traces_) 
-            {
-              line += "\t" + aggr_prec_Peak_Area + "\t" + aggr_prec_Peak_Apex + "\t" + aggr_prec_Fragment_Annotation;
-            }
-            line += "\t" + aggr_Peak_Area + "\t" + aggr_Peak_Apex + "\t" + aggr_Fragment_Annotation;
-            if (enable_uis_scoring_)
-            {
-              line += "\t" + (String)feature_it->getMetaValue("id_target_transition_names")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_log_intensity")
-              + "\t" + (String)feature_it->getMetaValue("id_target_num_transitions")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_xcorr_coelution")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_xcorr_shape")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_log_sn_score")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_massdev_score")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_isotope_correlation")
-              + "\t" + (String)feature_it->getMetaValue("id_target_ind_isotope_overlap")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_transition_names")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_log_intensity")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_num_transitions")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_xcorr_coelution")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_xcorr_shape")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_log_sn_score")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_massdev_score")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_isotope_correlation")
-              + "\t" + (String)feature_it->getMetaValue("id_decoy_ind_isotope_overlap");
-            }
-            line += "\n";          result += line;
-        } // end of iteration
-      return result;
-    }
-
-    void writeLines(std::vector<String> to_output)
-    {
-      for (Size i = 0; i < to_output.size(); i++) { ofs << to_output[i]; }
-    }
-
-  };
-
   /**
    * @brief Class to execute an OpenSwath Workflow
    *
@@ -461,8 +222,6 @@ namespace OpenMS
       trafo_inverse.invert();
 
       std::cout << "Will analyze " << transition_exp.transitions.size() << " transitions in total." << std::endl;
-      int progress = 0;
-      this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
       // (i) Obtain precursor chromatograms if precursor extraction is enabled
       std::map< std::string, OpenSwath::ChromatogramPtr > ms1_chromatograms;
@@ -504,129 +263,246 @@ namespace OpenMS
         }
       }
 
-      // (ii) Perform extraction and scoring of fragment ion chromatograms
-      // We set dynamic scheduling such that the maps are worked on in the order
-      // in which they were given to the program / acquired. This gives much
-      // better load balancing than static allocation.
+      // (ii) Select the transitions of each SWATH window and split the work
+      // into independent items (one batch of peptides from one window each).
+      // The items are listed in the order in which the maps were given to the
+      // program / acquired.
+      int nr_threads = 1;
 #ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic,1)
+      nr_threads = omp_get_max_threads();
 #endif
-      for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
+      std::vector<SwathWindowWork_> windows(swath_maps.size());
+      std::vector<Size> used_windows;
+      for (Size i = 0; i < swath_maps.size(); ++i)
+      {
+        if (swath_maps[i].ms1) continue; // skip MS1
+
+        OpenSwathHelper::selectSwathTransitions(transition_exp, windows[i].transitions,
+            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+        if (windows[i].transitions.getTransitions().empty()) continue; // skip if no transitions found
+        used_windows.push_back(i);
+      }
+
+      // If there are fewer windows than threads (e.g. without batching), the
+      // windows are split into more batches, so that every thread gets work
+      // items and the windows are still scored in parallel.
+      Size min_batches = 1;
+      if (!used_windows.empty())
       {
-        if (!swath_maps[i].ms1) // skip MS1
+        min_batches = (nr_threads + used_windows.size() - 1) / used_windows.size();
+      }
+      std::vector<std::pair<Size, Size> > work_items; // (window, batch)
+      for (Size w = 0; w < used_windows.size(); ++w)
+      {
+        const Size i = used_windows[w];
+        const Size nr_peptides = windows[i].transitions.getPeptides().size();
+        Size batch_size = nr_peptides;
+        if (batchSize > 0 && batchSize < (int)nr_peptides)
+        {
+          batch_size = batchSize;
+        }
+        if (nr_peptides < batch_size * min_batches)
         {
+          batch_size = std::max((Size)1, (nr_peptides + min_batches - 1) / min_batches);
+        }
+        windows[i].batch_size = (int)batch_size;
+
+        const Size nr_batches = (nr_peptides + batch_size - 1) / batch_size;
+        for (Size batch = 0; batch < nr_batches; ++batch)
+        {
+          work_items.push_back(std::make_pair(i, batch));
+        }
+        windows[i].remaining_batches = nr_batches;
+
+        std::cout << "Will analyze " << nr_peptides <<  " peptides and "
+          << windows[i].transitions.getTransitions().size() <<  " transitions "
+          "from SWATH " << i << " in batches of " << windows[i].batch_size << std::endl;
+      }
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
+      // (iii) Perform extraction and scoring of fragment ion chromatograms.
+      // Dynamic scheduling hands out the work items in order to whichever
+      // thread is idle, so that a window with many transitions is worked on
+      // by several threads at once (and no thread idles while a single large
+      // window is processed). If there are still fewer items than threads
+      // (very small assay libraries), only as many threads as items are
+      // started; with a single item, the extraction is parallelized over the
+      // spectra instead (see ChromatogramExtractorAlgorithm).
+      // The results of each item are kept until all previous items are done
+      // and are then written out, so that the output is in item order,
+      // independent of the number of threads.
+      int nr_item_threads = nr_threads;
+      if (work_items.size() < (Size)nr_item_threads)
+      {
+        nr_item_threads = std::max(1, (int)work_items.size());
+      }
+      std::vector<FeatureMap> item_features(work_items.size());
+      std::vector<std::vector<OpenMS::MSChromatogram<> > > item_chromatograms(work_items.size());
+      std::vector<bool> item_done(work_items.size(), false);
+      Size next_item_to_write = 0;
 
+#ifdef _OPENMP
+      // One lock per window protects its (lazily loaded) map and batch
+      // counter: loading a window into memory only blocks the threads that
+      // need the same window, other windows are loaded concurrently.
+      std::vector<omp_lock_t> window_locks(windows.size());
+      for (Size i = 0; i < window_locks.size(); ++i)
+      {
+        omp_init_lock(&window_locks[i]);
+      }
+#endif
+
+      int progress = 0;
+      this->startProgress(0, work_items.size(), "Extracting and scoring transitions");
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(nr_item_threads)
+#endif
+      for (SignedSize item = 0; item < boost::numeric_cast<SignedSize>(work_items.size()); ++item)
+      {
+        const Size i = work_items[item].first;
+        SwathWindowWork_& window = windows[i];
+
+        // Step 1: get a thread-safe handle on the map of this window (loading
+        // it into memory first if requested)
+        OpenSwath::SpectrumAccessPtr current_swath_map;
+#ifdef _OPENMP
+        omp_set_lock(&window_locks[i]);
+#endif
+        if (!window.map)
+        {
+          window.map = swath_maps[i].sptr;
           if (load_into_memory)
           {
             // This creates an InMemory object that keeps all data in memory
             // but provides the same access functionality to the raw data as
             // any object implementing ISpectrumAccess 
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
+            window.map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*window.map) );
             std::cout << " loading all data completely into memory !!! " << std::endl;
           }
+        }
+        current_swath_map = window.map->lightClone();
+#ifdef _OPENMP
+        omp_unset_lock(&window_locks[i]);
+#endif
 
-          // Step 1: select which transitions to extract (proceed in batches)
-          OpenSwath::LightTargetedExperiment transition_exp_used_all;
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-          if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
+        // Step 2.0: create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        selectPeptidesForBatch_(window.transitions, transition_exp_used, window.batch_size, work_items[item].second);
+
+        // Step 2.1: extract these transitions
+        ChromatogramExtractor extractor;
+        boost::shared_ptr<MSExperiment<Peak1D> > chrom_exp(new MSExperiment<Peak1D>);
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+        // Step 2.2: prepare the extraction coordinates & extract chromatograms
+        prepare_coordinates_wrap(chrom_list, coordinates, transition_exp_used, false, trafo_inverse, cp);
+        extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.extraction_function);
+
+        // Step 2.3: convert chromatograms back and write to output
+        std::vector< OpenMS::MSChromatogram<> > chromatograms;
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), chromatograms, false);
+        chrom_exp->setChromatograms(chromatograms);
+        OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(chrom_exp));
+
+        // Step 3: score these extracted transitions
+        FeatureMap featureFile;
+        scoreAllChromatograms(chromatogram_ptr, current_swath_map, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, 
+            ms1_chromatograms);
+
+        // Step 4: store the results of this item and write out the results
+        // of all items up to the first one that is not done yet (this needs
+        // to be done in a critical section since we only have one output file)
+#ifdef _OPENMP
+#pragma omp critical (featureFinder)
+#endif
+        {
+          if (store_features)
           {
-
-            int batch_size;
-            if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getPeptides().size())
+            item_features[item].swap(featureFile);
+          }
+          item_chromatograms[item].swap(chromatograms);
+          item_done[item] = true;
+          for (; next_item_to_write < work_items.size() && item_done[next_item_to_write]; ++next_item_to_write)
+          {
+            std::vector<OpenMS::MSChromatogram<> >& item_chroms = item_chromatograms[next_item_to_write];
+            for (Size chrom_idx = 0; chrom_idx < item_chroms.size(); ++chrom_idx)
             {
-              batch_size = transition_exp_used_all.getPeptides().size();
+              chromConsumer->consumeChromatogram(item_chroms[chrom_idx]);
             }
-            else
+            std::vector<OpenMS::MSChromatogram<> >().swap(item_chroms);
+            if (store_features)
             {
-              batch_size = batchSize;
+              appendFeatures_(item_features[next_item_to_write], out_featureFile);
+              FeatureMap().swap(item_features[next_item_to_write]);
             }
+          }
+        }
 
+        // Step 5: release the window once all of its batches are done
 #ifdef _OPENMP
-#pragma omp critical (featureFinder)
+        omp_set_lock(&window_locks[i]);
 #endif
-            {
-              std::cout << "Thread " <<
+        if (--window.remaining_batches == 0)
+        {
+          window.map.reset();
+          window.transitions = OpenSwath::LightTargetedExperiment();
+        }
 #ifdef _OPENMP
-              omp_get_thread_num() << " " <<
+        omp_unset_lock(&window_locks[i]);
 #endif
-              "will analyze " << transition_exp_used_all.getPeptides().size() <<  " peptides and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " in batches of " << batch_size << std::endl;
-            }
 
-            for (size_t pep_idx = 0; pep_idx <= (transition_exp_used_all.getPeptides().size() / batch_size); pep_idx++)
-            {
-              // Create the new, batch-size transition experiment
-              OpenSwath::LightTargetedExperiment transition_exp_used;
-              selectPeptidesForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
-
-              // Step 2.1: extract these transitions
-              ChromatogramExtractor extractor;
-              boost::shared_ptr<MSExperiment<Peak1D> > chrom_exp(new MSExperiment<Peak1D>);
-              std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-              std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
-
-              // Step 2.2: prepare the extraction coordinates & extract chromatograms
-              prepare_coordinates_wrap(chrom_list, coordinates, transition_exp_used, false, trafo_inverse, cp);
-              extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
-                  cp.ppm, cp.extraction_function);
-
-              // Step 2.3: convert chromatograms back and write to output
-              std::vector< OpenMS::MSChromatogram<> > chromatograms;
-              extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), chromatograms, false);
-              chrom_exp->setChromatograms(chromatograms);
-              OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(chrom_exp));
-
-              // Step 3: score these extracted transitions
-              FeatureMap featureFile;
-              scoreAllChromatograms(chromatogram_ptr, current_swath_map, transition_exp_used,
-                  feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, 
-                  ms1_chromatograms);
-
-              // Step 4: write all chromatograms and features out into an output object / file
-              // (this needs to be done in a critical section since we only have one
-              // output file and one output map).
 #ifdef _OPENMP
-#pragma omp critical (featureFinder)
+#pragma omp critical (progress)
 #endif
-              {
-                // write chromatograms to output if so desired
-                for (Size chrom_idx = 0; chrom_idx < chromatograms.size(); ++chrom_idx)
-                {
-                  chromConsumer->consumeChromatogram(chromatograms[chrom_idx]);
-                }
-
-                // write features to output if so desired
-                if (store_features)
-                {
-                  for (FeatureMap::iterator feature_it = featureFile.begin();
-                       feature_it != featureFile.end(); ++feature_it)
-                  {
-                    out_featureFile.push_back(*feature_it);
-                  }
-                  for (std::vector<ProteinIdentification>::iterator protid_it =
-                         featureFile.getProteinIdentifications().begin();
-                       protid_it != featureFile.getProteinIdentifications().end();
-                       ++protid_it)
-                  {
-                    out_featureFile.getProteinIdentifications().push_back(*protid_it);
-                  }
-                  this->setProgress(progress++);
-                }
-              }
-            }
+        this->setProgress(++progress);
+      }
 
-          } // continue 2 (no continue due to OpenMP)
-        } // continue 1 (no continue due to OpenMP)
+#ifdef _OPENMP
+      for (Size i = 0; i < window_locks.size(); ++i)
+      {
+        omp_destroy_lock(&window_locks[i]);
       }
+#endif
+
       this->endProgress();
     }
 
   private:
 
+    /// The transitions and (lazily loaded) map of one SWATH window, shared by all of its batches
+    struct SwathWindowWork_
+    {
+      SwathWindowWork_() :
+        batch_size(1),
+        remaining_batches(0)
+      {
+      }
+
+      OpenSwath::LightTargetedExperiment transitions;
+      OpenSwath::SpectrumAccessPtr map;
+      int batch_size;
+      Size remaining_batches;
+    };
+
+    /// Appends the features and protein identifications of @p source to @p target
+    void appendFeatures_(const FeatureMap& source, FeatureMap& target) const
+    {
+      for (FeatureMap::const_iterator feature_it = source.begin();
+           feature_it != source.end(); ++feature_it)
+      {
+        target.push_back(*feature_it);
+      }
+      for (std::vector<ProteinIdentification>::const_iterator protid_it =
+             source.getProteinIdentifications().begin();
+           protid_it != source.getProteinIdentifications().end();
+           ++protid_it)
+      {
+        target.getProteinIdentifications().push_back(*protid_it);
+      }
+    }
+
     /** @brief Select which peptides to analyze in the next batch (and copy to output)
      *
      * This function will select which peptides to analyze in the next batch j
@@ -953,7 +829,7 @@ namespace OpenMS
         const Param& feature_finder_param,
         TransformationDescription trafo, const double rt_extraction_window,
         FeatureMap& output, OpenSwathTSVWriter & tsv_writer, 
-        std::map< std::string, OpenSwath::ChromatogramPtr > & ms1_chromatograms
+        const std::map< std::string, OpenSwath::ChromatogramPtr > & ms1_chromatograms
         )
     {
       typedef OpenSwath::LightTransition TransitionType;
@@ -1002,7 +878,6 @@ namespace OpenMS
         assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
       }
 
-      std::vector<String> to_output;
       // Iterating over all the assays
       for (AssayMapT::iterator assay_it = assay_map.begin(); assay_it != assay_map.end(); ++assay_it)
       {
@@ -1048,9 +923,12 @@ namespace OpenMS
         if (tsv_writer.isActive()) { output.clear(); }
 
         // Set the MS1 chromatogram if available
-        if (!ms1_chromatograms.empty())
+        // (the map is shared between threads and must not be modified here)
+        std::map< std::string, OpenSwath::ChromatogramPtr >::const_iterator ms1_chrom_it =
+          ms1_chromatograms.find(transition_group.getTransitionGroupID());
+        if (ms1_chrom_it != ms1_chromatograms.end())
         {
-          OpenSwath::ChromatogramPtr cptr = ms1_chromatograms[ transition_group.getTransitionGroupID() ];
+          OpenSwath::ChromatogramPtr cptr = ms1_chrom_it->second;
           MSChromatogram<ChromatogramPeak> chromatogram_old;
           OpenSwathDataAccessHelper::convertToOpenMSChromatogram(chromatogram_old, cptr);
           RichPeakChromatogram chromatogram;
@@ -1064,23 +942,14 @@ namespace OpenMS
         trgroup_picker.pickTransitionGroup(transition_group);
         featureFinder.scorePeakgroups(transition_group, trafo, swath_map, output);
 
-        // Add to the output tsv if given
+        // Add to the output tsv if given (the line is handed over to the
+        // writer thread right away, so the features of this transition group
+        // can be freed)
         if (tsv_writer.isActive())
         {
           const OpenSwath::LightPeptide pep = transition_exp.getPeptides()[ assay_peptide_map[id] ];
           const TransitionType* transition = assay_it->second[0];
-          to_output.push_back(tsv_writer.prepareLine(pep, transition, output, id));
-        }
-      }
-
-      // Only write at the very end since this is a step needs a barrier
-      if (tsv_writer.isActive())
-      {
-#ifdef _OPENMP
-#pragma omp critical (scoreAll)
-#endif
-        {
-          tsv_writer.writeLines(to_output);
+          tsv_writer.writeLine(tsv_writer.prepareLine(pep, transition, output, id));
         }
       }
     }
@@ -1277,6 +1146,11 @@ namespace OpenMS
   re-implementation of mProphet) software tool, see Reiter et al (2011, Nature
   Methods).
 
+  The same table can also be written in a binary, column-oriented format
+  (-out_columnar, see ColumnarTableFile), in which scores are stored as
+  numbers. Both table outputs are written while the data is scored, so only a
+  bounded amount of output is held in memory.
+
   In addition, the extracted chromatograms can be written out using the
   -out_chrom parameter.
 
@@ -1532,6 +1406,7 @@ protected:
     setValidFormats_("out_features", ListUtils::create<String>("featureXML"));
 
     registerStringOption_("out_tsv", "<file>", "", "TSV output file (mProphet compatible)", false);
+    registerStringOption_("out_columnar", "<file>", "", "Binary columnar table output file (same columns as -out_tsv, can be combined with it)", false, true);
 
     registerOutputFile_("out_chrom", "<file>", "", "Also output all computed chromatograms (chrom.mzML) output", false, true);
     setValidFormats_("out_chrom", ListUtils::create<String>("mzML"));
@@ -1762,6 +1637,7 @@ protected:
 
     String out = getStringOption_("out_features");
     String out_tsv = getStringOption_("out_tsv");
+    String out_columnar = getStringOption_("out_columnar");
 
     String irt_tr_file = getStringOption_("tr_irt");
     String trafo_in = getStringOption_("rt_norm");
@@ -1806,10 +1682,11 @@ protected:
       std::cout << "Since neither rt_norm nor tr_irt is set, OpenSWATH will " <<
         "not use RT-transformation (rather a null transformation will be applied)" << std::endl;
     }
-    if ( (out.empty() && out_tsv.empty()) || (!out.empty() && !out_tsv.empty()) )
+    bool table_output = !out_tsv.empty() || !out_columnar.empty();
+    if ( (out.empty() && !table_output) || (!out.empty() && table_output) )
     {
       throw Exception::IllegalArgument(__FILE__, __LINE__, __PRETTY_FUNCTION__,
-          "Either out_features or out_tsv needs to be set (but not both)");
+          "Either out_features or out_tsv/out_columnar needs to be set (but not both)");
     }
 
     // Check swath window input
@@ -1969,12 +1846,13 @@ protected:
     ///////////////////////////////////
     FeatureMap out_featureFile;
 
-    OpenSwathTSVWriter tsvwriter(out_tsv, file_list[0], use_ms1_traces, enable_uis_scoring);
+    OpenSwathTSVWriter tsvwriter(out_tsv, file_list[0], use_ms1_traces, enable_uis_scoring, 16 * 1024 * 1024, out_columnar);
     OpenSwathWorkflow wf(use_ms1_traces);
     wf.setLogType(log_type_);
 
     wf.performExtraction(swath_maps, trafo_rtnorm, cp, feature_finder_param, transition_exp,
         out_featureFile, !out.empty(), tsvwriter, chromConsumer, batchSize, load_into_memory);
+    tsvwriter.close();
     if (!out.empty())
     {
       addDataProcessing_(out_featureFile, getProcessingInfo_(DataProcessing::QUANTITATION));
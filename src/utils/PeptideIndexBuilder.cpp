@@ -0,0 +1,169 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2015.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: Timo Sachsenberg $
+// $Authors: Timo Sachsenberg $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/APPLICATIONS/TOPPBase.h>
+#include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/PeptideIndexFile.h>
+#include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
+#include <OpenMS/CHEMISTRY/EnzymesDB.h>
+
+using namespace OpenMS;
+using namespace std;
+
+//-------------------------------------------------------------
+//Doxygen docu
+//-------------------------------------------------------------
+
+/**
+    @page UTILS_PeptideIndexBuilder PeptideIndexBuilder
+
+    @brief Digests a protein database in-silico and stores the peptides in a peptide index.
+<CENTER>
+    <table>
+        <tr>
+            <td ALIGN = "center" BGCOLOR="#EBEBEB"> pot. predecessor tools </td>
+            <td VALIGN="middle" ROWSPAN=2> \f$ \longrightarrow \f$ PeptideIndexBuilder \f$ \longrightarrow \f$</td>
+            <td ALIGN = "center" BGCOLOR="#EBEBEB"> pot. successor tools </td>
+        </tr>
+        <tr>
+            <td VALIGN="middle" ALIGN = "center" ROWSPAN=1> @ref UTILS_DecoyDatabase </td>
+            <td VALIGN="middle" ALIGN = "center" ROWSPAN=1> SimpleSearchEngine @n @ref TOPP_PeptideIndexer </td>
+        </tr>
+    </table>
+</CENTER>
+
+    Search tools digest the protein database on every run. This tool performs
+    the digestion once and stores the proteins, all distinct peptides (sorted
+    by mass) and the proteins they occur in as a peptide index (.pepidx, see
+    PeptideIndexFile). The index can be used instead of the FASTA file by
+    SimpleSearchEngine (which then skips the digestion) and by
+    @ref TOPP_PeptideIndexer (which then skips parsing the FASTA file).
+
+    The digestion settings are stored in the index. SimpleSearchEngine
+    refuses an index whose settings do not match its own, so they have to be
+    chosen accordingly.
+
+    Optionally (@p fragment_bin_size), a fragment ion index is added that
+    lists, for each m/z bin, the peptides with a singly charged b- or y-ion in
+    that bin.
+
+    <B>The command line parameters of this tool are:</B>
+    @verbinclude UTILS_PeptideIndexBuilder.cli
+    <B>INI file documentation of this tool:</B>
+    @htmlinclude UTILS_PeptideIndexBuilder.html
+*/
+
+// We do not want this class to show up in the docu:
+/// @cond TOPPCLASSES
+
+class TOPPPeptideIndexBuilder :
+  public TOPPBase
+{
+public:
+  TOPPPeptideIndexBuilder() :
+    TOPPBase("PeptideIndexBuilder", "Digests a protein database in-silico and stores the peptides in a peptide index.", false)
+  {
+  }
+
+protected:
+  void registerOptionsAndFlags_()
+  {
+    registerInputFile_("in", "<file>", "", "Input sequence database in FASTA format");
+    setValidFormats_("in", ListUtils::create<String>("fasta"));
+    registerOutputFile_("out", "<file>", "", "Output peptide index");
+    setValidFormats_("out", ListUtils::create<String>("pepidx"));
+
+    vector<String> all_enzymes;
+    EnzymesDB::getInstance()->getAllNames(all_enzymes);
+    registerStringOption_("enzyme", "<string>", "Trypsin", "The enzyme used for peptide digestion.", false);
+    setValidStrings_("enzyme", all_enzymes);
+    registerIntOption_("missed_cleavages", "<number>", 1, "Number of missed cleavages.", false);
+    setMinInt_("missed_cleavages", 0);
+    registerIntOption_("min_length", "<number>", 7, "Minimum length of peptides.", false);
+    setMinInt_("min_length", 1);
+    registerIntOption_("max_length", "<number>", 40, "Maximum length of peptides (0 = disabled).", false);
+    setMinInt_("max_length", 0);
+
+    registerDoubleOption_("fragment_bin_size", "<Th>", 0.0, "Bin width of the fragment ion index (0 = no fragment ion index).", false, true);
+    setMinFloat_("fragment_bin_size", 0.0);
+  }
+
+  ExitCodes main_(int, const char**)
+  {
+    //-------------------------------------------------------------
+    // parsing parameters
+    //-------------------------------------------------------------
+    String in = getStringOption_("in");
+    String out = getStringOption_("out");
+    Size min_length = getIntOption_("min_length");
+    Size max_length = getIntOption_("max_length");
+    double fragment_bin_size = getDoubleOption_("fragment_bin_size");
+
+    EnzymaticDigestion digestor;
+    digestor.setEnzyme(getStringOption_("enzyme"));
+    digestor.setMissedCleavages(getIntOption_("missed_cleavages"));
+
+    //-------------------------------------------------------------
+    // reading input
+    //-------------------------------------------------------------
+    vector<FASTAFile::FASTAEntry> proteins;
+    FASTAFile().load(in, proteins);
+
+    //-------------------------------------------------------------
+    // calculations
+    //-------------------------------------------------------------
+    PeptideIndexFile index;
+    index.setLogType(log_type_);
+    index.build(proteins, digestor, min_length, max_length, fragment_bin_size);
+
+    LOG_INFO << "Proteins: " << index.getProteins().size() << "\n"
+             << "Distinct peptides: " << index.getPeptideCount() << endl;
+
+    //-------------------------------------------------------------
+    // writing output
+    //-------------------------------------------------------------
+    index.store(out);
+
+    return EXECUTION_OK;
+  }
+
+};
+
+int main(int argc, const char** argv)
+{
+  TOPPPeptideIndexBuilder tool;
+  return tool.main(argc, argv);
+}
+
+/// @endcond
@@ -42,6 +42,8 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
+#include <OpenMS/FORMAT/FileHandler.h>
+#include <OpenMS/FORMAT/PeptideIndexFile.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
 #include <OpenMS/CHEMISTRY/EnzymesDB.h>
 
@@ -66,6 +68,8 @@
 
 #include <map>
 #include <algorithm>
+#include <deque>
+#include <limits>
 
 #ifdef _OPENMP
   #include <omp.h>
@@ -113,8 +117,8 @@ class SimpleSearchEngine :
       registerInputFile_("in", "<file>", "", "input file ");
       setValidFormats_("in", ListUtils::create<String>("mzML"));
 
-      registerInputFile_("database", "<file>", "", "input file ");
-      setValidFormats_("database", ListUtils::create<String>("fasta"));
+      registerInputFile_("database", "<file>", "", "input file (FASTA file or peptide index created by PeptideIndexBuilder)");
+      setValidFormats_("database", ListUtils::create<String>("fasta,pepidx"));
 
       registerOutputFile_("out", "<file>", "", "output file ");
       setValidFormats_("out", ListUtils::create<String>("idXML"));
@@ -327,27 +331,81 @@ class SimpleSearchEngine :
       }
     }
 
-    double computeHyperScore(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const MSSpectrum<Peak1D>& exp_spectrum, const MSSpectrum<RichPeak1D>& theo_spectrum)
+    /// Theoretical spectrum of a candidate peptide, prepared for scoring
+    struct TheoreticalSpectrum
+    {
+      /// m/z values of the b and y ions (sorted)
+      vector<double> mz;
+      /// is the ion at the same position a y ion?
+      vector<bool> is_y;
+    };
+
+    void getTheoreticalSpectrum_(const TheoreticalSpectrumGenerator& spectrum_generator, const AASequence& candidate, TheoreticalSpectrum& theo_spectrum) const
+    {
+      //create theoretical spectrum
+      MSSpectrum<RichPeak1D> spectrum;
+
+      //add peaks for b and y ions with charge 1
+      spectrum_generator.getSpectrum(spectrum, candidate, 1);
+
+      //sort by mz
+      spectrum.sortByPosition();
+
+      theo_spectrum.mz.resize(spectrum.size());
+      theo_spectrum.is_y.resize(spectrum.size());
+      for (Size i = 0; i < spectrum.size(); ++i)
+      {
+        theo_spectrum.mz[i] = spectrum[i].getMZ();
+        theo_spectrum.is_y[i] = (spectrum[i].getMetaValue("IonName").toString()[0] == 'y');
+      }
+    }
+
+    // theoretical and experimental spectrum must be sorted by m/z
+    double computeHyperScore(double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm, const MSSpectrum<Peak1D>& exp_spectrum, const TheoreticalSpectrum& theo_spectrum)
     {
       double dot_product = 0.0;
       UInt y_ion_count = 0;
       UInt b_ion_count = 0;
 
-      for (MSSpectrum<RichPeak1D>::ConstIterator theo_peak_it = theo_spectrum.begin(); theo_peak_it != theo_spectrum.end(); ++theo_peak_it)
+      if (exp_spectrum.empty())
+      {
+        return 0;
+      }
+
+      // first experimental peak not below the current theoretical peak - as
+      // both spectra are sorted, this only moves forward
+      Size next = 0;
+      for (Size theo_index = 0; theo_index < theo_spectrum.mz.size(); ++theo_index)
       {
-        const double& theo_mz = theo_peak_it->getMZ();
+        const double& theo_mz = theo_spectrum.mz[theo_index];
 
         double max_dist_dalton = fragment_mass_tolerance_unit_ppm ? theo_mz * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance;
 
-        // iterate over peaks in experimental spectrum in given fragment tolerance around theoretical peak
-        Size index = exp_spectrum.findNearest(theo_mz);
+        // nearest experimental peak (same choice as MSSpectrum::findNearest)
+        while ((next < exp_spectrum.size()) && (exp_spectrum[next].getMZ() < theo_mz))
+        {
+          ++next;
+        }
+        Size index;
+        if (next == 0)
+        {
+          index = 0;
+        }
+        else if (next == exp_spectrum.size())
+        {
+          index = next - 1;
+        }
+        else
+        {
+          index = (std::fabs(exp_spectrum[next].getMZ() - theo_mz) < std::fabs(exp_spectrum[next - 1].getMZ() - theo_mz)) ? next : next - 1;
+        }
         double exp_mz = exp_spectrum[index].getMZ();
 
         // found peak match
         if (std::abs(theo_mz - exp_mz) < max_dist_dalton)
         {
           dot_product += exp_spectrum[index].getIntensity();
-          if (theo_peak_it->getMetaValue("IonName").toString()[0] == 'y')
+          if (theo_spectrum.is_y[theo_index])
           {
             ++y_ion_count;
           }
@@ -371,6 +429,107 @@ class SimpleSearchEngine :
       }
     }
 
+    /// does a peptide of mass @p peptide_mass match a precursor of mass @p precursor_mass?
+    static bool precursorMatches_(double peptide_mass, double precursor_mass, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm)
+    {
+      double half_window = precursor_mass_tolerance_unit_ppm ? 0.5 * peptide_mass * precursor_mass_tolerance * 1e-6 : 0.5 * precursor_mass_tolerance;
+      return (precursor_mass >= peptide_mass - half_window) && (precursor_mass <= peptide_mass + half_window);
+    }
+
+    /**
+      Bounds of the mass change of a peptide by the fixed and variable
+      modifications (as applied by ModifiedPeptideGenerator: each residue
+      carries at most one modification of its origin, and there are at most
+      @p max_variable_mods variable modifications).
+    */
+    class ModificationShiftBounds
+    {
+public:
+      ModificationShiftBounds(const vector<ResidueModification>& fixed_mods, const vector<ResidueModification>& var_mods, Size max_variable_mods) :
+        fixed_min_(256, 0.0),
+        fixed_max_(256, 0.0),
+        var_min_(0.0),
+        var_max_(0.0),
+        has_fixed_(256, false)
+      {
+        for (Size i = 0; i < fixed_mods.size(); ++i)
+        {
+          if (fixed_mods[i].getOrigin().size() != 1) continue;
+          unsigned char origin = fixed_mods[i].getOrigin()[0];
+          fixed_min_[origin] = std::min(fixed_min_[origin], fixed_mods[i].getDiffMonoMass());
+          fixed_max_[origin] = std::max(fixed_max_[origin], fixed_mods[i].getDiffMonoMass());
+          has_fixed_[origin] = true;
+        }
+        for (Size i = 0; i < var_mods.size(); ++i)
+        {
+          var_min_ = std::min(var_min_, max_variable_mods * var_mods[i].getDiffMonoMass());
+          var_max_ = std::max(var_max_, max_variable_mods * var_mods[i].getDiffMonoMass());
+        }
+        // slack for masses of modified residues that differ slightly from origin + difference
+        slack_per_mod_ = 0.01;
+        var_slack_ = var_mods.empty() ? 0.0 : max_variable_mods * slack_per_mod_;
+      }
+
+      /// bounds for all peptides of at most @p max_length residues (returns false if there are none, i.e. @p max_length is 0 and there are fixed modifications)
+      bool getBounds(Size max_length, double& min_shift, double& max_shift) const
+      {
+        min_shift = var_min_ - var_slack_;
+        max_shift = var_max_ + var_slack_;
+        double fixed_min = 0.0, fixed_max = 0.0;
+        bool any_fixed = false;
+        for (Size c = 0; c < has_fixed_.size(); ++c)
+        {
+          if (!has_fixed_[c]) continue;
+          any_fixed = true;
+          fixed_min = std::min(fixed_min, fixed_min_[c] - slack_per_mod_);
+          fixed_max = std::max(fixed_max, fixed_max_[c] + slack_per_mod_);
+        }
+        if (!any_fixed) return true;
+        if (max_length == 0) return false;
+        min_shift += max_length * fixed_min;
+        max_shift += max_length * fixed_max;
+        return true;
+      }
+
+      /// the mass of any modified variant of @p peptide is in [unmodified mass + @p min_shift, unmodified mass + @p max_shift]
+      void getBounds(const StringView& peptide, double& min_shift, double& max_shift) const
+      {
+        min_shift = var_min_ - var_slack_;
+        max_shift = var_max_ + var_slack_;
+        const char* sequence = peptide.data();
+        for (Size i = 0; i < peptide.size(); ++i)
+        {
+          unsigned char residue = sequence[i];
+          if (has_fixed_[residue])
+          {
+            min_shift += fixed_min_[residue] - slack_per_mod_;
+            max_shift += fixed_max_[residue] + slack_per_mod_;
+          }
+        }
+      }
+
+protected:
+      vector<double> fixed_min_;
+      vector<double> fixed_max_;
+      double var_min_;
+      double var_max_;
+      vector<bool> has_fixed_;
+      double slack_per_mod_;
+      double var_slack_;
+    };
+
+    /// orders hits by decreasing score (for a heap of the best hits, with the worst hit on top)
+    static bool hasHigherScore_(const PeptideHit& a, const PeptideHit& b)
+    {
+      return a.getScore() > b.getScore();
+    }
+
+    /// equality of peptide sequences for removing duplicates from a sorted list
+    static bool sameSequence_(const StringView& a, const StringView& b)
+    {
+      return !(a < b) && !(b < a);
+    }
+
     void preprocessSpectra_(PeakMap& exp, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm)
     {
       // filter MS2 map
@@ -501,8 +660,8 @@ class SimpleSearchEngine :
       preprocessSpectra_(spectra, fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm);
       progresslogger.endProgress();
 
-      // build multimap of precursor mass to scan index
-      multimap<double, Size> multimap_mass_2_scan_index;
+      // precursor masses of the spectra to search, sorted by mass: (mass, scan index)
+      vector<pair<double, Size> > precursor_masses;
       for (PeakMap::ConstIterator s_it = spectra.begin(); s_it != spectra.end(); ++s_it)
       {
         int scan_index = s_it - spectra.begin();
@@ -520,143 +679,271 @@ class SimpleSearchEngine :
 
           double precursor_mz = precursor[0].getMZ();
           double precursor_mass = (double) precursor_charge * precursor_mz - (double) precursor_charge * Constants::PROTON_MASS_U;
-          multimap_mass_2_scan_index.insert(make_pair(precursor_mass, scan_index));
+          precursor_masses.push_back(make_pair(precursor_mass, scan_index));
         }
       }
+      sort(precursor_masses.begin(), precursor_masses.end());
 
       // create spectrum generator
       TheoreticalSpectrumGenerator spectrum_generator;
 
-      vector<vector<PeptideHit> > peptide_hits(spectra.size(), vector<PeptideHit>());
-
-      progresslogger.startProgress(0, 1, "Load database from FASTA file...");
-      FASTAFile fastaFile;
-      vector<FASTAFile::FASTAEntry> fasta_db;
-      fastaFile.load(in_db, fasta_db);
-      progresslogger.endProgress();
-
       const Size missed_cleavages = getIntOption_("peptide:missed_cleavages");
       EnzymaticDigestion digestor;
       digestor.setEnzyme(getStringOption_("enzyme"));
       digestor.setMissedCleavages(missed_cleavages);
 
-      progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Scoring peptide models against spectra...");
-
-      // lookup for processed peptides. must be defined outside of omp section and synchronized
-      set<StringView> processed_petides;
-
       // set minimum / maximum size of peptide after digestion
       Size min_peptide_length = getIntOption_("peptide:min_size");
       Size max_peptide_length = getIntOption_("peptide:max_size");
 
+      // peptides of the database (views on the protein sequences, which need to stay alive)
+      vector<FASTAFile::FASTAEntry> fasta_db;
+      PeptideIndexFile peptide_db;
+      vector<StringView> peptides;
+
+      if (FileHandler::getTypeByFileName(in_db) == FileTypes::PEPIDX)
+      {
+        // the database has already been digested (see PeptideIndexBuilder)
+        progresslogger.startProgress(0, 1, "Load database from peptide index...");
+        peptide_db.load(in_db);
+        progresslogger.endProgress();
+
+        if (peptide_db.getEnzymeName() != digestor.getEnzymeName() ||
+            peptide_db.getMissedCleavages() != missed_cleavages ||
+            peptide_db.getMinLength() != min_peptide_length ||
+            peptide_db.getMaxLength() != max_peptide_length)
+        {
+          LOG_ERROR << "Error: The peptide index was built with different digestion settings (enzyme: " << peptide_db.getEnzymeName()
+                    << ", missed cleavages: " << peptide_db.getMissedCleavages()
+                    << ", peptide size: " << peptide_db.getMinLength() << "-" << peptide_db.getMaxLength()
+                    << "). Adapt the parameters or re-create the index." << endl;
+          return ILLEGAL_PARAMETERS;
+        }
+
+        // skip peptides that cannot match any precursor with any combination
+        // of modifications, without generating their modified variants:
+        // peptides with an unknown mass (zero, at the start of the mass order)
+        // are always kept, the others are restricted to the mass range of the
+        // precursors (if the peptide length is bounded) and then checked
+        // individually
+        ModificationShiftBounds shift_bounds(fixedMods, varMods, max_variable_mods_per_peptide);
+        Size first_peptide = 0;
+        for (; first_peptide < peptide_db.getPeptideCount() && peptide_db.getPeptideMass(first_peptide) <= 0.0; ++first_peptide)
+        {
+          peptides.push_back(peptide_db.getPeptideSequence(first_peptide));
+        }
+        Size last_peptide = peptide_db.getPeptideCount();
+        double min_shift_all, max_shift_all;
+        if (!precursor_masses.empty() && shift_bounds.getBounds(peptide_db.getMaxLength(), min_shift_all, max_shift_all))
+        {
+          const double min_mass = precursor_masses.front().first - max_shift_all;
+          const double max_mass = precursor_masses.back().first - min_shift_all;
+          const double tolerance = precursor_mass_tolerance_unit_ppm ? max_mass * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
+          std::pair<Size, Size> range = peptide_db.getPeptidesInMassRange(min_mass - tolerance, max_mass + tolerance);
+          first_peptide = std::max(first_peptide, range.first);
+          last_peptide = range.second;
+        }
+        for (Size i = first_peptide; i < last_peptide; ++i)
+        {
+          const double mass = peptide_db.getPeptideMass(i);
+          StringView sequence = peptide_db.getPeptideSequence(i);
+          double min_shift, max_shift;
+          shift_bounds.getBounds(sequence, min_shift, max_shift);
+          const double max_mass = mass + max_shift;
+          const double half_window = precursor_mass_tolerance_unit_ppm ? 0.5 * max_mass * precursor_mass_tolerance * 1e-6 : 0.5 * precursor_mass_tolerance;
+          vector<pair<double, Size> >::const_iterator precursor_it = lower_bound(precursor_masses.begin(), precursor_masses.end(), make_pair(mass + min_shift - half_window, Size(0)));
+          if (precursor_it != precursor_masses.end() && precursor_it->first <= max_mass + half_window)
+          {
+            peptides.push_back(sequence);
+          }
+        }
+      }
+      else
+      {
+        progresslogger.startProgress(0, 1, "Load database from FASTA file...");
+        FASTAFile fastaFile;
+        fastaFile.load(in_db, fasta_db);
+        progresslogger.endProgress();
+
+        progresslogger.startProgress(0, (Size)(fasta_db.end() - fasta_db.begin()), "Digesting proteins...");
+        vector<vector<StringView> > digests(fasta_db.size());
 #ifdef _OPENMP
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+        for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+        {
+          IF_MASTERTHREAD
+          {
+            progresslogger.setProgress((SignedSize)fasta_index * NUMBER_OF_THREADS);
+          }
+
+          digestor.digestUnmodifiedString(fasta_db[fasta_index].sequence, digests[fasta_index], min_peptide_length, max_peptide_length);
+        }
+        progresslogger.endProgress();
+
+        for (Size fasta_index = 0; fasta_index < digests.size(); ++fasta_index)
+        {
+          peptides.insert(peptides.end(), digests[fasta_index].begin(), digests[fasta_index].end());
+          vector<StringView>().swap(digests[fasta_index]);
+        }
+      }
+
+      //-------------------------------------------------------------
+      // peptide index: all candidates that match a precursor, sorted by mass
+      //-------------------------------------------------------------
+      // peptides shared by several proteins (and all their modified variants) are scored only once.
+      // Sorting by sequence keeps the candidates (and thus the results) identical to those of a
+      // FASTA database (the mass order of a peptide index was only used to skip peptides above).
+      sort(peptides.begin(), peptides.end());
+      peptides.erase(unique(peptides.begin(), peptides.end(), sameSequence_), peptides.end());
+
+      progresslogger.startProgress(0, peptides.size(), "Generating modified peptides...");
+      // candidates of every peptide (kept separately, so the index does not depend on the thread schedule)
+      vector<vector<AASequence> > peptide_candidates(peptides.size());
+      vector<vector<double> > peptide_candidate_masses(peptides.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1000)
 #endif
-      for (SignedSize fasta_index = 0; fasta_index < (SignedSize)fasta_db.size(); ++fasta_index)
+      for (SignedSize peptide_index = 0; peptide_index < (SignedSize)peptides.size(); ++peptide_index)
       {
         IF_MASTERTHREAD
         {
-          progresslogger.setProgress((SignedSize)fasta_index * NUMBER_OF_THREADS);
+          progresslogger.setProgress((SignedSize)peptide_index * NUMBER_OF_THREADS);
         }
 
-        vector<StringView> current_digest;
-        digestor.digestUnmodifiedString(fasta_db[fasta_index].sequence, current_digest, min_peptide_length, max_peptide_length);
+        vector<AASequence> all_modified_peptides;
 
-        for (vector<StringView>::iterator cit = current_digest.begin(); cit != current_digest.end(); ++cit)
-        {
-          bool already_processed = false;
+        // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
 #ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
+#pragma omp critical (residuedb_access)
 #endif
+        {
+          AASequence aas = AASequence::fromString(peptides[peptide_index].getString());
+          ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), aas);
+          ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
+        }
+
+        for (vector<AASequence>::const_iterator mod_it = all_modified_peptides.begin(); mod_it != all_modified_peptides.end(); ++mod_it)
+        {
+          double current_peptide_mass = mod_it->getMonoWeight();
+
+          // keep only candidates that match the precursor of at least one spectrum
+          vector<pair<double, Size> >::const_iterator precursor_it = lower_bound(precursor_masses.begin(), precursor_masses.end(), make_pair(current_peptide_mass - (precursor_mass_tolerance_unit_ppm ? current_peptide_mass * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance), Size(0)));
+          for (; (precursor_it != precursor_masses.end()) && (precursor_it->first <= current_peptide_mass + (precursor_mass_tolerance_unit_ppm ? current_peptide_mass * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance)); ++precursor_it)
           {
-            if (processed_petides.find(*cit) != processed_petides.end())
+            if (precursorMatches_(current_peptide_mass, precursor_it->first, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm))
             {
-              // peptide (and all modified variants) already processed so skip it
-              already_processed = true;
+              peptide_candidates[peptide_index].push_back(*mod_it);
+              peptide_candidate_masses[peptide_index].push_back(current_peptide_mass);
+              break;
             }
           }
+        }
+      }
+      progresslogger.endProgress();
 
-          if (already_processed)
-          {
-            continue;
-          }
+      vector<AASequence> candidates;
+      vector<pair<double, Size> > candidate_masses; // (mass, index in "candidates"), sorted by mass
+      for (Size peptide_index = 0; peptide_index < peptides.size(); ++peptide_index)
+      {
+        for (Size i = 0; i < peptide_candidates[peptide_index].size(); ++i)
+        {
+          candidate_masses.push_back(make_pair(peptide_candidate_masses[peptide_index][i], candidates.size()));
+          candidates.push_back(peptide_candidates[peptide_index][i]);
+        }
+      }
+      vector<vector<AASequence> >().swap(peptide_candidates);
+      vector<vector<double> >().swap(peptide_candidate_masses);
+      sort(candidate_masses.begin(), candidate_masses.end());
+
+      //-------------------------------------------------------------
+      // scoring: stream the spectra (by increasing precursor mass) through the index
+      //-------------------------------------------------------------
+      // best hits of every spectrum; each spectrum is processed by one thread only
+      vector<vector<PeptideHit> > peptide_hits(spectra.size(), vector<PeptideHit>());
+      // keep at least one hit, so that spectra with hits still get an (empty)
+      // identification if no hits are reported (the list is cut in postProcessHits_)
+      const Size kept_hits = (report_top_hits == 0) ? 1 : (Size)report_top_hits;
 
+      progresslogger.startProgress(0, precursor_masses.size(), "Scoring peptide models against spectra...");
 #ifdef _OPENMP
-#pragma omp critical (processed_peptides_access)
+#pragma omp parallel
 #endif
-          {
-            processed_petides.insert(*cit);
-          }
-
-          vector<AASequence> all_modified_peptides;
+      {
+        // theoretical spectra of the candidates in the current precursor mass
+        // window: consecutive spectra of a thread have increasing precursor
+        // masses, so the window only moves forward
+        deque<TheoreticalSpectrum> theo_spectra;
+        Size theo_begin = 0; // position in "candidate_masses" of the first element of "theo_spectra"
 
-          // this critial section is because ResidueDB is not thread safe and new residues are created based on the PTMs
 #ifdef _OPENMP
-#pragma omp critical (residuedb_access)
+#pragma omp for schedule(dynamic, 100)
 #endif
+        for (SignedSize precursor_index = 0; precursor_index < (SignedSize)precursor_masses.size(); ++precursor_index)
+        {
+          IF_MASTERTHREAD
           {
-            AASequence aas = AASequence::fromString(cit->getString());
-            ModifiedPeptideGenerator::applyFixedModifications(fixedMods.begin(), fixedMods.end(), aas);
-            ModifiedPeptideGenerator::applyVariableModifications(varMods.begin(), varMods.end(), aas, max_variable_mods_per_peptide, all_modified_peptides);
+            progresslogger.setProgress((SignedSize)precursor_index * NUMBER_OF_THREADS);
           }
 
-          for (SignedSize mod_pep_idx = 0; mod_pep_idx < (SignedSize)all_modified_peptides.size(); ++mod_pep_idx)
-          {
-            const AASequence& candidate = all_modified_peptides[mod_pep_idx];
-            double current_peptide_mass = candidate.getMonoWeight();
+          double precursor_mass = precursor_masses[precursor_index].first;
+          const Size& scan_index = precursor_masses[precursor_index].second;
+          const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
+
+          // candidates that may match (the exact check is done below):
+          double max_tolerance = precursor_mass_tolerance_unit_ppm ? precursor_mass * precursor_mass_tolerance * 1e-6 : precursor_mass_tolerance;
+          Size first = lower_bound(candidate_masses.begin(), candidate_masses.end(), make_pair(precursor_mass - max_tolerance, Size(0))) - candidate_masses.begin();
+          Size last = upper_bound(candidate_masses.begin(), candidate_masses.end(), make_pair(precursor_mass + max_tolerance, numeric_limits<Size>::max())) - candidate_masses.begin();
 
-            // determine MS2 precursors that match to the current peptide mass
-            multimap<double, Size>::const_iterator low_it;
-            multimap<double, Size>::const_iterator up_it;
+          // move the window of theoretical spectra:
+          if (first >= theo_begin + theo_spectra.size())
+          {
+            theo_spectra.clear();
+            theo_begin = first;
+          }
+          while (theo_begin < first)
+          {
+            theo_spectra.pop_front();
+            ++theo_begin;
+          }
+          while (theo_begin + theo_spectra.size() < last)
+          {
+            theo_spectra.push_back(TheoreticalSpectrum());
+            getTheoreticalSpectrum_(spectrum_generator, candidates[candidate_masses[theo_begin + theo_spectra.size() - 1].second], theo_spectra.back());
+          }
 
-            if (precursor_mass_tolerance_unit_ppm) // ppm
+          vector<PeptideHit>& hits = peptide_hits[scan_index];
+          for (Size candidate_index = first; candidate_index < last; ++candidate_index)
+          {
+            if (!precursorMatches_(candidate_masses[candidate_index].first, precursor_mass, precursor_mass_tolerance, precursor_mass_tolerance_unit_ppm))
             {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * current_peptide_mass * precursor_mass_tolerance * 1e-6);
+              continue; // no matching precursor
             }
-            else // Dalton
+
+            double score = computeHyperScore(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectra[candidate_index - theo_begin]);
+
+            // no hit
+            if (score < 1e-16)
             {
-              low_it = multimap_mass_2_scan_index.lower_bound(current_peptide_mass - 0.5 * precursor_mass_tolerance);
-              up_it = multimap_mass_2_scan_index.upper_bound(current_peptide_mass + 0.5 * precursor_mass_tolerance);
+              continue;
             }
 
-            if (low_it == up_it)
+            // keep only the best hits (heap with the worst hit on top)
+            if (!hits.empty() && (hits.size() >= kept_hits) && (score <= hits.front().getScore()))
             {
-              continue;     // no matching precursor in data
+              continue;
             }
 
-            //create theoretical spectrum
-            MSSpectrum<RichPeak1D> theo_spectrum = MSSpectrum<RichPeak1D>();
-
-            //add peaks for b and y ions with charge 1
-            spectrum_generator.getSpectrum(theo_spectrum, candidate, 1);
-
-            //sort by mz
-            theo_spectrum.sortByPosition();
-
-            for (; low_it != up_it; ++low_it)
+            PeptideHit hit;
+            hit.setSequence(candidates[candidate_masses[candidate_index].second]);
+            hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
+            hit.setScore(score);
+            hits.push_back(hit);
+            push_heap(hits.begin(), hits.end(), hasHigherScore_);
+            if (hits.size() > kept_hits)
             {
-              const Size& scan_index = low_it->second;
-              const MSSpectrum<Peak1D>& exp_spectrum = spectra[scan_index];
-
-              double score = computeHyperScore(fragment_mass_tolerance, fragment_mass_tolerance_unit_ppm, exp_spectrum, theo_spectrum);
-
-              // no hit
-              if (score < 1e-16)
-              {
-                continue;
-              }
-
-              PeptideHit hit;
-              hit.setSequence(candidate);
-              hit.setCharge(exp_spectrum.getPrecursors()[0].getCharge());
-              hit.setScore(score);
-#ifdef _OPENMP
-#pragma omp critical (peptide_hits_access)
-#endif
-              {
-                peptide_hits[scan_index].push_back(hit);
-              }
+              pop_heap(hits.begin(), hits.end(), hasHigherScore_);
+              hits.pop_back();
             }
           }
         }
@@ -30,6 +30,7 @@ MSSimulator
 MzMLSplitter
 OpenMSInfo
 PeakPickerIterative
+PeptideIndexBuilder
 QCCalculator
 QCEmbedder
 QCExporter